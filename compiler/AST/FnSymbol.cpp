@@ -385,9 +385,30 @@ FnSymbol* FnSymbol::partialCopy(SymbolMap* map) {
   // Copy over the partialCopyMap, to be used later in finalizeCopy.
   pci.partialCopyMap.copy(*map);
 
+  gInstantiationStats.signaturesCopied++;
+
   return newFn;
 }
 
+/** Can finalizeCopy() copy a body straight from fn's own copy source,
+ *  instead of first materializing fn's body?
+ *
+ * This holds when fn is a partial copy whose body is still untouched, i.e.
+ * finalizing it would do nothing but copy its source's body and rename
+ * symbols.  Vararg expansion and constrained-generic bookkeeping both edit
+ * the intermediate body or map, so functions involved in those are excluded.
+ */
+static bool canCopyBodyThrough(FnSymbol* fn, PartialCopyData* pci) {
+  FnSymbol* source = pci->partialCopySource;
+
+  return fn->body->body.length               == 0     &&
+         fn->hasFlag(FLAG_EXPANDED_VARARGS) == false &&
+         pci->varargOldFormal               == NULL  &&
+         fn->interfaceInfo                  == NULL  &&
+         source->interfaceInfo              == NULL  &&
+         source->isConstrainedGeneric()     == false;
+}
+
 /** Finish copying the function's AST after a partial copy.
  *
  * This function finishes the work started by partialCopy.  This involves
@@ -398,7 +419,46 @@ FnSymbol* FnSymbol::partialCopy(SymbolMap* map) {
  */
 void FnSymbol::finalizeCopy() {
   if (PartialCopyData* pci = getPartialCopyData(this)) {
-    FnSymbol* const partialCopySource = pci->partialCopySource;
+    FnSymbol* partialCopySource = pci->partialCopySource;
+
+    // Retrieve our old/new symbol map from the partial copy process.
+    SymbolMap* map = &(pci->partialCopyMap);
+
+    /*
+     * Partial instantiations are often only stepping stones to the
+     * instantiation that is actually called, e.g. a method on a generic
+     * record is instantiated for the receiver and then again for its
+     * remaining generic formals.  Rather than materializing the bodies of
+     * such intermediate functions, copy from the function they were copied
+     * from, composing the symbol maps along the way.  The intermediates
+     * keep their PartialCopyData and can still be finalized on their own.
+     */
+    SymbolMap composedMap;
+
+    while (PartialCopyData* sourcePci = getPartialCopyData(partialCopySource)) {
+      if (canCopyBodyThrough(partialCopySource, sourcePci) == false)
+        break;
+
+      // sourcePci maps older symbols to the source's symbols; 'map' maps
+      // those on to ours.
+      SymbolMap next;
+
+      next.copy(*map);
+
+      form_Map(SymbolMapElem, e, sourcePci->partialCopyMap) {
+        Symbol* ours = map->get(e->value);
+
+        next.put(e->key, ours != NULL ? ours : e->value);
+      }
+
+      composedMap.clear();
+      composedMap.move(next);
+
+      map               = &composedMap;
+      partialCopySource = sourcePci->partialCopySource;
+
+      gInstantiationStats.bodiesCopiedThrough++;
+    }
 
     // Make sure that the source has been finalized.
     partialCopySource->finalizeCopy();
@@ -408,8 +468,7 @@ void FnSymbol::finalizeCopy() {
 
     SET_LINENO(this);
 
-    // Retrieve our old/new symbol map from the partial copy process.
-    SymbolMap* map = &(pci->partialCopyMap);
+    int firstNewId = lastNodeIDUsed() + 1;
 
     /*
      * When we reach this point we will be in one of three scenarios:
@@ -510,6 +569,9 @@ void FnSymbol::finalizeCopy() {
     if (InterfaceInfo* ifcInfo = partialCopySource->interfaceInfo)
       handleCallsToOtherCGfuns(partialCopySource, ifcInfo, *map, this);
 
+    gInstantiationStats.bodiesCopied++;
+    gInstantiationStats.bodyAstsCopied += lastNodeIDUsed() + 1 - firstNewId;
+
     // Clean up book keeping information.
     clearPartialCopyData(this);
   }
@@ -26,6 +26,8 @@
 
 static std::map<int, PartialCopyData> sFnMap;
 
+InstantiationStats gInstantiationStats;
+
 PartialCopyData::PartialCopyData() {
   partialCopySource = NULL;
   varargOldFormal   = NULL;
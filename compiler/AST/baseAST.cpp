@@ -36,6 +36,7 @@
 #include "ModuleSymbol.h"
 #include "ParamForLoop.h"
 #include "parser.h"
+#include "PartialCopyData.h"
 #include "passes.h"
 #include "resolution.h"
 #include "runpasses.h"
@@ -170,6 +171,13 @@ void printStatistics(const char* pass) {
   if (strstr(fPrintStatistics, "k") && !strstr(fPrintStatistics, "n"))
     fprintf(stderr, "    Type %6dK Prim  %6dK Enum %6dK Class %6dK\n",
             kType, kPrimitiveType, kEnumType, kAggregateType);
+
+  if (strstr(fPrintStatistics, "i")) {
+    const InstantiationStats& is = gInstantiationStats;
+    fprintf(stderr, "    Inst sig %9ld  body %9ld  skipped %9ld  bodyAsts %9ld\n",
+            is.signaturesCopied, is.bodiesCopied, is.bodiesCopiedThrough,
+            is.bodyAstsCopied);
+  }
   last_nasts = nasts;
 }
 
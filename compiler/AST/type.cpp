@@ -49,6 +49,7 @@
 
 #include "chpl/framework/compiler-configuration.h"
 
+#include <algorithm>
 #include <cmath>
 
 static bool isDerivedType(Type* type, Flag flag);
@@ -1536,6 +1537,67 @@ int get_exponent_width(Type *t) {
   return 0;
 }
 
+//
+// An estimate of the number of bytes a value of type 't' occupies, for
+// heuristics that should not copy or stack-allocate large values.  Class
+// instances count as a pointer.  Fields are aligned to their own size, up
+// to 8 bytes.  Returns -1 for types whose layout is not known here, such
+// as extern records and c_arrays.
+//
+int64_t estimateTypeSize(Type* t) {
+  if (t == dtVoid || t == dtNothing)
+    return 0;
+
+  if (is_bool_type(t))
+    return 1;
+
+  if (is_int_type(t) || is_uint_type(t) || is_real_type(t) ||
+      is_imag_type(t) || is_complex_type(t))
+    return get_width(t) / 8;
+
+  if (is_enum_type(t))
+    return 8;
+
+  TypeSymbol* ts = t->symbol;
+
+  if (ts->hasEitherFlag(FLAG_WIDE_REF, FLAG_WIDE_CLASS))
+    return 16;
+
+  AggregateType* at = toAggregateType(t);
+
+  if (at == NULL || at->isClass() || ts->hasFlag(FLAG_REF) ||
+      ts->hasFlag(FLAG_DATA_CLASS) || ts->hasFlag(FLAG_C_PTR_CLASS) ||
+      ts->hasFlag(FLAG_C_PTRCONST_CLASS))
+    return 8;
+
+  if (ts->hasFlag(FLAG_EXTERN) || ts->hasFlag(FLAG_C_ARRAY))
+    return -1;
+
+  int64_t size = 0;
+
+  for_fields(field, at) {
+    if (field->hasFlag(FLAG_PARAM) || field->hasFlag(FLAG_TYPE_VARIABLE))
+      continue;
+
+    int64_t fieldSize = field->isRef() ? 8 : estimateTypeSize(field->type);
+
+    if (fieldSize < 0)
+      return -1;
+
+    int64_t align = std::min(fieldSize, (int64_t) 8);
+
+    if (align > 0)
+      size = (size + align - 1) / align * align;
+
+    if (at->isUnion())
+      size = std::max(size, fieldSize);
+    else
+      size += fieldSize;
+  }
+
+  return size;
+}
+
 bool isClass(Type* t) {
   if (AggregateType* ct = toAggregateType(t))
     return ct->isClass();
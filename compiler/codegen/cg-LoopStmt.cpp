@@ -22,9 +22,19 @@
 
 #include "codegen.h"
 #include "driver.h"
+#include "OptRemarks.h"
 
 void LoopStmt::reportVectorizable()
 {
+  if (this->isVectorizable() && optRemarksEnabledFor(this)) {
+    if (this->hasParallelAccessVectorizationHazard())
+      optRemark(OPT_REMARK_PASSED, "vectorize", this,
+                "loop hinted for vectorization (no parallel access)");
+    else
+      optRemark(OPT_REMARK_PASSED, "vectorize", this,
+                "loop hinted for vectorization (with parallel access)");
+  }
+
   if (fReportVectorizedLoops) {
     ModuleSymbol *mod = toModuleSymbol(this->getModule());
     INT_ASSERT(mod);
@@ -40,6 +40,7 @@
 #include "expr.h"
 #include "files.h"
 #include "fixupExports.h"
+#include "FnProfiler.h"
 #include "ForLoop.h"
 #include "intlimits.h"
 #include "iterator.h"
@@ -2511,6 +2512,8 @@ void FnSymbol::codegenDef() {
   if( (hasFlag(FLAG_GPU_CODEGEN) != gCodegenGPU) &&
       !hasFlag(FLAG_GPU_AND_CPU_CODEGEN)) return;
 
+  FnProfileScope profile("codegen", this);
+
   info->cStatements.clear();
   info->cLocalDecls.clear();
 
@@ -2865,7 +2868,11 @@ void FnSymbol::codegenDef() {
 
     // (note, in particular, the default pass manager's
     //  populateFunctionPassManager does not include vectorization)
-    simplifyFunction(func);
+    {
+      FnProfileScope profileOpt("llvmOpt", this);
+
+      simplifyFunction(func);
+    }
 #endif
   }
 
@@ -40,6 +40,7 @@
 #include "misc.h"
 #include "mli.h"
 #include "mysystem.h"
+#include "OptRemarks.h"
 #include "passes.h"
 #include "stlUtil.h"
 #include "stmt.h"
@@ -2582,11 +2583,13 @@ static void codegenGpuGlobals() {
 // Implements the RemarkSerializer interface for LLVM
 // For each remark to be outputted (after filtering for pass names), `emit()` is called
 // We can then do further filtering and  control how the remarks are printed
+// Remarks are also added to the --opt-remarks stream when that is enabled
 struct ChapelRemarkSerializer : public llvm::remarks::RemarkSerializer {
-  ChapelRemarkSerializer(llvm::raw_ostream& OS)
+  ChapelRemarkSerializer(llvm::raw_ostream& OS, bool print)
       : llvm::remarks::RemarkSerializer(
             llvm::remarks::Format::Unknown, OS,
-            llvm::remarks::SerializerMode::Standalone) {}
+            llvm::remarks::SerializerMode::Standalone),
+        print(print) {}
 
   void emit(const llvm::remarks::Remark& Remark) override {
 
@@ -2621,6 +2624,12 @@ struct ChapelRemarkSerializer : public llvm::remarks::RemarkSerializer {
       if(shouldSkip) return;
     }
 
+    if (optRemarksEnabled()) {
+      addOptRemark(Remark, fn);
+    }
+
+    if (!print) return;
+
     if (auto Loc = Remark.Loc) {
       OS << Loc->SourceFilePath << ":" << Loc->SourceLine << ":" << Loc->SourceColumn;
     } else {
@@ -2642,6 +2651,37 @@ struct ChapelRemarkSerializer : public llvm::remarks::RemarkSerializer {
         OS, ExternalFilename);
   }
   private:
+  bool print;
+
+  void addOptRemark(const llvm::remarks::Remark& Remark, FnSymbol* fn) {
+    std::string filename;
+    int linenum = 0;
+
+    if (auto Loc = Remark.Loc) {
+      filename = Loc->SourceFilePath.str();
+      linenum = Loc->SourceLine;
+    } else if (fn != nullptr) {
+      filename = cleanFilename(fn->fname());
+      linenum = fn->linenum();
+    } else {
+      return;
+    }
+
+    OptRemarkKind kind = OPT_REMARK_ANALYSIS;
+    switch (Remark.RemarkType) {
+      case llvm::remarks::Type::Passed:  kind = OPT_REMARK_PASSED; break;
+      case llvm::remarks::Type::Missed:
+      case llvm::remarks::Type::Failure: kind = OPT_REMARK_MISSED; break;
+      default:                           break;
+    }
+
+    std::string pass = "llvm:" + Remark.PassName.str();
+    std::string function = fn ? fn->name : Remark.FunctionName.str();
+
+    optRemark(kind, pass.c_str(), filename.c_str(), linenum,
+              function.c_str(), Remark.getArgsAsMsg().c_str());
+  }
+
   std::string typeToString(llvm::remarks::Type t) {
     switch (t) {
       case llvm::remarks::Type::Passed:           return "passed";
@@ -2658,9 +2698,10 @@ struct ChapelRemarkSerializer : public llvm::remarks::RemarkSerializer {
 // based on `llvm::setupLLVMOptimizationRemarks`
 static llvm::Error setupRemarks(llvm::LLVMContext& Context,
                                 llvm::raw_ostream& OS,
+                                bool print,
                                 llvm::StringRef RemarksPasses) {
   std::unique_ptr<llvm::remarks::RemarkSerializer> RemarkSerializer =
-      std::make_unique<ChapelRemarkSerializer>(OS);
+      std::make_unique<ChapelRemarkSerializer>(OS, print);
 
   // Create the main remark streamer.
   Context.setMainRemarkStreamer(std::make_unique<llvm::remarks::RemarkStreamer>(
@@ -2680,6 +2721,11 @@ static llvm::Error setupRemarks(llvm::LLVMContext& Context,
 static bool shouldShowLLVMRemarks() {
   return !llvmRemarksFilters.empty() || !llvmRemarksFunctionsToShow.empty();
 }
+
+// the LLVM passes that --opt-remarks collects from when no
+// --llvm-remarks filter is given
+static const char* defaultOptRemarksLLVMPasses =
+  "inline|loop-vectorize|slp-vectorizer|licm";
 #endif
 
 // Do this for GPU and then do for CPU
@@ -2692,8 +2738,12 @@ static void codegenPartTwo() {
 
 #ifdef HAVE_LLVM
   if (fLlvmCodegen) {
-    if(shouldShowLLVMRemarks()) {
-      auto err = setupRemarks(gGenInfo->llvmContext, llvm::outs(), llvmRemarksFilters);
+    if(shouldShowLLVMRemarks() || optRemarksEnabled()) {
+      bool print = shouldShowLLVMRemarks();
+      std::string filters = llvmRemarksFilters;
+      if (!print) filters = defaultOptRemarksLLVMPasses;
+      auto err = setupRemarks(gGenInfo->llvmContext, llvm::outs(),
+                              print, filters);
       if (err) {
         USR_FATAL("failed to add optimization remarks reporting");
       }
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _FN_PROFILER_H_
+#define _FN_PROFILER_H_
+
+#include <cstdio>
+
+class FnSymbol;
+
+/************************************* | **************************************
+*                                                                             *
+* An opt-in, hierarchical profiler that attributes compile time to the        *
+* individual functions processed by the hot passes.  It complements the       *
+* PhaseTracker, which only reports time per pass.                             *
+*                                                                             *
+* Each FnProfileScope records one region of work.  Regions nest, so the time  *
+* spent resolving a function is split into the time spent in the function    *
+* itself ("self") and the time spent resolving the functions it calls.        *
+* Each region also records the number of AST nodes created inside it.  That  *
+* is the change in lastNodeIDUsed(), so it counts nodes that were later       *
+* freed too; it is not a measure of memory.                                   *
+*                                                                             *
+* Enabled by --profile-functions=<file>, which writes a Chrome trace          *
+* (chrome://tracing, Perfetto) to <file> and prints a top-N summary.          *
+*                                                                             *
+************************************** | *************************************/
+
+extern char fnProfileFilename[FILENAME_MAX + 1];
+extern int  fnProfileTopN;
+
+static inline bool fnProfilerEnabled() {
+  return fnProfileFilename[0] != '\0';
+}
+
+class FnProfileScope
+{
+public:
+  // Attribute the work to 'fn'
+                 FnProfileScope(const char* category, FnSymbol* fn);
+
+  // A named region that is not attributed to a function, e.g. a pass
+                 FnProfileScope(const char* category, const char* name);
+
+                ~FnProfileScope();
+
+private:
+                 FnProfileScope();
+
+  bool           mActive;
+};
+
+// Write the trace file and print the summary.  Does nothing if the
+// profiler is not enabled or nothing was recorded.
+void             fnProfilerReport();
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _OPT_REMARKS_H_
+#define _OPT_REMARKS_H_
+
+#include <cstdio>
+
+class BaseAST;
+
+/************************************* | **************************************
+*                                                                             *
+* A single stream of optimization remarks from the compiler's passes, keyed   *
+* to source locations.  A remark says that an optimization was applied        *
+* ("passed"), that it was considered and not applied ("missed", usually with  *
+* a reason), or gives other information a pass found ("analysis").            *
+*                                                                             *
+* The --report-* flags of the individual passes print their own formats to    *
+* stdout; the remarks are recorded independently of them.                     *
+*                                                                             *
+* Enabled by --opt-remarks=<file>, which writes one JSON object per line to   *
+* <file>.  The remarks are sorted by location, and only remarks for user      *
+* code are kept unless --devel is given.  tools/chplremarks shows them next   *
+* to the source.                                                              *
+*                                                                             *
+************************************** | *************************************/
+
+extern char optRemarksFilename[FILENAME_MAX + 1];
+
+static inline bool optRemarksEnabled() {
+  return optRemarksFilename[0] != '\0';
+}
+
+enum OptRemarkKind {
+  OPT_REMARK_PASSED,
+  OPT_REMARK_MISSED,
+  OPT_REMARK_ANALYSIS
+};
+
+// Would a remark for 'ast' be kept?  Useful to avoid building a message.
+bool optRemarksEnabledFor(BaseAST* ast);
+
+// Record a remark from 'pass' at the location of 'ast'.  'reason' may be
+// NULL; for a missed remark it says why the optimization was not applied.
+void optRemark(OptRemarkKind kind,
+               const char*   pass,
+               BaseAST*      ast,
+               const char*   message,
+               const char*   reason = NULL);
+
+// Record a remark for a location without an AST node, e.g. one from LLVM.
+// The caller decides whether the location is in user code.
+void optRemark(OptRemarkKind kind,
+               const char*   pass,
+               const char*   filename,
+               int           lineno,
+               const char*   function,
+               const char*   message,
+               const char*   reason = NULL);
+
+// Write the remarks file.  Does nothing if remarks are not enabled.
+void optRemarksReport();
+
+#endif
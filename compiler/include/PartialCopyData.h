@@ -59,4 +59,17 @@ void             clearPartialCopyDataFnMap();
 
 void             checkEmptyPartialCopyDataFnMap();
 
+//
+// Counters for the work done by FnSymbol::partialCopy() and
+// FnSymbol::finalizeCopy(), reported by --print-statistics=i.
+//
+struct InstantiationStats {
+  long signaturesCopied    = 0; // partialCopy() calls
+  long bodiesCopied        = 0; // bodies materialized by finalizeCopy()
+  long bodiesCopiedThrough = 0; // intermediate bodies that were skipped
+  long bodyAstsCopied      = 0; // AST nodes created by finalizeCopy()
+};
+
+extern InstantiationStats gInstantiationStats;
+
 #endif
@@ -133,7 +133,7 @@ def_vec_hash(BaseAST);
 //
 // type definitions for common maps
 //
-typedef Map<Symbol*,Symbol*>     SymbolMap;
+typedef SwissMap<Symbol*,Symbol*> SymbolMap;
 typedef MapElem<Symbol*,Symbol*> SymbolMapElem;
 
 typedef struct {
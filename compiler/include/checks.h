@@ -59,6 +59,7 @@ void check_loopInvariantCodeMotion();
 void check_prune2();
 void check_returnStarTuplesByRefArgs();
 void check_insertWideReferences();
+void check_batchRemoteAccesses();
 void check_optimizeOnClauses();
 void check_addInitCalls();
 void check_insertLineNumbers();
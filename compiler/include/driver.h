@@ -69,15 +69,18 @@ extern bool fAutoAggregation;
 extern bool fReportAutoAggregation;
 
 extern bool fNoRemoteValueForwarding;
+extern bool fNoRemoteAccessBatching;
 extern bool fNoInferConstRefs;
 extern bool fNoRemoteSerialization;
 extern bool fNoRemoveCopyCalls;
 extern bool fNoScalarReplacement;
+extern bool fNoStackAllocation;
 extern bool fNoTupleCopyOpt;
 extern bool fNoOptimizeRangeIteration;
 extern bool fNoOptimizeLoopIterators;
 extern bool fNoVectorize;
 extern bool fForceVectorize;
+extern bool fVectorizeGpuEligibleLoops;
 extern bool fNoPrivatization;
 extern bool fNoOptimizeOnClauses;
 extern bool fNoRemoveEmptyRecords;
@@ -87,6 +90,9 @@ extern bool fReplaceArrayAccessesWithRefTemps;
 extern int  optimize_on_clause_limit;
 extern int  scalar_replace_limit;
 extern int  inline_iter_yield_limit;
+extern int  inline_iter_cost_limit;
+extern int  inline_size_limit;
+extern int  stack_allocation_limit;
 extern int  tuple_copy_limit;
 
 extern bool fNoOptimizeForallUnordered;
@@ -247,10 +253,13 @@ extern bool fReportAliases;
 extern bool fReportBlocking;
 extern bool fReportOptimizedLoopIterators;
 extern bool fReportInlinedIterators;
+extern bool fReportNonInlinedIterators;
 extern bool fReportVectorizedLoops;
 extern bool fReportOptimizedOn;
+extern bool fReportRemoteAccessBatching;
 extern bool fReportPromotion;
 extern bool fReportScalarReplace;
+extern bool fReportStackAllocation;
 extern bool fReportGpu;
 extern bool fReportDeadBlocks;
 extern bool fReportDeadModules;
@@ -135,6 +135,50 @@ template <class K, class AHashFns, class C> class HashMap : public Map<K,C> {
           if ((_p)->key)
 
 
+// SwissMap is a replacement for Map with pointer or integer keys, built on
+// SwissIndex (vec.h).  As with Map, the key ((K)0) should not be used, and
+// form_Map can iterate over it.  Unlike Map, v[0..n) holds exactly the
+// entries, in the order their keys were first put, so the iteration order
+// does not depend on key addresses or ids.  del keeps that order, so it
+// takes time linear in the size of the map.
+// Code whose output depends on the order of a SymbolMap, e.g. the formals
+// added by createTaskFunctions and flattenFunctions, should not rely on
+// either order and instead walk sortedSymbolMapElts(), which sorts by id.
+template <class K, class C> class SwissMap {
+ public:
+  int           n;
+  MapElem<K,C>  *v;
+  MapElem<K,C>  e[VEC_INTEGRAL_SIZE];
+
+  SwissMap() : n(0), v(0) { }
+  SwissMap(const SwissMap<K,C> &m) : n(0), v(0) { copy(m); }
+  ~SwissMap() { if (v && v != e) free(v); }
+
+  MapElem<K,C> *put(K akey, C avalue);
+  C get(K akey);
+  void get_keys(Vec<K> &keys);
+  void get_keys_set(Vec<K> &keys);
+  void get_values(Vec<C> &values);
+  MapElem<K,C> *get_record(K akey);
+  void map_union(SwissMap<K,C> &m);
+  int del(K akey);
+  void clear();
+  void copy(const SwissMap<K,C> &m);
+  void move(SwissMap<K,C> &m);
+  int count() const { return n; }
+  MapElem<K,C>* begin() const { return v; }
+  MapElem<K,C>* end() const { return v + n; }
+  SwissMap<K,C>& operator=(const SwissMap<K,C> &m) { copy(m); return *this; }
+  int length() const { return n; }
+  int size() const { return n; }
+
+ private:
+  SwissIndex index;
+
+  void index_add(int i);
+  void index_rebuild();
+};
+
 class StringHashFns : public HashFns<const char*> {
  public:
   static unsigned int hash(const char *s) {
@@ -291,6 +335,137 @@ map_set_add(Map<K, Vec<C> *> &m, K akey, Vec<C> *madd) {
   v->set_union(*madd);
 }
 
+template <class K, class C> inline MapElem<K,C> *
+SwissMap<K,C>::get_record(K akey) {
+  if (!index.built()) {
+    for (int i = 0; i < n; i++)
+      if (v[i].key == akey)
+        return &v[i];
+    return 0;
+  }
+  int i = index.find(_swiss_hasher(akey),
+                     [&](int j) { return v[j].key == akey; });
+  return i < 0 ? 0 : &v[i];
+}
+
+template <class K, class C> inline C
+SwissMap<K,C>::get(K akey) {
+  MapElem<K,C> *x = get_record(akey);
+  if (x)
+    return x->value;
+  return (C)0;
+}
+
+template <class K, class C> inline MapElem<K,C> *
+SwissMap<K,C>::put(K akey, C avalue) {
+  MapElem<K,C> *x = get_record(akey);
+  if (x) {
+    x->value = avalue;
+    return x;
+  }
+  _swiss_reserve(v, e, n);
+  v[n].key = akey;
+  v[n].value = avalue;
+  index_add(n);
+  return &v[n++];
+}
+
+template <class K, class C> inline void
+SwissMap<K,C>::index_add(int i) {
+  if (index.built() && index.hasRoom(i)) {
+    index.insert(_swiss_hasher(v[i].key), i);
+    return;
+  }
+  if (!index.built() && i < SWISS_LINEAR_SIZE)
+    return;
+  index.reset(i + 1);
+  for (int j = 0; j <= i; j++)
+    index.insert(_swiss_hasher(v[j].key), j);
+}
+
+template <class K, class C> inline void
+SwissMap<K,C>::index_rebuild() {
+  index.clear();
+  if (n > SWISS_LINEAR_SIZE) {
+    index.reset(n);
+    for (int j = 0; j < n; j++)
+      index.insert(_swiss_hasher(v[j].key), j);
+  }
+}
+
+template <class K, class C> inline void
+SwissMap<K,C>::get_keys(Vec<K> &keys) {
+  for (int i = 0; i < n; i++)
+    keys.add(v[i].key);
+}
+
+template <class K, class C> inline void
+SwissMap<K,C>::get_keys_set(Vec<K> &keys) {
+  for (int i = 0; i < n; i++)
+    keys.set_add(v[i].key);
+}
+
+template <class K, class C> inline void
+SwissMap<K,C>::get_values(Vec<C> &values) {
+  for (int i = 0; i < n; i++)
+    values.add(v[i].value);
+}
+
+template <class K, class C> inline void
+SwissMap<K,C>::map_union(SwissMap<K,C> &m) {
+  for (int i = 0; i < m.n; i++)
+    put(m.v[i].key, m.v[i].value);
+}
+
+template <class K, class C> inline int
+SwissMap<K,C>::del(K akey) {
+  MapElem<K,C> *x = get_record(akey);
+  if (!x)
+    return 0;
+  int i = x - v;
+  memmove((void*)&v[i], &v[i + 1], (n - i - 1) * sizeof(MapElem<K,C>));
+  n--;
+  index_rebuild();
+  return 1;
+}
+
+template <class K, class C> inline void
+SwissMap<K,C>::clear() {
+  if (v && v != e)
+    free(v);
+  v = 0;
+  n = 0;
+  index.clear();
+}
+
+template <class K, class C> inline void
+SwissMap<K,C>::copy(const SwissMap<K,C> &m) {
+  if (this == &m)
+    return;
+  clear();
+  if (!m.n)
+    return;
+  _swiss_copy(v, e, m.v, m.n);
+  n = m.n;
+  index_rebuild();
+}
+
+template <class K, class C> inline void
+SwissMap<K,C>::move(SwissMap<K,C> &m) {
+  if (this == &m)
+    return;
+  clear();
+  n = m.n;
+  if (m.v == m.e) {
+    memcpy((void*)e, m.e, n * sizeof(MapElem<K,C>));
+    v = e;
+  } else
+    v = m.v;
+  m.v = 0;
+  m.n = 0;
+  index.take(m.index);
+}
+
 template <class K, class AHashFns, class C> inline MapElem<K,C> *
 HashMap<K,AHashFns,C>::get_internal(K akey) {
   if (!n)
@@ -726,6 +901,4 @@ NBlockHash<C, AHashFns, N>::move(NBlockHash<C, AHashFns, N> &hh) {
   hh.clear();
 }
 
-void test_map();
-
 #endif
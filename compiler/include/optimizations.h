@@ -67,6 +67,7 @@ bool outlivesBlock(LifetimeInformation* info, Symbol* sym, BlockStmt* block);
 void checkLifetimesForForallUnorderedOps(FnSymbol* fn,
                                          LifetimeInformation* lifetimeInfo);
 std::vector<Expr *> getLastStmtsForForallUnorderedOps(ForallStmt *forall);
+std::vector<Expr *> getLastStmtsForLoopBody(BlockStmt *body);
 void optimizeForallUnorderedOps();
 
 void liveVariableAnalysis(FnSymbol* fn,
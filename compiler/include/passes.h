@@ -38,6 +38,7 @@ extern bool iteratorsLowered;
 // prototypes of functions that are called as passes (alphabetical)
 //
 void addInitCalls();
+void batchRemoteAccesses();
 void buildDefaultFunctions();
 void bulkCopyRecords();
 void callDestructors();
@@ -592,6 +592,7 @@ bool isLegalParamType(Type*);
 int  get_width(Type*);
 int  get_mantissa_width(Type*);
 int  get_exponent_width(Type*);
+int64_t estimateTypeSize(Type* t); // bytes, or -1 if unknown
 bool isClass(Type* t); // includes ref, ddata, classes; not unmanaged
 bool isHeapAllocatedType(Type* t); // includes ddata, classes, wide classes
 bool isClassOrNil(Type* t);
@@ -257,6 +257,101 @@ class UnionFind : public Vec<int> {
 
 extern unsigned int prime2[];
 
+// SwissIndex is the hash index behind SwissSet (below) and SwissMap
+// (map.h).  Those containers keep their elements in a dense array, in
+// insertion order, and the index maps a hash to a position in that array.
+//
+// The index is open addressed over groups of SWISS_GROUP_SIZE slots.  Each
+// slot has a control byte, which is either SWISS_EMPTY or the low 7 bits
+// of the hash of the element it holds, and the position of that element.
+// A lookup compares all the control bytes of a group at once and only
+// looks at the elements whose 7 bits match.
+//
+// Iteration goes through the dense array, so unlike Vec's set mode the
+// iteration order does not depend on the hash function.  That makes it
+// safe for these containers to hash on pointer values.
+#define SWISS_GROUP_SIZE        8
+#define SWISS_LINEAR_SIZE       8               /* no index up to this size */
+#define SWISS_EMPTY             0x80
+
+class SwissIndex {
+ public:
+  SwissIndex() : ctrl(0), pos(0), capacity(0) { }
+  ~SwissIndex() { free(ctrl); }
+
+  static uint64_t hash(uintptr_t x) {
+    uint64_t h = (uint64_t)x * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 32);
+  }
+
+  bool built() const { return capacity != 0; }
+  // is there room for one more element in an index holding n?
+  bool hasRoom(int n) const { return n + 1 <= capacity - capacity / 8; }
+  // empty the index and size it for 2*n elements
+  void reset(int n);
+  void clear() { free(ctrl); ctrl = 0; pos = 0; capacity = 0; }
+  void take(SwissIndex &o) {
+    free(ctrl);
+    ctrl = o.ctrl; pos = o.pos; capacity = o.capacity;
+    o.ctrl = 0; o.pos = 0; o.capacity = 0;
+  }
+  void insert(uint64_t h, int i);
+  // return the position i for which eq(i) holds, or -1
+  template <class Eq> int find(uint64_t h, Eq eq) const;
+
+ private:
+  uint8_t* ctrl;
+  int32_t* pos;
+  int      capacity;                            // 0 or a power of 2
+
+  SwissIndex(const SwissIndex&);
+  void operator=(const SwissIndex&);
+
+  static uint64_t group(const uint8_t* p);
+  static uint64_t matchByte(uint64_t g, uint8_t b);
+  static uint64_t matchEmpty(uint64_t g) { return g & 0x8080808080808080ull; }
+  static int      firstByte(uint64_t m) { return __builtin_ctzll(m) >> 3; }
+};
+
+template <typename T> inline uint64_t _swiss_hasher(T obj) {
+  return SwissIndex::hash((uintptr_t)obj);
+}
+
+// SwissSet is a drop-in replacement for Vec's set mode (set_add, set_in)
+// for pointer and integer elements.  The element 0 should not be added.
+// Unlike a Vec set, v[0..n) holds exactly the elements, in the order they
+// were added, with no empty slots.  del keeps that order, so it takes
+// time linear in the size of the set.
+template <class C> class SwissSet {
+ public:
+  int           n;
+  C             *v;
+  C             e[VEC_INTEGRAL_SIZE];
+
+  SwissSet() : n(0), v(0) { }
+  SwissSet(const SwissSet<C> &s) : n(0), v(0) { copy(s); }
+  ~SwissSet() { if (v && v != e) free(v); }
+
+  C *set_add(C a);
+  C *set_in(C a);
+  int set_union(SwissSet<C> &s);
+  int del(C a);
+  void clear();
+  void copy(const SwissSet<C> &s);
+  int count() const { return n; }
+  C* begin() const { return v; }
+  C* end() const { return v + n; }
+  SwissSet<C>& operator=(const SwissSet<C> &s) { copy(s); return *this; }
+  int length() const { return n; }
+  int size() const { return n; }
+
+ private:
+  SwissIndex index;
+
+  void index_add(int i);
+  void index_rebuild();
+};
+
 
 
 /* IMPLEMENTATION */
@@ -599,6 +694,183 @@ Vec<C,S>::copy_internal(const Vec<C,S> &vv) {
   memset((void*)(v + n), 0, (nl - n) * sizeof(C));
 }
 
-void test_vec();
+inline void
+SwissIndex::reset(int n) {
+  int c = 2 * SWISS_GROUP_SIZE;
+  while (c - c / 8 < 2 * n)
+    c *= 2;
+  free(ctrl);
+  capacity = c;
+  ctrl = (uint8_t*)malloc(c * (sizeof(uint8_t) + sizeof(int32_t)));
+  pos = (int32_t*)(ctrl + c);
+  memset(ctrl, SWISS_EMPTY, c);
+}
+
+inline uint64_t
+SwissIndex::group(const uint8_t* p) {
+  uint64_t g;
+  memcpy(&g, p, sizeof(g));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  g = __builtin_bswap64(g);
+#endif
+  return g;
+}
+
+// Set the high bit of each byte of g that equals b.  This can also flag
+// a byte just above a real match, but never an empty one, and every
+// candidate is checked against the element anyway.
+inline uint64_t
+SwissIndex::matchByte(uint64_t g, uint8_t b) {
+  uint64_t x = g ^ (0x0101010101010101ull * b);
+  return (x - 0x0101010101010101ull) & ~x & 0x8080808080808080ull;
+}
+
+inline void
+SwissIndex::insert(uint64_t h, int i) {
+  int mask = capacity / SWISS_GROUP_SIZE - 1;
+  int g = (int)(h >> 7) & mask;
+  for (int step = 1; ; step++) {
+    uint8_t* p = ctrl + g * SWISS_GROUP_SIZE;
+    if (uint64_t m = matchEmpty(group(p))) {
+      int s = firstByte(m);
+      p[s] = (uint8_t)(h & 0x7f);
+      pos[g * SWISS_GROUP_SIZE + s] = i;
+      return;
+    }
+    g = (g + step) & mask;
+  }
+}
+
+template <class Eq> inline int
+SwissIndex::find(uint64_t h, Eq eq) const {
+  int mask = capacity / SWISS_GROUP_SIZE - 1;
+  int g = (int)(h >> 7) & mask;
+  for (int step = 1; ; step++) {
+    uint64_t x = group(ctrl + g * SWISS_GROUP_SIZE);
+    for (uint64_t m = matchByte(x, (uint8_t)(h & 0x7f)); m; m &= m - 1) {
+      int i = pos[g * SWISS_GROUP_SIZE + firstByte(m)];
+      if (eq(i))
+        return i;
+    }
+    if (matchEmpty(x))
+      return -1;
+    g = (g + step) & mask;
+  }
+}
+
+// Make room in the dense array v (with inline storage e) for element n.
+// The allocated size is always VEC_INTEGRAL_SIZE or a power of 2 >= n.
+template <class E> inline void
+_swiss_reserve(E *&v, E *e, int n) {
+  if (!v)
+    v = e;
+  else if (n >= VEC_INTEGRAL_SIZE && !(n & (n - 1))) {
+    if (v == e) {
+      v = (E*)malloc(2 * n * sizeof(E));
+      memcpy((void*)v, e, n * sizeof(E));
+    } else
+      v = (E*)realloc((void*)v, 2 * n * sizeof(E));
+  }
+}
+
+template <class E> inline void
+_swiss_copy(E *&v, E *e, const E *from, int n) {
+  if (n <= VEC_INTEGRAL_SIZE)
+    v = e;
+  else {
+    int l = VEC_INTEGRAL_SIZE;
+    while (l < n)
+      l *= 2;
+    v = (E*)malloc(l * sizeof(E));
+  }
+  memcpy((void*)v, from, n * sizeof(E));
+}
+
+template <class C> inline C *
+SwissSet<C>::set_in(C a) {
+  if (!index.built()) {
+    for (int i = 0; i < n; i++)
+      if (v[i] == a)
+        return &v[i];
+    return 0;
+  }
+  int i = index.find(_swiss_hasher(a), [&](int j) { return v[j] == a; });
+  return i < 0 ? 0 : &v[i];
+}
+
+template <class C> inline C *
+SwissSet<C>::set_add(C a) {
+  if (set_in(a))
+    return 0;
+  _swiss_reserve(v, e, n);
+  v[n] = a;
+  index_add(n);
+  return &v[n++];
+}
+
+template <class C> inline void
+SwissSet<C>::index_add(int i) {
+  if (index.built() && index.hasRoom(i)) {
+    index.insert(_swiss_hasher(v[i]), i);
+    return;
+  }
+  if (!index.built() && i < SWISS_LINEAR_SIZE)
+    return;
+  index.reset(i + 1);
+  for (int j = 0; j <= i; j++)
+    index.insert(_swiss_hasher(v[j]), j);
+}
+
+template <class C> inline void
+SwissSet<C>::index_rebuild() {
+  index.clear();
+  if (n > SWISS_LINEAR_SIZE) {
+    index.reset(n);
+    for (int j = 0; j < n; j++)
+      index.insert(_swiss_hasher(v[j]), j);
+  }
+}
+
+template <class C> inline int
+SwissSet<C>::del(C a) {
+  C *x = set_in(a);
+  if (!x)
+    return 0;
+  int i = x - v;
+  memmove((void*)&v[i], &v[i + 1], (n - i - 1) * sizeof(C));
+  n--;
+  index_rebuild();
+  return 1;
+}
+
+template <class C> inline int
+SwissSet<C>::set_union(SwissSet<C> &s) {
+  int changed = 0;
+  for (int i = 0; i < s.n; i++)
+    if (set_add(s.v[i]))
+      changed = 1;
+  return changed;
+}
+
+template <class C> inline void
+SwissSet<C>::clear() {
+  if (v && v != e)
+    free(v);
+  v = 0;
+  n = 0;
+  index.clear();
+}
+
+template <class C> inline void
+SwissSet<C>::copy(const SwissSet<C> &s) {
+  if (this == &s)
+    return;
+  clear();
+  if (!s.n)
+    return;
+  _swiss_copy(v, e, s.v, s.n);
+  n = s.n;
+  index_rebuild();
+}
 
 #endif
@@ -102,6 +102,7 @@ using LlvmOptimizationLevel = llvm::PassBuilder::OptimizationLevel;
 #include "driver.h"
 #include "expr.h"
 #include "files.h"
+#include "FnProfiler.h"
 #include "mli.h"
 #include "mysystem.h"
 #include "passes.h"
@@ -5185,6 +5186,8 @@ static void llvmRunOptimizations(void) {
   // Run optimizations, either with the old pass manager or with
   // the new one.
 
+  FnProfileScope profile("llvmOpt", "module optimization");
+
 #ifdef LLVM_USE_OLD_PASSES
   static bool addedGlobalExts = false;
   if( ! addedGlobalExts ) {
@@ -0,0 +1,365 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FnProfiler.h"
+
+#include "baseAST.h"
+#include "driver.h"
+#include "FnSymbol.h"
+#include "misc.h"
+#include "stringutil.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+char fnProfileFilename[FILENAME_MAX + 1] = "";
+int  fnProfileTopN                       = 20;
+
+/************************************* | **************************************
+*                                                                             *
+* Every closed region becomes a Record.  Records are kept in the order in     *
+* which they were closed; the trace viewer reconstructs the nesting from the  *
+* start times and durations.                                                  *
+*                                                                             *
+************************************** | *************************************/
+
+namespace {
+
+struct Record
+{
+  const char*   category;
+  const char*   name;
+  const char*   filename;
+  int           lineno;
+  int           fnId;        // 0 for regions that are not functions
+  const char*   genericName; // root of the instantiation, if any
+  int           genericId;
+
+  unsigned long start;       // usecs since the profiler started
+  unsigned long total;       // usecs, including nested regions
+  unsigned long self;        // usecs, excluding nested regions
+
+  long          totalNodes;  // AST nodes created, including nested regions
+  long          selfNodes;   // AST nodes created, excluding nested regions
+};
+
+struct Frame
+{
+  Record        record;
+  int           startNodeId;
+  unsigned long childTime;
+  long          childNodes;
+};
+
+struct Summary
+{
+  const char*   category;
+  const char*   name;
+  const char*   filename;
+  int           lineno;
+  unsigned long count;
+  unsigned long total;
+  unsigned long self;
+  long          selfNodes;
+};
+
+}
+
+static Timer               sTimer;
+static bool                sStarted = false;
+static std::vector<Frame>  sStack;
+static std::vector<Record> sRecords;
+
+static void pushFrame(const char* category,
+                      const char* name,
+                      FnSymbol*   fn) {
+  if (sStarted == false) {
+    sTimer.start();
+    sStarted = true;
+  }
+
+  Frame frame;
+
+  frame.record.category    = category;
+  frame.record.name        = name;
+  frame.record.filename    = NULL;
+  frame.record.lineno      = 0;
+  frame.record.fnId        = 0;
+  frame.record.genericName = NULL;
+  frame.record.genericId   = 0;
+
+  if (fn != NULL) {
+    FnSymbol* root = fn;
+
+    while (root->instantiatedFrom != NULL)
+      root = root->instantiatedFrom;
+
+    frame.record.name     = fn->name;
+    frame.record.filename = fn->fname();
+    frame.record.lineno   = fn->linenum();
+    frame.record.fnId     = fn->id;
+
+    if (root != fn) {
+      frame.record.genericName = root->name;
+      frame.record.genericId   = root->id;
+    }
+  }
+
+  frame.record.start = sTimer.elapsedUsecs();
+  frame.startNodeId  = lastNodeIDUsed();
+  frame.childTime    = 0;
+  frame.childNodes   = 0;
+
+  sStack.push_back(frame);
+}
+
+static void popFrame() {
+  Frame         frame = sStack.back();
+  Record&       rec   = frame.record;
+  unsigned long now   = sTimer.elapsedUsecs();
+
+  sStack.pop_back();
+
+  rec.total      = now - rec.start;
+  rec.self       = rec.total - std::min(rec.total, frame.childTime);
+  rec.totalNodes = lastNodeIDUsed() - frame.startNodeId;
+  rec.selfNodes  = rec.totalNodes - frame.childNodes;
+
+  if (sStack.empty() == false) {
+    sStack.back().childTime  += rec.total;
+    sStack.back().childNodes += rec.totalNodes;
+  }
+
+  sRecords.push_back(rec);
+}
+
+/************************************* | **************************************
+*                                                                             *
+* FnProfileScope                                                              *
+*                                                                             *
+************************************** | *************************************/
+
+FnProfileScope::FnProfileScope(const char* category, FnSymbol* fn) {
+  mActive = fnProfilerEnabled() && fn != NULL;
+
+  if (mActive)
+    pushFrame(category, NULL, fn);
+}
+
+FnProfileScope::FnProfileScope(const char* category, const char* name) {
+  mActive = fnProfilerEnabled();
+
+  if (mActive)
+    pushFrame(category, name, NULL);
+}
+
+FnProfileScope::~FnProfileScope() {
+  if (mActive)
+    popFrame();
+}
+
+/************************************* | **************************************
+*                                                                             *
+* Reporting                                                                   *
+*                                                                             *
+************************************** | *************************************/
+
+static void writeJsonString(FILE* fp, const char* str) {
+  fputc('"', fp);
+
+  for (const char* p = str; p != NULL && *p != '\0'; p++) {
+    unsigned char c = (unsigned char) *p;
+
+    if (c == '"' || c == '\\')
+      fprintf(fp, "\\%c", c);
+    else if (c < 0x20)
+      fprintf(fp, "\\u%04x", c);
+    else
+      fputc(c, fp);
+  }
+
+  fputc('"', fp);
+}
+
+static void writeTrace(const char* filename) {
+  FILE* fp = fopen(filename, "w");
+
+  if (fp == NULL) {
+    USR_WARN("Error opening function profile file: %s.", filename);
+    return;
+  }
+
+  fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+  for (size_t i = 0; i < sRecords.size(); i++) {
+    const Record& rec = sRecords[i];
+
+    fprintf(fp, "%s{\"name\":", (i == 0) ? "" : ",\n");
+    writeJsonString(fp, rec.name);
+    fprintf(fp, ",\"cat\":");
+    writeJsonString(fp, rec.category);
+    fprintf(fp,
+            ",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%lu,\"dur\":%lu",
+            rec.start,
+            rec.total);
+
+    fprintf(fp, ",\"args\":{\"selfUs\":%lu,\"astNodesCreated\":%ld,"
+            "\"selfAstNodesCreated\":%ld",
+            rec.self,
+            rec.totalNodes,
+            rec.selfNodes);
+
+    if (rec.fnId != 0) {
+      fprintf(fp, ",\"id\":%d,\"loc\":", rec.fnId);
+      writeJsonString(fp, astr(rec.filename, ":", istr(rec.lineno)));
+    }
+
+    if (rec.genericName != NULL) {
+      fprintf(fp, ",\"instantiatedFrom\":");
+      writeJsonString(fp, rec.genericName);
+      fprintf(fp, ",\"instantiatedFromId\":%d", rec.genericId);
+    }
+
+    fprintf(fp, "}}");
+  }
+
+  fprintf(fp, "\n]}\n");
+
+  fclose(fp);
+}
+
+static bool compareBySelf(const Summary& a, const Summary& b) {
+  if (a.self != b.self)
+    return a.self > b.self;
+
+  return a.total > b.total;
+}
+
+static void printSummary(const char*                 title,
+                         const char*                 countLabel,
+                         const std::vector<Summary>& entries) {
+  size_t n = std::min(entries.size(), (size_t) std::max(fnProfileTopN, 0));
+
+  if (n == 0)
+    return;
+
+  printf("\n%s (top %d by self time)\n", title, (int) n);
+  printf("%-16s %12s %12s %10s %14s  %s\n",
+         "category", "self (ms)", "total (ms)", countLabel, "new AST nodes",
+         "function");
+
+  for (size_t i = 0; i < n; i++) {
+    const Summary& s = entries[i];
+
+    printf("%-16s %12.3f %12.3f %10lu %14ld  %s (%s:%d)\n",
+           s.category,
+           s.self  / 1000.0,
+           s.total / 1000.0,
+           s.count,
+           s.selfNodes,
+           s.name,
+           s.filename ? s.filename : "<unknown>",
+           s.lineno);
+  }
+}
+
+static void summarize(const std::map<std::pair<const char*, int>,
+                                     Summary>& table,
+                      std::vector<Summary>&    result) {
+  for (auto& elem : table)
+    result.push_back(elem.second);
+
+  std::stable_sort(result.begin(), result.end(), compareBySelf);
+}
+
+static void addTo(std::map<std::pair<const char*, int>, Summary>& table,
+                  const Record&                                   rec,
+                  const char*                                     name,
+                  int                                             id) {
+  auto key = std::make_pair(rec.category, id);
+  auto it  = table.find(key);
+
+  if (it == table.end()) {
+    Summary s;
+
+    s.category  = rec.category;
+    s.name      = name;
+    s.filename  = rec.filename;
+    s.lineno    = rec.lineno;
+    s.count     = 0;
+    s.total     = 0;
+    s.self      = 0;
+    s.selfNodes = 0;
+
+    it = table.emplace(key, s).first;
+  }
+
+  it->second.count     += 1;
+  it->second.total     += rec.total;
+  it->second.self      += rec.self;
+  it->second.selfNodes += rec.selfNodes;
+}
+
+static void printSummaries() {
+  std::map<std::pair<const char*, int>, Summary> byFn;
+  std::map<std::pair<const char*, int>, Summary> byGeneric;
+  std::vector<Summary>                           fns;
+  std::vector<Summary>                           generics;
+
+  for (const Record& rec : sRecords) {
+    if (rec.fnId == 0)
+      continue;
+
+    addTo(byFn, rec, rec.name, rec.fnId);
+
+    // The location reported for a generic is that of its first instantiation
+    if (rec.genericName != NULL)
+      addTo(byGeneric, rec, rec.genericName, rec.genericId);
+  }
+
+  summarize(byFn,      fns);
+  summarize(byGeneric, generics);
+
+  printSummary("Compile time per function",   "calls",  fns);
+  printSummary("Compile time per generic function, "
+               "summed over its instantiations", "insts", generics);
+}
+
+void fnProfilerReport() {
+  if (fnProfilerEnabled() == false || sRecords.empty() == true)
+    return;
+
+  // Close regions left open by an early exit
+  while (sStack.empty() == false)
+    popFrame();
+
+  // In driver mode the makeBinary phase runs in its own process; keep it
+  // from overwriting the trace written by the compilation phase.
+  if (fDriverMakeBinaryPhase)
+    writeTrace(astr(fnProfileFilename, ".makeBinary"));
+  else
+    writeTrace(fnProfileFilename);
+
+  printSummaries();
+}
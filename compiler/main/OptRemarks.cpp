@@ -0,0 +1,344 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OptRemarks.h"
+
+#include "baseAST.h"
+#include "driver.h"
+#include "FnSymbol.h"
+#include "misc.h"
+#include "ModuleSymbol.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+char optRemarksFilename[FILENAME_MAX + 1] = "";
+
+namespace {
+
+struct Remark
+{
+  OptRemarkKind kind;
+  std::string   pass;
+  std::string   filename;
+  int           lineno;
+  std::string   function;
+  std::string   message;
+  std::string   reason;
+  size_t        order;     // keeps remarks at one location in pass order
+
+  bool operator<(const Remark& other) const {
+    if (filename != other.filename)
+      return filename < other.filename;
+
+    if (lineno != other.lineno)
+      return lineno < other.lineno;
+
+    return order < other.order;
+  }
+
+  bool sameAs(const Remark& other) const {
+    return kind     == other.kind     &&
+           lineno   == other.lineno   &&
+           pass     == other.pass     &&
+           filename == other.filename &&
+           message  == other.message  &&
+           reason   == other.reason;
+  }
+};
+
+}
+
+static std::vector<Remark> sRemarks;
+
+bool optRemarksEnabledFor(BaseAST* ast) {
+  if (optRemarksEnabled() == false || ast == NULL)
+    return false;
+
+  if (developer)
+    return true;
+
+  ModuleSymbol* mod = ast->getModule();
+
+  return mod != NULL && mod->modTag == MOD_USER;
+}
+
+static const char* nonNull(const char* str) {
+  return str != NULL ? str : "";
+}
+
+void optRemark(OptRemarkKind kind,
+               const char*   pass,
+               const char*   filename,
+               int           lineno,
+               const char*   function,
+               const char*   message,
+               const char*   reason) {
+  if (optRemarksEnabled() == false)
+    return;
+
+  Remark remark;
+
+  remark.kind     = kind;
+  remark.pass     = nonNull(pass);
+  remark.filename = nonNull(filename);
+  remark.lineno   = lineno;
+  remark.function = nonNull(function);
+  remark.message  = nonNull(message);
+  remark.reason   = nonNull(reason);
+  remark.order    = sRemarks.size();
+
+  sRemarks.push_back(remark);
+}
+
+void optRemark(OptRemarkKind kind,
+               const char*   pass,
+               BaseAST*      ast,
+               const char*   message,
+               const char*   reason) {
+  if (optRemarksEnabledFor(ast) == false)
+    return;
+
+  FnSymbol*   fn       = toFnSymbol(ast);
+  const char* function = NULL;
+
+  if (fn == NULL)
+    fn = ast->getFunction();
+
+  if (fn != NULL)
+    function = fn->name;
+
+  optRemark(kind, pass, cleanFilename(ast), ast->linenum(), function,
+            message, reason);
+}
+
+/************************************* | **************************************
+*                                                                             *
+* Reporting                                                                   *
+*                                                                             *
+************************************** | *************************************/
+
+static const char* kindToString(OptRemarkKind kind) {
+  switch (kind) {
+    case OPT_REMARK_PASSED:   return "passed";
+    case OPT_REMARK_MISSED:   return "missed";
+    case OPT_REMARK_ANALYSIS: return "analysis";
+  }
+
+  return "analysis";
+}
+
+static void appendJsonString(std::string& out, const std::string& str) {
+  out += '"';
+
+  for (size_t i = 0; i < str.size(); i++) {
+    unsigned char c = (unsigned char) str[i];
+
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += (char) c;
+    } else if (c < 0x20) {
+      char buf[8];
+
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    } else {
+      out += (char) c;
+    }
+  }
+
+  out += '"';
+}
+
+static std::string remarkToJson(const Remark& remark) {
+  std::string out;
+
+  out += "{\"kind\":\"";
+  out += kindToString(remark.kind);
+  out += "\",\"pass\":";
+  appendJsonString(out, remark.pass);
+
+  out += ",\"file\":";
+  appendJsonString(out, remark.filename);
+  out += ",\"line\":";
+  out += std::to_string(remark.lineno);
+
+  if (remark.function.empty() == false) {
+    out += ",\"function\":";
+    appendJsonString(out, remark.function);
+  }
+
+  out += ",\"message\":";
+  appendJsonString(out, remark.message);
+
+  if (remark.reason.empty() == false) {
+    out += ",\"reason\":";
+    appendJsonString(out, remark.reason);
+  }
+
+  out += "}";
+
+  return out;
+}
+
+namespace {
+
+// A remark as written to the file, with its location for sorting
+struct RemarkLine
+{
+  std::string filename;
+  int         lineno;
+  std::string text;
+
+  bool operator<(const RemarkLine& other) const {
+    if (filename != other.filename)
+      return filename < other.filename;
+
+    return lineno < other.lineno;
+  }
+};
+
+}
+
+// Read the JSON string starting at text[pos], as written by
+// appendJsonString().  Returns false if there is none.
+static bool readJsonString(const std::string& text, size_t pos,
+                           std::string& out) {
+  if (pos >= text.size() || text[pos] != '"')
+    return false;
+
+  out.clear();
+
+  for (size_t i = pos + 1; i < text.size(); i++) {
+    char c = text[i];
+
+    if (c == '"') {
+      return true;
+
+    } else if (c != '\\') {
+      out += c;
+
+    } else if (i + 1 < text.size() && text[i + 1] == 'u') {
+      if (i + 5 >= text.size())
+        return false;
+
+      out += (char) strtol(text.substr(i + 2, 4).c_str(), NULL, 16);
+      i   += 5;
+
+    } else if (i + 1 < text.size()) {
+      out += text[i + 1];
+      i   += 1;
+    }
+  }
+
+  return false;
+}
+
+// Recover the location of a remark written by an earlier phase.  Lines
+// that can't be parsed sort first, as if they had no location.
+static RemarkLine parseRemarkLine(const std::string& text) {
+  RemarkLine  line;
+  size_t      filePos = text.find("\"file\":");
+
+  line.lineno = 0;
+  line.text   = text;
+
+  if (filePos != std::string::npos &&
+      readJsonString(text, filePos + 7, line.filename)) {
+    size_t linePos = text.find("\"line\":", filePos);
+
+    if (linePos != std::string::npos)
+      line.lineno = atoi(text.c_str() + linePos + 7);
+  }
+
+  return line;
+}
+
+void optRemarksReport() {
+  if (optRemarksEnabled() == false)
+    return;
+
+  std::vector<RemarkLine> lines;
+
+  // In driver mode the makeBinary phase runs in its own process after the
+  // compilation phase has written its remarks; merge them with ours.
+  if (fDriverMakeBinaryPhase) {
+    std::ifstream in(optRemarksFilename);
+    std::string   text;
+
+    while (std::getline(in, text)) {
+      if (text.empty() == false)
+        lines.push_back(parseRemarkLine(text));
+    }
+  }
+
+  // Passes may consider the same code more than once, e.g. in each clone
+  // of a forall, so drop repeated remarks.
+  std::stable_sort(sRemarks.begin(), sRemarks.end());
+
+  for (size_t i = 0; i < sRemarks.size(); i++) {
+    bool repeated = false;
+
+    for (size_t j = i; j > 0; j--) {
+      const Remark& prev = sRemarks[j - 1];
+
+      if (prev.filename != sRemarks[i].filename ||
+          prev.lineno   != sRemarks[i].lineno) {
+        break;
+      }
+
+      if (prev.sameAs(sRemarks[i])) {
+        repeated = true;
+        break;
+      }
+    }
+
+    if (repeated == false) {
+      RemarkLine line;
+
+      line.filename = sRemarks[i].filename;
+      line.lineno   = sRemarks[i].lineno;
+      line.text     = remarkToJson(sRemarks[i]);
+
+      lines.push_back(line);
+    }
+  }
+
+  sRemarks.clear();
+
+  // The earlier phase's remarks come first at each location.
+  std::stable_sort(lines.begin(), lines.end());
+
+  FILE* fp = fopen(optRemarksFilename, "w");
+
+  if (fp == NULL) {
+    USR_WARN("Error opening optimization remarks file: %s.",
+             optRemarksFilename);
+    return;
+  }
+
+  for (size_t i = 0; i < lines.size(); i++) {
+    fprintf(fp, "%s\n", lines[i].text.c_str());
+  }
+
+  fclose(fp);
+}
@@ -569,6 +569,16 @@ void check_insertWideReferences()
   check_afterInlineFunctions();
 }
 
+void check_batchRemoteAccesses()
+{
+  check_afterEveryPass();
+  check_afterNormalization();
+  check_afterCallDestructors();
+  check_afterLowerIterators();
+  check_afterResolveIntents();
+  check_afterInlineFunctions();
+}
+
 void check_optimizeOnClauses()
 {
   check_afterEveryPass();
@@ -24,7 +24,9 @@
 
 #include "driver.h"
 
+#include "FnProfiler.h"
 #include "ModuleSymbol.h"
+#include "OptRemarks.h"
 #include "PhaseTracker.h"
 #include "arg.h"
 #include "chpl.h"
@@ -174,8 +176,11 @@ bool fFastFlag = false;
 bool fNoCopyPropagation = false;
 bool fNoDeadCodeElimination = false;
 bool fNoScalarReplacement = false;
+// off by default until the escape analysis has more test coverage
+bool fNoStackAllocation = true;
 bool fNoTupleCopyOpt = false;
 bool fNoRemoteValueForwarding = false;
+bool fNoRemoteAccessBatching = true;
 bool fNoInferConstRefs = false;
 bool fNoRemoteSerialization = false;
 bool fNoRemoveCopyCalls = false;
@@ -184,6 +189,7 @@ bool fNoOptimizeLoopIterators = false;
 bool fNoVectorize = false; // adjusted in postVectorize
 static bool fYesVectorize = false;
 bool fForceVectorize = false;
+bool fVectorizeGpuEligibleLoops = false;
 bool fNoGlobalConstOpt = false;
 bool fNoFastFollowers = false;
 bool fNoInlineIterators = false;
@@ -246,6 +252,9 @@ bool fNoOptimizeForallUnordered = false;
 int optimize_on_clause_limit = 20;
 int scalar_replace_limit = 8;
 int inline_iter_yield_limit = 10;
+int inline_iter_cost_limit = 0;
+int inline_size_limit = 0;
+int stack_allocation_limit = 256;
 int tuple_copy_limit = scalar_replace_limit;
 bool fGenIDS = false;
 bool fDetectColorTerminal = true;
@@ -287,11 +296,14 @@ bool fReportAliases = false;
 bool fReportBlocking = false;
 bool fReportOptimizedLoopIterators = false;
 bool fReportInlinedIterators = false;
+bool fReportNonInlinedIterators = false;
 bool fReportVectorizedLoops = false;
 bool fReportOptimizedOn = false;
+bool fReportRemoteAccessBatching = false;
 bool fReportOptimizeForallUnordered = false;
 bool fReportPromotion = false;
 bool fReportScalarReplace = false;
+bool fReportStackAllocation = false;
 bool fReportGpu = false;
 bool fReportDeadBlocks = false;
 bool fReportDeadModules = false;
@@ -1059,9 +1071,11 @@ static void setBaselineFlag(const ArgumentDescription* desc, const char* unused)
   fNoVectorize = true;                // --no-vectorize
   fNoInferConstRefs = true;           // --no-infer-const-refs
   fNoRemoteValueForwarding = true;    // --no-remote-value-forwarding
+  fNoRemoteAccessBatching = true;     // --no-remote-access-batching
   fNoRemoteSerialization = true;      // --no-remote-serialization
   fNoRemoveCopyCalls = true;          // --no-remove-copy-calls
   fNoScalarReplacement = true;        // --no-scalar-replacement
+  fNoStackAllocation = true;          // --no-stack-allocation
   fNoTupleCopyOpt = true;             // --no-tuple-copy-opt
   fNoPrivatization = true;            // --no-privatization
   fNoOptimizeOnClauses = true;        // --no-optimize-on-clauses
@@ -1247,6 +1261,8 @@ static ArgumentDescription arg_desc[] = {
  {"inline", ' ', NULL, "Enable [disable] function inlining", "n", &fNoInline, NULL, NULL},
  {"inline-iterators", ' ', NULL, "Enable [disable] iterator inlining", "n", &fNoInlineIterators, "CHPL_DISABLE_INLINE_ITERATORS", NULL},
  {"inline-iterators-yield-limit", ' ', "<limit>", "Limit number of yields permitted in inlined iterators", "I", &inline_iter_yield_limit, "CHPL_INLINE_ITER_YIELD_LIMIT", NULL},
+ {"inline-iterators-cost-limit", ' ', "<limit>", "Also inline iterators over the yield limit if the estimated code growth is within this many AST nodes", "I", &inline_iter_cost_limit, "CHPL_INLINE_ITER_COST_LIMIT", NULL},
+ {"inline-size-limit", ' ', "<limit>", "Also inline functions whose body is within this many AST nodes", "I", &inline_size_limit, "CHPL_INLINE_SIZE_LIMIT", NULL},
  {"live-analysis", ' ', NULL, "Enable [disable] live variable analysis", "n", &fNoLiveAnalysis, "CHPL_DISABLE_LIVE_ANALYSIS", NULL},
  {"loop-invariant-code-motion", ' ', NULL, "Enable [disable] loop invariant code motion", "n", &fNoLoopInvariantCodeMotion, NULL, NULL},
  {"optimize-forall-unordered-ops", ' ', NULL, "Enable [disable] optimization of foralls to unordered operations", "n", &fNoOptimizeForallUnordered, "CHPL_DISABLE_OPTIMIZE_FORALL_UNORDERED_OPS", NULL},
@@ -1254,16 +1270,21 @@ static ArgumentDescription arg_desc[] = {
  {"optimize-loop-iterators", ' ', NULL, "Enable [disable] optimization of iterators composed of a single loop", "n", &fNoOptimizeLoopIterators, "CHPL_DISABLE_OPTIMIZE_LOOP_ITERATORS", NULL},
  {"optimize-on-clauses", ' ', NULL, "Enable [disable] optimization of on clauses", "n", &fNoOptimizeOnClauses, "CHPL_DISABLE_OPTIMIZE_ON_CLAUSES", NULL},
  {"optimize-on-clause-limit", ' ', "<limit>", "Limit recursion depth of on clause optimization search", "I", &optimize_on_clause_limit, "CHPL_OPTIMIZE_ON_CLAUSE_LIMIT", NULL},
+ {"opt-remarks", ' ', "<filename>", "Write remarks about applied and missed optimizations (JSON, one per line) to <filename>", "P", optRemarksFilename, "CHPL_OPT_REMARKS", NULL},
  {"privatization", ' ', NULL, "Enable [disable] privatization of distributed arrays and domains", "n", &fNoPrivatization, "CHPL_DISABLE_PRIVATIZATION", NULL},
  {"remote-value-forwarding", ' ', NULL, "Enable [disable] remote value forwarding", "n", &fNoRemoteValueForwarding, "CHPL_DISABLE_REMOTE_VALUE_FORWARDING", NULL},
+ {"remote-access-batching", ' ', NULL, "Enable [disable] batching of remote field reads and whole-record writes into bulk gets/puts", "n", &fNoRemoteAccessBatching, "CHPL_DISABLE_REMOTE_ACCESS_BATCHING", NULL},
  {"remote-serialization", ' ', NULL, "Enable [disable] serialization for remote consts", "n", &fNoRemoteSerialization, "CHPL_DISABLE_REMOTE_SERIALIZATION", NULL},
  {"remove-copy-calls", ' ', NULL, "Enable [disable] remove copy calls", "n", &fNoRemoveCopyCalls, "CHPL_DISABLE_REMOVE_COPY_CALLS", NULL},
  {"scalar-replacement", ' ', NULL, "Enable [disable] scalar replacement", "n", &fNoScalarReplacement, "CHPL_DISABLE_SCALAR_REPLACEMENT", NULL},
+ {"stack-allocation", ' ', NULL, "Enable [disable] stack allocation of class instances that do not escape; 'new' in user code is only seen once --inline-size-limit inlines the initializer", "n", &fNoStackAllocation, "CHPL_DISABLE_STACK_ALLOCATION", NULL},
+ {"stack-allocation-limit", ' ', "<bytes>", "Limit on the size of class instances moved to the stack", "I", &stack_allocation_limit, "CHPL_STACK_ALLOCATION_LIMIT", NULL},
  {"scalar-replace-limit", ' ', "<limit>", "Limit on the size of tuples being replaced during scalar replacement", "I", &scalar_replace_limit, "CHPL_SCALAR_REPLACE_TUPLE_LIMIT", NULL},
  {"tuple-copy-opt", ' ', NULL, "Enable [disable] tuple (memcpy) optimization", "n", &fNoTupleCopyOpt, "CHPL_DISABLE_TUPLE_COPY_OPT", NULL},
  {"tuple-copy-limit", ' ', "<limit>", "Limit on the size of tuples considered for optimization", "I", &tuple_copy_limit, "CHPL_TUPLE_COPY_LIMIT", NULL},
  {"infer-local-fields", ' ', NULL, "Enable [disable] analysis to infer local fields in classes and records", "n", &fNoInferLocalFields, "CHPL_DISABLE_INFER_LOCAL_FIELDS", NULL},
  {"vectorize", ' ', NULL, "Enable [disable] generation of vectorization hints", "n", &fNoVectorize, "CHPL_DISABLE_VECTORIZATION", setVectorize},
+ {"vectorize-gpu-eligible-loops", ' ', NULL, "Enable [disable] explicit CPU vectorization of loops that are eligible for GPU execution", "N", &fVectorizeGpuEligibleLoops, "CHPL_VECTORIZE_GPU_ELIGIBLE_LOOPS", NULL},
 
  {"auto-local-access", ' ', NULL, "Enable [disable] using local access automatically", "N", &fAutoLocalAccess, "CHPL_DISABLE_AUTO_LOCAL_ACCESS", NULL},
  {"dynamic-auto-local-access", ' ', NULL, "Enable [disable] using local access automatically (dynamic only)", "N", &fDynamicAutoLocalAccess, "CHPL_DISABLE_DYNAMIC_AUTO_LOCAL_ACCESS", NULL},
@@ -1385,22 +1406,27 @@ static ArgumentDescription arg_desc[] = {
  {"print-emitted-code-size", ' ', NULL, "Print emitted code size", "F", &fPrintEmittedCodeSize, NULL, NULL},
  {"print-module-resolution", ' ', NULL, "Print name of module being resolved", "F", &fPrintModuleResolution, "CHPL_PRINT_MODULE_RESOLUTION", NULL},
  {"print-dispatch", ' ', NULL, "Print dynamic dispatch table", "F", &fPrintDispatch, NULL, NULL},
- {"print-statistics", ' ', "[n|k|t]", "Print AST statistics", "S256", fPrintStatistics, NULL, NULL},
+ {"print-statistics", ' ', "[n|k|i|t]", "Print AST statistics", "S256", fPrintStatistics, NULL, NULL},
+ {"profile-functions", ' ', "<filename>", "Write a per-function compile-time profile (Chrome trace format) to <filename>, counting AST nodes created as an approximation of memory use", "P", fnProfileFilename, "CHPL_PROFILE_FUNCTIONS", NULL},
+ {"profile-functions-top", ' ', "<n>", "Number of functions to list in the per-function compile-time summary", "I", &fnProfileTopN, "CHPL_PROFILE_FUNCTIONS_TOP", NULL},
  {"report-aliases", ' ', NULL, "Report aliases in user code", "N", &fReportAliases, NULL, NULL},
  {"report-blocking", ' ', NULL, "Report blocking functions in user code", "N", &fReportBlocking, NULL, NULL},
- {"report-inlining", ' ', NULL, "Print inlined functions", "F", &report_inlining, NULL, NULL},
+ {"report-inlining", ' ', NULL, "Print inlined functions and inlining decisions", "F", &report_inlining, NULL, NULL},
  {"report-dead-blocks", ' ', NULL, "Print dead block removal stats", "F", &fReportDeadBlocks, NULL, NULL},
  {"report-dead-modules", ' ', NULL, "Print dead module removal stats", "F", &fReportDeadModules, NULL, NULL},
  {"report-gpu-transform-time", ' ', NULL, "Print amount of time spent in GPU transformations", "F", &fReportGpuTransformTime, NULL, NULL},
  {"report-optimized-loop-iterators", ' ', NULL, "Print stats on optimized single loop iterators", "F", &fReportOptimizedLoopIterators, NULL, NULL},
  {"report-inlined-iterators", ' ', NULL, "Print stats on inlined iterators", "F", &fReportInlinedIterators, NULL, NULL},
+ {"report-non-inlined-iterators", ' ', NULL, "Print loops whose iterators were not inlined, and why", "F", &fReportNonInlinedIterators, NULL, NULL},
  {"report-vectorized-loops", ' ', NULL, "Show which loops have vectorization hints", "F", &fReportVectorizedLoops, NULL, NULL},
  {"report-optimized-on", ' ', NULL, "Print information about on clauses that have been optimized for potential fast remote fork operation", "F", &fReportOptimizedOn, NULL, NULL},
+ {"report-remote-access-batching", ' ', NULL, "Print information about remote field reads and whole-record writes that have been batched into bulk gets/puts", "F", &fReportRemoteAccessBatching, NULL, NULL},
  {"report-auto-local-access", ' ', NULL, "Enable compiler logs for auto local access optimization", "N", &fReportAutoLocalAccess, "CHPL_REPORT_AUTO_LOCAL_ACCESS", NULL},
  {"report-auto-aggregation", ' ', NULL, "Enable compiler logs for automatic aggregation", "N", &fReportAutoAggregation, "CHPL_REPORT_AUTO_AGGREGATION", NULL},
  {"report-optimized-forall-unordered-ops", ' ', NULL, "Show which statements in foralls have been converted to unordered operations", "F", &fReportOptimizeForallUnordered, NULL, NULL},
  {"report-promotion", ' ', NULL, "Print information about scalar promotion", "F", &fReportPromotion, NULL, NULL},
  {"report-scalar-replace", ' ', NULL, "Print scalar replacement stats", "F", &fReportScalarReplace, NULL, NULL},
+ {"report-stack-allocation", ' ', NULL, "Print class allocations that have been moved to the stack", "F", &fReportStackAllocation, NULL, NULL},
  {"report-gpu", ' ', NULL, "Print information about what loops are and are not GPU eligible", "F", &fReportGpu, NULL, NULL},
 
  {"", ' ', NULL, "Developer Flags -- Miscellaneous", NULL, NULL, NULL, NULL},
@@ -2562,6 +2588,10 @@ int main(int argc, char* argv[]) {
     fclose(printPassesFile);
   }
 
+  fnProfilerReport();
+
+  optRemarksReport();
+
   clean_exit(0);
 
   return 0;
@@ -22,6 +22,7 @@
 
 #include "checks.h"
 #include "driver.h"
+#include "FnProfiler.h"
 #include "log.h"
 #include "parser.h"
 #include "passes.h"
@@ -75,6 +76,7 @@ struct PassInfo {
 #define LOG_prune2                             LOG_NO_SHORT
 #define LOG_returnStarTuplesByRefArgs          LOG_NO_SHORT
 #define LOG_insertWideReferences               LOG_NO_SHORT
+#define LOG_batchRemoteAccesses                LOG_NO_SHORT
 #define LOG_optimizeOnClauses                  LOG_NO_SHORT
 #define LOG_addInitCalls                       LOG_NO_SHORT
 #define LOG_insertLineNumbers                  LOG_NO_SHORT
@@ -141,6 +143,7 @@ static PassInfo sPassList[] = {
   RUN(returnStarTuplesByRefArgs),
 
   RUN(insertWideReferences),    // inserts wide references for on clauses
+  RUN(batchRemoteAccesses),     // combine remote field reads and record writes into bulk gets/puts
   RUN(optimizeOnClauses),       // Optimize on clauses
   RUN(addInitCalls),            // Add module init calls and guards.
 
@@ -243,7 +246,11 @@ static void runPass(PhaseTracker& tracker, size_t passIndex) {
   if (fPrintStatistics[0] != '\0' && passIndex > 0)
     printStatistics("clean");
 
-  (*(info->passFunction))();
+  {
+    FnProfileScope profile("pass", info->name);
+
+    (*(info->passFunction))();
+  }
 
   //
   // Statistics and logging
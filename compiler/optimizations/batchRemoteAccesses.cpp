@@ -0,0 +1,547 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Combine accesses to several fields of the same remote record into a
+// single bulk get or put.
+//
+// After insertWideReferences, a sequence such as
+//
+//   const a = r.x, b = r.y, c = r.z;
+//
+// where 'r' is a wide reference to a record turns into one
+// (move tmp (.v r field)) per field, or into
+// (move ref (. r field)) (move tmp (deref ref)) when the field is read
+// through a reference.  Each of these becomes a separate chpl_gen_comm_get
+// at runtime.  Within a straight-line run of statements that cannot write
+// memory, this pass rewrites such a group into
+//
+//   (move batch_tmp (deref r))         // one get of the whole record
+//   (move a (.v batch_tmp x))          // local reads
+//   ...
+//
+// Likewise, when every field of a remote record is written, either with
+// (.= r field val) or with (move ref (. r field)) (= ref val), within a run
+// of statements that neither read nor write memory, the writes go to a
+// local record that is then stored with one (= r batch_tmp) put.  Writing
+// only some of the fields is left alone, since storing the whole record
+// would overwrite the other fields.
+//
+// Fields of remote class instances are not batched: there is no value type
+// in the AST that can hold a local copy of the object, so each field
+// access stays a separate get or put.
+//
+// The pass runs before optimizeOnClauses so that on-bodies that no longer
+// communicate per field can still be considered for fast execution.
+//
+// The pass is opt-in (--remote-access-batching); --fast does not enable it.
+//
+
+#include "passes.h"
+
+#include "astutil.h"
+#include "driver.h"
+#include "expr.h"
+#include "stlUtil.h"
+#include "stmt.h"
+#include "stringutil.h"
+#include "symbol.h"
+
+#include "global-ast-vecs.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+// Records with more fields than this are only batched when at least half
+// of their fields are read.
+static const int batchFieldLimit = 8;
+
+// Records larger than this many bytes are only batched when the bulk
+// transfer moves at most twice the bytes of the fields accessed, so that
+// a few reads of small fields next to a large one (say, a tuple) do not
+// turn into one large get.
+static const int64_t batchByteLimit = 256;
+
+static int numBatchedReads  = 0;
+static int numBatchedWrites = 0;
+static int numBatches       = 0;
+
+// Is 'sym' a local, narrow, non-reference temporary of 'fn'?
+static bool isLocalValue(Symbol* sym, FnSymbol* fn) {
+  return isVarSymbol(sym)                                 &&
+         sym->defPoint->parentSymbol == fn                &&
+         sym->isRef()                == false             &&
+         sym->isWideRef()            == false             &&
+         sym->type->symbol->hasFlag(FLAG_WIDE_CLASS) == false;
+}
+
+// Is the value type of 'ref' a record that can be copied as a whole?
+static AggregateType* batchableRecordType(Symbol* ref) {
+  AggregateType* at = toAggregateType(ref->getValType());
+
+  if (at == NULL || at->isRecord() == false ||
+      at->symbol->hasFlag(FLAG_STAR_TUPLE) ||
+      at->symbol->hasFlag(FLAG_EXTERN)) {
+    return NULL;
+  }
+
+  for_fields(field, at) {
+    if (field->isRef() || field->isWideRef())
+      return NULL;
+  }
+
+  return at;
+}
+
+// If 'get' is (.v wideRecordRef field) or (. wideRecordRef field) on a
+// record that can be batched, return the record reference.
+static Symbol* remoteRecordBase(CallExpr* get) {
+  SymExpr* base  = toSymExpr(get->get(1));
+  SymExpr* field = toSymExpr(get->get(2));
+
+  if (base == NULL || field == NULL ||
+      base->symbol()->isWideRef() == false ||
+      field->symbol()->isRef() || field->symbol()->isWideRef() ||
+      batchableRecordType(base->symbol()) == NULL) {
+    return NULL;
+  }
+
+  return base->symbol();
+}
+
+// If 'stmt' is (move ref (. wideRecordRef field)) and 'ref' is a temporary
+// of 'fn' that is used only once after that, return the move.
+static CallExpr* findRemoteFieldAddress(Expr* stmt, FnSymbol* fn) {
+  CallExpr* move = toCallExpr(stmt);
+
+  if (move == NULL || move->isPrimitive(PRIM_MOVE) == false)
+    return NULL;
+
+  SymExpr*  lhs = toSymExpr(move->get(1));
+  CallExpr* rhs = toCallExpr(move->get(2));
+
+  if (lhs == NULL || rhs == NULL ||
+      rhs->isPrimitive(PRIM_GET_MEMBER) == false ||
+      remoteRecordBase(rhs) == NULL) {
+    return NULL;
+  }
+
+  Symbol* ref = lhs->symbol();
+
+  if (isVarSymbol(ref) == false ||
+      ref->defPoint->parentSymbol != fn ||
+      ref->isRefOrWideRef() == false) {
+    return NULL;
+  }
+
+  int numSymExprs = 0;
+
+  for_SymbolSymExprs(se, ref) {
+    numSymExprs += 1;
+  }
+
+  return numSymExprs == 2 ? move : NULL;
+}
+
+// One read or write of a field of a remote record
+struct RemoteFieldAccess {
+  CallExpr* stmt;       // the statement that reads or writes the field
+  Symbol*   field;
+  CallExpr* addrMove;   // (move ref (. base field)), or NULL
+  Expr*     value;      // the value written, or NULL for reads
+};
+
+typedef std::map<Symbol*, CallExpr*> FieldAddresses;
+
+// If 'stmt' reads a field of a remote record into a local temporary,
+// describe it in 'access' and return the record reference.
+static Symbol* findRemoteFieldRead(Expr*              stmt,
+                                   FnSymbol*          fn,
+                                   FieldAddresses&    addrs,
+                                   RemoteFieldAccess& access) {
+  CallExpr* move = toCallExpr(stmt);
+
+  if (move == NULL || move->isPrimitive(PRIM_MOVE) == false)
+    return NULL;
+
+  SymExpr*  lhs = toSymExpr(move->get(1));
+  CallExpr* rhs = toCallExpr(move->get(2));
+
+  if (lhs == NULL || rhs == NULL || isLocalValue(lhs->symbol(), fn) == false)
+    return NULL;
+
+  access.stmt     = move;
+  access.addrMove = NULL;
+  access.value    = NULL;
+
+  // (move local (.v wideRecordRef field))
+  if (rhs->isPrimitive(PRIM_GET_MEMBER_VALUE)) {
+    access.field = toSymExpr(rhs->get(2))->symbol();
+
+    return remoteRecordBase(rhs);
+  }
+
+  // (move ref (. wideRecordRef field)) ... (move local (deref ref))
+  if (rhs->isPrimitive(PRIM_DEREF)) {
+    SymExpr* ref = toSymExpr(rhs->get(1));
+
+    if (ref == NULL || addrs.count(ref->symbol()) == 0)
+      return NULL;
+
+    CallExpr* get = toCallExpr(addrs[ref->symbol()]->get(2));
+
+    access.field    = toSymExpr(get->get(2))->symbol();
+    access.addrMove = addrs[ref->symbol()];
+
+    return remoteRecordBase(get);
+  }
+
+  return NULL;
+}
+
+// If 'stmt' writes a local value to a field of a remote record, describe it
+// in 'access' and return the record reference.
+static Symbol* findRemoteFieldWrite(Expr*              stmt,
+                                    FieldAddresses&    addrs,
+                                    RemoteFieldAccess& access) {
+  CallExpr* call = toCallExpr(stmt);
+
+  if (call == NULL)
+    return NULL;
+
+  access.stmt     = call;
+  access.addrMove = NULL;
+
+  // (.= wideRecordRef field value)
+  if (call->isPrimitive(PRIM_SET_MEMBER)) {
+    SymExpr* value = toSymExpr(call->get(3));
+
+    if (value == NULL || value->symbol()->isRefOrWideRef())
+      return NULL;
+
+    access.field = toSymExpr(call->get(2))->symbol();
+    access.value = value;
+
+    return remoteRecordBase(call);
+  }
+
+  // (move ref (. wideRecordRef field)) ... (= ref value)
+  if (call->isPrimitive(PRIM_ASSIGN)) {
+    SymExpr* ref   = toSymExpr(call->get(1));
+    SymExpr* value = toSymExpr(call->get(2));
+
+    if (ref == NULL || value == NULL || addrs.count(ref->symbol()) == 0 ||
+        value->symbol()->isRefOrWideRef()) {
+      return NULL;
+    }
+
+    CallExpr* get = toCallExpr(addrs[ref->symbol()]->get(2));
+
+    access.field    = toSymExpr(get->get(2))->symbol();
+    access.addrMove = addrs[ref->symbol()];
+    access.value    = value;
+
+    return remoteRecordBase(get);
+  }
+
+  return NULL;
+}
+
+// Primitives that compute a value without writing memory, synchronizing,
+// or calling out.  Reads may be reordered around them.
+static bool isPureValuePrimitive(CallExpr* call) {
+  switch (call->primitive->tag) {
+    case PRIM_UNARY_MINUS:
+    case PRIM_UNARY_PLUS:
+    case PRIM_UNARY_NOT:
+    case PRIM_UNARY_LNOT:
+    case PRIM_ADD:
+    case PRIM_SUBTRACT:
+    case PRIM_MULT:
+    case PRIM_DIV:
+    case PRIM_MOD:
+    case PRIM_LSH:
+    case PRIM_RSH:
+    case PRIM_EQUAL:
+    case PRIM_NOTEQUAL:
+    case PRIM_LESSOREQUAL:
+    case PRIM_GREATEROREQUAL:
+    case PRIM_LESS:
+    case PRIM_GREATER:
+    case PRIM_AND:
+    case PRIM_OR:
+    case PRIM_XOR:
+    case PRIM_POW:
+    case PRIM_MIN:
+    case PRIM_MAX:
+    case PRIM_CAST:
+    case PRIM_DEREF:
+    case PRIM_GET_MEMBER_VALUE:
+      break;
+
+    default:
+      return false;
+  }
+
+  for_actuals(actual, call) {
+    if (isSymExpr(actual) == false)
+      return false;
+  }
+
+  return true;
+}
+
+// Does the pure primitive 'call' read memory?
+static bool readsMemory(CallExpr* call) {
+  if (call->isPrimitive(PRIM_DEREF) ||
+      call->isPrimitive(PRIM_GET_MEMBER_VALUE))
+    return true;
+
+  for_actuals(actual, call) {
+    if (actual->isRefOrWideRef())
+      return true;
+  }
+
+  return false;
+}
+
+// Can the remote accesses in a group be moved across 'stmt'?  Pending
+// writes cannot be moved across statements that read memory either.
+static bool isBatchSafeStmt(Expr* stmt, FnSymbol* fn, bool allowReads) {
+  if (isDefExpr(stmt))
+    return true;
+
+  CallExpr* call = toCallExpr(stmt);
+
+  if (call == NULL || call->isPrimitive(PRIM_MOVE) == false)
+    return false;
+
+  SymExpr* lhs = toSymExpr(call->get(1));
+
+  if (lhs == NULL || isLocalValue(lhs->symbol(), fn) == false)
+    return false;
+
+  if (SymExpr* rhs = toSymExpr(call->get(2)))
+    return allowReads || rhs->isRefOrWideRef() == false;
+
+  CallExpr* rhs = toCallExpr(call->get(2));
+
+  return rhs != NULL && rhs->primitive != NULL && isPureValuePrimitive(rhs) &&
+         (allowReads || readsMemory(rhs) == false);
+}
+
+// 'loc' must be in the tree; the rewritten accesses may no longer be.
+static void reportBatch(Symbol* ref, Expr* loc, size_t numAccesses,
+                        bool isWrite) {
+  ModuleSymbol* mod = loc->getModule();
+
+  if (developer ||
+      (mod->modTag != MOD_INTERNAL && mod->modTag != MOD_STANDARD)) {
+    printf("Batched %d remote field %s of '%s' into one bulk %s (%s:%d)\n",
+           (int) numAccesses, isWrite ? "writes" : "reads", ref->name,
+           isWrite ? "put" : "get", loc->fname(), loc->linenum());
+  }
+}
+
+// Is a bulk transfer of the whole record small enough, compared to the
+// fields that are accessed, to replace the per-field transfers?
+static bool isBatchSizeOk(AggregateType* at, const std::set<Symbol*>& fields) {
+  int64_t recordBytes   = estimateTypeSize(at);
+  int64_t accessedBytes = 0;
+
+  if (recordBytes < 0)
+    return false;
+
+  if (recordBytes <= batchByteLimit)
+    return true;
+
+  for (Symbol* field : fields) {
+    int64_t fieldBytes = estimateTypeSize(field->type);
+
+    if (fieldBytes < 0)
+      return false;
+
+    accessedBytes += fieldBytes;
+  }
+
+  return recordBytes <= 2 * accessedBytes;
+}
+
+// Drop (move ref (. base field)) and 'ref' once its only use is rewritten.
+static void removeFieldAddress(CallExpr* addrMove) {
+  if (addrMove != NULL) {
+    Symbol* ref = toSymExpr(addrMove->get(1))->symbol();
+
+    addrMove->remove();
+    ref->defPoint->remove();
+  }
+}
+
+static void batchReadGroup(Symbol* ref, std::vector<RemoteFieldAccess>& reads) {
+  std::set<Symbol*> fields;
+
+  for (RemoteFieldAccess& read : reads) {
+    fields.insert(read.field);
+  }
+
+  AggregateType* at        = batchableRecordType(ref);
+  int            numFields = at->fields.length;
+  int            numRead   = (int) fields.size();
+
+  if (numRead < 2)
+    return;
+
+  if (numFields > batchFieldLimit && 2 * numRead < numFields)
+    return;
+
+  if (isBatchSizeOk(at, fields) == false)
+    return;
+
+  CallExpr* first = reads[0].stmt;
+
+  SET_LINENO(first);
+
+  VarSymbol* tmp = newTemp("batch_tmp", at);
+
+  first->insertBefore(new DefExpr(tmp));
+  first->insertBefore(new CallExpr(PRIM_MOVE,
+                                   tmp,
+                                   new CallExpr(PRIM_DEREF, ref)));
+
+  for (RemoteFieldAccess& read : reads) {
+    read.stmt->get(2)->replace(new CallExpr(PRIM_GET_MEMBER_VALUE,
+                                             tmp, read.field));
+
+    removeFieldAddress(read.addrMove);
+  }
+
+  numBatches      += 1;
+  numBatchedReads += (int) reads.size();
+
+  if (fReportRemoteAccessBatching)
+    reportBatch(ref, tmp->defPoint, reads.size(), false);
+}
+
+static void batchWriteGroup(Symbol*                         ref,
+                            std::vector<RemoteFieldAccess>& writes) {
+  std::set<Symbol*> fields;
+
+  for (RemoteFieldAccess& write : writes) {
+    fields.insert(write.field);
+  }
+
+  AggregateType* at = batchableRecordType(ref);
+
+  // Every field is written, so the put moves no more than the writes
+  // would; isBatchSizeOk only rejects records of unknown size here.
+  if (fields.size() < 2 || (int) fields.size() != at->fields.length ||
+      isBatchSizeOk(at, fields) == false)
+    return;
+
+  CallExpr* first = writes[0].stmt;
+  CallExpr* last  = writes.back().stmt;
+
+  SET_LINENO(first);
+
+  VarSymbol* tmp = newTemp("batch_tmp", at);
+
+  first->insertBefore(new DefExpr(tmp));
+  last->insertAfter(new CallExpr(PRIM_ASSIGN, ref, tmp));
+
+  for (RemoteFieldAccess& write : writes) {
+    write.stmt->replace(new CallExpr(PRIM_SET_MEMBER,
+                                      tmp, write.field,
+                                      write.value->remove()));
+
+    removeFieldAddress(write.addrMove);
+  }
+
+  numBatches       += 1;
+  numBatchedWrites += (int) writes.size();
+
+  // 'first' has been replaced, so report at the temporary's definition
+  if (fReportRemoteAccessBatching)
+    reportBatch(ref, tmp->defPoint, writes.size(), true);
+}
+
+typedef std::map<Symbol*, std::vector<RemoteFieldAccess> > AccessGroups;
+
+static void flushGroups(AccessGroups& groups, bool isWrite) {
+  for (AccessGroups::iterator it = groups.begin(); it != groups.end(); ++it) {
+    if (isWrite)
+      batchWriteGroup(it->first, it->second);
+    else
+      batchReadGroup(it->first, it->second);
+  }
+
+  groups.clear();
+}
+
+static void batchRemoteAccessesInBlock(BlockStmt* block, FnSymbol* fn) {
+  FieldAddresses    addrs;
+  AccessGroups      reads;
+  AccessGroups      writes;
+  RemoteFieldAccess access;
+
+  for_alist(stmt, block->body) {
+    if (CallExpr* addrMove = findRemoteFieldAddress(stmt, fn)) {
+      // only computes an address; the access is the later use of 'ref'
+      addrs[toSymExpr(addrMove->get(1))->symbol()] = addrMove;
+
+    } else if (Symbol* ref = findRemoteFieldRead(stmt, fn, addrs, access)) {
+      // the read may observe a pending write
+      flushGroups(writes, true);
+
+      reads[ref].push_back(access);
+
+    } else if (Symbol* ref = findRemoteFieldWrite(stmt, addrs, access)) {
+      // reads cannot be moved past a write
+      flushGroups(reads, false);
+
+      writes[ref].push_back(access);
+
+    } else if (isBatchSafeStmt(stmt, fn, writes.empty()) == false) {
+      flushGroups(reads, false);
+      flushGroups(writes, true);
+    }
+  }
+
+  flushGroups(reads, false);
+  flushGroups(writes, true);
+}
+
+void batchRemoteAccesses() {
+  if (fNoRemoteAccessBatching || fLocal)
+    return;
+
+  forv_Vec(BlockStmt, block, gBlockStmts) {
+    if (block->inTree()) {
+      if (FnSymbol* fn = toFnSymbol(block->parentSymbol)) {
+        batchRemoteAccessesInBlock(block, fn);
+      }
+    }
+  }
+
+  if (fReportRemoteAccessBatching && developer) {
+    printf("Batched %d remote field reads and %d remote field writes "
+           "into %d bulk transfers\n",
+           numBatchedReads, numBatchedWrites, numBatches);
+  }
+}
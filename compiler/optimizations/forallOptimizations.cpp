@@ -23,8 +23,10 @@
 #include "astutil.h"
 #include "build.h"
 #include "ForallStmt.h"
+#include "ForLoop.h"
 #include "LoopExpr.h"
 #include "LoopStmt.h"
+#include "OptRemarks.h"
 #include "passes.h"
 #include "preFold.h"
 #include "forallOptimizations.h"
@@ -47,7 +49,10 @@
 //                           accesses that can be proven to be local
 //
 // - automatic aggregation: Use aggregation instead of regular assignments for
-//                          applicable last statements within `forall` bodies
+//                          applicable last statements within `forall` bodies.
+//                          Remote scatters/gathers in coforall + for loops,
+//                          compound assignments and reductions are analyzed
+//                          and reported, but not transformed.
 
 static int curLogDepth = 0;
 static bool LOG_ALA(int depth, const char *msg, BaseAST *node);
@@ -141,6 +146,10 @@ static void removeAggregatorFromMaybeAggAssign(CallExpr *call, int argIndex);
 static void removeAggregatorFromFunction(Symbol *aggregator, FnSymbol *parent);
 static void removeAggregationFromRecursiveForallHelp(BlockStmt *block);
 static void autoAggregation(ForallStmt *forall);
+static bool isCompoundAssignment(CallExpr *call);
+static Symbol *getIndexedBaseSym(Expr *expr, BlockStmt *loop);
+static bool isReduceIntoShadowVar(CallExpr *call);
+static void analyzeAggregationInCoforalls();
 
 void doPreNormalizeArrayOptimizations() {
   const bool anyAnalysisNeeded = fAutoLocalAccess ||
@@ -161,6 +170,12 @@ void doPreNormalizeArrayOptimizations() {
       }
     }
   }
+
+  // Only forall bodies are transformed. Coforall + for loops are analyzed
+  // for reporting only; see analyzeAggregationInCoforalls for why.
+  if (fAutoAggregation && (fReportAutoAggregation || optRemarksEnabled())) {
+    analyzeAggregationInCoforalls();
+  }
 }
 
 Expr *preFoldMaybeLocalArrElem(CallExpr *call) {
@@ -475,6 +490,17 @@ void finalizeForallOptimizationsResolution() {
       LOG_ALA(0, message.str().c_str(), NULL);
     }
   }
+  if (optRemarksEnabled()) {
+    std::set<astlocT>::iterator it;
+    for (it = primMaybeLocalThisLocations.begin() ;
+         it != primMaybeLocalThisLocations.end();
+         ++it) {
+      optRemark(OPT_REMARK_MISSED, "auto-local-access",
+                cleanFilename(it->filename()), it->lineno(), NULL,
+                "local access attempt reverted",
+                "all static checks failed or the code is unreachable");
+    }
+  }
   primMaybeLocalThisLocations.clear();
 
   if (fAutoAggregation) {
@@ -486,6 +512,12 @@ void finalizeForallOptimizationsResolution() {
       message << "Aggregation attempt reverted. Could not prove that exactly one side of the assignment is local.";
       message << "(" << it->stringLoc() << ")";
       LOG_AA(0, message.str().c_str(), NULL);
+
+      optRemark(OPT_REMARK_MISSED, "auto-aggregation",
+                cleanFilename(it->filename()), it->lineno(), NULL,
+                "aggregation attempt reverted",
+                "could not prove that exactly one side of the assignment "
+                "is local");
     }
   }
   primMaybeAggregateAssignLocations.clear();
@@ -1429,11 +1461,15 @@ static void autoLocalAccess(ForallStmt *forall) {
 
   if (!loopHasValidInductionVariables(forall)) {
     LOG_ALA(1, "Can't optimize this forall: invalid induction variables", forall);
+    optRemark(OPT_REMARK_MISSED, "auto-local-access", forall,
+              "forall not optimized", "invalid induction variables");
     return;
   }
 
   if (!loopHasValidOptInfo(forall)) {
     LOG_ALA(1, "Can't optimize this forall: invalid loop", forall);
+    optRemark(OPT_REMARK_MISSED, "auto-local-access", forall,
+              "forall not optimized", "invalid loop");
     return;
   }
 
@@ -1470,6 +1506,10 @@ static void autoLocalAccess(ForallStmt *forall) {
         message << getCallRejectReasonStr(reason);
 
         LOG_ALA(3, message.str().c_str(), call);
+
+        optRemark(OPT_REMARK_MISSED, "auto-local-access", call,
+                  "access will not use localAccess",
+                  getCallRejectReasonStr(reason));
       }
       continue;
     }
@@ -1519,7 +1559,7 @@ static void autoLocalAccess(ForallStmt *forall) {
                                    call);
         LOGLN_ALA(call);
 
-        if (reportedLoc) {
+        if (reportedLoc || optRemarksEnabledFor(call)) {
           primMaybeLocalThisLocations.insert(call->astloc);
         }
 
@@ -1546,7 +1586,7 @@ static void autoLocalAccess(ForallStmt *forall) {
                                  call);
       LOGLN_ALA(call);
 
-      if (reportedLoc) {
+      if (reportedLoc || optRemarksEnabledFor(call)) {
         primMaybeLocalThisLocations.insert(call->astloc);
       }
 
@@ -1571,6 +1611,10 @@ static void autoLocalAccess(ForallStmt *forall) {
 static CallExpr *revertAccess(CallExpr *call) {
   LOG_ALA(0, "Static check failed. Reverting optimization", call,
           /*forallDetails=*/true);
+  if (fAutoLocalAccess) {
+    optRemark(OPT_REMARK_MISSED, "auto-local-access", call,
+              "access will not use localAccess", "static check failed");
+  }
 
   CallExpr *repl = new CallExpr(new UnresolvedSymExpr("this"),
                                 gMethodToken);
@@ -1589,9 +1633,13 @@ static CallExpr *confirmAccess(CallExpr *call) {
   if (toSymExpr(call->get(call->argList.length))->symbol() == gTrue) {
     LOG_ALA(0, "Static check successful. Using localAccess", call,
             /*forallDetails=*/true);
+    optRemark(OPT_REMARK_PASSED, "auto-local-access", call,
+              "access uses localAccess");
   }
   else {
     LOG_ALA(0, "Static check successful. Using localAccess with dynamic check", call);
+    optRemark(OPT_REMARK_PASSED, "auto-local-access", call,
+              "access uses localAccess with a dynamic check");
   }
 
   CallExpr *repl = new CallExpr(new UnresolvedSymExpr("localAccess"),
@@ -1689,22 +1737,42 @@ static void autoAggregation(ForallStmt *forall) {
     for_vector(Expr, lastStmt, lastStmts) {
       if (CallExpr *lastCall = toCallExpr(lastStmt)) {
         bool reportedLoc = false;
+        bool isCandidate = false;
         if (lastCall->isNamedAstr(astrSassign)) {
           // no need to do anything if it is array access
           if (assignmentSuitableForAggregation(lastCall, forall)) {
             reportedLoc = LOG_AA(1, "Found an aggregation candidate", lastCall);
+            isCandidate = true;
 
             insertAggCandidate(lastCall, forall);
           }
           // we need special handling if it is a symbol that is an array element
           else if (handleYieldedArrayElementsInAssignment(lastCall, forall)) {
             reportedLoc = LOG_AA(1, "Found an aggregation candidate", lastCall);
+            isCandidate = true;
 
             insertAggCandidate(lastCall, forall);
           }
         }
+        else if (isCompoundAssignment(lastCall) &&
+                 getIndexedBaseSym(lastCall->get(1), forall->loopBody())) {
+          LOG_AA(1, "Compound assignment will not use aggregation: "
+                    "aggregators only support copies", lastCall);
+          optRemark(OPT_REMARK_MISSED, "auto-aggregation", lastCall,
+                    "compound assignment will not use aggregation",
+                    "aggregators only support copies");
+        }
+        else if (isReduceIntoShadowVar(lastCall) &&
+                 getIndexedBaseSym(lastCall->get(2), forall->loopBody())) {
+          LOG_AA(1, "Reduction of a potentially remote read will not use "
+                    "aggregation: reductions accumulate in reduce-op objects",
+                 lastCall);
+          optRemark(OPT_REMARK_MISSED, "auto-aggregation", lastCall,
+                    "reduction will not use aggregation",
+                    "reductions accumulate in reduce-op objects");
+        }
 
-        if (reportedLoc) {
+        if (reportedLoc || (isCandidate && optRemarksEnabledFor(lastCall))) {
           primMaybeAggregateAssignLocations.insert(lastCall->astloc);
         }
       }
@@ -1712,12 +1780,157 @@ static void autoAggregation(ForallStmt *forall) {
   }
   else {
     LOG_AA(1, "Can't optimize this forall: invalid induction variables", forall);
+    optRemark(OPT_REMARK_MISSED, "auto-aggregation", forall,
+              "forall not optimized", "invalid induction variables");
   }
 
   LOG_AA(0, "End analyzing forall for automatic aggregation", forall);
   LOGLN_AA(forall);
 }
 
+static bool isCompoundAssignment(CallExpr *call) {
+  return call->isNamed("+=")  ||
+         call->isNamed("-=")  ||
+         call->isNamed("*=")  ||
+         call->isNamed("/=")  ||
+         call->isNamed("**=") ||
+         call->isNamed("%=")  ||
+         call->isNamed("&=")  ||
+         call->isNamed("|=")  ||
+         call->isNamed("^=")  ||
+         call->isNamed("&&=") ||
+         call->isNamed("||=") ||
+         call->isNamed("<<=") ||
+         call->isNamed(">>=");
+}
+
+// Is `call` like `x op= ...` or `x reduce= ...` where `x` is a reduce-intent
+// shadow variable of the enclosing forall?
+static bool isReduceIntoShadowVar(CallExpr *call) {
+  if (call->numActuals() != 2 ||
+      !(call->isNamed("reduce=") || isCompoundAssignment(call))) {
+    return false;
+  }
+
+  if (SymExpr *lhsSE = toSymExpr(call->get(1))) {
+    if (ShadowVarSymbol *svar = toShadowVarSymbol(lhsSE->symbol())) {
+      return svar->isReduce();
+    }
+  }
+  return false;
+}
+
+// If `expr` looks like `A[...]` or `A(...)` where `A` is a variable declared
+// outside of `loop`, return `A`.
+static Symbol *getIndexedBaseSym(Expr *expr, BlockStmt *loop) {
+  if (CallExpr *call = toCallExpr(expr)) {
+    if (call->numActuals() > 0) {
+      if (SymExpr *baseSE = toSymExpr(call->baseExpr)) {
+        Symbol *base = baseSE->symbol();
+        if ((isVarSymbol(base) || isArgSymbol(base)) &&
+            base->defPoint != NULL &&
+            !loop->contains(base->defPoint)) {
+          return base;
+        }
+      }
+    }
+  }
+  return NULL;
+}
+
+// Look for remote scatter/gather patterns in the last statements of serial
+// `for` loops that run within `coforall` tasks, e.g.
+//
+//   coforall loc in Locales do on loc {
+//     for i in myIndices do
+//       A[idx[i]] = B[i];
+//   }
+//
+// These are reported as missed opportunities and are NOT rewritten.
+// Aggregating them would delay the writes until the aggregator is flushed,
+// which is not safe in general because the iterations of a `for` loop are
+// ordered and a later iteration may read what an earlier one wrote. The
+// aggregators in the AutoAggregation module only support plain copies, so
+// compound assignments have nothing to map onto either; supporting them
+// needs an aggregator that applies the operator on the destination locale.
+//
+// Reductions in forall bodies are reported by autoAggregation: their
+// accumulation happens in reduce-op objects that are combined by the
+// runtime, so there is no remote write to aggregate.
+static void analyzeAggregationInCoforalls() {
+  // coforall bodies are cloned for bounded and unbounded versions; only
+  // report each location once
+  std::set<astlocT> reported;
+
+  forv_Vec(BlockStmt, block, gBlockStmts) {
+    CallExpr *info = block->blockInfoGet();
+
+    if (info == NULL || !block->inTree() ||
+        !(info->isPrimitive(PRIM_BLOCK_COFORALL) ||
+          info->isPrimitive(PRIM_BLOCK_COFORALL_ON))) {
+      continue;
+    }
+
+    std::vector<Expr *> stmts;
+    collect_stmts(block, stmts);
+
+    for_vector(Expr, stmt, stmts) {
+      ForLoop *loop = toForLoop(stmt);
+      if (loop == NULL || loop->isCoforallLoop() ||
+          enclosingForallStmt(loop) != NULL) {
+        continue;
+      }
+
+      std::vector<Expr *> lastStmts = getLastStmtsForLoopBody(loop);
+
+      for_vector(Expr, lastStmt, lastStmts) {
+        CallExpr *lastCall = toCallExpr(lastStmt);
+        if (lastCall == NULL || lastCall->numActuals() != 2 ||
+            reported.count(lastCall->astloc) != 0) {
+          continue;
+        }
+
+        bool isAssign = lastCall->isNamedAstr(astrSassign);
+        bool isCompound = isCompoundAssignment(lastCall);
+        if (!isAssign && !isCompound) {
+          continue;
+        }
+
+        Symbol *lhsBase = getIndexedBaseSym(lastCall->get(1), loop);
+        Symbol *rhsBase = getIndexedBaseSym(lastCall->get(2), loop);
+        if (lhsBase == NULL && rhsBase == NULL) {
+          continue;
+        }
+
+        reported.insert(lastCall->astloc);
+
+        LOG_AA(0, "Start analyzing for loop in coforall for automatic aggregation",
+               loop);
+        LOG_AA(1, lhsBase != NULL ? "Found a potential destination aggregation"
+                                  : "Found a potential source aggregation",
+               lastCall);
+        if (isCompound) {
+          LOG_AA(2, "Will not use aggregation: aggregators only support copies",
+                 lastCall);
+          optRemark(OPT_REMARK_MISSED, "auto-aggregation", lastCall,
+                    "assignment in a coforall will not use aggregation",
+                    "aggregators only support copies");
+        }
+        else {
+          LOG_AA(2, "Will not use aggregation: iterations of a for loop are "
+                    "ordered; consider a forall", lastCall);
+          optRemark(OPT_REMARK_MISSED, "auto-aggregation", lastCall,
+                    "assignment in a coforall will not use aggregation",
+                    "iterations of a for loop are ordered; consider a forall");
+        }
+        LOG_AA(0, "End analyzing for loop in coforall for automatic aggregation",
+               loop);
+        LOGLN_AA(loop);
+      }
+    }
+  }
+}
+
 AggregationCandidateInfo::AggregationCandidateInfo(CallExpr *candidate,
                                                    ForallStmt *forall):
   candidate(candidate),
@@ -1970,10 +2183,29 @@ Expr *preFoldMaybeAggregateAssign(CallExpr *call) {
 
     if (aggregator != NULL) {
       replacement = createAggCond(assign, aggregator, aggMarkerSE);
+
+      optRemark(OPT_REMARK_PASSED, "auto-aggregation", call,
+                aggregator == srcAggregator ?
+                "assignment uses source aggregation" :
+                "assignment uses destination aggregation");
     }
   }
 
   if (replacement == NULL) {
+    if (optRemarksEnabledFor(call)) {
+      const char* reason = NULL;
+
+      if (lhsLocal && rhsLocal)
+        reason = "both sides of the assignment look local";
+      else if (!lhsLocal && !rhsLocal)
+        reason = "could not prove the locality of either side";
+      else
+        reason = "the type does not support aggregation";
+
+      optRemark(OPT_REMARK_MISSED, "auto-aggregation", call,
+                "assignment will not use aggregation", reason);
+    }
+
     if (fReportAutoAggregation) {
       if (lhsLocal && rhsLocal) {
         message << "Both sides of the assignment looks local. Will not use aggregation";
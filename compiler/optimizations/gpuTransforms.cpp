@@ -35,6 +35,7 @@
 #include "bb.h"
 #include "astutil.h"
 #include "optimizations.h"
+#include "OptRemarks.h"
 #include "timer.h"
 #include "misc.h"
 #include "view.h"
@@ -375,7 +376,7 @@ class GpuizableLoop {
   std::vector<Symbol*> loopIndices_;
   std::vector<Symbol*> lowerBounds_;
   std::vector<CallExpr*> gpuAssertions_;
-  CallExpr* compileTimeGpuAssertion_;
+  CallExpr* compileTimeGpuAssertion_ = nullptr;
   const char* reason = nullptr;
 
   CondStmt* gpuCond_ = nullptr;
@@ -412,12 +413,24 @@ public:
     return loop;
   }
 
+  // Evaluate the eligibility of 'loop' without the side effects of the
+  // constructor: assertOnGpu() is not enforced and the AST is not changed.
+  // For loops that are only being classified, e.g. for CPU vectorization.
+  static GpuizableLoop analyzeOnly(CForLoop* loop) {
+    GpuizableLoop ret;
+    ret.loop_ = loop;
+    ret.parentFn_ = loop->getFunction();
+    ret.isEligible_ = ret.evaluateLoop();
+    return ret;
+  }
+
   bool isReportWorthy();
 
   CForLoop* cpuLoop() const { return loop_; }
   CForLoop* gpuLoop() const { return gpuLoop_; }
 
   bool isEligible() const { return isEligible_; }
+  const char* notEligibleReason() const { return reason; }
   Symbol* upperBound() const { return upperBound_; }
   const std::vector<Symbol*>& loopIndices() const { return loopIndices_; }
   const std::vector<Symbol*>& lowerBounds() const { return lowerBounds_; }
@@ -734,7 +747,8 @@ bool GpuizableLoop::extractUpperBound() {
 }
 
 void GpuizableLoop::reportNotGpuizable(const BaseAST* ast, const char *msg) {
-  this->reason = msg;
+  // 'msg' may be a temporary
+  this->reason = astr(msg);
   if(this->compileTimeGpuAssertion_) {
     printNonGpuizableError(this->compileTimeGpuAssertion_, loop_);
     USR_PRINT(ast, "%s", msg);
@@ -1441,6 +1455,106 @@ static void logGpuizableLoops() {
   }
 }
 
+// ----------------------------------------------------------------------------
+// CPU vectorization of GPU-eligible loops
+// ----------------------------------------------------------------------------
+
+// A loop that is eligible for GPU execution has order-independent
+// iterations, no reductions, and only calls functions and primitives that
+// are fast and local.  Those are the properties the loop vectorizer needs
+// as well, so we reuse the eligibility analysis to request vectorization of
+// the loop that runs on the CPU (either because there is no GPU locale
+// model, or because CHPL_GPU=cpu executes the non-GPU path after the
+// kernel launch).  Alias information for accesses in the loop body comes
+// from computeNoAliasSets, which runs after this.
+
+static bool hasGpuAssertion(CForLoop* loop) {
+  for_alist(expr, loop->body) {
+    CallExpr* call = toCallExpr(expr);
+    if (call && call->isPrimitive(PRIM_ASSERT_ON_GPU)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void markLoopForCpuVectorization(CForLoop* loop) {
+  // Respect an explicit request from the user (e.g. @llvm.metadata)
+  if (loop->hasAdditionalLLVMMetadata("llvm.loop.vectorize.enable"))
+    return;
+
+  LLVMMetadataList metadata = loop->getAdditionalLLVMMetadata();
+  metadata.push_back(
+      LLVMMetadata::constructBool("llvm.loop.vectorize.enable", true));
+  loop->setAdditionalLLVMMetadata(metadata);
+
+  if (fReportVectorizedLoops) {
+    if (developer || loop->getModule()->modTag == MOD_USER) {
+      printf("Vectorized GPU-eligible loop for the CPU at %s\n",
+             loop->stringLoc());
+    }
+  }
+
+  if (optRemarksEnabledFor(loop)) {
+    optRemark(OPT_REMARK_PASSED, "vectorize", loop,
+              "requested vectorization of a GPU-eligible loop for the CPU");
+  }
+}
+
+static void vectorizeGpuEligibleLoopsForCpu() {
+  forv_Vec(FnSymbol*, fn, gFnSymbols) {
+    if (fn->hasFlag(FLAG_GPU_CODEGEN))
+      continue;
+
+    std::vector<CForLoop*> loops;
+    collectCForLoopStmtsPreorder(fn, loops);
+
+    for_vector(CForLoop, loop, loops) {
+      // Skip the copies that will be outlined into GPU kernels, and loops
+      // whose GPU eligibility is asserted (and checked) elsewhere.
+      if (!loop->inTree() ||
+          getGpuEligibleMarker(loop) != nullptr ||
+          hasGpuAssertion(loop)) {
+        continue;
+      }
+
+      // Loops with vectorization hazards are not worth the analysis
+      if (!loop->isVectorizable())
+        continue;
+
+      if (GpuizableLoop::analyzeOnly(loop).isEligible()) {
+        markLoopForCpuVectorization(loop);
+      }
+    }
+  }
+}
+
+static void remarkGpuizableLoops() {
+  forv_Vec(FnSymbol*, fn, gFnSymbols) {
+    std::vector<CForLoop*> loops;
+    collectCForLoopStmtsPreorder(fn, loops);
+
+    for_vector(CForLoop, loop, loops) {
+      if (!optRemarksEnabledFor(loop))
+        continue;
+
+      GpuizableLoop gpuLoop = GpuizableLoop::analyzeOnly(loop);
+
+      if (!gpuLoop.isReportWorthy())
+        continue;
+
+      if (gpuLoop.isEligible()) {
+        optRemark(OPT_REMARK_PASSED, "gpu-eligibility", loop,
+                  "loop is eligible for GPU execution");
+      } else {
+        optRemark(OPT_REMARK_MISSED, "gpu-eligibility", loop,
+                  "loop is not eligible for GPU execution",
+                  gpuLoop.notEligibleReason());
+      }
+    }
+  }
+}
+
 // ----------------------------------------------------------------------------
 
 void lateGpuTransforms() {
@@ -1448,6 +1562,16 @@ void lateGpuTransforms() {
     logGpuizableLoops();
   }
 
+  if (optRemarksEnabled()) {
+    remarkGpuizableLoops();
+  }
+
+  // Do this before outlining so that the CPU copies of eligible loops are
+  // still recognizable.
+  if (fVectorizeGpuEligibleLoops && !fNoVectorize) {
+    vectorizeGpuEligibleLoopsForCpu();
+  }
+
   // For now, we are doing GPU outlining here. In the future, it should
   // probably be its own pass.
   if (usingGpuLocaleModel()) {
@@ -23,6 +23,8 @@
 #include "astutil.h"
 #include "driver.h"
 #include "expr.h"
+#include "FnProfiler.h"
+#include "OptRemarks.h"
 #include "optimizations.h"
 #include "stlUtil.h"
 #include "stmt.h"
@@ -30,11 +32,13 @@
 
 #include "global-ast-vecs.h"
 
+#include <map>
 #include <set>
 #include <vector>
 
 static void updateRefCalls();
 static void inlineFunctionsImpl();
+static void inlineSmallFunctions();
 static void inlineFunction(FnSymbol* fn, std::set<FnSymbol*>& inlinedSet);
 static void inlineCall(CallExpr* call);
 static void updateDerefCalls();
@@ -56,6 +60,8 @@ void inlineFunctions() {
 
   inlineFunctionsImpl();
 
+  inlineSmallFunctions();
+
   updateDerefCalls();
 
   inlineCleanup();
@@ -96,6 +102,8 @@ static void simplifyBody(FnSymbol* fn);
 static void inlineAtCallSites(FnSymbol* fn);
 
 static void inlineFunction(FnSymbol* fn, std::set<FnSymbol*>& inlinedSet) {
+  FnProfileScope profile("inlineFunctions", fn);
+
   markFunction(fn, inlinedSet);
 
   inlineBody(fn, inlinedSet);
@@ -165,6 +173,11 @@ static void simplifyBody(FnSymbol* fn) {
 static void inlineAtCallSites(FnSymbol* fn) {
   forv_Vec(CallExpr, call, *fn->calledBy) {
     if (call->isResolved()) {
+      if (optRemarksEnabledFor(call)) {
+        optRemark(OPT_REMARK_PASSED, "inline", call,
+                  astr("inlined '", fn->name, "', which is marked inline"));
+      }
+
       inlineCall(call);
 
       if (report_inlining) {
@@ -176,6 +189,296 @@ static void inlineAtCallSites(FnSymbol* fn) {
   }
 }
 
+/************************************* | **************************************
+*                                                                             *
+* With --inline-size-limit, also inline functions without the inline flag    *
+* when they are small enough.  These are mostly wrappers, accessors and other *
+* forwarding functions, which are cheaper to inline here than to leave for    *
+* the backend, since insertWideReferences will make their ref formals wide.   *
+*                                                                             *
+* Functions are considered callees first, so the summary that the decision   *
+* is based on (size, loops, on-statements) describes the function after its  *
+* own callees were inlined into it.                                           *
+*                                                                             *
+************************************** | *************************************/
+
+namespace {
+  struct InlineSummary {
+    int  size;        // AST nodes in the body
+    int  loops;       // loop statements in the body
+    bool hasOn;       // calls an on-statement or task function
+  };
+
+  enum InlineVisitState {
+    INLINE_VISITING,
+    INLINE_VISITED
+  };
+}
+
+static void considerForInlining(FnSymbol* fn,
+                                std::map<FnSymbol*, InlineVisitState>& state,
+                                std::set<FnSymbol*>& recursiveFns);
+static InlineSummary summarizeForInlining(FnSymbol* fn);
+static const char* cannotInlineReason(FnSymbol* fn,
+                                      const InlineSummary& summary,
+                                      int numCalls,
+                                      std::set<FnSymbol*>& recursiveFns);
+static const char* cannotInlineCallReason(CallExpr* call, FnSymbol* fn,
+                                          const InlineSummary& summary,
+                                          int numCalls);
+static void reportInliningDecision(CallExpr* call, FnSymbol* fn,
+                                   const InlineSummary& summary,
+                                   const char* reason);
+
+static void inlineSmallFunctions() {
+  if (fNoInline == false && inline_size_limit > 0) {
+    std::map<FnSymbol*, InlineVisitState> state;
+    std::set<FnSymbol*>                   recursiveFns;
+
+    forv_Vec(FnSymbol, fn, gFnSymbols) {
+      if (fn->inTree()) {
+        considerForInlining(fn, state, recursiveFns);
+      }
+    }
+  }
+}
+
+static void considerForInlining(FnSymbol* fn,
+                                std::map<FnSymbol*, InlineVisitState>& state,
+                                std::set<FnSymbol*>& recursiveFns) {
+  std::vector<CallExpr*> calls;
+  std::vector<CallExpr*> callSites;
+
+  if (state.count(fn) != 0) {
+    return;
+  }
+
+  state[fn] = INLINE_VISITING;
+
+  collectFnCalls(fn, calls);
+
+  for_vector(CallExpr, call, calls) {
+    if (FnSymbol* calledFn = call->resolvedFunction()) {
+      std::map<FnSymbol*, InlineVisitState>::iterator it =
+        state.find(calledFn);
+
+      if (it == state.end()) {
+        considerForInlining(calledFn, state, recursiveFns);
+
+      } else if (it->second == INLINE_VISITING) {
+        recursiveFns.insert(calledFn);
+      }
+    }
+  }
+
+  state[fn] = INLINE_VISITED;
+
+  if (fn->hasFlag(FLAG_INLINE)     == true  ||
+      fn->hasFlag(FLAG_EXTERN)     == true  ||
+      fn->hasFlag(FLAG_NO_FN_BODY) == true  ||
+      fn->hasFlag(FLAG_NO_CODEGEN) == true  ||
+      fn->calledBy                 == NULL) {
+    return;
+  }
+
+  forv_Vec(CallExpr, call, *fn->calledBy) {
+    if (call->inTree() && call->resolvedFunction() == fn) {
+      callSites.push_back(call);
+    }
+  }
+
+  if (callSites.empty()) {
+    return;
+  }
+
+  InlineSummary summary    = summarizeForInlining(fn);
+  int           numCalls   = (int) callSites.size();
+  bool          simplified = false;
+
+  // Larger functions could never be inlined; don't report on them.
+  if (summary.size > 8 * inline_size_limit) {
+    return;
+  }
+
+  const char* fnReason = cannotInlineReason(fn, summary, numCalls,
+                                            recursiveFns);
+
+  FnProfileScope profile("inlineFunctions", fn);
+
+  for_vector(CallExpr, call, callSites) {
+    const char* reason = fnReason;
+
+    if (reason == NULL) {
+      reason = cannotInlineCallReason(call, fn, summary, numCalls);
+    }
+
+    if (report_inlining) {
+      reportInliningDecision(call, fn, summary, reason);
+    }
+
+    if (optRemarksEnabledFor(call)) {
+      if (reason == NULL) {
+        optRemark(OPT_REMARK_PASSED, "inline", call,
+                  astr("inlined '", fn->name, "' (size ",
+                       istr(summary.size), ")"));
+      } else {
+        optRemark(OPT_REMARK_MISSED, "inline", call,
+                  astr("did not inline '", fn->name, "'"), reason);
+      }
+    }
+
+    if (reason == NULL) {
+      if (simplified == false) {
+        simplifyBody(fn);
+        simplified = true;
+      }
+
+      inlineCall(call);
+    }
+  }
+}
+
+static InlineSummary summarizeForInlining(FnSymbol* fn) {
+  InlineSummary          retval = { 0, 0, false };
+  std::vector<BaseAST*>  asts;
+
+  collect_asts(fn->body, asts);
+
+  retval.size = (int) asts.size();
+
+  for_vector(BaseAST, ast, asts) {
+    if (isLoopStmt(ast)) {
+      retval.loops++;
+    }
+
+    if (CallExpr* call = toCallExpr(ast)) {
+      if (FnSymbol* calledFn = call->resolvedFunction()) {
+        if (isTaskFun(calledFn) || calledFn->hasFlag(FLAG_ON_BLOCK)) {
+          retval.hasOn = true;
+        }
+      }
+    }
+  }
+
+  return retval;
+}
+
+//
+// Returns why none of fn's call sites can be inlined, or NULL
+//
+static const char* cannotInlineReason(FnSymbol* fn,
+                                      const InlineSummary& summary,
+                                      int numCalls,
+                                      std::set<FnSymbol*>& recursiveFns) {
+  const char* retval = NULL;
+
+  if (fn->hasFlag(FLAG_EXPORT)          == true) {
+    retval = "function is exported";
+
+  } else if (fn->hasFlag(FLAG_VIRTUAL)  == true) {
+    retval = "function is virtual";
+
+  } else if (fn->isIterator()           == true) {
+    retval = "function is an iterator";
+
+  } else if (isTaskFun(fn)                           == true ||
+             fn->hasFlag(FLAG_ON_BLOCK)              == true ||
+             fn->hasFlag(FLAG_BEGIN_BLOCK)           == true ||
+             fn->hasFlag(FLAG_COBEGIN_OR_COFORALL_BLOCK) == true) {
+    retval = "function is the body of a task or on-statement";
+
+  } else if (fn->hasFlag(FLAG_GPU_CODEGEN)         == true ||
+             fn->hasFlag(FLAG_GPU_AND_CPU_CODEGEN) == true) {
+    retval = "function is a GPU kernel";
+
+  } else if (recursiveFns.count(fn)     != 0) {
+    retval = "function is recursive";
+
+  } else if (summary.hasOn              == true) {
+    retval = "function contains an on-statement or starts tasks";
+
+  } else if (summary.loops > 0 && numCalls > 1) {
+    retval = "function contains a loop and has more than one call site";
+  }
+
+  return retval;
+}
+
+static bool isInLoop(Expr* expr) {
+  for (Expr* parent = expr->parentExpr; parent; parent = parent->parentExpr) {
+    if (isLoopStmt(parent)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//
+// Returns why this call to fn can't be inlined, or NULL
+//
+// The size limit is doubled for wrappers and field accessors, for calls
+// inside loops, and when this is the only call to fn (so inlining it does
+// not duplicate code).
+//
+static const char* cannotInlineCallReason(CallExpr* call, FnSymbol* fn,
+                                          const InlineSummary& summary,
+                                          int numCalls) {
+  int limit = inline_size_limit;
+
+  if (call->getFunction() == fn) {
+    return "function is recursive";
+  }
+
+  for_actuals(actual, call) {
+    if (isSymExpr(actual) == false) {
+      return "call has an actual that is not a symbol";
+    }
+  }
+
+  if (fn->hasFlag(FLAG_WRAPPER) || fn->hasFlag(FLAG_FIELD_ACCESSOR)) {
+    limit *= 2;
+  }
+
+  if (isInLoop(call)) {
+    limit *= 2;
+  }
+
+  if (numCalls == 1) {
+    limit *= 2;
+  }
+
+  if (summary.size > limit) {
+    char buf[128];
+
+    snprintf(buf, sizeof(buf),
+             "function size %d exceeds the limit of %d for this call",
+             summary.size, limit);
+
+    return astr(buf);
+  }
+
+  return NULL;
+}
+
+static void reportInliningDecision(CallExpr* call, FnSymbol* fn,
+                                   const InlineSummary& summary,
+                                   const char* reason) {
+  ModuleSymbol* mod = call->getModule();
+
+  if (developer || mod->modTag == MOD_USER) {
+    if (reason == NULL) {
+      printf("Inlined %s (size %d) into %s at %s:%d\n",
+             fn->name, summary.size, call->getFunction()->name,
+             call->fname(), call->linenum());
+    } else {
+      printf("Did not inline %s into %s at %s:%d: %s\n",
+             fn->name, call->getFunction()->name,
+             call->fname(), call->linenum(), reason);
+    }
+  }
+}
+
 /************************************* | **************************************
 *                                                                             *
 * inlines the function called by 'call' at that call site                     *
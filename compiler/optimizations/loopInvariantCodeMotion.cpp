@@ -41,8 +41,10 @@
 #include "global-ast-vecs.h"
 
 #include <algorithm>
+#include <map>
 #include <set>
 #include <stack>
+#include <vector>
 
 
 
@@ -509,6 +511,284 @@ static void addDefOrUse(symToVecSymExprMap& localDefOrUseMap, Symbol* var, SymEx
 }
 
 
+/*
+ * Interprocedural summary of the fields that a function may write.
+ *
+ * Without it, a call in the loop is assumed to write its actuals and every
+ * field of their types. That keeps loops with an on statement in them (the
+ * on statement is a call to the outlined on function by now) from hoisting
+ * any read of a field of an object used in the on statement, and those reads
+ * become remote loads once wide references are inserted.
+ *
+ * A field is written by a function if the function or anything it calls
+ * sets it or takes a reference to it that is not only read. Writes in an
+ * initializer to the object being initialized don't count, since no other
+ * code can see that object yet; in particular const fields are only ever
+ * written that way. A function that makes an indirect or virtual call, or
+ * that casts a class instance to a C pointer, may write anything.
+ *
+ * Summaries are computed for the strongly connected components of the call
+ * graph, so mutually recursive functions share one.
+ */
+struct FieldWrites {
+  FieldWrites() : unknown(false) { }
+
+  std::set<Symbol*> fields;
+  bool              unknown;
+};
+
+// the index into sccFieldWrites for each function's call graph component
+static std::map<FnSymbol*, int>  fnToScc;
+static std::vector<FieldWrites>  sccFieldWrites;
+
+static bool isReadOnlyFieldRef(CallExpr* getMember) {
+  CallExpr* move = toCallExpr(getMember->parentExpr);
+
+  if (move == NULL || move->isPrimitive(PRIM_MOVE) == false) {
+    return false;
+  }
+
+  Symbol* ref = toSymExpr(move->get(1))->symbol();
+
+  if (isVarSymbol(ref) == false) {
+    return false;
+  }
+
+  for_SymbolSymExprs(se, ref) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+
+    if (call == NULL) {
+      return false;
+
+    } else if (call == move) {
+      continue;
+
+    } else if (call->isPrimitive(PRIM_DEREF)) {
+      continue;
+
+    } else if (call->isPrimitive(PRIM_GET_MEMBER_VALUE) &&
+               call->get(1) == se) {
+      continue;
+
+    } else if (isMoveOrAssign(call) && call->get(2) == se &&
+               call->get(1)->isRef() == false) {
+      continue;
+
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool isInitializerThis(FnSymbol* fn, Expr* base) {
+  SymExpr* se = toSymExpr(base);
+
+  return se                                       != NULL &&
+         fn->_this                                != NULL &&
+         se->symbol()                             == fn->_this &&
+         (fn->isInitializer() || fn->isCopyInit());
+}
+
+// Collect the fields that 'fn' writes itself and the functions it calls
+static void collectLocalFieldWrites(FnSymbol* fn, FieldWrites& writes,
+                                    std::vector<FnSymbol*>& callees) {
+  std::vector<CallExpr*> calls;
+
+  collectCallExprs(fn->body, calls);
+
+  for_vector(CallExpr, call, calls) {
+    if (call->isPrimitive(PRIM_SET_MEMBER)) {
+      if (isInitializerThis(fn, call->get(1)) == false) {
+        writes.fields.insert(toSymExpr(call->get(2))->symbol());
+      }
+
+    } else if (call->isPrimitive(PRIM_SET_SVEC_MEMBER)) {
+      writes.fields.insert(getSvecSymbol(call));
+
+    } else if (call->isPrimitive(PRIM_GET_MEMBER)) {
+      if (isInitializerThis(fn, call->get(1)) == false &&
+          isReadOnlyFieldRef(call)            == false) {
+        writes.fields.insert(toSymExpr(call->get(2))->symbol());
+      }
+
+    } else if (call->isPrimitive(PRIM_GET_SVEC_MEMBER)) {
+      if (isReadOnlyFieldRef(call) == false) {
+        writes.fields.insert(getSvecSymbol(call));
+      }
+
+    } else if (call->isPrimitive(PRIM_VIRTUAL_METHOD_CALL) ||
+               call->isPrimitive(PRIM_FTABLE_CALL)) {
+      writes.unknown = true;
+
+    } else if (call->isPrimitive(PRIM_CAST_TO_VOID_STAR)) {
+      if (isClass(call->get(1)->getValType())) {
+        writes.unknown = true;
+      }
+
+    } else if (call->primitive == NULL) {
+      if (FnSymbol* callee = call->resolvedFunction()) {
+        // extern functions can reach fields through the class instances
+        // passed to them, or through addresses that the Chapel code took,
+        // which are counted above
+        if (callee->hasFlag(FLAG_EXTERN) == false) {
+          callees.push_back(callee);
+
+        } else {
+          for_actuals(actual, call) {
+            if (isClass(actual->getValType())) {
+              writes.unknown = true;
+            }
+          }
+        }
+
+      } else {
+        writes.unknown = true;
+      }
+    }
+  }
+}
+
+static void visitFieldWrites(FnSymbol* fn,
+                             std::map<FnSymbol*, int>& index,
+                             std::map<FnSymbol*, int>& lowLink,
+                             std::vector<FnSymbol*>& stack,
+                             std::set<FnSymbol*>& onStack,
+                             std::map<FnSymbol*, FieldWrites>& localWrites,
+                             std::map<FnSymbol*, std::vector<FnSymbol*> >& calls) {
+  int fnIndex = (int) index.size();
+
+  index[fn]   = fnIndex;
+  lowLink[fn] = fnIndex;
+
+  stack.push_back(fn);
+  onStack.insert(fn);
+
+  collectLocalFieldWrites(fn, localWrites[fn], calls[fn]);
+
+  for_vector(FnSymbol, callee, calls[fn]) {
+    if (index.count(callee) == 0) {
+      visitFieldWrites(callee, index, lowLink, stack, onStack,
+                       localWrites, calls);
+      lowLink[fn] = std::min(lowLink[fn], lowLink[callee]);
+
+    } else if (onStack.count(callee) != 0) {
+      lowLink[fn] = std::min(lowLink[fn], index[callee]);
+    }
+  }
+
+  // 'fn' is the root of a component; everything it calls outside of the
+  // component already has a summary
+  if (lowLink[fn] == fnIndex) {
+    std::vector<FnSymbol*> members;
+    int                    scc    = (int) sccFieldWrites.size();
+    FnSymbol*              member = NULL;
+
+    sccFieldWrites.push_back(FieldWrites());
+
+    do {
+      member = stack.back();
+      stack.pop_back();
+      onStack.erase(member);
+
+      fnToScc[member] = scc;
+      members.push_back(member);
+    } while (member != fn);
+
+    FieldWrites& writes = sccFieldWrites[scc];
+
+    for_vector(FnSymbol, member, members) {
+      FieldWrites& local = localWrites[member];
+
+      writes.unknown = writes.unknown || local.unknown;
+      writes.fields.insert(local.fields.begin(), local.fields.end());
+
+      for_vector(FnSymbol, callee, calls[member]) {
+        int calleeScc = fnToScc[callee];
+
+        if (calleeScc != scc) {
+          FieldWrites& other = sccFieldWrites[calleeScc];
+
+          writes.unknown = writes.unknown || other.unknown;
+          writes.fields.insert(other.fields.begin(), other.fields.end());
+        }
+      }
+    }
+
+    if (writes.unknown) {
+      writes.fields.clear();
+    }
+  }
+}
+
+static void computeFieldWrites() {
+  std::map<FnSymbol*, int>                      index;
+  std::map<FnSymbol*, int>                      lowLink;
+  std::vector<FnSymbol*>                        stack;
+  std::set<FnSymbol*>                           onStack;
+  std::map<FnSymbol*, FieldWrites>              localWrites;
+  std::map<FnSymbol*, std::vector<FnSymbol*> >  calls;
+
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (fn->inTree() && index.count(fn) == 0) {
+      visitFieldWrites(fn, index, lowLink, stack, onStack, localWrites, calls);
+    }
+  }
+}
+
+static void clearFieldWrites() {
+  fnToScc.clear();
+  sccFieldWrites.clear();
+}
+
+// Returns the fields the call may write, or NULL if it may write anything
+static FieldWrites* fieldWritesForCall(CallExpr* call) {
+  FnSymbol* fn = call->resolvedFunction();
+
+  // extern functions aren't summarized; they may write through any
+  // pointer they can reach
+  if (fn == NULL || fn->hasFlag(FLAG_EXTERN)) {
+    return NULL;
+
+  } else if (fnToScc.count(fn) == 0 ||
+             sccFieldWrites[fnToScc[fn]].unknown) {
+    return NULL;
+
+  } else {
+    return &sccFieldWrites[fnToScc[fn]];
+  }
+}
+
+// Can the call change the value of the actual 'se' in the caller?
+static bool callMayChangeActual(CallExpr* call, SymExpr* se) {
+  Type* type = se->symbol()->type;
+
+  // the elements of a data class are not fields, so keep those conservative
+  if (se->isRef() || isClass(type) == false ||
+      type->symbol->hasFlag(FLAG_DATA_CLASS)) {
+    return true;
+  }
+
+  ArgSymbol* formal = actual_to_formal(se);
+
+  return formal->isRef() || formal->intent == INTENT_OUT ||
+         formal->intent == INTENT_INOUT;
+}
+
+// Note the fields that a call writes as defs at 'defSite' in the call
+static void addCallFieldDefs(symToVecSymExprMap& localDefMap, CallExpr* call,
+                             SymExpr* defSite) {
+  FieldWrites* writes = fieldWritesForCall(call);
+
+  INT_ASSERT(writes != NULL);
+
+  for_set(Symbol, field, writes->fields) {
+    addDefOrUse(localDefMap, field, defSite);
+  }
+}
+
+
 /*
  * Build the local def use maps for a loop and while we're at it build the local map which is the map from each
  * symExpr to the block it it is defined in.
@@ -544,6 +824,18 @@ static void buildLocalDefUseMaps(Loop* loop, symToVecSymExprMap& localDefMap, sy
         }
       }
 
+      //Note the fields written by calls with a field write summary. The
+      //call's base is the def site, so calls without actuals are covered
+      std::vector<CallExpr*> calls;
+      collectFnCalls(expr, calls);
+      for_vector(CallExpr, call, calls) {
+        if(call->isResolved() && fieldWritesForCall(call) != NULL) {
+          SymExpr* base = toSymExpr(call->baseExpr);
+          localMap[base] = block->id;
+          addCallFieldDefs(localDefMap, call, base);
+        }
+      }
+
       //Check each symExpr to see if its a use and or def and add to the appropriate lists
       std::vector<SymExpr*> symExprs;
       collectLcnSymExprs(expr, symExprs);
@@ -559,8 +851,18 @@ static void buildLocalDefUseMaps(Loop* loop, symToVecSymExprMap& localDefMap, sy
             if(result & 2) {
               addDefOrUse(localUseMap, symExpr->symbol(), symExpr);
             }
-            //if we have a function call, assume any "classes" fields are changed
-            if(CallExpr* callExpr = toCallExpr(symExpr->parentExpr)) {
+            //if we have a function call with a field write summary, the
+            //fields were noted with the call. A class passed by value
+            //can't be changed by the call.
+            CallExpr* callExpr = toCallExpr(symExpr->parentExpr);
+            if(callExpr && callExpr->isResolved() &&
+               fieldWritesForCall(callExpr) != NULL) {
+              if(callMayChangeActual(callExpr, symExpr)) {
+                addDefOrUse(localDefMap, symExpr->symbol(), symExpr);
+              }
+            }
+            //otherwise, assume any "classes" fields are changed
+            else if(callExpr) {
               if(callExpr->isResolved() || callExpr->isPrimitive(PRIM_VIRTUAL_METHOD_CALL)) {
                 addDefOrUse(localDefMap, symExpr->symbol(), symExpr);
                 Type* type = symExpr->symbol()->type->symbol->type;
@@ -1305,11 +1607,17 @@ static void loopInvariantCodeMotionImpl(void) {
 
   startTimer(overallTimer);
 
+  if (!fNoInterproceduralAliasAnalysis) {
+    computeFieldWrites();
+  }
+
   //TODO use stl routine here
   forv_Vec(FnSymbol, fn, gFnSymbols) {
     licmFn(fn);
   }
 
+  clearFieldWrites();
+
   stopTimer(overallTimer);
 
 #ifdef detailedTiming
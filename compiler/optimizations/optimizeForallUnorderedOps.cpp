@@ -190,6 +190,13 @@ std::vector<Expr *> getLastStmtsForForallUnorderedOps(ForallStmt *forall) {
   return lastStmts;
 }
 
+// Same as above, but for the body of a loop that is not a forall
+std::vector<Expr *> getLastStmtsForLoopBody(BlockStmt *body) {
+  std::vector<Expr *> lastStmts;
+  getLastStmts(body, lastStmts);
+  return lastStmts;
+}
+
 // ---- mark optimizable foralls during lifetime checking
 
 // This could definitely be implemented in a faster way.
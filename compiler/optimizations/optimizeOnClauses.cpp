@@ -30,6 +30,7 @@
 #include "astutil.h"
 #include "driver.h"
 #include "expr.h"
+#include "OptRemarks.h"
 #include "stlUtil.h"
 #include "stmt.h"
 #include "wellknown.h"
@@ -391,6 +392,16 @@ inLocalBlock(CallExpr *call) {
   return false;
 }
 
+// Why markFastSafeFn did not find the function it was last called on to
+// be fast, for the optimization remarks.  The first reason found is kept,
+// which is usually the innermost one.
+static const char* notFastReason = NULL;
+
+static void noteNotFast(const char* reason) {
+  if (notFastReason == NULL)
+    notFastReason = reason;
+}
+
 static int
 markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
 
@@ -398,6 +409,7 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
   if (visited.count(fn) != 0) {
     if (fn->hasFlag(FLAG_FAST_ON))
       return FAST_AND_LOCAL;
+    noteNotFast("calls a function that is not fast");
     if (fn->hasFlag(FLAG_LOCAL_FN))
       return LOCAL_NOT_FAST;
     return NOT_FAST_NOT_LOCAL;
@@ -415,9 +427,11 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
       fn->addFlag(FLAG_LOCAL_FN);
       return FAST_AND_LOCAL;
     } else if(fn->hasFlag(FLAG_LOCAL_FN)) {
+      noteNotFast("calls an extern function that is not marked fast");
       return LOCAL_NOT_FAST;
     } else {
       // Other extern functions are not fast or local.
+      noteNotFast("calls an extern function that is not marked local");
       return NOT_FAST_NOT_LOCAL;
     }
   }
@@ -430,8 +444,10 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
   // in the function that is not local.
   bool maybefast = true;
 
-  if (fn->hasFlag(FLAG_NON_BLOCKING))
+  if (fn->hasFlag(FLAG_NON_BLOCKING)) {
+    noteNotFast("is non-blocking");
     maybefast = false;
+  }
 
   std::vector<CallExpr*> calls;
 
@@ -445,11 +461,13 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
 
       if (!isLocal(is)) {
         // FAST_NOT_LOCAL or NOT_FAST_NOT_LOCAL
+        noteNotFast("uses an operation that may communicate");
         return NOT_FAST_NOT_LOCAL;
       }
 
       // is == FAST_AND_LOCAL requires no action
       if (is == LOCAL_NOT_FAST) {
+        noteNotFast("uses an operation that may allocate or block");
         maybefast = false;
       }
 
@@ -457,11 +475,15 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
       if (recurse<=0 || !call->isResolved()) {
         // didn't resolve or past too much recursion.
         // No function calls allowed
+        noteNotFast(recurse <= 0 ?
+                    "calls are nested deeper than --optimize-on-clause-limit" :
+                    "makes an indirect call");
         return NOT_FAST_NOT_LOCAL;
 
       } else {
         // Handle nested 'on' statements
         if (call->resolvedFunction()->hasFlag(FLAG_ON_BLOCK)) {
+          noteNotFast("contains a nested on statement");
           if (inLocal) {
             maybefast = false;
           } else {
@@ -495,6 +517,7 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
   for_vector(Expr, stmt, stmts) {
     if (BlockStmt* block = toBlockStmt(stmt)) {
       if (block->isLoopStmt()) {
+        noteNotFast("contains a loop");
         maybefast = false;
         break;
       }
@@ -611,6 +634,8 @@ optimizeOnClauses(void) {
   forv_Vec(FnSymbol, fn, gFnSymbols) {
     std::set<FnSymbol*> visited;
 
+    notFastReason = NULL;
+
     int is = markFastSafeFn(fn, optimize_on_clause_limit, visited);
 
     bool fastFork = isFast(is);
@@ -637,6 +662,22 @@ optimizeOnClauses(void) {
       removeRmemFences = removeUnnecessaryFences(fn);
     }
 
+    if (fn->hasFlag(FLAG_ON_BLOCK) && optRemarksEnabledFor(fn)) {
+      if (fastFork) {
+        optRemark(OPT_REMARK_PASSED, "optimize-on-clauses", fn,
+                  "on statement will run in the active message handler");
+      } else {
+        optRemark(OPT_REMARK_MISSED, "optimize-on-clauses", fn,
+                  "on statement will run in a new task",
+                  notFastReason);
+      }
+
+      if (removeRmemFences) {
+        optRemark(OPT_REMARK_PASSED, "optimize-on-clauses", fn,
+                  "removed remote cache fences from on statement");
+      }
+    }
+
     if ( (fastFork || removeRmemFences) && fReportOptimizedOn) {
       ModuleSymbol *mod = toModuleSymbol(fn->defPoint->parentSymbol);
       INT_ASSERT(mod);
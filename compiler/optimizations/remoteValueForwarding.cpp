@@ -23,6 +23,7 @@
 #include "astutil.h"
 #include "driver.h"
 #include "expr.h"
+#include "OptRemarks.h"
 #include "resolution.h"
 #include "stlUtil.h"
 #include "stmt.h"
@@ -204,7 +205,8 @@ static bool canForwardValue(Map<Symbol*, Vec<SymExpr*>*>& defMap,
                             Map<Symbol*, Vec<SymExpr*>*>& useMap,
                             Vec<FnSymbol*>&               syncFns,
                             FnSymbol*                     fn,
-                            ArgSymbol*                    arg);
+                            ArgSymbol*                    arg,
+                            const char*&                  reason);
 
 static bool isSufficientlyConst(ArgSymbol* arg);
 
@@ -243,6 +245,39 @@ static bool shouldSerialize(ArgSymbol* arg) {
   return retval;
 }
 
+//
+// Name the construct that the on function 'fn' implements, for the
+// optimization remarks.  Both cobegin and coforall on statements are
+// marked COBEGIN_OR_COFORALL; a coforall's on function is called directly
+// in the body of its loop, while a cobegin's is called in a block.
+//
+static const char* onStatementKind(FnSymbol* fn) {
+  if (fn->hasFlag(FLAG_BEGIN)) {
+    return "begin on statement";
+
+  } else if (fn->hasFlag(FLAG_COBEGIN_OR_COFORALL)) {
+    if (fn->calledBy == NULL) {
+      return "cobegin or coforall on statement";
+    }
+
+    forv_Vec(CallExpr, call, *fn->calledBy) {
+      Expr* block = call->parentExpr;
+
+      while (block != NULL && isBlockStmt(block) == false) {
+        block = block->parentExpr;
+      }
+
+      if (block != NULL && isLoopStmt(block)) {
+        return "coforall on statement";
+      }
+    }
+
+    return "cobegin on statement";
+  }
+
+  return "on statement";
+}
+
 static void updateTaskFunctions(Map<Symbol*, Vec<SymExpr*>*>& defMap,
                                 Map<Symbol*, Vec<SymExpr*>*>& useMap) {
   Vec<FnSymbol*> syncSet;
@@ -256,26 +291,47 @@ static void updateTaskFunctions(Map<Symbol*, Vec<SymExpr*>*>& defMap,
 
       // For each reference arg that is safe to dereference
       for_formals(arg, fn) {
-        if (canForwardValue(defMap, useMap, syncSet, fn, arg)) {
+        const char* reason = NULL;
+
+        if (canForwardValue(defMap, useMap, syncSet, fn, arg, reason)) {
+          if (optRemarksEnabledFor(fn)) {
+            optRemark(OPT_REMARK_PASSED, "remote-value-forwarding", fn,
+                      astr("forwarded the value of '", arg->name,
+                           "' to the ", onStatementKind(fn)));
+          }
+
           if (shouldSerialize(arg)) {
             insertSerialization(fn, arg);
           } else {
             defaultForwarding(useMap, fn, arg);
           }
+
+        } else if (reason != NULL && arg->isRef() &&
+                   optRemarksEnabledFor(fn)) {
+          optRemark(OPT_REMARK_MISSED, "remote-value-forwarding", fn,
+                    astr("did not forward the value of '", arg->name,
+                         "' to the ", onStatementKind(fn)),
+                    reason);
         }
       }
     }
   }
 }
 
+//
+// If the value of an argument can't be forwarded, 'reason' may be set to
+// say why, for the optimization remarks.
+//
 static bool canForwardValue(Map<Symbol*, Vec<SymExpr*>*>& defMap,
                             Map<Symbol*, Vec<SymExpr*>*>& useMap,
                             Vec<FnSymbol*>&               syncFns,
                             FnSymbol*                     fn,
-                            ArgSymbol*                    arg) {
+                            ArgSymbol*                    arg,
+                            const char*&                  reason) {
   bool retval = false;
 
   if (arg->hasFlag(FLAG_NO_RVF)) {
+    reason = "forwarding is disabled for this argument";
     retval = false;
   } else if (arg->getValType()->symbol->hasFlag(FLAG_ALWAYS_RVF)) {
     retval = true;
@@ -303,6 +359,8 @@ static bool canForwardValue(Map<Symbol*, Vec<SymExpr*>*>& defMap,
   // const, then we cannot remote value forward the argument due
   // to the fence implied by the sync var accesses
   } else if (syncFns.set_in(fn) && isSufficientlyConst(arg) == false) {
+    reason = "the on statement accesses sync variables and the argument "
+             "is not const";
     retval = false;
 
   // If this argument is a reference atomic type, we need to preserve
@@ -313,12 +371,14 @@ static bool canForwardValue(Map<Symbol*, Vec<SymExpr*>*>& defMap,
   // See resolveFormals() [functionResolution.cpp:839] for where we decide
   // to convert atomic formals to ref formals.
   } else if (isAtomicType(arg->type)) {
+    reason = "atomic arguments keep reference semantics";
     retval = false;
 
   } else if (arg->isRef()) {
     // can forward if the actual is a QUAL_CONST_VAL or a ref-to-const
     DotInfo* info = dotLocaleMap[arg];
     if (info && info->usesDotLocale) {
+      reason = "the on statement queries the argument's locale";
       retval = false;
     } else if (arg->intent == INTENT_CONST_REF) {
       if (isClass(arg->getValType())) {
@@ -330,8 +390,14 @@ static bool canForwardValue(Map<Symbol*, Vec<SymExpr*>*>& defMap,
         retval = true;
       } else {
         retval = arg->hasFlag(FLAG_REF_TO_IMMUTABLE);
+
+        if (retval == false) {
+          reason = "the referenced value might change during the on "
+                   "statement";
+        }
       }
     } else {
+      reason = "the argument is passed by non-const reference";
       retval = false;
     }
   } else {
@@ -29,6 +29,7 @@
 #include "astutil.h"
 #include "driver.h"
 #include "expr.h"
+#include "OptRemarks.h"
 #include "passes.h"
 #include "stmt.h"
 #include "stringutil.h"
@@ -37,6 +38,9 @@
 
 #include "global-ast-vecs.h"
 
+#include <set>
+#include <vector>
+
 static const bool debugScalarReplacement = false;
 
 // statistics
@@ -573,6 +577,539 @@ debugScalarReplacementFailure(Symbol* var) {
 }
 
 
+/************************************* | **************************************
+*                                                                             *
+* Stack allocation of class instances that do not escape                      *
+*                                                                             *
+* A class instance allocated in a function (e.g. an iterator class after      *
+* _getIterator has been inlined) whose pointer is only used for field         *
+* accesses, comparisons, frees and as arguments to formals that do not let    *
+* it escape is allocated with PRIM_STACK_ALLOCATE_CLASS instead, and its      *
+* frees are removed.  This handles the instances that scalarReplaceClass     *
+* could not, because they are passed to other functions.                      *
+*                                                                             *
+* Whether a formal lets its argument escape is computed for the whole         *
+* program up front, as the least fixed point over the call graph.  This is    *
+* done both for class-typed formals and for ref formals, which may be passed  *
+* a reference to a field of the instance.                                     *
+*                                                                             *
+************************************** | *************************************/
+
+// class-typed formals that might let their argument escape
+static std::set<ArgSymbol*> escapingFormals;
+
+// class-typed formals that are being tracked; any other formal escapes
+static std::set<ArgSymbol*> trackedFormals;
+
+// ref formals that might let the reference escape
+static std::set<ArgSymbol*> escapingRefFormals;
+
+// ref formals that are being tracked; any other ref formal escapes
+static std::set<ArgSymbol*> trackedRefFormals;
+
+static bool formalMayEscape(ArgSymbol* formal) {
+  return trackedFormals.count(formal) == 0 ||
+         escapingFormals.count(formal) != 0;
+}
+
+static bool refFormalMayEscape(ArgSymbol* formal) {
+  return trackedRefFormals.count(formal) == 0 ||
+         escapingRefFormals.count(formal) != 0;
+}
+
+static bool isTaskOrOnFn(FnSymbol* fn) {
+  return isTaskFun(fn)                                  ||
+         fn->hasFlag(FLAG_ON_BLOCK)                     ||
+         fn->hasFlag(FLAG_BEGIN_BLOCK)                  ||
+         fn->hasFlag(FLAG_COBEGIN_OR_COFORALL_BLOCK);
+}
+
+static bool isInScope(Expr* expr, BlockStmt* scope) {
+  for (Expr* e = expr; e != NULL; e = e->parentExpr) {
+    if (e == scope) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Can the pointer be copied into 'lhs' and still be tracked?  The copy
+// must have a single def so that a free through it frees this object.
+static bool isTrackableCopy(Symbol* lhs, FnSymbol* fn, BlockStmt* scope) {
+  int defs = 0;
+
+  if (isVarSymbol(lhs)                  == false ||
+      lhs->isRef()                      == true  ||
+      lhs->defPoint->getFunction()      != fn    ||
+      (scope != NULL && !isInScope(lhs->defPoint, scope))) {
+    return false;
+  }
+
+  for_SymbolDefs(def, lhs) {
+    defs++;
+  }
+
+  return defs == 1;
+}
+
+//
+// Returns true if the reference in 'ref' can't outlive 'fn': it is only
+// read, written through, or passed to ref formals that don't let it
+// escape.  'def' is the move that set 'ref', if it is a local.
+//
+static bool refDoesNotEscape(Symbol* ref, FnSymbol* fn, CallExpr* def) {
+  for_SymbolSymExprs(se, ref) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+
+    if (call == NULL || se->getFunction() != fn) {
+      return false;
+
+    } else if (call == def) {
+      continue;
+
+    } else if (call->isPrimitive(PRIM_DEREF)             ||
+               call->isPrimitive(PRIM_GET_MEMBER_VALUE)) {
+      continue;
+
+    } else if (isMoveOrAssign(call)) {
+      if (call->get(2) == se && call->get(1)->isRef()) {
+        return false;
+      }
+
+    } else if (call->isPrimitive()) {
+      return false;
+
+    } else {
+      FnSymbol* callee = call->resolvedFunction();
+
+      if (callee == NULL                           ||
+          isTaskOrOnFn(callee)                     ||
+          refFormalMayEscape(actual_to_formal(se))) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+//
+// The result of a PRIM_GET_MEMBER is a reference into the object.  It
+// is fine as long as it is moved into a local ref that does not escape.
+//
+static bool isNonEscapingFieldRef(CallExpr* getMember, FnSymbol* fn) {
+  CallExpr* move = toCallExpr(getMember->parentExpr);
+
+  if (move == NULL || move->isPrimitive(PRIM_MOVE) == false) {
+    return false;
+  }
+
+  Symbol* ref = toSymExpr(move->get(1))->symbol();
+
+  if (isVarSymbol(ref) == false || ref->defPoint->getFunction() != fn) {
+    return false;
+  }
+
+  return refDoesNotEscape(ref, fn, move);
+}
+
+//
+// Is 'call' the cast in 'tmp = cast(se); chpl_here_free(tmp)'?  If so,
+// add both statements to 'frees'.
+//
+static bool isFreeOf(CallExpr* call, SymExpr* se,
+                     std::vector<CallExpr*>& frees) {
+  if (!((call->isPrimitive(PRIM_CAST_TO_VOID_STAR) && call->get(1) == se) ||
+        (call->isPrimitive(PRIM_CAST)              && call->get(2) == se &&
+         isCVoidPtr(call->get(1)->qualType().type())))) {
+    return false;
+  }
+
+  CallExpr* move = toCallExpr(call->parentExpr);
+
+  if (move == NULL || move->isPrimitive(PRIM_MOVE) == false) {
+    return false;
+  }
+
+  Symbol*   tmp  = toSymExpr(move->get(1))->symbol();
+  CallExpr* free = toCallExpr(move->next);
+  int       uses = 0;
+
+  if (free                                                == NULL  ||
+      free->isResolved()                                  == false ||
+      !free->resolvedFunction()->hasFlag(FLAG_LOCALE_MODEL_FREE)) {
+    return false;
+  }
+
+  for_SymbolSymExprs(tse, tmp) {
+    if (tse->parentExpr != move && tse->parentExpr != free) {
+      return false;
+    }
+
+    uses++;
+  }
+
+  if (uses != 2) {
+    return false;
+  }
+
+  frees.push_back(move);
+  frees.push_back(free);
+
+  return true;
+}
+
+//
+// Returns true if the object that 'sym' points to can't escape 'fn'
+// through any use of 'sym' or of the local copies it is moved into.  If
+// 'scope' is given, those copies must be declared within it.  Frees of
+// the object are added to 'frees' if it is given, and otherwise count as
+// escapes.
+//
+static bool doesNotEscape(Symbol* sym, FnSymbol* fn, BlockStmt* scope,
+                          std::vector<CallExpr*>* frees) {
+  std::vector<Symbol*> copies;
+  std::set<Symbol*>    seen;
+
+  copies.push_back(sym);
+  seen.insert(sym);
+
+  for (size_t i = 0; i < copies.size(); i++) {
+    for_SymbolSymExprs(se, copies[i]) {
+      CallExpr* call = toCallExpr(se->parentExpr);
+
+      if (call == NULL || se->getFunction() != fn) {
+        return false;
+
+      } else if (isMoveOrAssign(call) && call->get(1) == se) {
+        // a def of the copy; the rhs is checked where it is used
+
+      } else if (isMoveOrAssign(call)) {
+        Symbol* lhs = toSymExpr(call->get(1))->symbol();
+
+        if (isTrackableCopy(lhs, fn, scope) == false) {
+          return false;
+        }
+
+        if (seen.insert(lhs).second) {
+          copies.push_back(lhs);
+        }
+
+      } else if (call->isPrimitive(PRIM_GET_MEMBER)) {
+        if (call->get(1) != se || !isNonEscapingFieldRef(call, fn)) {
+          return false;
+        }
+
+      } else if (call->isPrimitive(PRIM_GET_MEMBER_VALUE) ||
+                 call->isPrimitive(PRIM_SET_MEMBER)       ||
+                 call->isPrimitive(PRIM_SETCID)           ||
+                 call->isPrimitive(PRIM_GETCID)           ||
+                 call->isPrimitive(PRIM_TESTCID)          ||
+                 call->isPrimitive(PRIM_CHECK_NIL)) {
+        if (call->get(1) != se) {
+          return false;
+        }
+
+      } else if (call->isPrimitive(PRIM_EQUAL)            ||
+                 call->isPrimitive(PRIM_NOTEQUAL)) {
+        // comparing the pointer doesn't let it escape
+
+      } else if (call->isPrimitive()) {
+        if (frees == NULL || isFreeOf(call, se, *frees) == false) {
+          return false;
+        }
+
+      } else {
+        FnSymbol* callee = call->resolvedFunction();
+
+        if (callee == NULL                        ||
+            isTaskOrOnFn(callee)                  ||
+            formalMayEscape(actual_to_formal(se))) {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool isTrackableFormal(ArgSymbol* formal, FnSymbol* fn) {
+  AggregateType* at = toAggregateType(formal->type);
+
+  return at                          != NULL  &&
+         at->isClass()               == true  &&
+         formal->isRef()             == false &&
+         fn->hasFlag(FLAG_EXTERN)    == false &&
+         fn->returnsRefOrConstRef()  == false &&
+         isTaskOrOnFn(fn)            == false;
+}
+
+static bool isTrackableRefFormal(ArgSymbol* formal, FnSymbol* fn) {
+  return formal->isRef()             == true  &&
+         fn->hasFlag(FLAG_EXTERN)    == false &&
+         fn->returnsRefOrConstRef()  == false &&
+         isTaskOrOnFn(fn)            == false;
+}
+
+static void computeEscapingFormals() {
+  std::vector<ArgSymbol*> formals;
+  std::vector<ArgSymbol*> refFormals;
+  bool                    changed = true;
+
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (fn->inTree()) {
+      for_formals(formal, fn) {
+        if (isTrackableFormal(formal, fn)) {
+          trackedFormals.insert(formal);
+          formals.push_back(formal);
+
+        } else if (isTrackableRefFormal(formal, fn)) {
+          trackedRefFormals.insert(formal);
+          refFormals.push_back(formal);
+        }
+      }
+    }
+  }
+
+  while (changed) {
+    changed = false;
+
+    for_vector(ArgSymbol, formal, formals) {
+      if (escapingFormals.count(formal) == 0 &&
+          !doesNotEscape(formal, formal->getFunction(), NULL, NULL)) {
+        escapingFormals.insert(formal);
+        changed = true;
+      }
+    }
+
+    for_vector(ArgSymbol, formal, refFormals) {
+      if (escapingRefFormals.count(formal) == 0 &&
+          !refDoesNotEscape(formal, formal->getFunction(), NULL)) {
+        escapingRefFormals.insert(formal);
+        changed = true;
+      }
+    }
+  }
+}
+
+static bool isStackAllocatableType(Type* t) {
+  AggregateType* at = toAggregateType(t);
+
+  if (at                                    == NULL  ||
+      at->isClass()                         == false ||
+      at->symbol->hasFlag(FLAG_EXTERN)      == true  ||
+      at->symbol->hasFlag(FLAG_DATA_CLASS)  == true  ||
+      at->symbol->hasFlag(FLAG_REF)         == true  ||
+      at->symbol->hasFlag(FLAG_WIDE_CLASS)  == true) {
+    return false;
+  }
+
+  // keep large fixed-size buffers off the stack
+  for_fields(field, at) {
+    if (field->type->symbol->hasFlag(FLAG_C_ARRAY)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//
+// Estimated size of an instance of the class 'at', including the fields
+// inherited from its parents, or -1 if it is not known.
+//
+static int64_t estimateInstanceSize(AggregateType* at) {
+  int64_t size = 0;
+
+  for_fields(field, at) {
+    int64_t fieldSize = 0;
+
+    if (field->hasFlag(FLAG_SUPER_CLASS)) {
+      AggregateType* parent = toAggregateType(field->type);
+
+      fieldSize = parent ? estimateInstanceSize(parent) : -1;
+
+    } else if (field->hasFlag(FLAG_PARAM)         == false &&
+               field->hasFlag(FLAG_TYPE_VARIABLE) == false) {
+      fieldSize = field->isRef() ? 8 : estimateTypeSize(field->type);
+    }
+
+    if (fieldSize < 0) {
+      return -1;
+    }
+
+    size += fieldSize;
+  }
+
+  return size;
+}
+
+//
+// Match 'sym = (T) allocTmp' preceded by 'allocTmp = chpl_here_alloc(...)'
+// where these are the only def of 'sym' and the only uses of 'allocTmp'.
+//
+static bool isHeapAllocated(Symbol* sym,
+                            CallExpr*& castMove, CallExpr*& allocMove) {
+  castMove = NULL;
+
+  for_SymbolDefs(def, sym) {
+    if (castMove != NULL) {
+      return false;
+    }
+
+    castMove = toCallExpr(def->parentExpr);
+  }
+
+  if (castMove == NULL || castMove->isPrimitive(PRIM_MOVE) == false) {
+    return false;
+  }
+
+  CallExpr* cast = toCallExpr(castMove->get(2));
+
+  if (cast == NULL || cast->isPrimitive(PRIM_CAST) == false) {
+    return false;
+  }
+
+  SymExpr* allocSe = toSymExpr(cast->get(2));
+
+  allocMove = toCallExpr(castMove->prev);
+
+  if (allocSe == NULL || allocMove == NULL ||
+      allocMove->isPrimitive(PRIM_MOVE) == false ||
+      toSymExpr(allocMove->get(1))->symbol() != allocSe->symbol()) {
+    return false;
+  }
+
+  CallExpr* alloc = toCallExpr(allocMove->get(2));
+
+  if (alloc == NULL || alloc->isResolved() == false ||
+      alloc->resolvedFunction()->hasFlag(FLAG_ALLOCATOR) == false) {
+    return false;
+  }
+
+  for_SymbolSymExprs(se, allocSe->symbol()) {
+    if (se->parentExpr != allocMove && se != allocSe) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void stackAllocate(Symbol* sym, CallExpr* castMove,
+                          CallExpr* allocMove,
+                          std::vector<CallExpr*>& frees) {
+  AggregateType* at       = toAggregateType(sym->type);
+  Symbol*        allocTmp = toSymExpr(allocMove->get(1))->symbol();
+
+  SET_LINENO(castMove);
+
+  castMove->get(2)->replace(new CallExpr(PRIM_STACK_ALLOCATE_CLASS,
+                                         at->symbol));
+  allocMove->remove();
+  allocTmp->defPoint->remove();
+
+  for_vector(CallExpr, free, frees) {
+    free->remove();
+  }
+}
+
+//
+// Record the decision for a heap allocation as an optimization remark.
+// --report-stack-allocation prints the same remarks for user code, or for
+// all code with --devel.
+//
+static void stackAllocationRemark(CallExpr* castMove, Type* t,
+                                  const char* reason) {
+  const char* name = t->symbol->name;
+
+  if (reason == NULL) {
+    optRemark(OPT_REMARK_PASSED, "stack-allocation", castMove,
+              astr("allocated '", name, "' instance on the stack"));
+  } else {
+    optRemark(OPT_REMARK_MISSED, "stack-allocation", castMove,
+              astr("did not stack allocate '", name, "' instance"), reason);
+  }
+
+  if (fReportStackAllocation) {
+    ModuleSymbol* mod = castMove->getModule();
+
+    if (developer || mod->modTag == MOD_USER) {
+      if (reason == NULL) {
+        printf("Stack allocated %s instance at %s:%d\n",
+               name, castMove->fname(), castMove->linenum());
+      } else {
+        printf("Did not stack allocate %s instance at %s:%d: %s\n",
+               name, castMove->fname(), castMove->linenum(), reason);
+      }
+    }
+  }
+}
+
+static void stackAllocateClasses() {
+  std::vector<Symbol*> candidates;
+
+  forv_Vec(VarSymbol, var, gVarSymbols) {
+    if (var->inTree()                          &&
+        var->isRef()               == false    &&
+        isFnSymbol(var->defPoint->parentSymbol) &&
+        isStackAllocatableType(var->type)) {
+      candidates.push_back(var);
+    }
+  }
+
+  if (candidates.empty()) {
+    return;
+  }
+
+  computeEscapingFormals();
+
+  for_vector(Symbol, sym, candidates) {
+    FnSymbol*              fn        = sym->defPoint->getFunction();
+    CallExpr*              castMove  = NULL;
+    CallExpr*              allocMove = NULL;
+    std::vector<CallExpr*> frees;
+
+    if (isHeapAllocated(sym, castMove, allocMove)) {
+      BlockStmt*  scope  = toBlockStmt(castMove->parentExpr);
+      const char* reason = NULL;
+
+      int64_t     size   = estimateInstanceSize(toAggregateType(sym->type));
+
+      if (size < 0) {
+        reason = "the size of the instance is not known";
+
+      } else if (size > stack_allocation_limit) {
+        reason = astr("the instance is larger than ",
+                      istr(stack_allocation_limit), " bytes");
+
+      } else if (fn->returnsRefOrConstRef()) {
+        reason = "the function returns by ref";
+
+      } else if (scope == NULL || sym->defPoint->parentExpr != scope) {
+        reason = "the allocation is not in the block declaring it";
+
+      } else if (doesNotEscape(sym, fn, scope, &frees) == false) {
+        reason = "the instance may escape the function";
+      }
+
+      if (reason == NULL) {
+        stackAllocate(sym, castMove, allocMove, frees);
+      }
+
+      stackAllocationRemark(castMove, sym->type, reason);
+    }
+  }
+
+  escapingFormals.clear();
+  trackedFormals.clear();
+  escapingRefFormals.clear();
+  trackedRefFormals.clear();
+}
+
+
 void
 scalarReplace() {
   if (!fNoScalarReplacement) {
@@ -697,4 +1234,8 @@ scalarReplace() {
       printf("\tReplaced %d of %d classes\n", srClassReplaced, srClass);
     }
   }
+
+  if (!fNoStackAllocation) {
+    stackAllocateClasses();
+  }
 }
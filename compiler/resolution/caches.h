@@ -49,7 +49,7 @@ public:
   SymbolMap map;
 };
 
-typedef Map<FnSymbol*,     Vec<SymbolMapCacheEntry*>*> SymbolMapCache;
+typedef SwissMap<FnSymbol*, Vec<SymbolMapCacheEntry*>*> SymbolMapCache;
 typedef MapElem<FnSymbol*, Vec<SymbolMapCacheEntry*>*> SymbolMapCacheElem;
 
 
@@ -97,7 +97,7 @@ public:
   SymbolMap map;
 };
 
-typedef Map<FnSymbol*,     Vec<SymbolMapScopeCacheEntry*>*> SymbolMapScopeCache;
+typedef SwissMap<FnSymbol*, Vec<SymbolMapScopeCacheEntry*>*> SymbolMapScopeCache;
 typedef MapElem<FnSymbol*, Vec<SymbolMapScopeCacheEntry*>*> SymbolMapScopeCacheElem;
 
 void      addCache(SymbolMapScopeCache& cache,
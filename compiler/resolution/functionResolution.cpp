@@ -1858,7 +1858,7 @@ isDefinedInBlock(BlockStmt* block, FnSymbol* fn) {
 static bool
 isDefinedInUseImport(BlockStmt* block, FnSymbol* fn,
                      bool allowPrivateUseImp, bool forShadowScope,
-                     Vec<BlockStmt*>& visited) {
+                     SwissSet<BlockStmt*>& visited) {
   if (block && block->useList) {
     visited.set_add(block);
 
@@ -1926,7 +1926,8 @@ isDefinedInUseImport(BlockStmt* block, FnSymbol* fn,
 // or if the block was already visited.
 static int
 computeVisibilityDistanceInternal(BlockStmt* block, FnSymbol* fn,
-                                  int distance, Vec<BlockStmt*>& visited) {
+                                  int distance,
+                                  SwissSet<BlockStmt*>& visited) {
   // if the block was already visited, we should have
   // already gathered the distance if it was there at all
   if (visited.set_in(block))
@@ -1976,7 +1977,7 @@ static int computeVisibilityDistance(Expr* expr, FnSymbol* fn) {
   //
   // call helper function with visited set to avoid infinite recursion
   //
-  Vec<BlockStmt*> visited;
+  SwissSet<BlockStmt*> visited;
   BlockStmt* block = toBlockStmt(expr);
   if (!block)
     block = getParentBlock(expr);
@@ -1988,7 +1989,8 @@ static int computeVisibilityDistance(Expr* expr, FnSymbol* fn) {
 
 static MoreVisibleResult
 isMoreVisibleInternal(BlockStmt* block, FnSymbol* fn1, FnSymbol* fn2,
-                      Vec<BlockStmt*>& visited1, Vec<BlockStmt*>& visited2) {
+                      SwissSet<BlockStmt*>& visited1,
+                      SwissSet<BlockStmt*>& visited2) {
 
   if (visited1.set_in(block) && visited2.set_in(block))
     return FOUND_NEITHER;
@@ -2060,8 +2062,8 @@ isMoreVisible(Expr* expr, FnSymbol* fn1, FnSymbol* fn2) {
   //
   // call helper function with visited set to avoid infinite recursion
   //
-  Vec<BlockStmt*> visited1;
-  Vec<BlockStmt*> visited2;
+  SwissSet<BlockStmt*> visited1;
+  SwissSet<BlockStmt*> visited2;
   BlockStmt* block = toBlockStmt(expr);
   if (!block)
     block = getParentBlock(expr);
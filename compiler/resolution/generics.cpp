@@ -25,6 +25,7 @@
 #include "chpl.h"
 #include "driver.h"
 #include "expr.h"
+#include "FnProfiler.h"
 #include "PartialCopyData.h"
 #include "passes.h"
 #include "resolveFunction.h"
@@ -333,6 +334,8 @@ FnSymbol* instantiateWithoutCall(FnSymbol* fn, SymbolMap& subs) {
  */
 void instantiateBody(FnSymbol* fn) {
   if (getPartialCopyData(fn) != NULL) {
+    FnProfileScope profile("instantiateBody", fn);
+
     fn->finalizeCopy();
   }
 }
@@ -395,6 +398,8 @@ FnSymbol* instantiateSignature(FnSymbol*  fn,
     } else {
       SET_LINENO(fn);
 
+      FnProfileScope profile("instantiate", fn);
+
       // copy generic class type if this function is a type constructor
       SymbolMap map;
       FnSymbol* newFn = NULL;
@@ -24,9 +24,11 @@
 #include "driver.h"
 #include "errorHandling.h"
 #include "expr.h"
+#include "FnProfiler.h"
 #include "ForallStmt.h"
 #include "ForLoop.h"
 #include "iterator.h"
+#include "OptRemarks.h"
 #include "optimizations.h"
 #include "passes.h"
 #include "resolution.h"
@@ -327,6 +329,21 @@ static bool isCallVectorHazard(CallExpr* call,
   return hazard;
 }
 
+// Describe why a loop is not vectorized, for the optimization remarks.
+// 'call' is the hazard the VectorHazardVisitor found, if it found one.
+static const char* vectorHazardReason(bool callHazard, CallExpr* call) {
+  FnSymbol* fn = call != NULL ? call->resolvedFunction() : NULL;
+
+  if (callHazard == false)
+    return "uses a reduction that is not vectorized";
+  else if (fn != NULL)
+    return astr("calls synchronizing function ", fn->name);
+  else if (call != NULL && call->isPrimitive(PRIM_VIRTUAL_METHOD_CALL))
+    return "calls a virtual function";
+  else
+    return "may synchronize";
+}
+
 static void markVectorizableForallLoops()
 {
   std::map<FnSymbol*, bool> fnHasVectorHazard;
@@ -355,6 +372,12 @@ static void markVectorizableForallLoops()
         hazard = v.hazard;
         loop->setHasVectorizationHazard(hazard);
 
+        if (hazard && optRemarksEnabledFor(loop)) {
+          optRemark(OPT_REMARK_MISSED, "vectorize", loop,
+                    "loop will not be hinted for vectorization",
+                    vectorHazardReason(v.hazard, v.reason));
+        }
+
         bool report = false;
         if (fReportVectorizedLoops) {
           ModuleSymbol *mod = toModuleSymbol(loop->getModule());
@@ -421,6 +444,12 @@ static void markVectorizableForallLoops()
     }
     forall->setHasVectorizationHazard(hazard);
 
+    if (hazard && optRemarksEnabledFor(forall)) {
+      optRemark(OPT_REMARK_MISSED, "vectorize", forall,
+                "forall will not be hinted for vectorization",
+                vectorHazardReason(v.hazard, v.reason));
+    }
+
     bool report = false;
     if (fReportVectorizedLoops) {
       ModuleSymbol *mod = toModuleSymbol(forall->getModule());
@@ -1529,8 +1558,8 @@ static void markLoopProperties(ForLoop* forLoop, BlockStmt* ibody,
 }
 
 // Returns true if the given ForLoop was handled (converted and removed from
-// the tree); false otherwise.
-static bool expandIteratorInline(ForLoop* forLoop)
+// the tree); false otherwise, with 'reason' describing why.
+static bool expandIteratorInline(ForLoop* forLoop, const char*& reason)
 {
   Symbol*   ic       = forLoop->iteratorGet()->symbol();
   FnSymbol* iterator = getTheIteratorFn(ic);
@@ -1556,14 +1585,18 @@ static bool expandIteratorInline(ForLoop* forLoop)
     // to be handled in the recursive iterator function
     //
     if (forLoop->parentSymbol->hasFlag(FLAG_RECURSIVE_ITERATOR)) {
+      reason = "recursive iterator used within a recursive iterator";
       return false;
     // vass: ditto for task functions called from recursive iterators
     } else if (taskFunInRecursiveIteratorSet.set_in(forLoop->parentSymbol)) {
+      reason = "recursive iterator used within a task function of a "
+               "recursive iterator";
       return false;
     } else if (containsYield(forLoop)) {
       // Inlining a recursive iterator into a loop with a 'yield' pushes
       // that 'yield' into one of _rec_ functions, where it dangles. Ex.:
       // test/library/standard/FileSystem/filerator/bradc/findfiles-par.chpl
+      reason = "recursive iterator used in a loop that yields";
       return false;
     } else {
       expandRecursiveIteratorInline(forLoop);
@@ -2269,14 +2302,46 @@ countYieldsInFn(FnSymbol* fn)
   return count;
 }
 
-// Returns true if the iterator can be inlined; false otherwise.
+// Returns true if the iterator can be inlined into forLoop; false otherwise.
 //
 // Iterators can be inlined if they contains between 1 and
-// inline_iter_yield_limit yield statements
+// inline_iter_yield_limit yield statements.  Inlining copies the body of
+// the loop once per yield, so an iterator with more yields is still
+// inlined when the estimated growth (yields * loop body size) is within
+// inline_iter_cost_limit.
 static bool
-canInlineIterator(FnSymbol* iterator) {
+canInlineIterator(FnSymbol* iterator, ForLoop* forLoop, const char*& reason) {
   int count = countYieldsInFn(iterator);
-  return count <= inline_iter_yield_limit;
+
+  if (count <= inline_iter_yield_limit)
+    return true;
+
+  std::vector<BaseAST*> asts;
+  collect_asts(forLoop, asts);
+
+  long cost = (long) count * (long) asts.size();
+
+  if (cost <= inline_iter_cost_limit)
+    return true;
+
+  char buf[256];
+  snprintf(buf, sizeof(buf),
+           "iterator has %d yields (limit %d) and an estimated cost of %ld "
+           "(limit %d)",
+           count, inline_iter_yield_limit, cost, inline_iter_cost_limit);
+  reason = astr(buf);
+  return false;
+}
+
+static void
+reportNonInlinedIterator(ForLoop* forLoop, FnSymbol* iterFn,
+                         const char* reason) {
+  ModuleSymbol* mod = forLoop->getModule();
+
+  if (developer || mod->modTag == MOD_USER) {
+    printf("Iterator (%s) not inlined into loop at %s:%d: %s\n",
+           iterFn->name, forLoop->fname(), forLoop->linenum(), reason);
+  }
 }
 
 static void
@@ -2419,16 +2484,28 @@ expandForLoop(ForLoop* forLoop) {
   SymExpr*   se2      = forLoop->iteratorGet();
   VarSymbol* iterator = toVarSymbol(se2->symbol());
   bool converted = false;
+  const char* reason = NULL;
 
   if (!fNoInlineIterators)
   {
     FnSymbol* iterFn = getTheIteratorFn(iterator->type);
-    if (iterFn->iteratorInfo                          &&
-        !iterator->type->symbol->hasFlag(FLAG_TUPLE)  &&
-        canInlineIterator(iterFn)                     &&
-        ! isVirtualIterator(iterFn)                   ) {
-      converted = expandIteratorInline(forLoop);
+    if (iterFn->iteratorInfo == NULL) {
+      reason = "iterator has no iterator class information";
+    } else if (iterator->type->symbol->hasFlag(FLAG_TUPLE)) {
+      reason = "zippered iteration";
+    } else if (isVirtualIterator(iterFn)) {
+      reason = "iterator is dynamically dispatched";
+    } else if (canInlineIterator(iterFn, forLoop, reason)) {
+      converted = expandIteratorInline(forLoop, reason);
     }
+  } else {
+    reason = "iterator inlining is disabled";
+  }
+
+  if (! converted && fReportNonInlinedIterators) {
+    INT_ASSERT(reason != NULL);
+    reportNonInlinedIterator(forLoop, getTheIteratorFn(iterator->type),
+                             reason);
   }
 
   if (! converted)
@@ -2649,7 +2726,8 @@ inlineIterators() {
         // However, all ForLoops that remain in the tree after the call to
         // inlineIterators() are passed through expandForLoop() which *does*
         // replace them.
-        expandIteratorInline(forLoop);
+        const char* reason = NULL;
+        expandIteratorInline(forLoop, reason);
       }
     }
   }
@@ -3084,6 +3162,8 @@ void lowerIterators() {
 
   for_alive_in_Vec(FnSymbol, fn, gFnSymbols) {
     if (fn->isIterator()) {
+      FnProfileScope profile("lowerIterators", fn);
+
       // This collapseBlocks call is required for lowerIterator to inline
       // advance() into zip[1-4]
       fn->collapseBlocks();
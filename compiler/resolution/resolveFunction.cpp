@@ -29,6 +29,7 @@
 #include "DeferStmt.h"
 #include "driver.h"
 #include "expr.h"
+#include "FnProfiler.h"
 #include "ForLoop.h"
 #include "ForallStmt.h"
 #include "IfExpr.h"
@@ -530,6 +531,8 @@ void resolveFunction(FnSymbol* fn, CallExpr* forCall) {
       gdbShouldBreakHere();
     }
 
+    FnProfileScope profile("resolve", fn);
+
     fn->addFlag(FLAG_RESOLVED);
 
     fn->tagIfGeneric();
@@ -64,13 +64,13 @@ typedef std::pair<bool, std::vector<FnSymbol*> > ReexportEntry;
 
 class VisibleFunctionBlock {
 public:
-                                        VisibleFunctionBlock();
+                                          VisibleFunctionBlock();
 
-  Map<const char*, Vec<FnSymbol*>*>     visibleFunctions;
-  std::map<const char*, ReexportEntry>  reexports;
+  SwissMap<const char*, Vec<FnSymbol*>*>  visibleFunctions;
+  std::map<const char*, ReexportEntry>    reexports;
 };
 
-static Map<BlockStmt*, VisibleFunctionBlock*> visibleFunctionMap;
+static SwissMap<BlockStmt*, VisibleFunctionBlock*> visibleFunctionMap;
 
 static int                                    nVisibleFunctions       = 0;
 
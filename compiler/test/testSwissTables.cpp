@@ -0,0 +1,349 @@
+/*
+ * Copyright 2021-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// always check assertions in the tests
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include "map.h"
+#include "vec.h"
+
+#include <cassert>
+#include <vector>
+
+// Tests SwissSet (vec.h) and SwissMap (map.h).
+
+typedef SwissSet<intptr_t> IntSet;
+typedef SwissMap<intptr_t, intptr_t> IntMap;
+
+// Keys that are not consecutive, so that they spread over the index.
+static intptr_t key(int i) {
+  return (intptr_t)(i + 1) * 4099;
+}
+
+// Check that s holds exactly key(k) for k in ks, in that order.
+static void checkSet(IntSet& s, const std::vector<int>& ks) {
+  assert(s.n == (int)ks.size());
+  int i = 0;
+  for (intptr_t x : s)
+    assert(x == key(ks[i++]));
+  for (int k : ks) {
+    intptr_t* p = s.set_in(key(k));
+    assert(p && *p == key(k));
+  }
+}
+
+// Check that m maps key(k) to -k for k in ks, in that order.
+static void checkMap(IntMap& m, const std::vector<int>& ks) {
+  assert(m.n == (int)ks.size());
+  int i = 0;
+  for (auto& elt : m) {
+    assert(elt.key == key(ks[i]));
+    assert(elt.value == -ks[i]);
+    i++;
+  }
+  for (int k : ks) {
+    assert(m.get(key(k)) == -k);
+    assert(m.get_record(key(k))->key == key(k));
+  }
+}
+
+static std::vector<int> range(int lo, int hi) {
+  std::vector<int> ret;
+  for (int i = lo; i < hi; i++)
+    ret.push_back(i);
+  return ret;
+}
+
+// Insertion order is kept while the set grows from its inline storage,
+// past SWISS_LINEAR_SIZE, and through several rebuilds of the index.
+static void test1() {
+  IntSet s;
+  std::vector<int> ks;
+
+  assert(s.n == 0);
+  assert(!s.set_in(key(0)));
+
+  for (int i = 0; i < 1000; i++) {
+    assert(s.set_add(key(i)));
+    ks.push_back(i);
+    if (i < 4 * SWISS_LINEAR_SIZE || i % 97 == 0)
+      checkSet(s, ks);
+  }
+  checkSet(s, ks);
+
+  // adding an element again does nothing
+  for (int i = 0; i < 1000; i += 7)
+    assert(!s.set_add(key(i)));
+  checkSet(s, ks);
+
+  for (int i = 1000; i < 1100; i++)
+    assert(!s.set_in(key(i)));
+
+  // set_union adds only the new elements, at the end
+  IntSet t;
+  for (int i = 990; i < 1010; i++)
+    t.set_add(key(i));
+  assert(s.set_union(t));
+  assert(!s.set_union(t));
+  checkSet(s, range(0, 1010));
+}
+
+// del keeps the order of the other elements, and the set still works
+// as it shrinks below SWISS_LINEAR_SIZE and grows again.
+static void test2() {
+  IntSet s;
+  std::vector<int> ks = range(0, 100);
+
+  for (int k : ks)
+    s.set_add(key(k));
+
+  assert(!s.del(key(100)));
+
+  // from the middle, the front, and the end
+  assert(s.del(key(50)));
+  assert(s.del(key(0)));
+  assert(s.del(key(99)));
+  assert(!s.del(key(50)));
+  ks.erase(ks.begin() + 99);
+  ks.erase(ks.begin() + 50);
+  ks.erase(ks.begin());
+  checkSet(s, ks);
+  assert(!s.set_in(key(0)));
+  assert(!s.set_in(key(50)));
+  assert(!s.set_in(key(99)));
+
+  // a removed element can be added back, at the end
+  assert(s.set_add(key(50)));
+  ks.push_back(50);
+  checkSet(s, ks);
+
+  while (ks.size() > 2) {
+    assert(s.del(key(ks[ks.size() / 2])));
+    ks.erase(ks.begin() + ks.size() / 2);
+    checkSet(s, ks);
+  }
+
+  for (int i = 200; i < 300; i++) {
+    s.set_add(key(i));
+    ks.push_back(i);
+  }
+  checkSet(s, ks);
+}
+
+// Copies are independent of the original, whether small or large.
+static void test3() {
+  for (int size : {0, 1, 4, SWISS_LINEAR_SIZE, SWISS_LINEAR_SIZE + 1, 100}) {
+    IntSet s;
+    for (int i = 0; i < size; i++)
+      s.set_add(key(i));
+
+    IntSet c(s);
+    IntSet a;
+    a.set_add(key(5000));
+    a = s;
+    checkSet(c, range(0, size));
+    checkSet(a, range(0, size));
+
+    c.set_add(key(size));
+    a.del(key(0));
+    checkSet(s, range(0, size));
+    checkSet(c, range(0, size + 1));
+    if (size > 0)
+      checkSet(a, range(1, size));
+
+    IntSet& self = s;
+    s = self;
+    checkSet(s, range(0, size));
+  }
+}
+
+// clear() empties the set, which can then be reused.
+static void test4() {
+  IntSet s;
+  for (int i = 0; i < 100; i++)
+    s.set_add(key(i));
+  s.clear();
+  assert(s.n == 0);
+  assert(s.begin() == s.end());
+  for (int i = 0; i < 100; i++)
+    assert(!s.set_in(key(i)));
+
+  for (int i = 100; i > 0; i--)
+    s.set_add(key(i));
+  std::vector<int> ks;
+  for (int i = 100; i > 0; i--)
+    ks.push_back(i);
+  checkSet(s, ks);
+}
+
+// Keys stay in the order they were first put, and put on an existing
+// key changes its value without moving it.
+static void test5() {
+  IntMap m;
+  std::vector<int> ks;
+
+  assert(m.get(key(0)) == 0);
+  assert(!m.get_record(key(0)));
+
+  for (int i = 0; i < 1000; i++) {
+    MapElem<intptr_t, intptr_t>* x = m.put(key(i), -i);
+    assert(x->key == key(i) && x->value == -i);
+    ks.push_back(i);
+    if (i < 4 * SWISS_LINEAR_SIZE || i % 97 == 0)
+      checkMap(m, ks);
+  }
+
+  for (int i = 0; i < 1000; i += 3)
+    m.put(key(i), 1);
+  assert(m.n == 1000);
+  for (int i = 0; i < 1000; i++) {
+    assert(m.v[i].key == key(i));
+    assert(m.get(key(i)) == (i % 3 == 0 ? 1 : -i));
+    m.put(key(i), -i);
+  }
+  checkMap(m, ks);
+
+  Vec<intptr_t> keys;
+  Vec<intptr_t> values;
+  m.get_keys(keys);
+  m.get_values(values);
+  assert(keys.n == 1000 && values.n == 1000);
+  for (int i = 0; i < 1000; i++) {
+    assert(keys.v[i] == key(i));
+    assert(values.v[i] == -i);
+  }
+
+  IntMap other;
+  for (int i = 990; i < 1010; i++)
+    other.put(key(i), -i);
+  m.map_union(other);
+  checkMap(m, range(0, 1010));
+}
+
+// del, copy, and clear on a map.
+static void test6() {
+  IntMap m;
+  std::vector<int> ks = range(0, 100);
+  for (int k : ks)
+    m.put(key(k), -k);
+
+  assert(!m.del(key(100)));
+  assert(m.del(key(50)));
+  assert(m.del(key(0)));
+  assert(m.del(key(99)));
+  assert(!m.del(key(99)));
+  ks.erase(ks.begin() + 99);
+  ks.erase(ks.begin() + 50);
+  ks.erase(ks.begin());
+  checkMap(m, ks);
+  assert(!m.get_record(key(50)));
+
+  while (ks.size() > 2) {
+    assert(m.del(key(ks[1])));
+    ks.erase(ks.begin() + 1);
+    checkMap(m, ks);
+  }
+  m.put(key(0), 0);
+  ks.push_back(0);
+  checkMap(m, ks);
+
+  for (int size : {0, 1, 4, SWISS_LINEAR_SIZE, SWISS_LINEAR_SIZE + 1, 100}) {
+    IntMap s;
+    for (int i = 0; i < size; i++)
+      s.put(key(i), -i);
+
+    IntMap c(s);
+    IntMap a;
+    a.put(key(5000), 1);
+    a = s;
+    checkMap(c, range(0, size));
+    checkMap(a, range(0, size));
+    c.put(key(size), -size);
+    a.put(key(0), 12);
+    checkMap(s, range(0, size));
+    checkMap(c, range(0, size + 1));
+  }
+
+  m.clear();
+  assert(m.n == 0);
+  assert(!m.get_record(key(1)));
+  for (int i = 0; i < 20; i++)
+    m.put(key(i), -i);
+  checkMap(m, range(0, 20));
+}
+
+// move takes the entries, and the index if there is one, and leaves the
+// source empty and usable.
+static void test7() {
+  for (int size : {0, 1, 4, SWISS_LINEAR_SIZE, SWISS_LINEAR_SIZE + 1, 100}) {
+    IntMap src;
+    for (int i = 0; i < size; i++)
+      src.put(key(i), -i);
+
+    IntMap dst;
+    for (int i = 0; i < 50; i++)
+      dst.put(key(5000 + i), 1);
+    dst.move(src);
+
+    checkMap(dst, range(0, size));
+    assert(!dst.get_record(key(5000)));
+    assert(src.n == 0);
+    assert(!src.get_record(key(0)));
+
+    for (int i = 0; i < 10; i++)
+      src.put(key(i), -i);
+    checkMap(src, range(0, 10));
+
+    dst.put(key(size), -size);
+    checkMap(dst, range(0, size + 1));
+  }
+}
+
+// Pointer keys, as in SymbolMap.
+static void test8() {
+  static int objs[200];
+  SwissMap<int*, int*> m;
+  SwissSet<int*> s;
+
+  for (int i = 199; i >= 0; i--) {
+    m.put(&objs[i], &objs[199 - i]);
+    s.set_add(&objs[i]);
+  }
+  for (int i = 0; i < 200; i++) {
+    assert(m.v[i].key == &objs[199 - i]);
+    assert(m.get(&objs[i]) == &objs[199 - i]);
+    assert(s.v[i] == &objs[199 - i]);
+    assert(s.set_in(&objs[i]));
+  }
+}
+
+int main() {
+  test1();
+  test2();
+  test3();
+  test4();
+  test5();
+  test6();
+  test7();
+  test8();
+
+  return 0;
+}
@@ -27,7 +27,12 @@
 #include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
 #include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -43,7 +48,8 @@ class ErrorBase;
 namespace detail {
 
 /**
-  Helper type that represents a string and a length.
+  Helper type that represents a string and a length, along with
+  the hash of the string (so that it is computed only once per lookup).
   An alternative strategy for storing null bytes in unique'd strings
   would be to store the length before the allocation -- but
   then we'd have to allocate such a special buffer in order to query it.
@@ -51,18 +57,25 @@ namespace detail {
 struct StringAndLength {
   const char* str;
   size_t len;
+  size_t hash;
+
+  static StringAndLength build(const char* str, size_t len) {
+    return {str, len, chpl::hash(str, len)};
+  }
 };
 
 struct UniqueStrEqual final {
   bool operator()(StringAndLength lhs, StringAndLength rhs) const {
-    if (lhs.len != rhs.len) return false;
+    if (lhs.hash != rhs.hash || lhs.len != rhs.len) return false;
     return 0 == memcmp(lhs.str, rhs.str, lhs.len);
   }
 };
 
+// This is noexcept and cheap, so the table does not need to
+// store another copy of the hash in each node.
 struct UniqueStrHash final {
-  size_t operator()(StringAndLength key) const {
-    return chpl::hash(key.str, key.len);
+  size_t operator()(StringAndLength key) const noexcept {
+    return key.hash;
   }
 };
 
@@ -85,6 +98,76 @@ struct QueryTimingStat {
   }
 };
 
+struct QueryMemoryStat {
+  // Estimated bytes held by the results currently stored
+  size_t bytes = 0;
+  // Number of results removed by garbage collection or eviction
+  size_t evicted = 0;
+};
+
+// Estimate the heap memory owned by a query result, not counting
+// sizeof(T) itself. This is only an estimate used for the memory budget
+// and the query report; types without a specialization count as 0.
+template<typename T> struct resultHeapBytes {
+  size_t operator()(const T& v) const { return 0; }
+};
+template<typename T> static inline size_t estimateHeapBytes(const T& v) {
+  return resultHeapBytes<T>()(v);
+}
+template<> struct resultHeapBytes<std::string> {
+  size_t operator()(const std::string& v) const {
+    // short strings are stored within the std::string itself
+    const char* data = v.data();
+    bool inPlace = data >= (const char*) &v && data < (const char*) (&v + 1);
+    return inPlace ? 0 : v.capacity() + 1;
+  }
+};
+template<typename T> struct resultHeapBytes<owned<T>> {
+  size_t operator()(const owned<T>& v) const {
+    return v ? sizeof(T) + estimateHeapBytes(*v) : 0;
+  }
+};
+template<typename A, typename B> struct resultHeapBytes<std::pair<A, B>> {
+  size_t operator()(const std::pair<A, B>& v) const {
+    return estimateHeapBytes(v.first) + estimateHeapBytes(v.second);
+  }
+};
+template<typename T> struct resultHeapBytes<std::vector<T>> {
+  size_t operator()(const std::vector<T>& v) const {
+    size_t ret = v.capacity() * sizeof(T);
+    for (const auto& elt : v) ret += estimateHeapBytes(elt);
+    return ret;
+  }
+};
+// node-based containers: count the node, a next pointer and a bucket
+template<typename C> static inline size_t estimateNodeContainerBytes(const C& v) {
+  size_t ret = v.size() * (sizeof(typename C::value_type) + 2*sizeof(void*));
+  for (const auto& elt : v) ret += estimateHeapBytes(elt);
+  return ret;
+}
+template<typename K, typename V> struct resultHeapBytes<std::map<K, V>> {
+  size_t operator()(const std::map<K, V>& v) const {
+    return estimateNodeContainerBytes(v);
+  }
+};
+template<typename K> struct resultHeapBytes<std::set<K>> {
+  size_t operator()(const std::set<K>& v) const {
+    return estimateNodeContainerBytes(v);
+  }
+};
+template<typename K, typename V, typename H, typename E>
+struct resultHeapBytes<std::unordered_map<K, V, H, E>> {
+  size_t operator()(const std::unordered_map<K, V, H, E>& v) const {
+    return estimateNodeContainerBytes(v);
+  }
+};
+template<typename K, typename H, typename E>
+struct resultHeapBytes<std::unordered_set<K, H, E>> {
+  size_t operator()(const std::unordered_set<K, H, E>& v) const {
+    return estimateNodeContainerBytes(v);
+  }
+};
+
 // forward declare some types
 class QueryMapResultBase;
 template<typename ResultType, typename... ArgTs> class QueryMapResult;
@@ -260,6 +343,10 @@ class QueryMapResultBase {
   mutable bool emittedErrors = false;
   mutable QueryErrorVec errors;
 
+  // Estimated memory used by this entry, as last computed by
+  // updateMemoryEstimate (counted in the parent map's memory stat)
+  mutable size_t memoryBytes = 0;
+
   QueryMapBase* parentQueryMap;
 
   QueryMapResultBase(RevisionNumber lastChecked,
@@ -269,6 +356,10 @@ class QueryMapResultBase {
   virtual ~QueryMapResultBase() = 0; // this is an abstract base class
   virtual void recompute(Context* context) const = 0;
   virtual void markUniqueStringsInResult(Context* context) const = 0;
+  virtual size_t computeMemoryEstimate() const = 0;
+
+  // recompute memoryBytes and update the parent map's total
+  void updateMemoryEstimate() const;
 };
 
 template<typename ResultType, typename... ArgTs>
@@ -298,6 +389,13 @@ class QueryMapResult final : public QueryMapResultBase {
   }
   void recompute(Context* context) const override;
   void markUniqueStringsInResult(Context* context) const override;
+  size_t computeMemoryEstimate() const override {
+    return sizeof(*this) +
+           estimateHeapBytes(tupleOfArgs) +
+           estimateHeapBytes(result) +
+           dependencies.capacity() * sizeof(QueryDependency) +
+           errors.capacity() * sizeof(QueryErrorVec::value_type);
+  }
 };
 
 class QueryMapBase {
@@ -321,11 +419,29 @@ class QueryMapBase {
     // Other per-query timings can be added here as needed
   } timings;
 
+  QueryMemoryStat memory;
+
    QueryMapBase(const char* queryName, bool isInputQuery)
      : queryName(queryName), isInputQuery(isInputQuery) {
    }
    virtual ~QueryMapBase() = 0; // this is an abstract base class
    virtual void clearOldResults(RevisionNumber currentRevisionNumber) = 0;
+   // Remove results that were last checked before 'oldestRevisionToKeep'
+   virtual void removeResultsCheckedBefore(RevisionNumber oldestRevisionToKeep) = 0;
+   // Remove old results that were replaced in 'revision' or earlier
+   virtual void removeOldResultsReplacedBy(RevisionNumber revision) = 0;
+   // Returns the earliest revision in which a result still in the map
+   // was last checked, or 'ifNone' if the map is empty
+   virtual RevisionNumber oldestLastChecked(RevisionNumber ifNone) const = 0;
+   // Add the estimated memory of each result to 'bytesByRevision',
+   // keyed by the revision in which the result was last checked.
+   // An old result is counted in the revision before it was replaced,
+   // the last one whose results might still refer to it.
+   virtual void
+   addMemoryByRevision(std::map<RevisionNumber, size_t>& bytesByRevision)
+     const = 0;
+   virtual size_t numResults() const = 0;
+   virtual size_t numOldResults() const = 0;
 };
 
 template<typename ResultType,
@@ -343,7 +459,13 @@ class QueryMap final : public QueryMapBase {
   MapType map;
   // old results stores replaced results long enough for dependent
   // queries to compare with them.
-  std::vector<ResultType> oldResults;
+  struct OldResult {
+    // the revision in which the result was replaced
+    RevisionNumber replaced;
+    size_t memoryBytes;
+    ResultType result;
+  };
+  std::deque<OldResult> oldResults;
   // the function to recompute the query.
   QueryFunctionType queryFunction;
 
@@ -355,21 +477,68 @@ class QueryMap final : public QueryMapBase {
   ~QueryMap() = default;
 
   void clearOldResults(RevisionNumber currentRevisionNumber) override {
+    removeResultsCheckedBefore(currentRevisionNumber);
+    removeOldResultsReplacedBy(currentRevisionNumber);
+  }
+
+  void saveOldResult(RevisionNumber replaced, ResultType&& result) {
+    size_t bytes = sizeof(OldResult) + estimateHeapBytes(result);
+    memory.bytes += bytes;
+    oldResults.push_back(OldResult{replaced, bytes, std::move(result)});
+  }
+
+  void removeOldResultsReplacedBy(RevisionNumber revision) override {
+    // results are saved in revision order. Pop them one at a time since
+    // some result types (e.g. BuilderResult) can't be assigned, which
+    // erase would need.
+    while (!oldResults.empty() && oldResults.front().replaced <= revision) {
+      memory.bytes -= oldResults.front().memoryBytes;
+      oldResults.pop_front();
+    }
+  }
+
+  RevisionNumber oldestLastChecked(RevisionNumber ifNone) const override {
+    RevisionNumber ret = ifNone;
+    for (const TheResultType& result : map) {
+      if (result.lastChecked < ret) ret = result.lastChecked;
+    }
+    return ret;
+  }
+
+  void removeResultsCheckedBefore(RevisionNumber oldestRevisionToKeep) override {
     // Performance: Would it be better to move everything to a new map
     // rather than modify it in place as is done here?
     auto iter = map.begin();
     while (iter != map.end()) {
       const TheResultType& result = *iter;
-      if (result.lastChecked == currentRevisionNumber) {
+      if (result.lastChecked >= oldestRevisionToKeep) {
         // Keep the result
         ++iter;
       } else {
         // Remove the result
+        memory.bytes -= result.memoryBytes;
+        memory.evicted++;
         iter = map.erase(iter);
       }
     }
+  }
+
+  void addMemoryByRevision(std::map<RevisionNumber, size_t>& bytesByRevision)
+    const override {
+    for (const TheResultType& result : map) {
+      bytesByRevision[result.lastChecked] += result.memoryBytes;
+    }
+    for (const OldResult& old : oldResults) {
+      bytesByRevision[old.replaced - 1] += old.memoryBytes;
+    }
+  }
+
+  size_t numResults() const override {
+    return map.size();
+  }
 
-    oldResults.clear();
+  size_t numOldResults() const override {
+    return oldResults.size();
   }
 };
 
@@ -324,6 +324,9 @@ class Context {
   querydetail::RevisionNumber lastPrepareToGCRevisionNumber = 0;
   querydetail::RevisionNumber gcCounter = 1;
 
+  // approximate limit on memory used by query results; 0 means no limit
+  size_t queryMemoryBudget_ = 0;
+
   // --------- end all Context fields ---------
 
   void setupGlobalStrings();
@@ -437,6 +440,10 @@ class Context {
 
   void doNotCollectUniqueCString(const char *s);
 
+  querydetail::RevisionNumber
+  oldestRevisionToKeepForBudget(querydetail::RevisionNumber limit) const;
+  void removeResultsCheckedBefore(querydetail::RevisionNumber revision);
+
   // Future Work: make the context thread-safe
 
   // Future Work: allow moving some AST to a different context
@@ -738,6 +745,44 @@ class Context {
    */
   void advanceToNextRevision(bool prepareToGC);
 
+  /**
+    Set an approximate limit, in bytes, on the memory used by saved query
+    results that collectGarbage keeps. Instead of removing every result not
+    checked in the current revision, collectGarbage then only evicts the
+    results that were last checked in the oldest revisions, until the
+    estimated total is within the limit. An evicted result is simply
+    recomputed if it is needed again.
+
+    Results are only evicted a whole revision at a time, so that a result
+    is never kept while something it depends on is evicted. Replaced
+    results, which are kept while older results might still refer to
+    them, count toward the budget as well.
+
+    Results are only ever evicted by collectGarbage, never by
+    advanceToNextRevision, so pointers into results (such as AST nodes)
+    stay valid until the caller chooses to collect garbage.
+
+    A budget of 0 (the default) turns this off, and collectGarbage removes
+    every result not checked in the current revision.
+   */
+  void setQueryMemoryBudget(size_t bytes) {
+    queryMemoryBudget_ = bytes;
+  }
+
+  /** Returns the limit set by setQueryMemoryBudget */
+  size_t queryMemoryBudget() const {
+    return queryMemoryBudget_;
+  }
+
+  /** Returns the estimated memory, in bytes, used by saved query results */
+  size_t queryMemoryUsage() const;
+
+  /**
+    Returns the number of saved query results, including replaced results
+    that are kept so that dependent queries can compare with them
+   */
+  size_t numSavedQueryResults() const;
+
   /**
     Returns the number of query bodies executed in this revision.
    */
@@ -749,6 +794,11 @@ class Context {
     This function runs garbage collection. It will collect UniqueStrings
     if the last call to advanceToNextRevision passed prepareToGC=true.
 
+    Query results that were not checked in the current revision are
+    removed. However, if a query memory budget is set and UniqueStrings
+    are not being collected, such results are kept as long as they fit
+    within the budget.
+
     It is an implementation error to call this function while a query
     is running.
    */
@@ -948,7 +998,8 @@ class Context {
 
 
   /**
-     Output a timing report of the cumulative time each query spent
+     Output a timing report of the cumulative time each query spent,
+     along with the estimated memory used by each query's saved results
    */
   void queryTimingReport(std::ostream& os);
 
@@ -221,8 +221,8 @@ class ID final {
 
   size_t hash() const {
     (void)numChildIds_; // this field is intentionally not hashed
-    std::hash<int> hasher;
-    return hash_combine(symbolPath_.hash(), hasher(postOrderId_));
+    // the symbol path's hash is cached, so this is just one mix
+    return hash_combine(symbolPath_.hash(), (size_t) postOrderId_);
   }
 
   void swap(ID& other) {
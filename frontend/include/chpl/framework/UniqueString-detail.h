@@ -25,6 +25,7 @@
 #ifndef CHPL_QUERIES_UNIQUE_STRING_DETAIL_H
 #define CHPL_QUERIES_UNIQUE_STRING_DETAIL_H
 
+#include "chpl/util/hash.h"
 #include "chpl/util/memory.h"
 #include "chpl/util/string-escapes.h"
 #include "chpl/framework/stringify-functions.h"
@@ -209,6 +210,19 @@ struct InlinedString {
     return false;
   }
 
+  // Returns a hash of the string contents. Inline strings hash their
+  // data directly; strings in the Context's table store a precomputed
+  // hash just before the string data (see Context::setupStringMetadata).
+  size_t hash() const {
+    if (isInline()) {
+      return hash_int((uintptr_t) this->v);
+    }
+
+    uint64_t h;
+    memcpy(&h, this->v - sizeof(h), sizeof(h));
+    return (size_t) h;
+  }
+
   // mark the string as used this revision (so it is not GC'd)
   void mark(Context* context) const;
 };
@@ -272,8 +286,7 @@ struct PODUniqueString {
     return !(*this == other);
   }
   size_t hash() const {
-    std::hash<size_t> hasher;
-    return hasher((size_t) i.v);
+    return i.hash();
   }
   void mark(Context* context) const {
     i.mark(context);
@@ -291,8 +291,7 @@ class UniqueString final {
     return strcmp(this->c_str(), other);
   }
   size_t hash() const {
-    std::hash<size_t> hasher;
-    return hasher((size_t) s.i.v);
+    return s.i.hash();
   }
   void swap(UniqueString& other) {
     UniqueString oldThis = *this;
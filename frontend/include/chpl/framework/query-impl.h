@@ -427,7 +427,7 @@ Context::updateResultForQueryMapR(QueryMap<ResultType, ArgTs...>* queryMap,
   if (initialResult || changed==false) {
     // no need to save old result
   } else {
-    queryMap->oldResults.push_back(std::move(result));
+    queryMap->saveOldResult(currentRevision, std::move(result));
   }
 
   r->emittedErrors = errorCollectionStack.empty();
@@ -435,6 +435,7 @@ Context::updateResultForQueryMapR(QueryMap<ResultType, ArgTs...>* queryMap,
   if (changed || initialResult) {
     r->lastChanged  = currentRevision;
   }
+  r->updateMemoryEstimate();
   return r;
 }
 
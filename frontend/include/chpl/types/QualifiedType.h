@@ -210,15 +210,12 @@ class QualifiedType final {
     std::swap(this->param_, other.param_);
   }
   size_t hash() const {
-    size_t h1 = (size_t) kind_;
-    size_t h2 = chpl::hash(type_);
-    size_t h3 = chpl::hash(param_);
-
-    size_t ret = 0;
-    ret = hash_combine(ret, h1);
-    ret = hash_combine(ret, h2);
-    ret = hash_combine(ret, h3);
-    return ret;
+    // Types and Params are unique'd, so their addresses can be hashed.
+    // Kind has few values, so pack it in below the Param pointer
+    // (whose top bits are unused) to save a combine.
+    size_t h1 = (size_t) type_;
+    size_t h2 = (((size_t) param_) << 8) ^ (size_t) kind_;
+    return hash_combine(h1, h2);
   }
   static bool update(QualifiedType& keep, QualifiedType& addin);
   void mark(Context* context) const;
@@ -22,6 +22,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <set>
 #include <string>
@@ -31,39 +32,133 @@
 
 namespace chpl {
 
+namespace detail {
+
+// These helpers implement a word-at-a-time string hash following the
+// design of wyhash (https://github.com/wangyi-fudan/wyhash, public domain).
+// It reads 8 bytes at a time and mixes with a single 64x64->128 multiply,
+// which is much faster than a byte-at-a-time hash for identifiers and paths.
+
+constexpr uint64_t hashSecret0 = 0xa0761d6478bd642full;
+constexpr uint64_t hashSecret1 = 0xe7037ed1a0b428dbull;
+constexpr uint64_t hashSecret2 = 0x8ebc6af09c88c6e3ull;
+constexpr uint64_t hashSecret3 = 0x589965cc75374cc3ull;
+
+// multiply to 128 bits and return the two halves in a and b
+inline void hashMum(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t r = (__uint128_t) a * b;
+  a = (uint64_t) r;
+  b = (uint64_t) (r >> 64);
+#else
+  uint64_t ha = a >> 32, hb = b >> 32;
+  uint64_t la = (uint32_t) a, lb = (uint32_t) b;
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32);
+  uint64_t c = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  a = lo;
+  b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+// multiply to 128 bits and fold the halves together
+inline uint64_t hashMix(uint64_t a, uint64_t b) {
+  hashMum(a, b);
+  return a ^ b;
+}
+
+// the read functions use memcpy since the data need not be aligned
+inline uint64_t hashRead8(const unsigned char* p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t hashRead4(const unsigned char* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t hashBytes(const void* key, size_t len) {
+  const unsigned char* p = (const unsigned char*) key;
+  uint64_t seed = hashMix(hashSecret0, hashSecret1);
+  uint64_t a, b;
+  if (len <= 16) {
+    if (len >= 4) {
+      // read the first and last 4 bytes along with 4 bytes from
+      // the middle (the reads overlap for shorter strings)
+      size_t mid = (len >> 3) << 2;
+      a = (hashRead4(p) << 32) | hashRead4(p + mid);
+      b = (hashRead4(p + len - 4) << 32) | hashRead4(p + len - 4 - mid);
+    } else if (len > 0) {
+      a = ((uint64_t) p[0] << 16) | ((uint64_t) p[len >> 1] << 8) | p[len - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = len;
+    if (i > 48) {
+      uint64_t seed1 = seed, seed2 = seed;
+      do {
+        seed = hashMix(hashRead8(p) ^ hashSecret1, hashRead8(p + 8) ^ seed);
+        seed1 = hashMix(hashRead8(p + 16) ^ hashSecret2,
+                        hashRead8(p + 24) ^ seed1);
+        seed2 = hashMix(hashRead8(p + 32) ^ hashSecret3,
+                        hashRead8(p + 40) ^ seed2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= seed1 ^ seed2;
+    }
+    while (i > 16) {
+      seed = hashMix(hashRead8(p) ^ hashSecret1, hashRead8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = hashRead8(p + i - 16);
+    b = hashRead8(p + i - 8);
+  }
+  a ^= hashSecret1;
+  b ^= seed;
+  hashMum(a, b);
+  return hashMix(a ^ hashSecret0 ^ len, b ^ hashSecret1);
+}
+
+} // end namespace detail
+
 // Combine two hash functions
 inline size_t hash_combine(size_t hash, size_t other) {
-  return hash ^ (other + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+  // This is not symmetric, so the order of the combined hashes matters
+  return (size_t) detail::hashMix(hash ^ detail::hashSecret0,
+                                  other ^ detail::hashSecret1);
 }
 
-constexpr uint64_t FNV_offset_basis = 0xcbf29ce484222325;
-constexpr uint64_t FNV_prime        = 0x100000001b3;
+// Hash function for an integer value (such as a pointer) that might not
+// have well-distributed low-order bits
+inline size_t hash_int(uint64_t x) {
+  return (size_t) detail::hashMix(x ^ detail::hashSecret0, detail::hashSecret1);
+}
 
-// FNV-1a hash function for null-terminated C strings
+// Hash function for null-terminated C strings
 inline size_t hash(const char* s)
 {
-  uint64_t seed = FNV_offset_basis;
-  for(char c; (c = *s) != '\0'; ++s)
-    seed = (seed ^ static_cast<unsigned char>(c)) * FNV_prime;
-  return (size_t) seed;
+  return (size_t) detail::hashBytes(s, strlen(s));
 }
 
-// FNV-1a hash function for strings with length
+// Hash function for strings with length
 inline size_t hash(const char* s, size_t len)
 {
-  uint64_t seed = FNV_offset_basis;
-  for(size_t i = 0; i < len; i++)
-    seed = (seed ^ static_cast<unsigned char>(s[i])) * FNV_prime;
-  return (size_t) seed;
+  return (size_t) detail::hashBytes(s, len);
 }
 
-// FNV-1a hash function for C++ std::string
+// Hash function for C++ std::string
 inline size_t hash(const std::string& s)
 {
-  uint64_t seed = FNV_offset_basis;
-  for(char c : s)
-    seed = (seed ^ static_cast<unsigned char>(c)) * FNV_prime;
-  return (size_t) seed;
+  return (size_t) detail::hashBytes(s.data(), s.size());
 }
 
 // Default hash function for one argument
@@ -108,6 +108,7 @@ void Context::swap(Context& other) {
   std::swap(queryTimingTraceOutput, other.queryTimingTraceOutput);
   std::swap(lastPrepareToGCRevisionNumber, other.lastPrepareToGCRevisionNumber);
   std::swap(gcCounter, other.gcCounter);
+  std::swap(queryMemoryBudget_, other.queryMemoryBudget_);
 }
 
 Context::Context() {
@@ -279,10 +280,13 @@ void Context::defaultReportError(Context* context, const ErrorBase* err) {
   }
 }
 
-// unique'd strings are preceded by 4 bytes of length, gcMark and doNotCollectMark
+// unique'd strings are preceded by 4 bytes of length, gcMark,
+// doNotCollectMark and then 8 bytes of hash (just before the string data,
+// where InlinedString::hash can find it)
 // this number must be even
-#define UNIQUED_STRING_METADATA_BYTES 6
+#define UNIQUED_STRING_METADATA_BYTES 14
 #define UNIQUED_STRING_METADATA_LEN 4
+#define UNIQUED_STRING_METADATA_HASH 8
 
 Context::~Context() {
   // free all the unique'd strings
@@ -328,15 +332,21 @@ static char* allocateEvenAligned(size_t amt) {
 // room for len and then a null terminator.
 // Assumes that buf is allocated with even alignment
 // Returns the pointer to where to copy the string and null terminator.
+// The hash is stored separately with setStringHash once the string
+// has been copied.
 char* Context::setupStringMetadata(char* buf, size_t len) {
   char gcMark = this->gcCounter & 0xff;
 
   CHPL_ASSERT(len <= INT32_MAX);
 
   int32_t len32 = len;
+  uint64_t hash64 = 0;
   // these assert should fail if the below code needs to change
-  static_assert(sizeof(len32) + 2 == UNIQUED_STRING_METADATA_BYTES, "Size mismatch");
+  static_assert(sizeof(len32) + 2 + sizeof(hash64) ==
+                UNIQUED_STRING_METADATA_BYTES, "Size mismatch");
   static_assert(sizeof(len32) == UNIQUED_STRING_METADATA_LEN, "Size mismatch");
+  static_assert(sizeof(hash64) == UNIQUED_STRING_METADATA_HASH,
+                "Size mismatch");
 
   // copy the length
   memcpy(buf, &len32, sizeof(len32));
@@ -347,12 +357,19 @@ char* Context::setupStringMetadata(char* buf, size_t len) {
   // set the doNotCollectMark
   *buf = 0;
   buf++;
+  // leave room for the hash
+  buf += sizeof(hash64);
   return buf;
 }
 
+static void setStringHash(char* s, size_t hash) {
+  uint64_t hash64 = hash;
+  memcpy(s - UNIQUED_STRING_METADATA_HASH, &hash64, sizeof(hash64));
+}
+
 // allocates new storage for the string if it was not found
 const char* Context::getOrCreateUniqueString(const char* str, size_t len) {
-  chpl::detail::StringAndLength key = {str, len};
+  auto key = chpl::detail::StringAndLength::build(str, len);
   auto search = this->uniqueStringsTable.find(key);
   if (search != this->uniqueStringsTable.end()) {
     const char* ret = search->str;
@@ -369,8 +386,9 @@ const char* Context::getOrCreateUniqueString(const char* str, size_t len) {
   memcpy(s, str, len);
   // null terminate
   s[len] = 0x0;
+  setStringHash(s, key.hash);
   // Add it to the table
-  chpl::detail::StringAndLength ret = {s, len};
+  chpl::detail::StringAndLength ret = {s, len, key.hash};
   this->uniqueStringsTable.insert(search, ret);
   return s;
 }
@@ -445,7 +463,7 @@ const char* Context::uniqueCStringConcatLen(const char* s1, size_t len1,
   s[len] = '\0';
 
   // Check for it in the table
-  chpl::detail::StringAndLength key = {s, len};
+  auto key = chpl::detail::StringAndLength::build(s, len);
   auto search = this->uniqueStringsTable.find(key);
   if (search != this->uniqueStringsTable.end()) {
     const char* ret = search->str;
@@ -456,8 +474,8 @@ const char* Context::uniqueCStringConcatLen(const char* s1, size_t len1,
   }
 
   // Add it to the table
-  chpl::detail::StringAndLength ret = {s, len};
-  this->uniqueStringsTable.insert(search, ret);
+  setStringHash(s, key.hash);
+  this->uniqueStringsTable.insert(search, key);
   return s;
 }
 
@@ -715,6 +733,74 @@ void Context::registerLibraryForModule(ID moduleId,
   setFilePathForModuleId(moduleId, filePath);
 }
 
+size_t Context::queryMemoryUsage() const {
+  size_t total = 0;
+  for (auto& dbEntry: queryDB) {
+    total += dbEntry.second->memory.bytes;
+  }
+  return total;
+}
+
+size_t Context::numSavedQueryResults() const {
+  size_t total = 0;
+  for (auto& dbEntry: queryDB) {
+    total += dbEntry.second->numResults() + dbEntry.second->numOldResults();
+  }
+  return total;
+}
+
+// Returns the oldest revision whose results should be kept in order to
+// get within the query memory budget, evicting whole revisions (starting
+// with the oldest) but never revision 'limit' or later.
+//
+// Evicting by revision keeps the dependency graph consistent: when a
+// result is checked, its dependencies are checked in the same revision,
+// so they are never checked in an earlier revision than the result itself.
+// The same goes for results whose arguments are pointers owned by other
+// results.
+RevisionNumber
+Context::oldestRevisionToKeepForBudget(RevisionNumber limit) const {
+  RevisionNumber keep = 0;
+  if (queryMemoryBudget_ == 0) return keep;
+
+  std::map<RevisionNumber, size_t> bytesByRevision;
+  size_t total = 0;
+  for (auto& dbEntry: queryDB) {
+    const QueryMapBase* queryMapBase = dbEntry.second.get();
+    queryMapBase->addMemoryByRevision(bytesByRevision);
+    total += queryMapBase->memory.bytes;
+  }
+
+  for (auto& pair : bytesByRevision) {
+    if (total <= queryMemoryBudget_ || pair.first >= limit) break;
+    total -= pair.second;
+    keep = pair.first + 1;
+  }
+
+  return keep;
+}
+
+void Context::removeResultsCheckedBefore(RevisionNumber revision) {
+  if (enableDebugTrace) {
+    printf("%i EVICTING QUERY RESULTS LAST CHECKED BEFORE %i\n",
+           queryTraceDepth, (int) revision);
+  }
+
+  // warning: this loop proceeds in a nondeterministic order
+  RevisionNumber oldestChecked = this->currentRevisionNumber;
+  for (auto& dbEntry: queryDB) {
+    dbEntry.second->removeResultsCheckedBefore(revision);
+    oldestChecked = dbEntry.second->oldestLastChecked(oldestChecked);
+  }
+
+  // A replaced result can only be referred to by results that were last
+  // checked before it was replaced. Once there are none of those left,
+  // it can go.
+  for (auto& dbEntry: queryDB) {
+    dbEntry.second->removeOldResultsReplacedBy(oldestChecked);
+  }
+}
+
 void Context::advanceToNextRevision(bool prepareToGC) {
   this->currentRevisionNumber++;
   this->numQueriesRunThisRevision_ = 0;
@@ -749,11 +835,27 @@ void Context::collectGarbage() {
     printf("%i COLLECTING GARBAGE\n", queryTraceDepth);
   }
 
-  // clear out the saved old results
-  // warning: this loop proceeds in a nondeterministic order
-  for (auto& dbEntry: queryDB) {
-    QueryMapBase* queryMapBase = dbEntry.second.get();
-    queryMapBase->clearOldResults(this->currentRevisionNumber);
+  // Results not checked in this revision did not mark their UniqueStrings,
+  // so they have to go if UniqueStrings are being collected. Otherwise,
+  // with a memory budget, keep as many of them as fit.
+  RevisionNumber keep = this->currentRevisionNumber;
+  if (queryMemoryBudget_ != 0 &&
+      this->lastPrepareToGCRevisionNumber != this->currentRevisionNumber) {
+    keep = oldestRevisionToKeepForBudget(this->currentRevisionNumber);
+  }
+
+  if (keep < this->currentRevisionNumber) {
+    // Some results from earlier revisions remain and might refer to
+    // replaced results, so only the replaced results that none of them
+    // can refer to are cleared.
+    removeResultsCheckedBefore(keep);
+  } else {
+    // clear out the saved old results
+    // warning: this loop proceeds in a nondeterministic order
+    for (auto& dbEntry: queryDB) {
+      QueryMapBase* queryMapBase = dbEntry.second.get();
+      queryMapBase->clearOldResults(this->currentRevisionNumber);
+    }
   }
 
   if (this->lastPrepareToGCRevisionNumber == this->currentRevisionNumber) {
@@ -1148,7 +1250,8 @@ void Context::queryTimingReport(std::ostream& os) {
   os << std::setw(w1) << "name"  << std::setw(w2) << "query (ms)"
      << std::setw(w2) << "calls" << std::setw(w2) << "getMap (ms)"
      << std::setw(w2) << "calls" << std::setw(w2) << "getResult (ms)"
-     << std::setw(w2) << "calls" << "\n";
+     << std::setw(w2) << "calls" << std::setw(w2) << "results"
+     << std::setw(w2) << "memory (KiB)" << std::setw(w2) << "evicted" << "\n";
 
   for (const auto& it : queryDB) {
     QueryMapBase* base = it.second.get();
@@ -1163,8 +1266,18 @@ void Context::queryTimingReport(std::ostream& os) {
        << std::setw(w2) << timings.systemGetMap.count
       // getResult
        << std::setw(w2) << elapsed(timings.systemGetResult.elapsed)
-       << std::setw(w2) << base->timings.systemGetResult.count << "\n";
+       << std::setw(w2) << base->timings.systemGetResult.count
+      // memory
+       << std::setw(w2) << base->numResults()
+       << std::setw(w2) << base->memory.bytes / 1024
+       << std::setw(w2) << base->memory.evicted << "\n";
     }
+
+  os << "total query result memory (KiB): " << queryMemoryUsage() / 1024;
+  if (queryMemoryBudget_ != 0) {
+    os << " of " << queryMemoryBudget_ / 1024 << " budgeted";
+  }
+  os << "\n";
 }
 
 // TODO should these be ifdef'd away if !QUERY_TIMING_ENABLED? Or just warn?
@@ -1200,6 +1313,13 @@ QueryMapResultBase::QueryMapResultBase(RevisionNumber lastChecked,
 QueryMapResultBase::~QueryMapResultBase() {
 }
 
+void QueryMapResultBase::updateMemoryEstimate() const {
+  size_t bytes = computeMemoryEstimate();
+  parentQueryMap->memory.bytes += bytes;
+  parentQueryMap->memory.bytes -= memoryBytes;
+  memoryBytes = bytes;
+}
+
 QueryMapBase::~QueryMapBase() {
 }
 
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2021-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test-common.h"
+
+#include "chpl/framework/Context.h"
+#include "chpl/framework/ID.h"
+#include "chpl/framework/UniqueString.h"
+#include "chpl/framework/query-impl.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace chpl;
+
+// This is a micro-benchmark for the hashing and lookups done by the
+// Context: UniqueString creation and query map lookups with ID
+// arguments. Run it with --timing to print the throughput.
+
+static int nQueryRuns = 0;
+
+static const int& idQuery(Context* context, ID id) {
+  QUERY_BEGIN(idQuery, context, id);
+
+  int result = id.postOrderId() + (int) id.symbolPath().length();
+  nQueryRuns++;
+
+  return QUERY_END(result);
+}
+
+static std::vector<std::string> makeNames(int n) {
+  std::vector<std::string> ret;
+  for (int i = 0; i < n; i++) {
+    // a mix of short (inlined) and longer names
+    if (i % 4 == 0) {
+      ret.push_back("x" + std::to_string(i));
+    } else {
+      ret.push_back("SomeModule.someFunction" + std::to_string(i) +
+                    ".localVariable");
+    }
+  }
+  return ret;
+}
+
+static void testHashes() {
+  Context ctx;
+  Context* context = &ctx;
+
+  // equal strings have equal hashes, and the hash of a string in the
+  // Context's table matches hashing its contents
+  auto names = makeNames(1000);
+  std::unordered_set<size_t> hashes;
+  for (const auto& name : names) {
+    auto a = UniqueString::get(context, name);
+    auto b = UniqueString::get(context, name.c_str(), name.size());
+    auto c = UniqueString::getConcat(context, name.substr(0, 1).c_str(),
+                                     name.substr(1).c_str());
+    assert(a.hash() == b.hash());
+    assert(a.hash() == c.hash());
+    if (name.size() > 6) {
+      assert(a.hash() == chpl::hash(name));
+    }
+    hashes.insert(a.hash());
+
+    auto id1 = ID(a, 3, 0);
+    auto id2 = ID(b, 3, 5); // numChildIds is not hashed
+    auto id3 = ID(a, 4, 0);
+    assert(id1.hash() == id2.hash());
+    assert(id1.hash() != id3.hash());
+  }
+  assert(hashes.size() == names.size());
+
+  // strings with inner null bytes are stored in the table
+  std::string withNull("ab\0cd", 5);
+  auto n1 = UniqueString::get(context, withNull.c_str(), withNull.size());
+  auto n2 = UniqueString::get(context, withNull.c_str(), withNull.size());
+  assert(n1 == n2);
+  assert(n1.hash() == n2.hash());
+  assert(n1.hash() == chpl::hash(withNull));
+
+  // hashing is done in chunks, so check lengths around the boundaries
+  std::unordered_set<size_t> lenHashes;
+  std::string s;
+  for (int i = 0; i < 100; i++) {
+    lenHashes.insert(chpl::hash(s));
+    s += 'a';
+  }
+  assert(lenHashes.size() == 100);
+}
+
+static void testPerformance(bool printTiming) {
+  Context ctx;
+  Context* context = &ctx;
+
+  int nNames = 20000;
+  int nRepeat = 20;
+  auto names = makeNames(nNames);
+
+  context->advanceToNextRevision(false);
+
+  // UniqueString lookups
+  auto start = std::chrono::steady_clock::now();
+  std::vector<ID> ids;
+  for (int r = 0; r < nRepeat; r++) {
+    for (int i = 0; i < nNames; i++) {
+      auto path = UniqueString::get(context, names[i]);
+      if (r == 0) ids.push_back(ID(path, i % 50, 0));
+    }
+  }
+  auto mid1 = std::chrono::steady_clock::now();
+
+  // query map lookups within a revision
+  long total = 0;
+  for (int r = 0; r < nRepeat; r++) {
+    for (const auto& id : ids) {
+      total += idQuery(context, id);
+    }
+  }
+  auto mid2 = std::chrono::steady_clock::now();
+  assert(nQueryRuns == nNames);
+
+  // query map lookups when checking results in a new revision
+  context->advanceToNextRevision(false);
+  for (int r = 0; r < nRepeat; r++) {
+    for (const auto& id : ids) {
+      total += idQuery(context, id);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  assert(nQueryRuns == nNames);
+  assert(total > 0);
+
+  if (printTiming) {
+    double nLookups = (double) nNames * nRepeat;
+    std::chrono::duration<double> strings = mid1 - start;
+    std::chrono::duration<double> queries = mid2 - mid1;
+    std::chrono::duration<double> revision = end - mid2;
+    std::cout << "UniqueString lookups per second: "
+              << nLookups / strings.count() << "\n";
+    std::cout << "query lookups per second: "
+              << nLookups / queries.count() << "\n";
+    std::cout << "query lookups per second in a new revision: "
+              << nLookups / revision.count() << "\n";
+  }
+}
+
+int main(int argc, char** argv) {
+  std::string timingArg = "--timing";
+  bool printTiming = false;
+  for (int i = 1; i < argc; i++) {
+    if (argv[i] == timingArg)
+      printTiming = true;
+  }
+
+  testHashes();
+  testPerformance(printTiming);
+
+  return 0;
+}
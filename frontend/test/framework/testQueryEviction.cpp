@@ -0,0 +1,302 @@
+/*
+ * Copyright 2021-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test-common.h"
+
+#include "chpl/framework/Context.h"
+#include "chpl/framework/query-impl.h"
+
+#include <cstdlib>
+#include <sstream>
+
+using namespace chpl;
+
+// This test uses global variables so that the queries
+// have side effects. That's not allowed in the framework
+// and if this test becomes problematic then it should be updated.
+int nInputQueryRuns = 0;
+int nQueryOneRuns = 0;
+int nQueryTwoRuns = 0;
+
+static const std::string& inputQuery(Context* context, int key) {
+  QUERY_BEGIN_INPUT(inputQuery, context, key);
+
+  std::string result = "input " + std::to_string(key);
+  nInputQueryRuns++;
+
+  return QUERY_END(result);
+}
+static const std::string& queryOne(Context* context, int key) {
+  QUERY_BEGIN(queryOne, context, key);
+
+  // make the result big enough to dominate the memory estimate
+  std::string result = inputQuery(context, key) + std::string(4096, 'x');
+  nQueryOneRuns++;
+
+  return QUERY_END(result);
+}
+static const std::vector<std::string>& queryTwo(Context* context, int key) {
+  QUERY_BEGIN(queryTwo, context, key);
+
+  std::vector<std::string> result;
+  result.push_back(queryOne(context, key));
+  nQueryTwoRuns++;
+
+  return QUERY_END(result);
+}
+
+// The versioned queries' results change in every revision where
+// inputVersion does, so each revision replaces them.
+int inputVersion = 0;
+int nVersionedQueryRuns = 0;
+
+static const std::string& versionedInput(Context* context, int key) {
+  QUERY_BEGIN_INPUT(versionedInput, context, key);
+
+  std::string result = "input " + std::to_string(key) +
+                       " version " + std::to_string(inputVersion);
+
+  return QUERY_END(result);
+}
+static const std::string& versionedQuery(Context* context, int key) {
+  QUERY_BEGIN(versionedQuery, context, key);
+
+  std::string result = versionedInput(context, key) + std::string(1024, 'x');
+  nVersionedQueryRuns++;
+
+  return QUERY_END(result);
+}
+
+static void resetCounts() {
+  nInputQueryRuns = 0;
+  nQueryOneRuns = 0;
+  nQueryTwoRuns = 0;
+}
+
+static void test1() {
+  printf("test1\n");
+  // without a budget, results are kept across revisions
+  // until collectGarbage removes the ones not checked.
+  Context ctx;
+  Context* context = &ctx;
+  resetCounts();
+
+  context->advanceToNextRevision(false);
+  for (int i = 0; i < 10; i++) queryTwo(context, i);
+  assert(nQueryTwoRuns == 10);
+  size_t tenResults = context->queryMemoryUsage();
+  assert(tenResults >= 2 * 10 * 4096);
+
+  context->advanceToNextRevision(false);
+  assert(context->queryMemoryUsage() == tenResults);
+  queryTwo(context, 0);
+  context->collectGarbage();
+  assert(context->queryMemoryUsage() < tenResults / 5);
+
+  // the collected results are recomputed when needed
+  context->advanceToNextRevision(false);
+  queryTwo(context, 0);
+  queryTwo(context, 1);
+  assert(nQueryOneRuns == 11);
+  assert(nQueryTwoRuns == 11);
+}
+
+static void test2() {
+  printf("test2\n");
+  // with a budget, collectGarbage evicts the results that were
+  // checked in the oldest revisions, and advancing the revision
+  // never evicts anything
+  Context ctx;
+  Context* context = &ctx;
+  resetCounts();
+
+  context->advanceToNextRevision(false);
+  for (int i = 0; i < 10; i++) queryTwo(context, i);
+  size_t tenResults = context->queryMemoryUsage();
+
+  // revision 2 checks only the first two keys
+  context->advanceToNextRevision(false);
+  queryTwo(context, 0);
+  queryTwo(context, 1);
+  assert(nQueryTwoRuns == 10);
+
+  // a budget that fits everything evicts nothing
+  context->setQueryMemoryBudget(2 * tenResults);
+  context->collectGarbage();
+  assert(context->queryMemoryUsage() == tenResults);
+
+  // advancing over the budget does not evict
+  context->setQueryMemoryBudget(tenResults / 2);
+  context->advanceToNextRevision(false);
+  assert(context->queryMemoryUsage() == tenResults);
+
+  // with room for about half of the results, everything only checked
+  // in revision 1 goes, but the results from revision 2 are kept
+  context->collectGarbage();
+  assert(context->queryMemoryUsage() <= tenResults / 2);
+  assert(context->queryMemoryUsage() >= tenResults / 10);
+
+  resetCounts();
+  queryTwo(context, 0);
+  queryTwo(context, 1);
+  assert(nInputQueryRuns == 2);
+  assert(nQueryOneRuns == 0);
+  assert(nQueryTwoRuns == 0);
+  queryTwo(context, 5);
+  assert(nQueryOneRuns == 1);
+  assert(nQueryTwoRuns == 1);
+
+  // the per-query memory is included in the report
+  std::ostringstream ss;
+  context->queryTimingReport(ss);
+  assert(ss.str().find("memory (KiB)") != std::string::npos);
+  assert(ss.str().find("queryTwo") != std::string::npos);
+}
+
+static void test3() {
+  printf("test3\n");
+  // with a budget, collectGarbage keeps results from earlier
+  // revisions unless UniqueStrings are being collected
+  Context ctx;
+  Context* context = &ctx;
+  resetCounts();
+
+  context->setQueryMemoryBudget(1024 * 1024);
+  context->advanceToNextRevision(false);
+  for (int i = 0; i < 10; i++) queryTwo(context, i);
+  size_t tenResults = context->queryMemoryUsage();
+
+  context->advanceToNextRevision(false);
+  queryTwo(context, 0);
+  context->collectGarbage();
+  assert(context->queryMemoryUsage() == tenResults);
+
+  context->advanceToNextRevision(true);
+  queryTwo(context, 0);
+  context->collectGarbage();
+  assert(context->queryMemoryUsage() < tenResults / 5);
+}
+
+static void test4() {
+  printf("test4\n");
+  // with a budget, replaced results don't pile up across
+  // collectGarbage calls when the same results are checked
+  // in every revision
+  Context ctx;
+  Context* context = &ctx;
+  inputVersion = 0;
+
+  context->setQueryMemoryBudget(1024 * 1024);
+  for (int rev = 0; rev < 50; rev++) {
+    inputVersion++;
+    context->advanceToNextRevision(false);
+    for (int i = 0; i < 10; i++) versionedQuery(context, i);
+    // 10 inputs and 10 results, plus the ones they replaced this revision
+    assert(context->numSavedQueryResults() <= 40);
+    context->collectGarbage();
+    assert(context->numSavedQueryResults() == 20);
+  }
+}
+
+static void test5() {
+  printf("test5\n");
+  // with a budget, a result that is never checked again keeps the
+  // replaced results alive only until its revision is evicted, so the
+  // query DB stays bounded across revisions
+  Context ctx;
+  Context* context = &ctx;
+  inputVersion = 0;
+  nVersionedQueryRuns = 0;
+
+  context->advanceToNextRevision(false);
+  for (int i = 0; i < 10; i++) versionedQuery(context, i);
+  versionedQuery(context, 100);
+  size_t firstRevision = context->queryMemoryUsage();
+  size_t budget = 3 * firstRevision;
+  context->setQueryMemoryBudget(budget);
+
+  size_t maxSaved = 0;
+  for (int rev = 0; rev < 50; rev++) {
+    inputVersion++;
+    context->advanceToNextRevision(false);
+    for (int i = 0; i < 10; i++) versionedQuery(context, i);
+    if (context->numSavedQueryResults() > maxSaved) {
+      maxSaved = context->numSavedQueryResults();
+    }
+    context->collectGarbage();
+    assert(context->queryMemoryUsage() <= budget);
+  }
+  // a few revisions' worth at most, not 50
+  assert(maxSaved <= 120);
+
+  // the result only checked in the first revision was evicted
+  nVersionedQueryRuns = 0;
+  versionedQuery(context, 100);
+  assert(nVersionedQueryRuns == 1);
+}
+
+static void test6() {
+  printf("test6\n");
+  // a pointer into a saved result stays valid while revisions
+  // advance past the budget, and across collectGarbage as long as
+  // the result is checked in the current revision
+  Context ctx;
+  Context* context = &ctx;
+  resetCounts();
+
+  context->advanceToNextRevision(false);
+  const std::string* kept = &queryOne(context, 7);
+  const std::string* stale = &queryOne(context, 8);
+  std::string keptCopy = *kept;
+  std::string staleCopy = *stale;
+  for (int i = 0; i < 10; i++) queryTwo(context, i);
+  context->setQueryMemoryBudget(1);
+
+  for (int rev = 0; rev < 5; rev++) {
+    context->advanceToNextRevision(false);
+    for (int i = 10; i < 20; i++) queryTwo(context, i);
+    assert(*kept == keptCopy);
+    assert(*stale == staleCopy);
+  }
+
+  // the result is reused rather than recomputed, so it is not moved
+  resetCounts();
+  assert(&queryOne(context, 7) == kept);
+  assert(nQueryOneRuns == 0);
+
+  size_t beforeGC = context->queryMemoryUsage();
+  context->collectGarbage();
+  assert(*kept == keptCopy);
+
+  // the results not checked in this revision were evicted
+  assert(context->queryMemoryUsage() < beforeGC);
+  queryOne(context, 8);
+  assert(nQueryOneRuns == 1);
+}
+
+int main() {
+  test1();
+  test2();
+  test3();
+  test4();
+  test5();
+  test6();
+
+  return 0;
+}
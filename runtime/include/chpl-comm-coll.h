@@ -0,0 +1,119 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_comm_coll_h_
+#define _chpl_comm_coll_h_
+
+#ifndef LAUNCHER
+
+#include <stddef.h>
+#include <stdint.h>
+#include "chpltypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Runtime collectives.
+//
+// These are built only on chpl_comm_put() and chpl_comm_get(), so they
+// work the same way over every comm layer.  Every one of them is
+// collective: all locales must call it, from exactly one task per
+// locale, and all locales must call the collectives in the same order.
+// While waiting they yield, so they can be called from Chapel tasks.
+// The first collective call sets up the collectives on every locale, so
+// programs that never use them pay nothing at startup.
+//
+// When there are several locales per node and they are numbered
+// consecutively within each node (as the launchers arrange), the
+// collectives work within each node first and only the node leaders
+// (local rank 0) communicate across the network.  Setting
+// CHPL_RT_COMM_COLL_HIERARCHICAL=false forces flat trees instead.
+//
+
+typedef enum {
+  CHPL_COMM_COLL_INT32,
+  CHPL_COMM_COLL_INT64,
+  CHPL_COMM_COLL_UINT32,
+  CHPL_COMM_COLL_UINT64,
+  CHPL_COMM_COLL_REAL32,
+  CHPL_COMM_COLL_REAL64,
+} chpl_comm_coll_type_t;
+
+typedef enum {
+  CHPL_COMM_COLL_SUM,
+  CHPL_COMM_COLL_PROD,
+  CHPL_COMM_COLL_MIN,
+  CHPL_COMM_COLL_MAX,
+  CHPL_COMM_COLL_BAND,    // bitwise ops are for the integral types only
+  CHPL_COMM_COLL_BOR,
+  CHPL_COMM_COLL_BXOR,
+} chpl_comm_coll_op_t;
+
+//
+// Barriers.  chpl_comm_coll_barrier() uses the algorithm selected by
+// CHPL_RT_COMM_COLL_BARRIER, "dissemination" (the default) or "tree".
+//
+void chpl_comm_coll_barrier(void);
+void chpl_comm_coll_barrier_dissemination(void);
+void chpl_comm_coll_barrier_tree(void);
+
+//
+// Copy 'size' bytes at 'buf' on locale 'root' to 'buf' on every other
+// locale.
+//
+void chpl_comm_coll_broadcast(c_nodeid_t root, void* buf, size_t size);
+
+//
+// Combine the 'count' elements of type 'type' at 'sendbuf' on every
+// locale with 'op', leaving the result in 'recvbuf' on 'root' (reduce)
+// or on every locale (allreduce).  'recvbuf' may be the same as
+// 'sendbuf'.  For reduce 'recvbuf' is only referenced on 'root'.
+//
+void chpl_comm_coll_reduce(c_nodeid_t root,
+                           const void* sendbuf, void* recvbuf, size_t count,
+                           chpl_comm_coll_type_t type,
+                           chpl_comm_coll_op_t op);
+void chpl_comm_coll_allreduce(const void* sendbuf, void* recvbuf,
+                              size_t count,
+                              chpl_comm_coll_type_t type,
+                              chpl_comm_coll_op_t op);
+
+//
+// Gather 'size' bytes at 'sendbuf' from every locale into 'recvbuf' on
+// every locale, which must hold chpl_numNodes*size bytes.  Locale i's
+// contribution ends up at offset i*size.
+//
+void chpl_comm_coll_allgather(const void* sendbuf, void* recvbuf,
+                              size_t size);
+
+//
+// Runtime-internal: the address of locale 0's collectives directory,
+// broadcast to the other locales when the collectives are set up.
+//
+extern void* chpl_comm_coll_root_dir;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LAUNCHER
+
+#endif
@@ -156,6 +156,13 @@ extern chpl_bool chpl_task_getCommDiagsTemporarilyDisabled(void);
                                  chpl_lookupFilename(fn), ln, op,       \
                                  (int) node, (int) commid)
 
+#define chpl_comm_diags_verbose_rdmaIdx(op, node, cnt, ln, fn, commid)  \
+  chpl_comm_diags_verbose_printf(false,                                 \
+                                 "%s:%d: remote indexed %s, node %d, "  \
+                                 "%zu pieces, commid %d",               \
+                                 chpl_lookupFilename(fn), ln, op,       \
+                                 (int) node, (size_t) cnt, (int) commid)
+
 #define chpl_comm_diags_verbose_amo(op, node, ln, fn)                   \
   chpl_comm_diags_verbose_printf(true,                                  \
                                  "%s:%d: remote %s, node %d",           \
@@ -54,11 +54,12 @@ extern size_t chpl_rt_priv_bcast_lens[];
   MACRO(chpl_comm_diagnostics)               \
   MACRO(chpl_comm_diags_print_unstable)      \
   MACRO(chpl_verbose_comm_stacktrace)        \
-  MACRO(chpl_verbose_gpu)                   \
-  MACRO(chpl_gpu_diagnostics)               \
-  MACRO(chpl_gpu_diags_print_unstable)      \
-  MACRO(chpl_verbose_gpu_stacktrace)        \
-  MACRO(chpl_verbose_mem)
+  MACRO(chpl_verbose_gpu)                    \
+  MACRO(chpl_gpu_diagnostics)                \
+  MACRO(chpl_gpu_diags_print_unstable)       \
+  MACRO(chpl_verbose_gpu_stacktrace)         \
+  MACRO(chpl_verbose_mem)                    \
+  MACRO(chpl_comm_coll_root_dir)
 
 #define _RT_PRV_BCAST_M(sym)  chpl_rt_prv_tab_ ## sym ## _idx,
 typedef enum {
@@ -37,6 +37,7 @@
 #include "chpl-mem.h"
 #include "chpl-mem-desc.h"
 #include "chpl-tasks.h"
+#include "error.h"
 
 // Don't get warning macros for chpl_comm_get etc
 #include "chpl-comm-no-warning-macros.h"
@@ -533,6 +534,93 @@ void strd_common_call(void* dstaddr_arg, size_t* dststrides, int32_t srclocale,
 }
 
 
+//
+// Common version of the indexed (scatter/gather) transfers, for comm
+// layer implementations that do not have native ones.  The remote and
+// local address lists describe the same byte stream cut into pieces of
+// different sizes, so walk both of them at once and issue one
+// contiguous transfer for each overlap between a remote piece and a
+// local one.  When the piece sizes are equal, as they are for the
+// usual element-wise gather or scatter, that is one transfer per piece.
+// In-flight transactions are managed by strd_nb_helper(), as above.
+//
+static inline
+void indexed_common(chpl_comm_nb_handle_t (*xferFn)(void*, int32_t, void*,
+                                                    size_t,
+                                                    int32_t,
+                                                    int, int32_t),
+                    int32_t remoteLocale,
+                    size_t remotecount, void* const remotelist[],
+                    size_t remotelen,
+                    size_t localcount, void* const locallist[],
+                    size_t locallen,
+                    size_t maxOutstandingXfers, void (yieldFn)(void),
+                    int32_t commID, int ln, int32_t fn) {
+  size_t ri = 0, roff = 0;
+  size_t li = 0, loff = 0;
+
+  chpl_comm_nb_handle_t handles[maxOutstandingXfers];
+  size_t currHandles = 0;
+
+  if (remotecount * remotelen != localcount * locallen) {
+    chpl_internal_error("indexed transfer: source and destination sizes "
+                        "differ");
+  }
+
+  if (remotelen == 0 || locallen == 0)
+    return;
+
+  while (ri < remotecount && li < localcount) {
+    size_t rleft = remotelen - roff;
+    size_t lleft = locallen - loff;
+    size_t len = (rleft < lleft) ? rleft : lleft;
+
+    strd_nb_helper(xferFn,
+                   (int8_t*)locallist[li] + loff, remoteLocale,
+                   (int8_t*)remotelist[ri] + roff, len,
+                   handles, &currHandles, maxOutstandingXfers, yieldFn,
+                   commID, ln, fn);
+
+    if ((roff += len) == remotelen) {
+      ri++;
+      roff = 0;
+    }
+    if ((loff += len) == locallen) {
+      li++;
+      loff = 0;
+    }
+  }
+
+  if (currHandles > 0) {
+    (void) chpl_comm_wait_nb_some(handles, currHandles);
+  }
+}
+
+
+static inline
+void put_indexed_common(int32_t dstlocale,
+                        size_t dstcount, void* const dstlist[], size_t dstlen,
+                        size_t srccount, void* const srclist[], size_t srclen,
+                        size_t maxOutstandingXfers, void (yieldFn)(void),
+                        int32_t commID, int ln, int32_t fn) {
+  indexed_common(chpl_comm_put_nb, dstlocale,
+                 dstcount, dstlist, dstlen, srccount, srclist, srclen,
+                 maxOutstandingXfers, yieldFn, commID, ln, fn);
+}
+
+
+static inline
+void get_indexed_common(size_t dstcount, void* const dstlist[], size_t dstlen,
+                        int32_t srclocale,
+                        size_t srccount, void* const srclist[], size_t srclen,
+                        size_t maxOutstandingXfers, void (yieldFn)(void),
+                        int32_t commID, int ln, int32_t fn) {
+  indexed_common(chpl_comm_get_nb, srclocale,
+                 srccount, srclist, srclen, dstcount, dstlist, dstlen,
+                 maxOutstandingXfers, yieldFn, commID, ln, fn);
+}
+
+
 #ifdef __cplusplus
 }
 #endif
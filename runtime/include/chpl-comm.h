@@ -139,8 +139,11 @@ chpl_comm_nb_handle_t chpl_comm_put_nb(void *addr, c_nodeid_t node, void* raddr,
                                        size_t size, int32_t commID,
                                        int ln, int32_t fn);
 
-// Returns nonzero iff the handle has already been waited for and has
-// been cleared out in a call to chpl_comm_{wait,try}_some.
+// Returns nonzero iff the operation for the handle has completed, either
+// because it has been waited for and cleared out in a call to
+// chpl_comm_{wait,try}_some or because the comm layer found it done.
+// Once this returns nonzero the handle has been consumed and must not be
+// passed to the comm layer again (other than as a NULL, completed handle).
 // This function must not call chpl_task_yield.
 int chpl_comm_test_nb_complete(chpl_comm_nb_handle_t h);
 
@@ -497,6 +500,81 @@ void chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode,
                         int32_t stridelevels, size_t elemSize, int32_t commID,
                         int ln, int32_t fn);
 
+//
+// non-blocking versions of chpl_comm_put_strd() and chpl_comm_get_strd().
+// The strides and count arrays may be reused as soon as these return,
+// but the source and destination data may not be touched until the
+// returned handle has been completed with chpl_comm_wait_nb_some() or
+// chpl_comm_try_nb_some().  Comm layers without native strided support
+// may do the whole transfer before returning, and return a completed
+// (NULL) handle.
+//
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn);
+
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn);
+
+//
+// Indexed (scatter/gather) transfers.  The 'srccount' source pieces of
+// 'srclen' bytes each, at the addresses listed in 'srclist', are
+// copied to the 'dstcount' destination pieces of 'dstlen' bytes each at
+// the addresses listed in 'dstlist'.  Both lists are taken in order and
+// treated as one concatenated byte stream, so dstcount*dstlen must
+// equal srccount*srclen.  For a put the destination pieces are on
+// 'dstnode' and the source pieces are local; for a get it is the other
+// way around.  Under comm=gasnet these map onto GASNet-EX's
+// gex_VIS_Indexed{Put,Get}NB(); elsewhere they are a series of
+// non-blocking contiguous transfers.
+//
+void chpl_comm_put_indexed(c_nodeid_t dstnode,
+                           size_t dstcount, void* const dstlist[],
+                           size_t dstlen,
+                           size_t srccount, void* const srclist[],
+                           size_t srclen,
+                           int32_t commID, int ln, int32_t fn);
+
+void chpl_comm_get_indexed(size_t dstcount, void* const dstlist[],
+                           size_t dstlen,
+                           c_nodeid_t srcnode,
+                           size_t srccount, void* const srclist[],
+                           size_t srclen,
+                           int32_t commID, int ln, int32_t fn);
+
+//
+// non-blocking versions of the above, with the same rules as
+// chpl_comm_put_strd_nb(): the address lists may be reused on return.
+//
+chpl_comm_nb_handle_t chpl_comm_put_indexed_nb(c_nodeid_t dstnode,
+                                               size_t dstcount,
+                                               void* const dstlist[],
+                                               size_t dstlen,
+                                               size_t srccount,
+                                               void* const srclist[],
+                                               size_t srclen,
+                                               int32_t commID,
+                                               int ln, int32_t fn);
+
+chpl_comm_nb_handle_t chpl_comm_get_indexed_nb(size_t dstcount,
+                                               void* const dstlist[],
+                                               size_t dstlen,
+                                               c_nodeid_t srcnode,
+                                               size_t srccount,
+                                               void* const srclist[],
+                                               size_t srclen,
+                                               int32_t commID,
+                                               int ln, int32_t fn);
+
 
 //
 // Unordered ops
@@ -37,4 +37,25 @@ void chpl_comm_impl_regMemHeapInfo(void** start_p, size_t* size_p);
 }
 #endif
 
+//
+// Network atomic operations.
+//
+#include "chpl-comm-native-atomics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Task end hook, to complete any unordered network atomics the task
+// still has in flight.
+//
+#define CHPL_COMM_IMPL_TASK_END() \
+        chpl_comm_impl_task_end()
+void chpl_comm_impl_task_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif // _chpl_comm_impl_h_
@@ -31,6 +31,7 @@ extern "C" {
 
 typedef struct {
     chpl_cache_taskPrvData_t cache_data;
+    void* amo_nf_buff;  // in-flight unordered network atomics
 } chpl_comm_taskPrvData_t;
 
 //
@@ -59,6 +59,8 @@ typedef uint32_t qio_hint_t;
 
 extern ssize_t qio_write_unbuffered_threshold;
 extern ssize_t qio_read_unbuffered_threshold;
+extern ssize_t qio_readahead_max_iobufs;
+extern ssize_t qio_writebehind_max_iobufs;
 
 // TODO: make these better values
 #ifndef FTYPE_NONE
@@ -181,6 +183,7 @@ extern "C" {
 extern ssize_t qio_too_small_for_default_mmap;
 extern ssize_t qio_too_large_for_default_mmap;
 extern ssize_t qio_mmap_chunk_iobufs;
+extern ssize_t qio_mmap_max_chunk_iobufs;
 
 /* Wrap system calls readv, writev, preadv, pwritev
  * to take a buffer.
@@ -228,6 +231,10 @@ char* qio_chtype_to_string(qio_chtype_t type);
      -- noreuse -- pread/pwrite
      -- cached -- mmap for reads and writes
      -- force_readwrite
+     -- uring -- like pread/pwrite, but submitted through io_uring so
+                 that waiting tasks yield instead of blocking a thread.
+                 Only used when requested; it is not yet faster than
+                 pread/pwrite, so it is never chosen by default.
  */
 
 #define QIO_HINT_AFTERCHTYPE 0x0010
@@ -238,13 +245,14 @@ typedef enum {
   QIO_METHOD_FREADFWRITE = 3*QIO_HINT_AFTERCHTYPE,
   QIO_METHOD_MMAP = 4*QIO_HINT_AFTERCHTYPE,
   QIO_METHOD_MEMORY = 5*QIO_HINT_AFTERCHTYPE,
+  QIO_METHOD_URING = 6*QIO_HINT_AFTERCHTYPE,
   //QIO_METHOD_LIBEVENT,
 } qio_method_t;
 #define QIO_METHODMASK 0x00f0
 #define QIO_HINT_AFTERMETHOD 0x0100
 #define QIO_METHOD_DEFAULT 0
 #define QIO_MIN_METHOD QIO_METHOD_READWRITE
-#define QIO_MAX_METHOD QIO_METHOD_MEMORY
+#define QIO_MAX_METHOD QIO_METHOD_URING
 
 enum {
   QIO_HINT_RANDOM       = QIO_HINT_AFTERMETHOD,
@@ -279,10 +287,19 @@ enum {
   // is opened within the qio implementation.  Otherwise, the user (or system)
   // has to close it.
   QIO_HINT_OWNED        = QIO_HINT_NOFAST<<1,
+
+  // For mmap: prefault mapped regions (MAP_POPULATE) so that later
+  // accesses don't take page faults.
+  QIO_HINT_POPULATE     = QIO_HINT_OWNED<<1,
+
+  // For mmap: ask for transparent huge pages (MADV_HUGEPAGE) to reduce
+  // TLB misses. This is only advice; file systems that can't back a
+  // mapping with huge pages ignore it.
+  QIO_HINT_HUGEPAGE     = QIO_HINT_POPULATE<<1,
 };
 
 
-#define QIO_NUM_HINT_BITS 8
+#define QIO_NUM_HINT_BITS 12
 #define QIO_HINTMASK 0xffff00
 
 char* qio_hints_to_string(qio_hint_t hint);
@@ -339,6 +356,9 @@ char* qio_hints_to_string(qio_hint_t hint)
       case QIO_METHOD_MEMORY:
         strcat(buf, " memory"); ok = 1;
         break;
+      case QIO_METHOD_URING:
+        strcat(buf, " uring"); ok = 1;
+        break;
       // no default to get warned if any are added.
     }
   }
@@ -355,6 +375,8 @@ char* qio_hints_to_string(qio_hint_t hint)
   if( hint & QIO_HINT_NOREUSE ) strcat(buf, " noreuse");
   if( hint & QIO_HINT_NOFAST ) strcat(buf, " nofast");
   if( hint & QIO_HINT_OWNED ) strcat(buf, " owned");
+  if( hint & QIO_HINT_POPULATE ) strcat(buf, " populate");
+  if( hint & QIO_HINT_HUGEPAGE ) strcat(buf, " hugepage");
 
   return qio_strdup(buf);
 }
@@ -435,6 +457,8 @@ qioerr qio_readv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer
 qioerr qio_writev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, ssize_t* num_written);
 qioerr qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read);
 qioerr qio_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written);
+qioerr qio_uring_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read);
+qioerr qio_uring_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written);
 
 // if fp is not null, fd is ignored; if fp is null, we use fd.
 // the QIO file takes ownership of fp or fd, closing it when the QIO file is closed.
@@ -724,6 +748,19 @@ typedef struct qio_channel_s {
 
   qio_style_t style;
   int64_t bufIoMax; // maximum single I/O to/from buffer
+
+  // Adaptive read-ahead and write-behind for pread/pwrite channels.
+  int64_t readahead; // bytes to read beyond what was required
+  int64_t readahead_end; // av_end after the last read; detects seeks
+  int64_t writebehind; // bytes of finished iobufs to collect before writing
+
+  // mmap channels: the next mapping size (grows while reading
+  // sequentially), and statistics for qio_channel_mmap_stats.
+  int64_t mmap_chunk;
+  int64_t mmap_count;
+  int64_t mmap_bytes;
+  int64_t mmap_minflt_base;
+  int64_t mmap_majflt_base;
 } qio_channel_t;
 
 
@@ -1279,6 +1316,21 @@ int64_t qio_channel_end_offset_unlocked(qio_channel_t* ch)
 
 qioerr qio_channel_end_offset(const int threadsafe, qio_channel_t* ch, int64_t* offset_out);
 
+/*
+ * For a channel using QIO_METHOD_MMAP, report how many regions it has
+ * mapped on demand and their total length. Regions from a file's initial
+ * mapping are not counted.
+ *
+ * minflt_out and majflt_out are process-level deltas: the change in the
+ * process's getrusage fault counts since the channel's first mapping.
+ * They include faults from every thread and on any memory, not only the
+ * channel's mappings, so they are an upper bound on the channel's faults
+ * and are only meaningful when little else runs concurrently.
+ */
+qioerr qio_channel_mmap_stats(const int threadsafe, qio_channel_t* ch,
+                              int64_t* nmaps_out, int64_t* bytes_out,
+                              int64_t* minflt_out, int64_t* majflt_out);
+
 
 qioerr qio_channel_advance(const int threadsafe, qio_channel_t* ch, int64_t nbytes);
 
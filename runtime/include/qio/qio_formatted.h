@@ -671,6 +671,35 @@ int32_t qio_skip_json_field_unlocked(qio_channel_t* restrict ch);
 
 qioerr qio_channel_skip_json_field(const int threadsafe, qio_channel_t* ch);
 
+// Divide the byte range [start, end) of a file into 'nchunks' pieces of
+// roughly equal size that each begin at the start of a record, and
+// return the range of piece number 'chunk' (0 <= chunk < nchunks).
+//
+// A record starts at 'start' or just after an occurrence of the
+// delimiter 'delim' (of 'delim_len' bytes; e.g. "\n" for lines).
+// Each boundary is the first record start at or after its nominal
+// position, so the pieces cover [start, end) without gaps or overlap
+// and each task (or locale) can compute its own piece independently
+// without communicating with the others. Some pieces may be empty
+// when records are longer than a piece.
+//
+// Since boundaries are found by searching forward from an arbitrary
+// offset, a delimiter that can overlap itself (such as "||") may be
+// matched out of phase with a reader that starts at the beginning.
+qioerr qio_file_record_chunk(qio_file_t* f, int64_t start, int64_t end,
+                             int64_t nchunks, int64_t chunk,
+                             const char* delim, ssize_t delim_len,
+                             int64_t* chunk_start_out, int64_t* chunk_end_out);
+
+// Create a reading channel for piece 'chunk' as computed by
+// qio_file_record_chunk.
+qioerr qio_channel_create_record_chunk(qio_channel_t** ch_out, qio_file_t* f,
+                                       qio_hint_t hints,
+                                       int64_t start, int64_t end,
+                                       int64_t nchunks, int64_t chunk,
+                                       const char* delim, ssize_t delim_len,
+                                       qio_style_t* style);
+
 enum {
   QIO_CONV_UNK = 0,
   QIO_CONV_ARG_TYPE_NUMERIC,
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// qio_scan.h
+//
+// Byte-class scanners used by the formatted I/O routines to skip over
+// runs of uninteresting bytes in a channel's cached buffer window
+// (ch->cached_cur .. ch->cached_end) without going through
+// qio_channel_read_byte one byte at a time.
+//
+// Each scanner takes a range [p, end) and returns a pointer to the first
+// byte that stops the scan, or end if there is none. They never read
+// at or past end.
+//
+// When the compiler targets SSE2 or AVX2 (and supports GNU builtins),
+// the scanners compare 16 or 32 bytes at a time; otherwise (or for the
+// tail of the range) they fall back to a scalar loop.
+#ifndef _QIO_SCAN_H_
+#define _QIO_SCAN_H_
+
+#include "sys_basic.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__AVX2__)
+#include <immintrin.h>
+typedef __m256i qio_scan_vec_t;
+#define QIO_SCAN_VEC_LEN 32
+#define qio_scan_load(p) _mm256_loadu_si256((const __m256i*) (p))
+#define qio_scan_set1(c) _mm256_set1_epi8((char) (c))
+#define qio_scan_eq(a, b) _mm256_cmpeq_epi8((a), (b))
+#define qio_scan_or(a, b) _mm256_or_si256((a), (b))
+#define qio_scan_sub(a, b) _mm256_sub_epi8((a), (b))
+#define qio_scan_min_u8(a, b) _mm256_min_epu8((a), (b))
+#define qio_scan_mask(v) ((uint32_t) _mm256_movemask_epi8(v))
+#define QIO_SCAN_ALL_MASK 0xffffffffu
+#elif defined(__GNUC__) && defined(__SSE2__)
+#include <emmintrin.h>
+typedef __m128i qio_scan_vec_t;
+#define QIO_SCAN_VEC_LEN 16
+#define qio_scan_load(p) _mm_loadu_si128((const __m128i*) (p))
+#define qio_scan_set1(c) _mm_set1_epi8((char) (c))
+#define qio_scan_eq(a, b) _mm_cmpeq_epi8((a), (b))
+#define qio_scan_or(a, b) _mm_or_si128((a), (b))
+#define qio_scan_sub(a, b) _mm_sub_epi8((a), (b))
+#define qio_scan_min_u8(a, b) _mm_min_epu8((a), (b))
+#define qio_scan_mask(v) ((uint32_t) _mm_movemask_epi8(v))
+#define QIO_SCAN_ALL_MASK 0xffffu
+#endif
+
+#ifdef QIO_SCAN_VEC_LEN
+#define qio_scan_first(mask) __builtin_ctz(mask)
+#endif
+
+// Find the first byte equal to 'a'.
+// libc memchr is already vectorized on the platforms we care about.
+static inline
+const uint8_t* qio_scan_find_byte(const uint8_t* p, const uint8_t* end,
+                                  uint8_t a)
+{
+  const void* found = memchr(p, a, end - p);
+  return found ? (const uint8_t*) found : end;
+}
+
+// Find the first byte that is 'a', 'b', or not ASCII (>= 0x80).
+// If 'ctl' is set, also stop at any control character or space (<= 0x20).
+// Passing 0x80 for 'a' or 'b' matches nothing extra.
+static inline
+const uint8_t* qio_scan_find_special(const uint8_t* p, const uint8_t* end,
+                                     uint8_t a, uint8_t b, int ctl)
+{
+#ifdef QIO_SCAN_VEC_LEN
+  qio_scan_vec_t va = qio_scan_set1(a);
+  qio_scan_vec_t vb = qio_scan_set1(b);
+  qio_scan_vec_t vsp = qio_scan_set1(0x20);
+  while( end - p >= QIO_SCAN_VEC_LEN ) {
+    qio_scan_vec_t v = qio_scan_load(p);
+    qio_scan_vec_t hit = qio_scan_or(qio_scan_eq(v, va), qio_scan_eq(v, vb));
+    uint32_t mask;
+    if( ctl ) {
+      // v <= 0x20 (unsigned) iff min(v, 0x20) == v
+      hit = qio_scan_or(hit, qio_scan_eq(qio_scan_min_u8(v, vsp), v));
+    }
+    // movemask of v itself picks out the non-ASCII bytes
+    mask = qio_scan_mask(hit) | qio_scan_mask(v);
+    if( mask ) return p + qio_scan_first(mask);
+    p += QIO_SCAN_VEC_LEN;
+  }
+#endif
+  while( p < end ) {
+    uint8_t c = *p;
+    if( c == a || c == b || c >= 0x80 || (ctl && c <= 0x20) ) break;
+    p++;
+  }
+  return p;
+}
+
+// Find the first byte that is not one of the bytes 'a', 'b', 'c', 'd'
+// (pass a repeated byte to use fewer). Used to skip whitespace classes.
+static inline
+const uint8_t* qio_scan_skip_bytes4(const uint8_t* p, const uint8_t* end,
+                                    uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+{
+#ifdef QIO_SCAN_VEC_LEN
+  qio_scan_vec_t va = qio_scan_set1(a);
+  qio_scan_vec_t vb = qio_scan_set1(b);
+  qio_scan_vec_t vc = qio_scan_set1(c);
+  qio_scan_vec_t vd = qio_scan_set1(d);
+  while( end - p >= QIO_SCAN_VEC_LEN ) {
+    qio_scan_vec_t v = qio_scan_load(p);
+    qio_scan_vec_t in = qio_scan_or(qio_scan_or(qio_scan_eq(v, va),
+                                                qio_scan_eq(v, vb)),
+                                    qio_scan_or(qio_scan_eq(v, vc),
+                                                qio_scan_eq(v, vd)));
+    uint32_t mask = ~qio_scan_mask(in) & QIO_SCAN_ALL_MASK;
+    if( mask ) return p + qio_scan_first(mask);
+    p += QIO_SCAN_VEC_LEN;
+  }
+#endif
+  while( p < end ) {
+    uint8_t x = *p;
+    if( x != a && x != b && x != c && x != d ) break;
+    p++;
+  }
+  return p;
+}
+
+// Find the first byte that is not an ASCII digit.
+static inline
+const uint8_t* qio_scan_skip_digits(const uint8_t* p, const uint8_t* end)
+{
+#ifdef QIO_SCAN_VEC_LEN
+  qio_scan_vec_t v0 = qio_scan_set1('0');
+  qio_scan_vec_t v9 = qio_scan_set1(9);
+  while( end - p >= QIO_SCAN_VEC_LEN ) {
+    // v - '0' <= 9 (unsigned) iff v is a digit
+    qio_scan_vec_t d = qio_scan_sub(qio_scan_load(p), v0);
+    qio_scan_vec_t digit = qio_scan_eq(qio_scan_min_u8(d, v9), d);
+    uint32_t mask = ~qio_scan_mask(digit) & QIO_SCAN_ALL_MASK;
+    if( mask ) return p + qio_scan_first(mask);
+    p += QIO_SCAN_VEC_LEN;
+  }
+#endif
+  while( p < end && '0' <= *p && *p <= '9' ) p++;
+  return p;
+}
+
+#endif
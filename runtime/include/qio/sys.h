@@ -159,6 +159,11 @@ qio_err_t sys_feof(FILE* stream, int *iseof);
 qio_err_t sys_ferror(FILE* stream);
 qio_err_t sys_posix_fadvise(fd_t fd, off_t offset, off_t len, int advice);
 qio_err_t sys_posix_madvise(void* addr, size_t len, int advice);
+// Non-POSIX madvise advice (e.g. MADV_HUGEPAGE); returns ENOSYS
+// where madvise is not available.
+qio_err_t sys_madvise(void* addr, size_t len, int advice);
+// Page faults taken by this process so far.
+qio_err_t sys_page_faults(int64_t* minor_out, int64_t* major_out);
 
 // returns an allocated string in string_out, which must be freed.
 qio_err_t sys_strerror(qio_err_t error, const char** string_out);
@@ -204,6 +209,22 @@ qio_err_t sys_writev(fd_t fd, const struct iovec* iov, int iovcnt, ssize_t* num_
 qio_err_t sys_preadv(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_read_out);
 qio_err_t sys_pwritev(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_written_out);
 
+// Like sys_pread/sys_pwrite/sys_preadv/sys_pwritev, but submitted through
+// io_uring where available.  The calling task yields until the request
+// completes instead of blocking its thread.  These fall back to the
+// synchronous versions if io_uring is not available.
+int sys_uring_available(void);
+qio_err_t sys_uring_pread(fd_t fd, void* buf, size_t count, off_t offset, ssize_t* num_read_out);
+qio_err_t sys_uring_pwrite(fd_t fd, const void* buf, size_t count, off_t offset, ssize_t* num_written_out);
+qio_err_t sys_uring_preadv(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_read_out);
+qio_err_t sys_uring_pwritev(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_written_out);
+
+#ifdef CHPL_RT_UNIT_TEST
+// When set, io_uring submissions are treated as if the kernel took none
+// of them, so the synchronous fallback can be tested.
+extern int sys_uring_test_reject_submit;
+#endif
+
 qio_err_t sys_fsync(fd_t fd);
 
 qio_err_t sys_fcntl(fd_t fd, int cmd, int* ret);
@@ -43,6 +43,7 @@
 #include "chpl-atomics.h"
 #include "chpl-bitops.h"
 #include "chpl-comm.h"
+#include "chpl-comm-coll.h"
 #include "chpl-comm-diags.h"
 #include "chpl-const-arg-check.h"
 #include "chpldirent.h"
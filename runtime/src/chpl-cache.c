@@ -1932,14 +1932,15 @@ chpl_bool do_wait_for(struct rdcache_s* cache, cache_seqn_t sn)
   while (1) {
     int index;
     int last;
+    int complete;
 
     index = cache->pending_first_entry;
     if (index == -1) break;
 
     // If the first entry's sequence number is earlier than sn
     // and that comm event isn't complete yet, then wait for some
-    if (cache->pending_sequence_numbers[index] <= sn &&
-        !chpl_comm_test_nb_complete(cache->pending[index])) {
+    complete = chpl_comm_test_nb_complete(cache->pending[index]);
+    if (cache->pending_sequence_numbers[index] <= sn && !complete) {
       // Wait for some requests
       last = cache->pending_last_entry;
       if (last < index) last = cache->pending_len - 1;
@@ -1961,12 +1962,16 @@ chpl_bool do_wait_for(struct rdcache_s* cache, cache_seqn_t sn)
                           chpl_nodeID, (int) chpl_task_getId(), cache));
       }
 
+      complete = chpl_comm_test_nb_complete(cache->pending[index]);
+
       // continue the loop
     }
 
     // Whether we waited above or not, if the first entry's event
-    // is already complete, then remove it from the queue.
-    if (chpl_comm_test_nb_complete(cache->pending[index])) {
+    // is already complete, then remove it from the queue.  A handle
+    // the comm layer reported complete may not be tested again.
+    if (complete) {
+      cache->pending[index] = NULL;
       fifo_circleb_pop(&cache->pending_first_entry,
                        &cache->pending_last_entry,
                        cache->pending_len);
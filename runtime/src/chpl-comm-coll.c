@@ -0,0 +1,789 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Runtime collectives, built on chpl_comm_put() and chpl_comm_get().
+// See chpl-comm-coll.h for the interface.
+//
+// Each locale has a collectives area, allocated from the heap so that
+// it is remotely accessible under every comm layer, and a directory of
+// the other locales' area addresses.  Peers signal each other by
+// PUTting into fields of these areas.  Every collective call takes the
+// next value of a per-locale sequence number, which advances the same
+// way everywhere because the calls are collective.  Flags only ever
+// increase, so a waiter simply waits until a flag reaches the current
+// sequence number and nothing ever needs to be reset.
+//
+// Data moves by GETs rather than PUTs: a sender publishes the address
+// of a heap staging buffer in the receiver's area, the receiver GETs
+// from it and then acknowledges, after which the sender may free it.
+//
+// Each locale's area has a separate mailbox for every other locale,
+// written only by that locale.  Which locales talk to each other
+// depends on the root of the collective, so with shared mailboxes a
+// locale that has already moved on to the next collective could
+// overwrite a message that hasn't been read yet.  With one mailbox per
+// sender that can't happen, because a sender that publishes a buffer
+// waits for it to be acknowledged before going on.
+//
+
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-comm-coll.h"
+#include "chpl-comm-compiler-macros.h"
+#include "chpl-comm-internal.h"
+#include "chpl-env.h"
+#include "chpl-mem.h"
+#include "chpl-tasks.h"
+#include "error.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// Don't get warning macros for chpl_comm_get etc
+#include "chpl-comm-no-warning-macros.h"
+
+// Enough dissemination rounds or binomial tree levels for 2^32 nodes.
+#define COLL_MAX_ROUNDS 32
+
+//
+// The mailbox for one sender.  The sender sets 'seq' to signal us, or
+// to publish a buffer at 'addr', which it writes first.  It sets 'ack'
+// once it is done reading a buffer we published to it.
+//
+typedef struct {
+  volatile int64_t seq;
+  void* volatile addr;
+  volatile int64_t ack;
+} coll_slot_t;
+
+typedef struct {
+  volatile int64_t dissem[COLL_MAX_ROUNDS];  // dissemination barrier rounds
+  coll_slot_t from[];                        // one per locale
+} coll_area_t;
+
+typedef struct {
+  void* area;
+  int32_t numLocalesOnNode;
+  int32_t localRank;
+} coll_dir_ent_t;
+
+void* chpl_comm_coll_root_dir;
+
+static chpl_bool coll_initialized;
+static coll_area_t* coll_area;
+static void** coll_dir;        // every locale's coll_area address
+static int coll_max_kids;
+static int64_t coll_seq;
+
+static chpl_bool coll_use_tree_barrier;
+
+// The tree shape.  Locales are grouped into coll_nnodes groups of
+// coll_lpn consecutive locales; without the hierarchy, coll_lpn is 1.
+static int32_t coll_lpn;
+static int32_t coll_nnodes;
+
+
+//
+// Set up the collectives.  This is done by the first collective call
+// rather than at runtime init, so that programs which don't use the
+// collectives don't pay for the directory exchange and its barriers.
+// Every locale makes the same first call, so they all get here
+// together.  Only one task per locale may be in the collectives at a
+// time, so the flag needs no synchronization.
+//
+static
+void coll_init(void) {
+  int32_t lpn = chpl_get_num_locales_on_node();
+  coll_dir_ent_t me;
+  coll_dir_ent_t* dir;
+  const char* ev;
+  chpl_bool hier;
+  int32_t i;
+
+  coll_max_kids = COLL_MAX_ROUNDS + lpn;
+  coll_area = chpl_mem_allocManyZero(1, sizeof(coll_area_t)
+                                     + chpl_numNodes * sizeof(coll_slot_t),
+                                     CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+  coll_dir = chpl_mem_allocMany(chpl_numNodes, sizeof(coll_dir[0]),
+                                CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+  coll_dir[chpl_nodeID] = coll_area;
+  coll_seq = 0;
+
+  ev = chpl_env_rt_get("COMM_COLL_BARRIER", "dissemination");
+  if (strcmp(ev, "tree") == 0) {
+    coll_use_tree_barrier = true;
+  } else if (strcmp(ev, "dissemination") == 0) {
+    coll_use_tree_barrier = false;
+  } else {
+    chpl_warning("CHPL_RT_COMM_COLL_BARRIER must be \"dissemination\" or "
+                 "\"tree\"; using \"dissemination\"", 0, 0);
+    coll_use_tree_barrier = false;
+  }
+
+  coll_lpn = 1;
+  coll_nnodes = chpl_numNodes;
+  coll_initialized = true;
+
+  if (chpl_numNodes == 1) {
+    return;
+  }
+
+  //
+  // Build the directory.  Node 0 broadcasts the address of a table
+  // that everyone fills in their own entry of, then everyone reads
+  // the whole thing.  This runs once, so the O(numNodes) traffic on
+  // node 0 doesn't matter.
+  //
+  if (chpl_nodeID == 0) {
+    chpl_comm_coll_root_dir =
+      chpl_mem_allocManyZero(chpl_numNodes, sizeof(coll_dir_ent_t),
+                             CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+    chpl_comm_bcast_rt_private(chpl_comm_coll_root_dir);
+  }
+  chpl_comm_barrier("collectives: root directory");
+
+  me.area = coll_area;
+  me.numLocalesOnNode = lpn;
+  me.localRank = chpl_get_local_rank();
+  chpl_comm_put(&me, 0,
+                (coll_dir_ent_t*) chpl_comm_coll_root_dir + chpl_nodeID,
+                sizeof(me), CHPL_COMM_UNKNOWN_ID, 0, -1);
+  chpl_comm_barrier("collectives: directory filled in");
+
+  dir = chpl_mem_allocMany(chpl_numNodes, sizeof(*dir),
+                           CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+  chpl_comm_get(dir, 0, chpl_comm_coll_root_dir,
+                chpl_numNodes * sizeof(*dir), CHPL_COMM_UNKNOWN_ID, 0, -1);
+
+  //
+  // Use the node-aware trees only if every node has the same number of
+  // locales and they are numbered consecutively within each node, so
+  // that locale i has local rank i % lpn.  Every locale sees the same
+  // directory, so they all come to the same conclusion.
+  //
+  hier = chpl_env_rt_get_bool("COMM_COLL_HIERARCHICAL", true)
+         && lpn > 1 && chpl_numNodes % lpn == 0;
+  for (i = 0; i < chpl_numNodes; i++) {
+    coll_dir[i] = dir[i].area;
+    if (dir[i].numLocalesOnNode != lpn || dir[i].localRank != i % lpn) {
+      hier = false;
+    }
+  }
+  chpl_mem_free(dir, 0, 0);
+
+  if (hier) {
+    coll_lpn = lpn;
+    coll_nnodes = chpl_numNodes / lpn;
+  }
+}
+
+static inline
+void coll_ensure_init(void) {
+  if (!coll_initialized) {
+    coll_init();
+  }
+}
+
+// Every collective starts by taking the next sequence number.
+static inline
+int64_t coll_next_seq(void) {
+  coll_ensure_init();
+  return ++coll_seq;
+}
+
+
+//
+// Signalling.
+//
+
+// Translate the address of a field in our own area to that field in
+// 'node's area.  All the areas have the same layout.
+static inline
+void* coll_raddr(c_nodeid_t node, volatile void* field) {
+  return (char*) coll_dir[node] + ((char*) field - (char*) coll_area);
+}
+
+static inline
+void coll_put(c_nodeid_t node, volatile void* field, void* src, size_t size) {
+  chpl_comm_put(src, node, coll_raddr(node, field), size,
+                CHPL_COMM_UNKNOWN_ID, 0, -1);
+}
+
+static inline
+void coll_signal(c_nodeid_t node, volatile int64_t* flag, int64_t seq) {
+  coll_put(node, flag, &seq, sizeof(seq));
+}
+
+// Our mailbox in 'node's area.
+#define coll_my_slot() (&coll_area->from[chpl_nodeID])
+
+// Publish 'addr' to 'node' for collective 'seq'.
+static inline
+void coll_publish(c_nodeid_t node, void* addr, int64_t seq) {
+  coll_put(node, &coll_my_slot()->addr, &addr, sizeof(addr));
+  coll_signal(node, &coll_my_slot()->seq, seq);
+}
+
+static inline
+void coll_wait(volatile int64_t* flag, int64_t seq) {
+  while (*flag < seq) {
+    chpl_task_yield();
+  }
+  chpl_atomic_thread_fence(memory_order_acquire);
+}
+
+
+//
+// Tree shape.
+//
+// The locales in each group of coll_lpn form a star around the group's
+// head, and the heads form a binomial tree over the groups.  The head
+// of the root's group is the root itself; the head of every other
+// group is its first locale.
+//
+
+static inline
+int32_t coll_group(int32_t loc) {
+  return loc / coll_lpn;
+}
+
+static inline
+int32_t coll_head(int32_t grp, int32_t root) {
+  return (grp == coll_group(root)) ? root : grp * coll_lpn;
+}
+
+// 'grp' numbered relative to the root's group
+static inline
+int32_t coll_rel(int32_t grp, int32_t root) {
+  return (grp - coll_group(root) + coll_nnodes) % coll_nnodes;
+}
+
+static inline
+int32_t coll_unrel(int32_t rel, int32_t root) {
+  return (rel + coll_group(root)) % coll_nnodes;
+}
+
+static
+int32_t coll_parent(int32_t root, int32_t loc) {
+  int32_t grp = coll_group(loc);
+  int32_t rel;
+
+  if (loc != coll_head(grp, root)) {
+    return coll_head(grp, root);
+  }
+
+  rel = coll_rel(grp, root);
+  if (rel == 0) {
+    return -1;
+  }
+  rel &= rel - 1;   // binomial parent: clear the lowest set bit
+  return coll_head(coll_unrel(rel, root), root);
+}
+
+// Fill in 'kids' (at least coll_max_kids long) and return how many.
+static
+int coll_children(int32_t root, int32_t loc, int32_t* kids) {
+  int32_t grp = coll_group(loc);
+  int32_t rel, bit, i;
+  int nk = 0;
+
+  if (loc != coll_head(grp, root)) {
+    return 0;
+  }
+
+  for (i = grp * coll_lpn; i < (grp + 1) * coll_lpn; i++) {
+    if (i != loc) {
+      kids[nk++] = i;
+    }
+  }
+
+  // binomial children: rel + 2^k, for each 2^k below rel's lowest set bit
+  rel = coll_rel(grp, root);
+  for (bit = 1;
+       bit < coll_nnodes && (rel == 0 || bit < (rel & -rel));
+       bit <<= 1) {
+    if (rel + bit < coll_nnodes) {
+      kids[nk++] = coll_head(coll_unrel(rel + bit, root), root);
+    }
+  }
+
+  return nk;
+}
+
+// Append the locales in the subtree rooted at 'loc' to 'list'.
+static
+void coll_subtree(int32_t root, int32_t loc, int32_t* list, int32_t* pn) {
+  int32_t kids[coll_max_kids];
+  int nk = coll_children(root, loc, kids);
+  int i;
+
+  list[(*pn)++] = loc;
+  for (i = 0; i < nk; i++) {
+    coll_subtree(root, kids[i], list, pn);
+  }
+}
+
+
+//
+// Barriers.
+//
+
+void chpl_comm_coll_barrier_dissemination(void) {
+  const int64_t seq = coll_next_seq();
+  const int32_t grp = coll_group(chpl_nodeID);
+  const int32_t lead = grp * coll_lpn;
+  int32_t dist, i;
+  int r;
+
+  if (chpl_numNodes == 1) {
+    return;
+  }
+
+  //
+  // The other locales in a group check in with the group's leader and
+  // wait to be released.  The leaders run the dissemination barrier
+  // among themselves.
+  //
+  if (chpl_nodeID != lead) {
+    coll_signal(lead, &coll_my_slot()->seq, seq);
+    coll_wait(&coll_area->from[lead].seq, seq);
+    return;
+  }
+
+  for (i = 1; i < coll_lpn; i++) {
+    coll_wait(&coll_area->from[lead + i].seq, seq);
+  }
+
+  for (r = 0, dist = 1; dist < coll_nnodes; r++, dist <<= 1) {
+    coll_signal(((grp + dist) % coll_nnodes) * coll_lpn,
+                &coll_area->dissem[r], seq);
+    coll_wait(&coll_area->dissem[r], seq);
+  }
+
+  for (i = 1; i < coll_lpn; i++) {
+    coll_signal(lead + i, &coll_my_slot()->seq, seq);
+  }
+}
+
+
+void chpl_comm_coll_barrier_tree(void) {
+  const int64_t seq = coll_next_seq();
+  int32_t kids[coll_max_kids];
+  int32_t parent;
+  int nk, i;
+
+  if (chpl_numNodes == 1) {
+    return;
+  }
+
+  nk = coll_children(0, chpl_nodeID, kids);
+  for (i = 0; i < nk; i++) {
+    coll_wait(&coll_area->from[kids[i]].seq, seq);
+  }
+
+  parent = coll_parent(0, chpl_nodeID);
+  if (parent >= 0) {
+    coll_signal(parent, &coll_my_slot()->seq, seq);
+    coll_wait(&coll_area->from[parent].seq, seq);
+  }
+
+  for (i = 0; i < nk; i++) {
+    coll_signal(kids[i], &coll_my_slot()->seq, seq);
+  }
+}
+
+
+void chpl_comm_coll_barrier(void) {
+  coll_ensure_init();
+  if (coll_use_tree_barrier) {
+    chpl_comm_coll_barrier_tree();
+  } else {
+    chpl_comm_coll_barrier_dissemination();
+  }
+}
+
+
+//
+// Broadcast: each locale GETs the data from its parent's staging
+// buffer, then publishes its own copy to its children.
+//
+
+void chpl_comm_coll_broadcast(c_nodeid_t root, void* buf, size_t size) {
+  const int64_t seq = coll_next_seq();
+  int32_t kids[coll_max_kids];
+  int32_t parent;
+  void* stage;
+  int nk, i;
+
+  if (chpl_numNodes == 1 || size == 0) {
+    return;
+  }
+
+  stage = chpl_mem_alloc(size, CHPL_RT_MD_COMM_UTIL, 0, 0);
+
+  parent = coll_parent(root, chpl_nodeID);
+  if (parent < 0) {
+    memcpy(stage, buf, size);
+  } else {
+    coll_wait(&coll_area->from[parent].seq, seq);
+    chpl_comm_get(stage, parent, coll_area->from[parent].addr, size,
+                  CHPL_COMM_UNKNOWN_ID, 0, -1);
+    coll_signal(parent, &coll_my_slot()->ack, seq);
+  }
+
+  nk = coll_children(root, chpl_nodeID, kids);
+  for (i = 0; i < nk; i++) {
+    coll_publish(kids[i], stage, seq);
+  }
+
+  if (parent >= 0) {
+    memcpy(buf, stage, size);
+  }
+
+  for (i = 0; i < nk; i++) {
+    coll_wait(&coll_area->from[kids[i]].ack, seq);
+  }
+
+  chpl_mem_free(stage, 0, 0);
+}
+
+
+//
+// Reductions.
+//
+
+static
+size_t coll_type_size(chpl_comm_coll_type_t type) {
+  switch (type) {
+  case CHPL_COMM_COLL_INT32:  return sizeof(int32_t);
+  case CHPL_COMM_COLL_INT64:  return sizeof(int64_t);
+  case CHPL_COMM_COLL_UINT32: return sizeof(uint32_t);
+  case CHPL_COMM_COLL_UINT64: return sizeof(uint64_t);
+  case CHPL_COMM_COLL_REAL32: return sizeof(float);
+  case CHPL_COMM_COLL_REAL64: return sizeof(double);
+  }
+  chpl_internal_error("collectives: unknown type");
+  return 0;
+}
+
+#define COLL_ARITH_CASES(T)                                              \
+  case CHPL_COMM_COLL_SUM:                                               \
+    for (i = 0; i < count; i++) a[i] += b[i];                            \
+    break;                                                               \
+  case CHPL_COMM_COLL_PROD:                                              \
+    for (i = 0; i < count; i++) a[i] *= b[i];                            \
+    break;                                                               \
+  case CHPL_COMM_COLL_MIN:                                               \
+    for (i = 0; i < count; i++) if (b[i] < a[i]) a[i] = b[i];            \
+    break;                                                               \
+  case CHPL_COMM_COLL_MAX:                                               \
+    for (i = 0; i < count; i++) if (b[i] > a[i]) a[i] = b[i];            \
+    break;
+
+#define COLL_BITWISE_CASES(T)                                            \
+  case CHPL_COMM_COLL_BAND:                                              \
+    for (i = 0; i < count; i++) a[i] &= b[i];                            \
+    break;                                                               \
+  case CHPL_COMM_COLL_BOR:                                               \
+    for (i = 0; i < count; i++) a[i] |= b[i];                            \
+    break;                                                               \
+  case CHPL_COMM_COLL_BXOR:                                              \
+    for (i = 0; i < count; i++) a[i] ^= b[i];                            \
+    break;
+
+#define COLL_NO_BITWISE_CASES(T)                                         \
+  default:                                                               \
+    chpl_internal_error("collectives: bitwise op on a real type");       \
+    break;
+
+#define DEFN_COLL_COMBINE(name, T, BITWISE)                              \
+  static void coll_combine_ ## name(void* acc, const void* in,           \
+                                    size_t count,                        \
+                                    chpl_comm_coll_op_t op) {            \
+    T* a = (T*) acc;                                                     \
+    const T* b = (const T*) in;                                          \
+    size_t i;                                                            \
+    switch (op) {                                                        \
+    COLL_ARITH_CASES(T)                                                  \
+    BITWISE(T)                                                           \
+    }                                                                    \
+  }
+
+DEFN_COLL_COMBINE(int32, int32_t, COLL_BITWISE_CASES)
+DEFN_COLL_COMBINE(int64, int64_t, COLL_BITWISE_CASES)
+DEFN_COLL_COMBINE(uint32, uint32_t, COLL_BITWISE_CASES)
+DEFN_COLL_COMBINE(uint64, uint64_t, COLL_BITWISE_CASES)
+DEFN_COLL_COMBINE(real32, float, COLL_NO_BITWISE_CASES)
+DEFN_COLL_COMBINE(real64, double, COLL_NO_BITWISE_CASES)
+
+#undef DEFN_COLL_COMBINE
+#undef COLL_NO_BITWISE_CASES
+#undef COLL_BITWISE_CASES
+#undef COLL_ARITH_CASES
+
+static
+void coll_combine(void* acc, const void* in, size_t count,
+                  chpl_comm_coll_type_t type, chpl_comm_coll_op_t op) {
+  switch (type) {
+  case CHPL_COMM_COLL_INT32:  coll_combine_int32(acc, in, count, op);  break;
+  case CHPL_COMM_COLL_INT64:  coll_combine_int64(acc, in, count, op);  break;
+  case CHPL_COMM_COLL_UINT32: coll_combine_uint32(acc, in, count, op); break;
+  case CHPL_COMM_COLL_UINT64: coll_combine_uint64(acc, in, count, op); break;
+  case CHPL_COMM_COLL_REAL32: coll_combine_real32(acc, in, count, op); break;
+  case CHPL_COMM_COLL_REAL64: coll_combine_real64(acc, in, count, op); break;
+  }
+}
+
+
+void chpl_comm_coll_reduce(c_nodeid_t root,
+                           const void* sendbuf, void* recvbuf, size_t count,
+                           chpl_comm_coll_type_t type,
+                           chpl_comm_coll_op_t op) {
+  const int64_t seq = coll_next_seq();
+  const size_t size = count * coll_type_size(type);
+  int32_t kids[coll_max_kids];
+  int32_t parent;
+  void* acc;
+  void* tmp;
+  int nk, i;
+
+  if (chpl_numNodes == 1 || size == 0) {
+    if (recvbuf != sendbuf) {
+      memmove(recvbuf, sendbuf, size);
+    }
+    return;
+  }
+
+  acc = chpl_mem_alloc(size, CHPL_RT_MD_COMM_UTIL, 0, 0);
+  memcpy(acc, sendbuf, size);
+
+  //
+  // Fold in each child's partial result as soon as it is ready, then
+  // let the child go.
+  //
+  nk = coll_children(root, chpl_nodeID, kids);
+  if (nk > 0) {
+    tmp = chpl_mem_alloc(size, CHPL_RT_MD_COMM_UTIL, 0, 0);
+    for (i = 0; i < nk; i++) {
+      coll_wait(&coll_area->from[kids[i]].seq, seq);
+      chpl_comm_get(tmp, kids[i], coll_area->from[kids[i]].addr, size,
+                    CHPL_COMM_UNKNOWN_ID, 0, -1);
+      coll_signal(kids[i], &coll_my_slot()->ack, seq);
+      coll_combine(acc, tmp, count, type, op);
+    }
+    chpl_mem_free(tmp, 0, 0);
+  }
+
+  parent = coll_parent(root, chpl_nodeID);
+  if (parent >= 0) {
+    coll_publish(parent, acc, seq);
+    coll_wait(&coll_area->from[parent].ack, seq);
+  } else {
+    memcpy(recvbuf, acc, size);
+  }
+
+  chpl_mem_free(acc, 0, 0);
+}
+
+
+//
+// Allreduce.  Small counts use recursive doubling: in round k each
+// locale swaps its partial result with the locale whose number differs
+// from its own in bit k and folds it in, so all locales have the result
+// after log2(numNodes) rounds rather than the 2*log2(numNodes) tree
+// levels of a reduce followed by a broadcast.  If the number of locales
+// isn't a power of 2, the first 2*rem of them pair up beforehand: each
+// even one hands its data to the odd one after it, sits out the rounds,
+// and gets the result back from it at the end.  Every op is
+// commutative, so both partners in a round compute the same value and
+// the locales end up with identical results.
+//
+// Larger counts use reduce and broadcast, whose node-aware trees send
+// less data between nodes.
+//
+
+#define COLL_ALLREDUCE_RD_MAX_SIZE 4096
+
+// Swap 'acc' with 'partner' and fold the partner's data into it.  We
+// may only change 'acc' once the partner has acknowledged reading it.
+static
+void coll_swap_and_combine(int32_t partner, void* acc, void* tmp,
+                           size_t count, chpl_comm_coll_type_t type,
+                           chpl_comm_coll_op_t op, int64_t seq) {
+  const size_t size = count * coll_type_size(type);
+
+  coll_publish(partner, acc, seq);
+  coll_wait(&coll_area->from[partner].seq, seq);
+  chpl_comm_get(tmp, partner, coll_area->from[partner].addr, size,
+                CHPL_COMM_UNKNOWN_ID, 0, -1);
+  coll_signal(partner, &coll_my_slot()->ack, seq);
+  coll_wait(&coll_area->from[partner].ack, seq);
+  coll_combine(acc, tmp, count, type, op);
+}
+
+static
+void coll_allreduce_recursive_doubling(const void* sendbuf, void* recvbuf,
+                                       size_t count,
+                                       chpl_comm_coll_type_t type,
+                                       chpl_comm_coll_op_t op) {
+  const int64_t seq = coll_next_seq();
+  const size_t size = count * coll_type_size(type);
+  const int32_t me = chpl_nodeID;
+  int32_t pof2, rem, rank, mask;
+  void* acc;
+  void* tmp;
+
+  if (chpl_numNodes == 1 || size == 0) {
+    if (recvbuf != sendbuf) {
+      memmove(recvbuf, sendbuf, size);
+    }
+    return;
+  }
+
+  for (pof2 = 1; pof2 * 2 <= chpl_numNodes; pof2 *= 2) ;
+  rem = chpl_numNodes - pof2;
+
+  acc = chpl_mem_alloc(size, CHPL_RT_MD_COMM_UTIL, 0, 0);
+  memcpy(acc, sendbuf, size);
+
+  if (me < 2 * rem && me % 2 == 0) {
+    // Hand our data to the next locale and wait for the result.
+    coll_publish(me + 1, acc, seq);
+    coll_wait(&coll_area->from[me + 1].ack, seq);
+    coll_wait(&coll_area->from[me + 1].seq, seq);
+    chpl_comm_get(acc, me + 1, coll_area->from[me + 1].addr, size,
+                  CHPL_COMM_UNKNOWN_ID, 0, -1);
+    coll_signal(me + 1, &coll_my_slot()->ack, seq);
+    memcpy(recvbuf, acc, size);
+    chpl_mem_free(acc, 0, 0);
+    return;
+  }
+
+  tmp = chpl_mem_alloc(size, CHPL_RT_MD_COMM_UTIL, 0, 0);
+
+  if (me < 2 * rem) {
+    coll_wait(&coll_area->from[me - 1].seq, seq);
+    chpl_comm_get(tmp, me - 1, coll_area->from[me - 1].addr, size,
+                  CHPL_COMM_UNKNOWN_ID, 0, -1);
+    coll_signal(me - 1, &coll_my_slot()->ack, seq);
+    coll_combine(acc, tmp, count, type, op);
+    rank = me / 2;
+  } else {
+    rank = me - rem;
+  }
+
+  // 'rank' numbers the locales taking part in the rounds 0..pof2-1.
+  for (mask = 1; mask < pof2; mask <<= 1) {
+    const int32_t prank = rank ^ mask;
+    const int32_t partner = (prank < rem) ? 2 * prank + 1 : prank + rem;
+    coll_swap_and_combine(partner, acc, tmp, count, type, op, seq);
+  }
+
+  if (me < 2 * rem) {
+    coll_publish(me - 1, acc, seq);
+    coll_wait(&coll_area->from[me - 1].ack, seq);
+  }
+
+  memcpy(recvbuf, acc, size);
+
+  chpl_mem_free(tmp, 0, 0);
+  chpl_mem_free(acc, 0, 0);
+}
+
+
+void chpl_comm_coll_allreduce(const void* sendbuf, void* recvbuf,
+                              size_t count,
+                              chpl_comm_coll_type_t type,
+                              chpl_comm_coll_op_t op) {
+  if (count * coll_type_size(type) <= COLL_ALLREDUCE_RD_MAX_SIZE) {
+    coll_allreduce_recursive_doubling(sendbuf, recvbuf, count, type, op);
+  } else {
+    chpl_comm_coll_reduce(0, sendbuf, recvbuf, count, type, op);
+    chpl_comm_coll_broadcast(0, recvbuf, count * coll_type_size(type));
+  }
+}
+
+
+//
+// Allgather: gather up the tree to locale 0, then broadcast.  Every
+// staging buffer is full size, with each locale's block at its final
+// offset.  A child's subtree is not contiguous in the node-aware tree,
+// so we pull exactly its subtree's blocks with one indexed GET.
+//
+
+void chpl_comm_coll_allgather(const void* sendbuf, void* recvbuf,
+                              size_t size) {
+  const int64_t seq = coll_next_seq();
+  const size_t total = chpl_numNodes * size;
+  int32_t kids[coll_max_kids];
+  int32_t parent;
+  char* stage;
+  int nk, i;
+
+  if (chpl_numNodes == 1 || size == 0) {
+    memmove(recvbuf, sendbuf, size);
+    return;
+  }
+
+  stage = chpl_mem_alloc(total, CHPL_RT_MD_COMM_UTIL, 0, 0);
+  memcpy(stage + chpl_nodeID * size, sendbuf, size);
+
+  nk = coll_children(0, chpl_nodeID, kids);
+  if (nk > 0) {
+    int32_t* members = chpl_mem_allocMany(chpl_numNodes, sizeof(*members),
+                                          CHPL_RT_MD_COMM_UTIL, 0, 0);
+    void** dstlist = chpl_mem_allocMany(chpl_numNodes, sizeof(*dstlist),
+                                        CHPL_RT_MD_COMM_UTIL, 0, 0);
+    void** srclist = chpl_mem_allocMany(chpl_numNodes, sizeof(*srclist),
+                                        CHPL_RT_MD_COMM_UTIL, 0, 0);
+    for (i = 0; i < nk; i++) {
+      char* kidStage;
+      int32_t n = 0, j;
+
+      coll_subtree(0, kids[i], members, &n);
+      coll_wait(&coll_area->from[kids[i]].seq, seq);
+      kidStage = coll_area->from[kids[i]].addr;
+      for (j = 0; j < n; j++) {
+        dstlist[j] = stage + members[j] * size;
+        srclist[j] = kidStage + members[j] * size;
+      }
+      chpl_comm_get_indexed(n, dstlist, size, kids[i], n, srclist, size,
+                            CHPL_COMM_UNKNOWN_ID, 0, -1);
+      coll_signal(kids[i], &coll_my_slot()->ack, seq);
+    }
+    chpl_mem_free(srclist, 0, 0);
+    chpl_mem_free(dstlist, 0, 0);
+    chpl_mem_free(members, 0, 0);
+  }
+
+  parent = coll_parent(0, chpl_nodeID);
+  if (parent >= 0) {
+    coll_publish(parent, stage, seq);
+    coll_wait(&coll_area->from[parent].ack, seq);
+  } else {
+    memcpy(recvbuf, stage, total);
+  }
+
+  chpl_mem_free(stage, 0, 0);
+
+  chpl_comm_coll_broadcast(0, recvbuf, total);
+}
@@ -26,6 +26,7 @@
 
 #include "chpl-align.h"
 #include "chpl-comm.h"
+#include "chpl-comm-coll.h"
 #include "chpl-comm-compiler-macros.h"
 #include "chpl-comm-diags.h"
 #include "chpl-comm-internal.h"
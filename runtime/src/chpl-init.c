@@ -26,6 +26,7 @@
 #include "chplcgfns.h"
 #include "chpl-cache.h"
 #include "chpl-comm.h"
+#include "chpl-comm-coll.h"
 #include "chplexit.h"
 #include "chplio.h"
 #include "chpl-gpu.h"
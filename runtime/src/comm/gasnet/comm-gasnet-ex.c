@@ -23,11 +23,13 @@
 #include "gasnet.h"
 #include "gasnet_vis.h"
 #include "gasnet_coll.h"
+#include "gasnet_ratomic.h"
 #include "chpl-comm.h"
 #include "chpl-comm-diags.h"
 #include "chpl-comm-callbacks.h"
 #include "chpl-comm-callbacks-internal.h"
 #include "chpl-comm-internal.h"
+#include "chpl-comm-strd-xfer.h"
 #include "chpl-env.h"
 #include "chpl-mem.h"
 #include "chplsys.h"
@@ -237,6 +239,44 @@ typedef struct {
   size_t size; // number of bytes.
 } xfer_info_t;
 
+//
+// Operands and results of atomic operations.
+//
+typedef enum {
+  amo_int32,
+  amo_int64,
+  amo_uint32,
+  amo_uint64,
+  amo_real32,
+  amo_real64,
+  amo_num_types
+} amo_type_t;
+
+typedef union {
+  int32_t  i32;
+  int64_t  i64;
+  uint32_t u32;
+  uint64_t u64;
+  _real32  r32;
+  _real64  r64;
+} amo_datum_t;
+
+typedef struct {
+  void*       ack;     // acknowledgement object
+  void*       result;  // result address on the requester, or NULL
+  void*       object;  // target object
+  gex_OP_t    op;      // GEX_OP_* operation
+  amo_type_t  type;
+  amo_datum_t opnd1;
+  amo_datum_t opnd2;
+} amo_req_t;
+
+typedef struct {
+  void*       ack;     // acknowledgement object
+  void*       result;  // result address on the requester, or NULL
+  amo_datum_t value;   // result value
+} amo_reply_t;
+
 
 //
 // AM functions
@@ -258,7 +298,9 @@ typedef enum {
   FREE,                 // free data at addr
   SHUTDOWN,             // tell nodes to get ready for shutdown
   DO_REPLY_PUT,         // do a PUT here from another locale
-  DO_COPY_PAYLOAD       // copy AM payload to another address
+  DO_COPY_PAYLOAD,      // copy AM payload to another address
+  DO_AMO,               // do an atomic op here on the CPU
+  AMO_REPLY             // return an atomic op result and ack a done_t
 } AM_handler_function_idx_t;
 
 static void AM_fork_fast(gasnet_token_t token, void* buf, size_t nbytes) {
@@ -566,6 +608,36 @@ void AM_copy_payload(gasnet_token_t token, void* buf, size_t nbytes,
   GASNET_Safe(gasnet_AMReplyShort2(token, SIGNAL, ack0, ack1));
 }
 
+static void do_cpu_amo(void*, gex_OP_t, amo_type_t,
+                       const amo_datum_t*, const amo_datum_t*, amo_datum_t*);
+
+// Do an atomic op on an object outside our segment, for another locale.
+static void AM_amo(gasnet_token_t token, void* buf, size_t nbytes) {
+  amo_req_t* req = buf;
+  amo_reply_t rep = { .ack = req->ack, .result = req->result };
+
+  assert(nbytes == sizeof(amo_req_t));
+
+  do_cpu_amo(req->object, req->op, req->type,
+             &req->opnd1, &req->opnd2, &rep.value);
+
+  GASNET_Safe(gasnet_AMReplyMedium0(token, AMO_REPLY, &rep, sizeof(rep)));
+}
+
+static void AM_amo_reply(gasnet_token_t token, void* buf, size_t nbytes) {
+  amo_reply_t* rep = buf;
+  done_t* done = (done_t*) rep->ack;
+  uint_least32_t prev;
+
+  if (rep->result != NULL)
+    memcpy(rep->result, &rep->value, sizeof(rep->value));
+
+  prev = atomic_fetch_add_explicit_uint_least32_t(&done->count, 1,
+                                                  memory_order_seq_cst);
+  if (prev + 1 == done->target)
+    done->flag = 1;
+}
+
 static gex_AM_Entry_t ftable[] = {
   {FORK,             AM_fork,             GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_fork"             },
   {FORK_SMALL,       AM_fork_small,       GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_fork_small"       },
@@ -582,7 +654,9 @@ static gex_AM_Entry_t ftable[] = {
   {FREE,             AM_free,             GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_SHORT,  2, NULL, "AM_free"             },
   {SHUTDOWN,         AM_shutdown,         GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_SHORT,  0, NULL, "AM_shutdown"         },
   {DO_REPLY_PUT,     AM_reply_put,        GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_reply_put"        },
-  {DO_COPY_PAYLOAD,  AM_copy_payload,     GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 4, NULL, "AM_copy_payload"     }
+  {DO_COPY_PAYLOAD,  AM_copy_payload,     GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 4, NULL, "AM_copy_payload"     },
+  {DO_AMO,           AM_amo,              GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_amo"              },
+  {AMO_REPLY,        AM_amo_reply,        GEX_FLAG_AM_REPLY   | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_amo_reply"        }
 };
 
 //
@@ -663,10 +737,10 @@ chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node, void* raddr,
 
 int chpl_comm_test_nb_complete(chpl_comm_nb_handle_t h)
 {
-  return ((void*)h) == GEX_EVENT_INVALID;
-  // TODO GEX Note that this just checks if the op was blocking, if we want
-  // this to check if a non-blocking op is complete it should be:
-  // return gex_Event_Test((gex_Event_t) h) == GASNET_OK;
+  // gex_Event_Test() polls but does not block, and is GASNET_OK for
+  // GEX_EVENT_INVALID, the handle for blocking fallbacks and for events
+  // already reaped by chpl_comm_{wait,try}_nb_some().
+  return gex_Event_Test((gex_Event_t) h) == GASNET_OK;
 }
 
 void chpl_comm_wait_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles)
@@ -928,8 +1002,11 @@ void chpl_comm_pre_mem_init(void) {
   gasnet_set_waitmode(GASNET_WAIT_BLOCK);
 }
 
+static void setup_atomic_domains(void);
+
 void chpl_comm_post_mem_init(void) {
   chpl_comm_init_prv_bcast_tab();
+  setup_atomic_domains();
 }
 
 //
@@ -1291,15 +1368,31 @@ void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
   }
 }
 
+//
+// Wait for a GASNet event to complete, letting other tasks run while it
+// is in flight.
+//
+static inline
+void wait_event_yield(gex_Event_t ev) {
+  while (gex_Event_Test(ev) != GASNET_OK) {
+    chpl_task_yield();
+  }
+}
+
 //
 // This is an adapter from Chapel code to GASNet's VIS interface. It does:
 // * convert count[0] and all of 'srcstr' and 'dststr' from counts of element
 //   to counts of bytes,
+// GASNet copies the stride and count metadata during initiation, so the
+// VLAs here can go away as soon as the NB call returns.
 //
-void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_id,
-                         void* srcaddr, size_t* srcstrides, size_t* count,
-                         int32_t stridelevels, size_t elemSize, int32_t commID,
-                         int ln, int32_t fn) {
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode_id,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
   int i;
   const size_t strlvls = (size_t)stridelevels;
   // Avoid 0-lengh VLA when stridelevels is 0 (contiguous transfer), gasnet
@@ -1334,15 +1427,19 @@ void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_i
   }
 
   // TODO -- handle strided get for non-registered memory
-  // TODO GEX convert to NB with task-yield
-  gex_VIS_StridedGetBlocking(myteam, dstaddr, dststr, srcnode, srcaddr, srcstr, elemsz, cnt, strlvls, GEX_NO_FLAGS);
-}
-
-// See the comment for chpl_comm_get_strd().
-void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_id,
-                         void* srcaddr, size_t* srcstrides, size_t* count,
-                         int32_t stridelevels, size_t elemSize, int32_t commID,
-                         int ln, int32_t fn) {
+  return (chpl_comm_nb_handle_t)
+         gex_VIS_StridedGetNB(myteam, dstaddr, dststr, srcnode, srcaddr,
+                              srcstr, elemsz, cnt, strlvls, GEX_NO_FLAGS);
+}
+
+// See the comment for chpl_comm_get_strd_nb().
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode_id,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
   int i;
   const size_t strlvls = (size_t)stridelevels;
   // Avoid 0-lengh VLA when stridelevels is 0 (contiguous transfer), gasnet
@@ -1377,8 +1474,135 @@ void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_i
   }
 
   // TODO -- handle strided put for non-registered memory
-  // TODO GEX convert to NB with task-yield
-  gex_VIS_StridedPutBlocking(myteam, dstnode, dstaddr, dststr, srcaddr, srcstr, elemsz, cnt, strlvls, GEX_NO_FLAGS);
+  return (chpl_comm_nb_handle_t)
+         gex_VIS_StridedPutNB(myteam, dstnode, dstaddr, dststr, srcaddr,
+                              srcstr, elemsz, cnt, strlvls, GEX_NO_FLAGS);
+}
+
+void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_id,
+                         void* srcaddr, size_t* srcstrides, size_t* count,
+                         int32_t stridelevels, size_t elemSize, int32_t commID,
+                         int ln, int32_t fn) {
+  wait_event_yield((gex_Event_t)
+                   chpl_comm_get_strd_nb(dstaddr, dststrides, srcnode_id,
+                                         srcaddr, srcstrides, count,
+                                         stridelevels, elemSize, commID,
+                                         ln, fn));
+}
+
+void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_id,
+                         void* srcaddr, size_t* srcstrides, size_t* count,
+                         int32_t stridelevels, size_t elemSize, int32_t commID,
+                         int ln, int32_t fn) {
+  wait_event_yield((gex_Event_t)
+                   chpl_comm_put_strd_nb(dstaddr, dststrides, dstnode_id,
+                                         srcaddr, srcstrides, count,
+                                         stridelevels, elemSize, commID,
+                                         ln, fn));
+}
+
+//
+// Indexed transfers go to gex_VIS_Indexed{Put,Get}NB(), which need all
+// the remote pieces to be in the remote segment.  If any of them isn't
+// we fall back to the common implementation, whose contiguous NB
+// transfers already know how to deal with that.
+//
+static const size_t indexed_maxHandles = 16;
+
+static int indexed_in_segment(c_nodeid_t node, size_t count,
+                              void* const list[], size_t len) {
+#ifdef GASNET_SEGMENT_EVERYTHING
+  return 1;
+#else
+  size_t i;
+
+  for (i = 0; i < count; i++) {
+    if (!chpl_comm_addr_gettable(node, list[i], len)) {
+      return 0;
+    }
+  }
+  return 1;
+#endif
+}
+
+chpl_comm_nb_handle_t chpl_comm_put_indexed_nb(c_nodeid_t dstnode,
+                                               size_t dstcount,
+                                               void* const dstlist[],
+                                               size_t dstlen,
+                                               size_t srccount,
+                                               void* const srclist[],
+                                               size_t srclen,
+                                               int32_t commID,
+                                               int ln, int32_t fn) {
+  if (!indexed_in_segment(dstnode, dstcount, dstlist, dstlen)) {
+    put_indexed_common(dstnode, dstcount, dstlist, dstlen,
+                       srccount, srclist, srclen,
+                       indexed_maxHandles, chpl_task_yield,
+                       commID, ln, fn);
+    return (chpl_comm_nb_handle_t) GEX_EVENT_INVALID;
+  }
+
+  chpl_comm_diags_verbose_rdmaIdx("put", dstnode, dstcount, ln, fn, commID);
+  if (chpl_nodeID != dstnode) {
+    chpl_comm_diags_incr(put);
+  }
+
+  return (chpl_comm_nb_handle_t)
+         gex_VIS_IndexedPutNB(myteam, (gex_Rank_t)dstnode,
+                              dstcount, dstlist, dstlen,
+                              srccount, srclist, srclen, GEX_NO_FLAGS);
+}
+
+chpl_comm_nb_handle_t chpl_comm_get_indexed_nb(size_t dstcount,
+                                               void* const dstlist[],
+                                               size_t dstlen,
+                                               c_nodeid_t srcnode,
+                                               size_t srccount,
+                                               void* const srclist[],
+                                               size_t srclen,
+                                               int32_t commID,
+                                               int ln, int32_t fn) {
+  if (!indexed_in_segment(srcnode, srccount, srclist, srclen)) {
+    get_indexed_common(dstcount, dstlist, dstlen, srcnode,
+                       srccount, srclist, srclen,
+                       indexed_maxHandles, chpl_task_yield,
+                       commID, ln, fn);
+    return (chpl_comm_nb_handle_t) GEX_EVENT_INVALID;
+  }
+
+  chpl_comm_diags_verbose_rdmaIdx("get", srcnode, srccount, ln, fn, commID);
+  if (chpl_nodeID != srcnode) {
+    chpl_comm_diags_incr(get);
+  }
+
+  return (chpl_comm_nb_handle_t)
+         gex_VIS_IndexedGetNB(myteam, dstcount, dstlist, dstlen,
+                              (gex_Rank_t)srcnode,
+                              srccount, srclist, srclen, GEX_NO_FLAGS);
+}
+
+void chpl_comm_put_indexed(c_nodeid_t dstnode,
+                           size_t dstcount, void* const dstlist[],
+                           size_t dstlen,
+                           size_t srccount, void* const srclist[],
+                           size_t srclen,
+                           int32_t commID, int ln, int32_t fn) {
+  wait_event_yield((gex_Event_t)
+                   chpl_comm_put_indexed_nb(dstnode, dstcount, dstlist, dstlen,
+                                            srccount, srclist, srclen,
+                                            commID, ln, fn));
+}
+
+void chpl_comm_get_indexed(size_t dstcount, void* const dstlist[],
+                           size_t dstlen,
+                           c_nodeid_t srcnode,
+                           size_t srccount, void* const srclist[],
+                           size_t srclen,
+                           int32_t commID, int ln, int32_t fn) {
+  wait_event_yield((gex_Event_t)
+                   chpl_comm_get_indexed_nb(dstcount, dstlist, dstlen, srcnode,
+                                            srccount, srclist, srclen,
+                                            commID, ln, fn));
 }
 
 #define MAX_UNORDERED_TRANS_SZ 1024
@@ -1617,3 +1841,457 @@ void  chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
                       /*fast*/ true, /*blocking*/ true);
   }
 }
+
+////////////////////////////////////////
+//
+// Interface: network atomics
+//
+
+//
+// Remote atomics are done through GASNet-EX atomic domains, one per
+// Chapel atomic type, created collectively once the segment is
+// attached.  GASNet only guarantees atomicity among operations done
+// through the same domain, so we use the domain even when the target
+// is this locale.
+//
+// A domain can only reach objects in the target's segment.  Atomic ops
+// on other objects are done on the target's CPU, by us if the target
+// is this locale and otherwise in an AM handler there.  All the ops on
+// a given object agree on which of these paths to take, so the domain
+// and CPU atomics are never mixed on one object.
+//
+
+#define AMO_INT_OPS                                                     \
+  (GEX_OP_SET | GEX_OP_GET | GEX_OP_SWAP | GEX_OP_FCAS                  \
+   | GEX_OP_AND | GEX_OP_FAND | GEX_OP_OR | GEX_OP_FOR                  \
+   | GEX_OP_XOR | GEX_OP_FXOR | GEX_OP_ADD | GEX_OP_FADD                \
+   | GEX_OP_SUB | GEX_OP_FSUB)
+
+#define AMO_REAL_OPS                                                    \
+  (GEX_OP_SET | GEX_OP_GET | GEX_OP_SWAP | GEX_OP_FCAS                  \
+   | GEX_OP_ADD | GEX_OP_FADD | GEX_OP_SUB | GEX_OP_FSUB)
+
+static gex_AD_t amo_domains[amo_num_types];
+
+static const gex_DT_t amo_gex_types[amo_num_types] = {
+  [amo_int32]  = GEX_DT_I32,
+  [amo_int64]  = GEX_DT_I64,
+  [amo_uint32] = GEX_DT_U32,
+  [amo_uint64] = GEX_DT_U64,
+  [amo_real32] = GEX_DT_FLT,
+  [amo_real64] = GEX_DT_DBL,
+};
+
+static const size_t amo_sizes[amo_num_types] = {
+  [amo_int32]  = sizeof(int32_t),
+  [amo_int64]  = sizeof(int64_t),
+  [amo_uint32] = sizeof(uint32_t),
+  [amo_uint64] = sizeof(uint64_t),
+  [amo_real32] = sizeof(_real32),
+  [amo_real64] = sizeof(_real64),
+};
+
+static void setup_atomic_domains(void) {
+  for (int t = 0; t < amo_num_types; t++) {
+    gex_OP_t ops = (t == amo_real32 || t == amo_real64)
+                   ? AMO_REAL_OPS
+                   : AMO_INT_OPS;
+    gex_AD_Create(&amo_domains[t], myteam, amo_gex_types[t], ops,
+                  GEX_NO_FLAGS);
+  }
+}
+
+static inline
+gex_Flags_t amo_order_flags(memory_order order) {
+  switch (order) {
+  case memory_order_relaxed:
+    return GEX_NO_FLAGS;
+  case memory_order_consume:
+  case memory_order_acquire:
+    return GEX_FLAG_AD_ACQ;
+  case memory_order_release:
+    return GEX_FLAG_AD_REL;
+  default:
+    return GEX_FLAG_AD_ACQ | GEX_FLAG_AD_REL;
+  }
+}
+
+static inline
+chpl_bool amo_in_segment(c_nodeid_t node, void* object, size_t size) {
+#ifdef GASNET_SEGMENT_EVERYTHING
+  return true;
+#else
+  return chpl_comm_addr_gettable(node, object, size);
+#endif
+}
+
+//
+// Start an atomic op through the domain for the given type.  The
+// result, if any, is valid once the returned event completes.
+//
+static inline
+gex_Event_t amo_start(amo_type_t type, amo_datum_t* result,
+                      c_nodeid_t node, void* object, gex_OP_t op,
+                      const amo_datum_t* opnd1, const amo_datum_t* opnd2,
+                      gex_Flags_t flags) {
+  gex_AD_t ad = amo_domains[type];
+
+  switch (type) {
+  case amo_int32:
+    return gex_AD_OpNB_I32(ad, result ? &result->i32 : NULL, node, object,
+                           op, opnd1->i32, opnd2->i32, flags);
+  case amo_int64:
+    return gex_AD_OpNB_I64(ad, result ? &result->i64 : NULL, node, object,
+                           op, opnd1->i64, opnd2->i64, flags);
+  case amo_uint32:
+    return gex_AD_OpNB_U32(ad, result ? &result->u32 : NULL, node, object,
+                           op, opnd1->u32, opnd2->u32, flags);
+  case amo_uint64:
+    return gex_AD_OpNB_U64(ad, result ? &result->u64 : NULL, node, object,
+                           op, opnd1->u64, opnd2->u64, flags);
+  case amo_real32:
+    return gex_AD_OpNB_FLT(ad, result ? &result->r32 : NULL, node, object,
+                           op, opnd1->r32, opnd2->r32, flags);
+  case amo_real64:
+    return gex_AD_OpNB_DBL(ad, result ? &result->r64 : NULL, node, object,
+                           op, opnd1->r64, opnd2->r64, flags);
+  default:
+    chpl_internal_error("unknown atomic type");
+  }
+
+  return GEX_EVENT_INVALID;
+}
+
+//
+// Do an atomic op on the CPU.  For GEX_OP_FCAS, opnd1 is the value to
+// compare against and opnd2 the value to store; the old value is
+// returned either way.
+//
+static void do_cpu_amo(void* obj, gex_OP_t op, amo_type_t type,
+                       const amo_datum_t* opnd1, const amo_datum_t* opnd2,
+                       amo_datum_t* result) {
+#define CPU_AMO_COMMON(_t, _m)                                          \
+  case GEX_OP_SET:                                                      \
+    atomic_store_##_t((atomic_##_t*) obj, opnd1->_m);                   \
+    break;                                                              \
+  case GEX_OP_GET:                                                      \
+    result->_m = atomic_load_##_t((atomic_##_t*) obj);                  \
+    break;                                                              \
+  case GEX_OP_SWAP:                                                     \
+    result->_m = atomic_exchange_##_t((atomic_##_t*) obj, opnd1->_m);   \
+    break;                                                              \
+  case GEX_OP_FCAS:                                                     \
+    {                                                                   \
+      _t cmpr = opnd1->_m;                                              \
+      (void) atomic_compare_exchange_strong_##_t((atomic_##_t*) obj,    \
+                                                 &cmpr, opnd2->_m);     \
+      result->_m = cmpr;                                                \
+    }                                                                   \
+    break;                                                              \
+  case GEX_OP_ADD:                                                      \
+  case GEX_OP_FADD:                                                     \
+    result->_m = atomic_fetch_add_##_t((atomic_##_t*) obj, opnd1->_m);  \
+    break;                                                              \
+  case GEX_OP_SUB:                                                      \
+  case GEX_OP_FSUB:                                                     \
+    result->_m = atomic_fetch_sub_##_t((atomic_##_t*) obj, opnd1->_m);  \
+    break;
+
+#define CPU_AMO_BITWISE(_t, _m)                                         \
+  case GEX_OP_AND:                                                      \
+  case GEX_OP_FAND:                                                     \
+    result->_m = atomic_fetch_and_##_t((atomic_##_t*) obj, opnd1->_m);  \
+    break;                                                              \
+  case GEX_OP_OR:                                                       \
+  case GEX_OP_FOR:                                                      \
+    result->_m = atomic_fetch_or_##_t((atomic_##_t*) obj, opnd1->_m);   \
+    break;                                                              \
+  case GEX_OP_XOR:                                                      \
+  case GEX_OP_FXOR:                                                     \
+    result->_m = atomic_fetch_xor_##_t((atomic_##_t*) obj, opnd1->_m);  \
+    break;
+
+#define CPU_AMO_INT(_t, _m)                                             \
+  switch (op) {                                                         \
+  CPU_AMO_COMMON(_t, _m)                                                \
+  CPU_AMO_BITWISE(_t, _m)                                               \
+  default:                                                              \
+    chpl_internal_error("unsupported atomic op");                       \
+  }
+
+#define CPU_AMO_REAL(_t, _m)                                            \
+  switch (op) {                                                         \
+  CPU_AMO_COMMON(_t, _m)                                                \
+  default:                                                              \
+    chpl_internal_error("unsupported atomic op");                       \
+  }
+
+  switch (type) {
+  case amo_int32:  CPU_AMO_INT(int_least32_t, i32);   break;
+  case amo_int64:  CPU_AMO_INT(int_least64_t, i64);   break;
+  case amo_uint32: CPU_AMO_INT(uint_least32_t, u32);  break;
+  case amo_uint64: CPU_AMO_INT(uint_least64_t, u64);  break;
+  case amo_real32: CPU_AMO_REAL(_real32, r32);        break;
+  case amo_real64: CPU_AMO_REAL(_real64, r64);        break;
+  default:
+    chpl_internal_error("unknown atomic type");
+  }
+
+#undef CPU_AMO_COMMON
+#undef CPU_AMO_BITWISE
+#undef CPU_AMO_INT
+#undef CPU_AMO_REAL
+}
+
+//
+// Do an atomic op on an object on the given locale and wait for it to
+// complete.  If result is non-NULL, the object's prior value is
+// returned there.
+//
+static void do_amo(c_nodeid_t node, void* object, gex_OP_t op,
+                   amo_type_t type, const void* opnd1, const void* opnd2,
+                   void* result, memory_order order) {
+  size_t size = amo_sizes[type];
+  amo_datum_t v1, v2, res;
+
+  memset(&v1, 0, sizeof(v1));
+  memset(&v2, 0, sizeof(v2));
+  if (opnd1 != NULL)
+    memcpy(&v1, opnd1, size);
+  if (opnd2 != NULL)
+    memcpy(&v2, opnd2, size);
+
+  if (amo_in_segment(node, object, size)) {
+    gex_Event_Wait(amo_start(type, result ? &res : NULL, node, object, op,
+                             &v1, &v2, amo_order_flags(order)));
+  } else if (node == chpl_nodeID) {
+    do_cpu_amo(object, op, type, &v1, &v2, &res);
+  } else {
+    amo_req_t req = { .result = result ? &res : NULL, .object = object,
+                      .op = op, .type = type, .opnd1 = v1, .opnd2 = v2 };
+    done_t done;
+
+    init_done_obj(&done, 1);
+    req.ack = &done;
+    GASNET_Safe(gasnet_AMRequestMedium0(node, DO_AMO, &req, sizeof(req)));
+    wait_done_obj(&done, false);
+  }
+
+  if (result != NULL)
+    memcpy(result, &res, size);
+}
+
+
+/*
+ *** START OF NON-FETCHING BUFFERED ATOMIC OPERATIONS ***
+ *
+ * The unordered non-fetching ops only have to be complete by the next
+ * chpl_comm_atomic_unordered_task_fence() or the end of the task, so
+ * we start them and keep their events in a task-private buffer rather
+ * than waiting for each one.  That lets many of them be in flight at
+ * once.
+ */
+
+//
+// Maximum number of unordered AMOs a task has in flight.  This is a
+// provisional value, not yet tuned.
+//
+#define MAX_AMO_NF_IN_FLIGHT 64
+
+typedef struct {
+  int         vi;
+  gex_Event_t ev_v[MAX_AMO_NF_IN_FLIGHT];
+} amo_nf_buff_task_info_t;
+
+static inline
+amo_nf_buff_task_info_t* amo_nf_buff_acquire(void) {
+  chpl_task_infoRuntime_t* infoRuntime = chpl_task_getInfoRuntime();
+  chpl_comm_taskPrvData_t* prvData;
+
+  if (infoRuntime == NULL)
+    return NULL;
+
+  prvData = &infoRuntime->comm_data;
+  if (prvData->amo_nf_buff == NULL) {
+    prvData->amo_nf_buff =
+      chpl_mem_allocManyZero(1, sizeof(amo_nf_buff_task_info_t),
+                             CHPL_RT_MD_COMM_UTIL, 0, 0);
+  }
+  return prvData->amo_nf_buff;
+}
+
+static inline
+void amo_nf_buff_flush(amo_nf_buff_task_info_t* info) {
+  if (info->vi > 0) {
+    gex_Event_WaitAll(info->ev_v, info->vi, GEX_NO_FLAGS);
+    info->vi = 0;
+  }
+}
+
+static inline
+void do_amo_nf_buff(c_nodeid_t node, void* object, gex_OP_t op,
+                    amo_type_t type, const void* opnd) {
+  size_t size = amo_sizes[type];
+  amo_nf_buff_task_info_t* info;
+  amo_datum_t v1, v2;
+
+  if (!amo_in_segment(node, object, size)
+      || (info = amo_nf_buff_acquire()) == NULL) {
+    do_amo(node, object, op, type, opnd, NULL, NULL, memory_order_relaxed);
+    return;
+  }
+
+  memset(&v1, 0, sizeof(v1));
+  memset(&v2, 0, sizeof(v2));
+  memcpy(&v1, opnd, size);
+
+  info->ev_v[info->vi++] = amo_start(type, NULL, node, object, op,
+                                     &v1, &v2, GEX_NO_FLAGS);
+
+  // flush if the buffer is full
+  if (info->vi == MAX_AMO_NF_IN_FLIGHT) {
+    amo_nf_buff_flush(info);
+  }
+}
+
+void chpl_comm_atomic_unordered_task_fence(void) {
+  chpl_task_infoRuntime_t* infoRuntime = chpl_task_getInfoRuntime();
+
+  if (infoRuntime != NULL && infoRuntime->comm_data.amo_nf_buff != NULL) {
+    amo_nf_buff_flush(infoRuntime->comm_data.amo_nf_buff);
+  }
+}
+
+void chpl_comm_impl_task_end(void) {
+  chpl_task_infoRuntime_t* infoRuntime = chpl_task_getInfoRuntime();
+
+  if (infoRuntime != NULL && infoRuntime->comm_data.amo_nf_buff != NULL) {
+    amo_nf_buff_flush(infoRuntime->comm_data.amo_nf_buff);
+    chpl_mem_free(infoRuntime->comm_data.amo_nf_buff, 0, 0);
+    infoRuntime->comm_data.amo_nf_buff = NULL;
+  }
+}
+/*** END OF NON-FETCHING BUFFERED ATOMIC OPERATIONS ***/
+
+
+#define DEFN_CHPL_COMM_ATOMIC_WRITE(fnType)                             \
+  void chpl_comm_atomic_write_##fnType                                  \
+         (void* desired, c_nodeid_t node, void* object,                 \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo write", node, ln, fn);             \
+    chpl_comm_diags_incr(amo);                                          \
+    do_amo(node, object, GEX_OP_SET, amo_##fnType,                      \
+           desired, NULL, NULL, order);                                 \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_READ(fnType)                              \
+  void chpl_comm_atomic_read_##fnType                                   \
+         (void* result, c_nodeid_t node, void* object,                  \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo read", node, ln, fn);              \
+    chpl_comm_diags_incr(amo);                                          \
+    do_amo(node, object, GEX_OP_GET, amo_##fnType,                      \
+           NULL, NULL, result, order);                                  \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_XCHG(fnType)                              \
+  void chpl_comm_atomic_xchg_##fnType                                   \
+         (void* desired, c_nodeid_t node, void* object, void* result,   \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo xchg", node, ln, fn);              \
+    chpl_comm_diags_incr(amo);                                          \
+    do_amo(node, object, GEX_OP_SWAP, amo_##fnType,                     \
+           desired, NULL, result, order);                               \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_CMPXCHG(fnType)                           \
+  void chpl_comm_atomic_cmpxchg_##fnType                                \
+         (void* expected, void* desired, c_nodeid_t node, void* object, \
+          chpl_bool32* result, memory_order succ, memory_order fail,    \
+          int ln, int32_t fn) {                                         \
+    size_t size = amo_sizes[amo_##fnType];                              \
+    amo_datum_t old;                                                    \
+    chpl_comm_diags_verbose_amo("amo cmpxchg", node, ln, fn);           \
+    chpl_comm_diags_incr(amo);                                          \
+    do_amo(node, object, GEX_OP_FCAS, amo_##fnType,                     \
+           expected, desired, &old, succ);                              \
+    *result = (chpl_bool32) (memcmp(&old, expected, size) == 0);        \
+    if (!*result) memcpy(expected, &old, size);                         \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_BINARY(fnOp, gexOp, fnType)               \
+  void chpl_comm_atomic_##fnOp##_##fnType                               \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo " #fnOp, node, ln, fn);            \
+    chpl_comm_diags_incr(amo);                                          \
+    do_amo(node, object, GEX_OP_##gexOp, amo_##fnType,                  \
+           operand, NULL, NULL, order);                                 \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_##fnOp##_unordered_##fnType                     \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          int ln, int32_t fn) {                                         \
+    chpl_comm_diags_verbose_amo("amo unord_" #fnOp, node, ln, fn);      \
+    chpl_comm_diags_incr(amo);                                          \
+    do_amo_nf_buff(node, object, GEX_OP_##gexOp, amo_##fnType,          \
+                   operand);                                            \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_fetch_##fnOp##_##fnType                         \
+         (void* operand, c_nodeid_t node, void* object, void* result,   \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo fetch_" #fnOp, node, ln, fn);      \
+    chpl_comm_diags_incr(amo);                                          \
+    do_amo(node, object, GEX_OP_F##gexOp, amo_##fnType,                 \
+           operand, NULL, result, order);                               \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_ALL_TYPES(DEFN)                           \
+  DEFN(int32)                                                           \
+  DEFN(int64)                                                           \
+  DEFN(uint32)                                                          \
+  DEFN(uint64)                                                          \
+  DEFN(real32)                                                          \
+  DEFN(real64)
+
+DEFN_CHPL_COMM_ATOMIC_ALL_TYPES(DEFN_CHPL_COMM_ATOMIC_WRITE)
+DEFN_CHPL_COMM_ATOMIC_ALL_TYPES(DEFN_CHPL_COMM_ATOMIC_READ)
+DEFN_CHPL_COMM_ATOMIC_ALL_TYPES(DEFN_CHPL_COMM_ATOMIC_XCHG)
+DEFN_CHPL_COMM_ATOMIC_ALL_TYPES(DEFN_CHPL_COMM_ATOMIC_CMPXCHG)
+
+DEFN_CHPL_COMM_ATOMIC_BINARY(and, AND, int32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(and, AND, int64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(and, AND, uint32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(and, AND, uint64)
+
+DEFN_CHPL_COMM_ATOMIC_BINARY(or, OR, int32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(or, OR, int64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(or, OR, uint32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(or, OR, uint64)
+
+DEFN_CHPL_COMM_ATOMIC_BINARY(xor, XOR, int32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(xor, XOR, int64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(xor, XOR, uint32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(xor, XOR, uint64)
+
+DEFN_CHPL_COMM_ATOMIC_BINARY(add, ADD, int32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(add, ADD, int64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(add, ADD, uint32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(add, ADD, uint64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(add, ADD, real32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(add, ADD, real64)
+
+DEFN_CHPL_COMM_ATOMIC_BINARY(sub, SUB, int32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(sub, SUB, int64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(sub, SUB, uint32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(sub, SUB, uint64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(sub, SUB, real32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(sub, SUB, real64)
+
+#undef DEFN_CHPL_COMM_ATOMIC_WRITE
+#undef DEFN_CHPL_COMM_ATOMIC_READ
+#undef DEFN_CHPL_COMM_ATOMIC_XCHG
+#undef DEFN_CHPL_COMM_ATOMIC_CMPXCHG
+#undef DEFN_CHPL_COMM_ATOMIC_BINARY
+#undef DEFN_CHPL_COMM_ATOMIC_ALL_TYPES
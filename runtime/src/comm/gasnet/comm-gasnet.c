@@ -29,6 +29,7 @@
 #include "chpl-comm-callbacks.h"
 #include "chpl-comm-callbacks-internal.h"
 #include "chpl-comm-internal.h"
+#include "chpl-comm-strd-xfer.h"
 #include "chpl-env.h"
 #include "chpl-mem.h"
 #include "chplsys.h"
@@ -1320,14 +1321,17 @@ void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
 }
 
 //
-// This is an adapter from Chapel code to GASNet's gasnet_gets_bulk. It does:
+// This is an adapter from Chapel code to GASNet's gasnet_gets_nb_bulk. It does:
 // * convert count[0] and all of 'srcstr' and 'dststr' from counts of element
 //   to counts of bytes,
 //
-void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_id,
-                         void* srcaddr, size_t* srcstrides, size_t* count,
-                         int32_t stridelevels, size_t elemSize, int32_t commID,
-                         int ln, int32_t fn) {
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode_id,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
   int i;
   const size_t strlvls = (size_t)stridelevels;
   const gasnet_node_t srcnode = (gasnet_node_t)srcnode_id;
@@ -1366,14 +1370,19 @@ void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_i
   }
 
   // TODO -- handle strided get for non-registered memory
-  gasnet_gets_bulk(dstaddr, dststr, srcnode, srcaddr, srcstr, cnt, strlvls);
-}
-
-// See the comment for chpl_comm_gets().
-void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_id,
-                         void* srcaddr, size_t* srcstrides, size_t* count,
-                         int32_t stridelevels, size_t elemSize, int32_t commID,
-                         int ln, int32_t fn) {
+  return (chpl_comm_nb_handle_t)
+         gasnet_gets_nb_bulk(dstaddr, dststr, srcnode, srcaddr, srcstr,
+                             cnt, strlvls);
+}
+
+// See the comment for chpl_comm_get_strd_nb().
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode_id,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
   int i;
   const size_t strlvls = (size_t)stridelevels;
   const gasnet_node_t dstnode = (gasnet_node_t)dstnode_id;
@@ -1411,7 +1420,89 @@ void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_i
   }
 
   // TODO -- handle strided put for non-registered memory
-  gasnet_puts_bulk(dstnode, dstaddr, dststr, srcaddr, srcstr, cnt, strlvls);
+  return (chpl_comm_nb_handle_t)
+         gasnet_puts_nb_bulk(dstnode, dstaddr, dststr, srcaddr, srcstr,
+                             cnt, strlvls);
+}
+
+void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_id,
+                         void* srcaddr, size_t* srcstrides, size_t* count,
+                         int32_t stridelevels, size_t elemSize, int32_t commID,
+                         int ln, int32_t fn) {
+  gasnet_wait_syncnb((gasnet_handle_t)
+                     chpl_comm_get_strd_nb(dstaddr, dststrides, srcnode_id,
+                                           srcaddr, srcstrides, count,
+                                           stridelevels, elemSize, commID,
+                                           ln, fn));
+}
+
+void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_id,
+                         void* srcaddr, size_t* srcstrides, size_t* count,
+                         int32_t stridelevels, size_t elemSize, int32_t commID,
+                         int ln, int32_t fn) {
+  gasnet_wait_syncnb((gasnet_handle_t)
+                     chpl_comm_put_strd_nb(dstaddr, dststrides, dstnode_id,
+                                           srcaddr, srcstrides, count,
+                                           stridelevels, elemSize, commID,
+                                           ln, fn));
+}
+
+//
+// The GASNet-1 interface has no indexed transfers, so use the common
+// implementation on top of our contiguous NB transfers.
+//
+static const size_t indexed_maxHandles = 16;
+
+void chpl_comm_put_indexed(c_nodeid_t dstnode,
+                           size_t dstcount, void* const dstlist[],
+                           size_t dstlen,
+                           size_t srccount, void* const srclist[],
+                           size_t srclen,
+                           int32_t commID, int ln, int32_t fn) {
+  put_indexed_common(dstnode, dstcount, dstlist, dstlen,
+                     srccount, srclist, srclen,
+                     indexed_maxHandles, chpl_task_yield,
+                     commID, ln, fn);
+}
+
+void chpl_comm_get_indexed(size_t dstcount, void* const dstlist[],
+                           size_t dstlen,
+                           c_nodeid_t srcnode,
+                           size_t srccount, void* const srclist[],
+                           size_t srclen,
+                           int32_t commID, int ln, int32_t fn) {
+  get_indexed_common(dstcount, dstlist, dstlen, srcnode,
+                     srccount, srclist, srclen,
+                     indexed_maxHandles, chpl_task_yield,
+                     commID, ln, fn);
+}
+
+chpl_comm_nb_handle_t chpl_comm_put_indexed_nb(c_nodeid_t dstnode,
+                                               size_t dstcount,
+                                               void* const dstlist[],
+                                               size_t dstlen,
+                                               size_t srccount,
+                                               void* const srclist[],
+                                               size_t srclen,
+                                               int32_t commID,
+                                               int ln, int32_t fn) {
+  chpl_comm_put_indexed(dstnode, dstcount, dstlist, dstlen,
+                        srccount, srclist, srclen, commID, ln, fn);
+  return NULL;
+}
+
+chpl_comm_nb_handle_t chpl_comm_get_indexed_nb(size_t dstcount,
+                                               void* const dstlist[],
+                                               size_t dstlen,
+                                               c_nodeid_t srcnode,
+                                               size_t srccount,
+                                               void* const srclist[],
+                                               size_t srclen,
+                                               int32_t commID,
+                                               int ln, int32_t fn) {
+  chpl_comm_get_indexed(dstcount, dstlist, dstlen, srcnode,
+                        srccount, srclist, srclen, commID, ln, fn);
+  return NULL;
 }
 
 #define MAX_UNORDERED_TRANS_SZ 1024
@@ -1462,6 +1553,10 @@ void chpl_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
 
 void chpl_comm_getput_unordered_task_fence(void) { }
 
+// Network atomics are only supported with GASNet-EX, so there is
+// nothing for a task to complete here.
+void chpl_comm_impl_task_end(void) { }
+
 static inline
 void  execute_on_common(c_nodeid_t node, c_sublocid_t subloc,
                         chpl_fn_int_t fid,
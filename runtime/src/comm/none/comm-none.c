@@ -201,6 +201,91 @@ void  chpl_comm_get_strd(void* dstaddr_arg, size_t* dststrides, c_nodeid_t srcno
                   commID, ln, fn);
 }
 
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn)
+{
+  // No native strided transfers, so do the whole thing now.
+  chpl_comm_put_strd(dstaddr, dststrides, dstnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn)
+{
+  chpl_comm_get_strd(dstaddr, dststrides, srcnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
+void chpl_comm_put_indexed(c_nodeid_t dstnode,
+                           size_t dstcount, void* const dstlist[],
+                           size_t dstlen,
+                           size_t srccount, void* const srclist[],
+                           size_t srclen,
+                           int32_t commID, int ln, int32_t fn)
+{
+  assert(dstnode==0);
+  put_indexed_common(dstnode, dstcount, dstlist, dstlen,
+                     srccount, srclist, srclen,
+                     1, NULL, // "nb" xfers block, so no need for yield
+                     commID, ln, fn);
+}
+
+void chpl_comm_get_indexed(size_t dstcount, void* const dstlist[],
+                           size_t dstlen,
+                           c_nodeid_t srcnode,
+                           size_t srccount, void* const srclist[],
+                           size_t srclen,
+                           int32_t commID, int ln, int32_t fn)
+{
+  assert(srcnode==0);
+  get_indexed_common(dstcount, dstlist, dstlen, srcnode,
+                     srccount, srclist, srclen,
+                     1, NULL, // "nb" xfers block, so no need for yield
+                     commID, ln, fn);
+}
+
+chpl_comm_nb_handle_t chpl_comm_put_indexed_nb(c_nodeid_t dstnode,
+                                               size_t dstcount,
+                                               void* const dstlist[],
+                                               size_t dstlen,
+                                               size_t srccount,
+                                               void* const srclist[],
+                                               size_t srclen,
+                                               int32_t commID,
+                                               int ln, int32_t fn)
+{
+  chpl_comm_put_indexed(dstnode, dstcount, dstlist, dstlen,
+                        srccount, srclist, srclen, commID, ln, fn);
+  return NULL;
+}
+
+chpl_comm_nb_handle_t chpl_comm_get_indexed_nb(size_t dstcount,
+                                               void* const dstlist[],
+                                               size_t dstlen,
+                                               c_nodeid_t srcnode,
+                                               size_t srccount,
+                                               void* const srclist[],
+                                               size_t srclen,
+                                               int32_t commID,
+                                               int ln, int32_t fn)
+{
+  chpl_comm_get_indexed(dstcount, dstlist, dstlen, srcnode,
+                        srccount, srclist, srclen, commID, ln, fn);
+  return NULL;
+}
+
 void chpl_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
                                 c_nodeid_t srcnode, void* srcaddr,
                                 size_t size, int32_t commID,
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+
+#include "chplrt.h"
+#include "chpl-comm-launch.h"
+#include "chpl-env.h"
+
+void chpl_comm_preLaunch(int32_t numLocales) {
+  // The program itself forks one process per locale; see chpl_comm_init().
+  chpl_env_set_uint("CHPL_RT_COMM_SHM_NUM_LOCALES", numLocales, 1);
+}
@@ -0,0 +1,274 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Support code for the shm comm layer that does not depend on the rest of
+// the runtime: the active message rings and the implementation of AMOs on
+// directly addressable memory.  It is #included by comm-shm.c, and by the
+// unit test in test/runtime/comm/shm.
+//
+
+#include "chpltypes.h"
+#include "error.h"
+
+#include <stdint.h>
+#include <string.h>
+
+
+////////////////////////////////////////
+//
+// Active message rings
+//
+
+#define AM_SLOT_SIZE 256
+#define AM_RING_SLOTS 256            // must be a power of 2
+#define AM_SLOT_HDR_SIZE 16
+#define AM_MAX_MEDIUM (AM_SLOT_SIZE - AM_SLOT_HDR_SIZE)
+
+typedef struct {
+  uint64_t      seq;                 // see ring_try_push()/ring_try_pop()
+  uint16_t      handler;
+  uint16_t      size;
+  uint32_t      pad;
+  unsigned char data[AM_MAX_MEDIUM];
+} am_slot_t;
+
+//
+// A bounded multi-producer, single-consumer queue (after Vyukov).  Any
+// task on the source locale may push; only the target locale pops.
+// Each slot's sequence number says whose turn it is: seq == pos means
+// the slot is free for the producer claiming position pos, and
+// seq == pos + 1 means it holds the message at pos.
+//
+typedef struct {
+  uint64_t  tail __attribute__((aligned(64)));
+  uint64_t  head __attribute__((aligned(64)));
+  am_slot_t slots[AM_RING_SLOTS] __attribute__((aligned(64)));
+} am_ring_t;
+
+static
+void ring_init(am_ring_t* r) {
+  r->tail = 0;
+  r->head = 0;
+  for (uint64_t i = 0; i < AM_RING_SLOTS; i++) {
+    r->slots[i].seq = i;
+  }
+}
+
+static
+chpl_bool ring_try_push(am_ring_t* r, uint16_t handler,
+                        const void* hdr, size_t hdr_size,
+                        const void* data, size_t data_size) {
+  uint64_t pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+
+  for (;;) {
+    am_slot_t* s = &r->slots[pos & (AM_RING_SLOTS - 1)];
+    uint64_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+    int64_t diff = (int64_t) (seq - pos);
+
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&r->tail, &pos, pos + 1,
+                                      /*weak*/ true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        s->handler = handler;
+        s->size = (uint16_t) (hdr_size + data_size);
+        memcpy(s->data, hdr, hdr_size);
+        if (data_size > 0) {
+          memcpy(s->data + hdr_size, data, data_size);
+        }
+        __atomic_store_n(&s->seq, pos + 1, __ATOMIC_RELEASE);
+        return true;
+      }
+      // The failed CAS reloaded pos; try again.
+    } else if (diff < 0) {
+      return false;  // full
+    } else {
+      pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+typedef struct {
+  uint16_t      handler;
+  uint16_t      size;
+  unsigned char data[AM_MAX_MEDIUM] __attribute__((aligned(16)));
+} am_msg_t;
+
+// The caller must hold the ring's consumer lock.
+static
+chpl_bool ring_try_pop(am_ring_t* r, am_msg_t* msg) {
+  uint64_t pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+  am_slot_t* s = &r->slots[pos & (AM_RING_SLOTS - 1)];
+
+  if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+    return false;  // empty
+  }
+
+  // Copy the message out so the slot can be reused while the handler
+  // runs (the handler may itself send to the same ring's producer).
+  msg->handler = s->handler;
+  msg->size = s->size;
+  memcpy(msg->data, s->data, msg->size);
+
+  __atomic_store_n(&s->seq, pos + AM_RING_SLOTS, __ATOMIC_RELEASE);
+  __atomic_store_n(&r->head, pos + 1, __ATOMIC_RELAXED);
+  return true;
+}
+
+
+////////////////////////////////////////
+//
+// AMOs on directly addressable memory
+//
+
+typedef enum {
+  amo_write,
+  amo_read,
+  amo_xchg,
+  amo_cmpxchg,
+  amo_and,
+  amo_or,
+  amo_xor,
+  amo_add,
+  amo_sub,
+} amo_op_t;
+
+typedef enum {
+  amo_int32,
+  amo_int64,
+  amo_uint32,
+  amo_uint64,
+  amo_real32,
+  amo_real64,
+} amo_type_t;
+
+typedef union {
+  int32_t  int32;
+  int64_t  int64;
+  uint32_t uint32;
+  uint64_t uint64;
+  _real32  real32;
+  _real64  real64;
+} amo_val_t;
+
+//
+// Do an atomic operation on memory this process can address directly,
+// returning the prior value in *old.  For cmpxchg, opnd1 is the
+// expected value and opnd2 the desired one, and the return value says
+// whether the exchange happened.
+//
+#define DO_AMO_INT(field, T)                                            \
+  do {                                                                  \
+    T* obj = (T*) object;                                               \
+    switch (op) {                                                       \
+    case amo_write:                                                     \
+      __atomic_store_n(obj, opnd1->field, __ATOMIC_SEQ_CST); break;     \
+    case amo_read:                                                      \
+      old->field = __atomic_load_n(obj, __ATOMIC_SEQ_CST); break;       \
+    case amo_xchg:                                                      \
+      old->field = __atomic_exchange_n(obj, opnd1->field,               \
+                                       __ATOMIC_SEQ_CST); break;        \
+    case amo_cmpxchg:                                                   \
+      old->field = opnd1->field;                                        \
+      return __atomic_compare_exchange_n(obj, &old->field, opnd2->field,\
+                                         false, __ATOMIC_SEQ_CST,       \
+                                         __ATOMIC_SEQ_CST);             \
+    case amo_and:                                                       \
+      old->field = __atomic_fetch_and(obj, opnd1->field,                \
+                                      __ATOMIC_SEQ_CST); break;         \
+    case amo_or:                                                        \
+      old->field = __atomic_fetch_or(obj, opnd1->field,                 \
+                                     __ATOMIC_SEQ_CST); break;          \
+    case amo_xor:                                                       \
+      old->field = __atomic_fetch_xor(obj, opnd1->field,                \
+                                      __ATOMIC_SEQ_CST); break;         \
+    case amo_add:                                                       \
+      old->field = __atomic_fetch_add(obj, opnd1->field,                \
+                                      __ATOMIC_SEQ_CST); break;         \
+    case amo_sub:                                                       \
+      old->field = __atomic_fetch_sub(obj, opnd1->field,                \
+                                      __ATOMIC_SEQ_CST); break;         \
+    }                                                                   \
+  } while (0)
+
+// Reals are handled through their bit patterns.
+#define DO_AMO_REAL(field, T, BitsT)                                    \
+  do {                                                                  \
+    BitsT* obj = (BitsT*) object;                                       \
+    BitsT bits, newbits, expbits;                                       \
+    T val;                                                              \
+    switch (op) {                                                       \
+    case amo_write:                                                     \
+      memcpy(&bits, &opnd1->field, sizeof(bits));                       \
+      __atomic_store_n(obj, bits, __ATOMIC_SEQ_CST); break;             \
+    case amo_read:                                                      \
+      bits = __atomic_load_n(obj, __ATOMIC_SEQ_CST);                    \
+      memcpy(&old->field, &bits, sizeof(bits)); break;                  \
+    case amo_xchg:                                                      \
+      memcpy(&bits, &opnd1->field, sizeof(bits));                       \
+      bits = __atomic_exchange_n(obj, bits, __ATOMIC_SEQ_CST);          \
+      memcpy(&old->field, &bits, sizeof(bits)); break;                  \
+    case amo_cmpxchg: {                                                 \
+      chpl_bool32 ok;                                                   \
+      memcpy(&expbits, &opnd1->field, sizeof(expbits));                 \
+      memcpy(&newbits, &opnd2->field, sizeof(newbits));                 \
+      ok = __atomic_compare_exchange_n(obj, &expbits, newbits, false,   \
+                                       __ATOMIC_SEQ_CST,                \
+                                       __ATOMIC_SEQ_CST);               \
+      memcpy(&old->field, &expbits, sizeof(expbits));                   \
+      return ok;                                                        \
+    }                                                                   \
+    case amo_add:                                                       \
+    case amo_sub:                                                       \
+      bits = __atomic_load_n(obj, __ATOMIC_SEQ_CST);                    \
+      do {                                                              \
+        memcpy(&val, &bits, sizeof(val));                               \
+        val = (op == amo_add) ? val + opnd1->field : val - opnd1->field;\
+        memcpy(&newbits, &val, sizeof(newbits));                        \
+      } while (!__atomic_compare_exchange_n(obj, &bits, newbits, false, \
+                                            __ATOMIC_SEQ_CST,           \
+                                            __ATOMIC_SEQ_CST));         \
+      memcpy(&old->field, &bits, sizeof(bits)); break;                  \
+    default:                                                            \
+      chpl_internal_error("unsupported real AMO");                      \
+    }                                                                   \
+  } while (0)
+
+static chpl_bool32 do_amo(amo_op_t op, amo_type_t type, void* object,
+                          const amo_val_t* opnd1, const amo_val_t* opnd2,
+                          amo_val_t* old) {
+  switch (type) {
+  case amo_int32:  DO_AMO_INT(int32, int32_t); break;
+  case amo_int64:  DO_AMO_INT(int64, int64_t); break;
+  case amo_uint32: DO_AMO_INT(uint32, uint32_t); break;
+  case amo_uint64: DO_AMO_INT(uint64, uint64_t); break;
+  case amo_real32: DO_AMO_REAL(real32, _real32, uint32_t); break;
+  case amo_real64: DO_AMO_REAL(real64, _real64, uint64_t); break;
+  }
+  return true;
+}
+
+#undef DO_AMO_INT
+#undef DO_AMO_REAL
+
+static inline
+size_t amo_type_size(amo_type_t type) {
+  return (type == amo_int32 || type == amo_uint32 || type == amo_real32)
+         ? 4 : 8;
+}
@@ -0,0 +1,1589 @@
+/*
+ * Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// The shm communication layer runs a multi-locale program on a single
+// node, with one process per locale.
+//
+// chpl_comm_init() creates one shared memory region and then forks the
+// locale processes, so the region (and the program image) has the same
+// address in every locale.  The original process stays behind only to
+// wait for the locales and report the program's exit status.
+//
+// The region holds:
+//   - a small control block (barrier state, exit flag),
+//   - the table locale 0 uses to publish global variable addresses,
+//   - an active message ring for each (source, target, class) triple,
+//   - each locale's heap, which the memory layer uses as its fixed heap.
+//
+// PUTs, GETs, and AMOs on addresses in the region are done directly,
+// with memcpy and CPU atomics.  Other addresses (task stacks, static
+// data) are private to their process, so for those we fall back to
+// active messages, much as the gasnet layer does for addresses outside
+// its segment.
+//
+
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-comm-callbacks.h"
+#include "chpl-comm-callbacks-internal.h"
+#include "chpl-comm-diags.h"
+#include "chpl-comm-internal.h"
+#include "chpl-comm-native-atomics.h"
+#include "chpl-comm-strd-xfer.h"
+#include "chpl-env.h"
+#include "chpl-mem.h"
+#include "chpl-mem-sys.h"
+#include "chpl-tasks.h"
+#include "chplcgfns.h"
+#include "chpl-gen-includes.h"
+#include "chpl-linefile-support.h"
+#include "chplexit.h"
+#include "chplsys.h"
+#include "error.h"
+
+// Don't get warning macros for chpl_comm_get etc
+#include "chpl-comm-no-warning-macros.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+
+
+////////////////////////////////////////
+//
+// Shared memory layout
+//
+
+//
+// Structures in the shared region are used by several processes at
+// once, so they are accessed with the compiler's __atomic builtins
+// rather than through chpl-atomics.h, whose lock-based implementation
+// is not process-shared.
+//
+
+// The active message rings and the AMO implementation are in a separate
+// file so that they can be unit tested without the rest of the runtime.
+#include "comm-shm-support.c"
+
+typedef struct {
+  uint32_t bar_count __attribute__((aligned(64)));
+  uint32_t bar_gen;
+  int32_t  exit_all;   // all locales reached the final barrier
+} shm_ctrl_t;
+
+//
+// Requests may cause the target to send a reply; replies never cause
+// further sends.  Keeping them on separate rings means a handler that
+// is blocked sending a reply can always make progress by draining its
+// own reply rings, so two locales can't deadlock on full rings.
+//
+typedef enum {
+  AM_CLASS_REQUEST = 0,
+  AM_CLASS_REPLY   = 1,
+  AM_NUM_CLASSES
+} am_class_t;
+
+static void*       shm_base;
+static size_t      shm_size;
+static shm_ctrl_t* shm_ctrl;
+static wide_ptr_t* shm_globals;
+static am_ring_t*  shm_rings;
+static char*       shm_heaps;
+static size_t      shm_heap_size;
+
+static inline
+am_ring_t* ring_for(c_nodeid_t src, c_nodeid_t dst, am_class_t cls) {
+  return &shm_rings[((size_t) dst * chpl_numNodes + src) * AM_NUM_CLASSES
+                    + cls];
+}
+
+//
+// Is [addr, addr+len) in the shared region, and so directly reachable
+// from every locale?
+//
+static inline
+chpl_bool in_shared_region(const void* addr, size_t len) {
+  uintptr_t start = (uintptr_t) shm_base;
+  uintptr_t a = (uintptr_t) addr;
+  return shm_base != NULL
+         && a >= start
+         && a - start <= shm_size
+         && len <= shm_size - (a - start);
+}
+
+
+////////////////////////////////////////
+//
+// Active message handlers
+//
+
+//
+// A done_t is a completion flag local to the locale that waits on it;
+// the target posts to it with a SIGNAL (or COPY_REPLY) message.
+//
+typedef struct {
+  atomic_uint_least32_t count;
+  uint_least32_t        target;
+  volatile int          flag;
+} done_t;
+
+static inline
+void init_done_obj(done_t* done, int target) {
+  atomic_init_uint_least32_t(&done->count, 0);
+  done->target = target;
+  done->flag = 0;
+}
+
+static void am_poll(void);
+
+//
+// Set when there are more locales than CPUs.  A task that waits without
+// yielding its thread then keeps the target locale from running until
+// the scheduler preempts it, which takes a full time slice (several ms
+// per AM round trip), so waiters yield the CPU instead, much as GASNet
+// does when it finds the node overcommitted.
+//
+static chpl_bool shm_overcommitted;
+
+static inline
+void wait_done_obj(done_t* done, chpl_bool do_yield) {
+  while (!done->flag) {
+    am_poll();
+    if (do_yield)
+      chpl_task_yield();
+    else if (shm_overcommitted)
+      sched_yield();
+  }
+}
+
+typedef struct {
+  c_nodeid_t    caller;
+  c_sublocid_t  subloc;
+
+  void*         ack;
+
+  chpl_fn_int_t fid;
+  uint16_t      payload_size;
+
+  chpl_task_infoChapel_t infoChapel;
+} small_fork_hdr_t;
+
+typedef struct {
+  small_fork_hdr_t hdr;
+  void*            arg;
+  size_t           arg_size;
+} large_fork_t;
+
+typedef struct {
+  chpl_comm_on_bundle_t bundle;
+  unsigned char         payload[AM_MAX_MEDIUM];
+} small_fork_task_t;
+
+typedef struct {
+  chpl_comm_on_bundle_t bundle;
+  large_fork_t          large;
+} large_fork_task_t;
+
+typedef struct {
+  void*  ack;
+  int    id;       // private broadcast table entry to update
+  int    offset;   // offset of this piece of the data
+  int    size;     // size of this piece of the data
+} priv_bcast_t;
+
+typedef struct {
+  void*  ack;      // acknowledgement object on the requester
+  void*  tgt;      // target memory address
+  void*  src;      // source memory address
+  size_t size;     // number of bytes
+} xfer_info_t;
+
+typedef struct {
+  amo_val_t   old;
+  chpl_bool32 ok;
+} amo_result_t;
+
+typedef struct {
+  void*     ack;
+  void*     result;   // amo_result_t on the requester
+  void*     object;
+  int32_t   op;
+  int32_t   type;
+  amo_val_t opnd1;
+  amo_val_t opnd2;
+} amo_req_t;
+
+typedef enum {
+  // requests
+  FORK,
+  FORK_LARGE,
+  FORK_NB,
+  FORK_NB_LARGE,
+  FORK_FAST,
+  PRIV_BCAST,
+  DO_COPY_PAYLOAD,
+  DO_REPLY_PUT,
+  DO_AMO,
+  // replies
+  SIGNAL,
+  COPY_REPLY,
+  FREE,
+  SHUTDOWN,
+  AM_NUM_HANDLERS
+} am_handler_idx_t;
+
+static void am_send(c_nodeid_t node, am_handler_idx_t handler,
+                    const void* hdr, size_t hdr_size,
+                    const void* data, size_t data_size);
+
+static inline
+void send_signal(c_nodeid_t node, void* ack) {
+  am_send(node, SIGNAL, &ack, sizeof(ack), NULL, 0);
+}
+
+static inline
+size_t setup_small_fork_task(small_fork_task_t* dst, small_fork_hdr_t* f)
+{
+  chpl_comm_bundleData_t comm  = { .caller = f->caller,
+                                   .ack    = f->ack };
+  chpl_comm_on_bundle_t bundle = { .kind = CHPL_ARG_BUNDLE_KIND_COMM,
+                                   .comm =  comm };
+
+  // Copy task-local data to the new task
+  bundle.task_bundle.infoChapel = f->infoChapel;
+
+  dst->bundle = bundle;
+
+  // Copy the payload into the special task
+  memcpy(&dst->bundle + 1, f + 1, f->payload_size);
+
+  return sizeof(chpl_comm_on_bundle_t) + f->payload_size;
+}
+
+static inline
+size_t setup_large_fork_task(large_fork_task_t* dst, large_fork_t* f)
+{
+  chpl_comm_bundleData_t comm  = { .caller = f->hdr.caller,
+                                   .ack    = f->hdr.ack };
+  chpl_comm_on_bundle_t bundle = { .kind = CHPL_ARG_BUNDLE_KIND_COMM,
+                                   .comm =  comm };
+
+  // Copy task-local data to the new task
+  bundle.task_bundle.infoChapel = f->hdr.infoChapel;
+
+  dst->bundle = bundle;
+  dst->large = *f;
+
+  return sizeof(large_fork_task_t);
+}
+
+static void fork_wrapper(chpl_comm_on_bundle_t *f) {
+  chpl_ftable_call(f->task_bundle.requested_fid, f);
+  send_signal(f->comm.caller, f->comm.ack);
+}
+
+static void fork_nb_wrapper(chpl_comm_on_bundle_t *f) {
+  chpl_ftable_call(f->task_bundle.requested_fid, f);
+}
+
+static void AM_fork(c_nodeid_t src, void* buf, size_t nbytes) {
+  small_fork_hdr_t* f = buf;
+  small_fork_task_t task;
+  size_t size = setup_small_fork_task(&task, f);
+
+  chpl_task_startMovedTask(f->fid, (chpl_fn_p) fork_wrapper,
+                           &task.bundle, size,
+                           f->subloc, chpl_nullTaskID);
+}
+
+static void AM_fork_nb(c_nodeid_t src, void* buf, size_t nbytes) {
+  small_fork_hdr_t* f = buf;
+  small_fork_task_t task;
+  size_t size = setup_small_fork_task(&task, f);
+
+  chpl_task_startMovedTask(f->fid, (chpl_fn_p) fork_nb_wrapper,
+                           &task.bundle, size,
+                           f->subloc, chpl_nullTaskID);
+}
+
+static void AM_fork_fast(c_nodeid_t src, void* buf, size_t nbytes) {
+  small_fork_hdr_t* f = buf;
+  small_fork_task_t task;
+
+  setup_small_fork_task(&task, f);
+
+  // Run the function right here in the handler.
+  chpl_ftable_call(f->fid, &task.bundle);
+
+  if (f->ack)
+    send_signal(src, f->ack);
+}
+
+//
+// Get a large bundle from the caller.  If the caller's copy is in the
+// shared region this is just a memcpy; otherwise chpl_comm_get() asks
+// the caller for it.
+//
+static chpl_comm_on_bundle_t* get_large_bundle(large_fork_t* lg) {
+  chpl_comm_on_bundle_t* arg;
+
+  arg = chpl_mem_allocMany(1, lg->arg_size,
+                           CHPL_RT_MD_COMM_FRK_RCV_ARG, 0, 0);
+  chpl_comm_get(arg, lg->hdr.caller, lg->arg, lg->arg_size,
+                CHPL_COMM_UNKNOWN_ID, 0, CHPL_FILE_IDX_FORK_LARGE);
+  return arg;
+}
+
+static void fork_large_wrapper(large_fork_task_t* f) {
+  large_fork_t* lg = &f->large;
+  chpl_comm_on_bundle_t* arg = get_large_bundle(lg);
+
+  chpl_ftable_call(lg->hdr.fid, arg);
+  send_signal(lg->hdr.caller, lg->hdr.ack);
+  chpl_mem_free(arg, 0, 0);
+}
+
+static void fork_nb_large_wrapper(large_fork_task_t* f) {
+  large_fork_t* lg = &f->large;
+  chpl_comm_on_bundle_t* arg = get_large_bundle(lg);
+
+  // The caller made a copy for us; tell it that it can free that.
+  am_send(lg->hdr.caller, FREE, &lg->arg, sizeof(lg->arg), NULL, 0);
+
+  chpl_ftable_call(lg->hdr.fid, arg);
+  chpl_mem_free(arg, 0, 0);
+}
+
+static void AM_fork_large(c_nodeid_t src, void* buf, size_t nbytes) {
+  large_fork_t* f = buf;
+  large_fork_task_t task;
+  size_t size = setup_large_fork_task(&task, f);
+
+  chpl_task_startMovedTask(f->hdr.fid, (chpl_fn_p) fork_large_wrapper,
+                           &task.bundle, size,
+                           f->hdr.subloc, chpl_nullTaskID);
+}
+
+static void AM_fork_nb_large(c_nodeid_t src, void* buf, size_t nbytes) {
+  large_fork_t* f = buf;
+  large_fork_task_t task;
+  size_t size = setup_large_fork_task(&task, f);
+
+  chpl_task_startMovedTask(f->hdr.fid, (chpl_fn_p) fork_nb_large_wrapper,
+                           &task.bundle, size,
+                           f->hdr.subloc, chpl_nullTaskID);
+}
+
+static void AM_priv_bcast(c_nodeid_t src, void* buf, size_t nbytes) {
+  priv_bcast_t* pbp = buf;
+
+  chpl_memcpy((char*) chpl_rt_priv_bcast_tab[pbp->id] + pbp->offset,
+              pbp + 1, pbp->size);
+  send_signal(src, pbp->ack);
+}
+
+// Copy the payload following the xfer_info_t to its tgt.
+static void AM_copy_payload(c_nodeid_t src, void* buf, size_t nbytes) {
+  xfer_info_t* x = buf;
+
+  memcpy(x->tgt, x + 1, x->size);
+  send_signal(src, x->ack);
+}
+
+// Send x->size bytes from our x->src back to the requester's x->tgt.
+static void AM_reply_put(c_nodeid_t src, void* buf, size_t nbytes) {
+  xfer_info_t* x = buf;
+
+  am_send(src, COPY_REPLY, x, sizeof(*x), x->src, x->size);
+}
+
+static void AM_amo(c_nodeid_t src, void* buf, size_t nbytes) {
+  amo_req_t* req = buf;
+  amo_result_t res;
+  xfer_info_t x = { .ack = req->ack, .tgt = req->result,
+                    .src = NULL, .size = sizeof(res) };
+
+  memset(&res, 0, sizeof(res));
+  res.ok = do_amo((amo_op_t) req->op, (amo_type_t) req->type, req->object,
+                  &req->opnd1, &req->opnd2, &res.old);
+  am_send(src, COPY_REPLY, &x, sizeof(x), &res, sizeof(res));
+}
+
+static inline
+void post_done_obj(done_t* done) {
+  uint_least32_t prev;
+  prev = atomic_fetch_add_explicit_uint_least32_t(&done->count, 1,
+                                                  memory_order_seq_cst);
+  if (prev + 1 == done->target)
+    done->flag = 1;
+}
+
+static void AM_signal(c_nodeid_t src, void* buf, size_t nbytes) {
+  done_t* done;
+
+  memcpy(&done, buf, sizeof(done));
+  post_done_obj(done);
+}
+
+static void AM_copy_reply(c_nodeid_t src, void* buf, size_t nbytes) {
+  xfer_info_t* x = buf;
+
+  memcpy(x->tgt, x + 1, x->size);
+  post_done_obj((done_t*) x->ack);
+}
+
+static void AM_free(c_nodeid_t src, void* buf, size_t nbytes) {
+  void* to_free;
+
+  memcpy(&to_free, buf, sizeof(to_free));
+  chpl_mem_free(to_free, 0, 0);
+}
+
+static void AM_shutdown(c_nodeid_t src, void* buf, size_t nbytes) {
+  chpl_signal_shutdown();
+}
+
+typedef void (*am_handler_fn_t)(c_nodeid_t src, void* buf, size_t nbytes);
+
+static const struct {
+  am_handler_fn_t fn;
+  am_class_t      cls;
+} am_table[AM_NUM_HANDLERS] = {
+  [FORK]            = { AM_fork,          AM_CLASS_REQUEST },
+  [FORK_LARGE]      = { AM_fork_large,    AM_CLASS_REQUEST },
+  [FORK_NB]         = { AM_fork_nb,       AM_CLASS_REQUEST },
+  [FORK_NB_LARGE]   = { AM_fork_nb_large, AM_CLASS_REQUEST },
+  [FORK_FAST]       = { AM_fork_fast,     AM_CLASS_REQUEST },
+  [PRIV_BCAST]      = { AM_priv_bcast,    AM_CLASS_REQUEST },
+  [DO_COPY_PAYLOAD] = { AM_copy_payload,  AM_CLASS_REQUEST },
+  [DO_REPLY_PUT]    = { AM_reply_put,     AM_CLASS_REQUEST },
+  [DO_AMO]          = { AM_amo,           AM_CLASS_REQUEST },
+  [SIGNAL]          = { AM_signal,        AM_CLASS_REPLY   },
+  [COPY_REPLY]      = { AM_copy_reply,    AM_CLASS_REPLY   },
+  [FREE]            = { AM_free,          AM_CLASS_REPLY   },
+  [SHUTDOWN]        = { AM_shutdown,      AM_CLASS_REPLY   },
+};
+
+
+////////////////////////////////////////
+//
+// Sending and polling
+//
+
+//
+// Consumer locks for the rings targeting this locale, indexed by
+// source locale and class.  Whoever holds one may drain that ring.
+//
+static atomic_spinlock_t* poll_locks;
+
+static
+int am_poll_class(am_class_t cls) {
+  am_msg_t msg;
+  int handled = 0;
+
+  for (c_nodeid_t src = 0; src < chpl_numNodes; src++) {
+    atomic_spinlock_t* lock;
+    am_ring_t* r;
+
+    if (src == chpl_nodeID)
+      continue;
+
+    lock = &poll_locks[src * AM_NUM_CLASSES + cls];
+    if (!atomic_try_lock_spinlock_t(lock))
+      continue;
+
+    r = ring_for(src, chpl_nodeID, cls);
+    while (ring_try_pop(r, &msg)) {
+      am_table[msg.handler].fn(src, msg.data, msg.size);
+      handled++;
+    }
+
+    atomic_unlock_spinlock_t(lock);
+  }
+
+  return handled;
+}
+
+static
+void am_poll(void) {
+  if (poll_locks == NULL)
+    return;
+
+  (void) am_poll_class(AM_CLASS_REPLY);
+  (void) am_poll_class(AM_CLASS_REQUEST);
+}
+
+static
+void am_send(c_nodeid_t node, am_handler_idx_t handler,
+             const void* hdr, size_t hdr_size,
+             const void* data, size_t data_size) {
+  am_class_t cls = am_table[handler].cls;
+  am_ring_t* r = ring_for(chpl_nodeID, node, cls);
+
+  assert(hdr_size + data_size <= AM_MAX_MEDIUM);
+
+  while (!ring_try_push(r, (uint16_t) handler,
+                        hdr, hdr_size, data, data_size)) {
+    //
+    // The ring is full.  Help the target drain ours in the meantime:
+    // a reply can only wait on other replies, which never send, but a
+    // request can wait on anything.
+    //
+    if (cls == AM_CLASS_REPLY)
+      (void) am_poll_class(AM_CLASS_REPLY);
+    else
+      am_poll();
+    chpl_task_yield();
+  }
+}
+
+
+//
+// On all locales, we'll do the primary polling in a task, as the gasnet
+// layer does.  Tasks waiting for replies also poll, so the polling task
+// mostly serves to run execute_on requests promptly.
+//
+static volatile int pollingRunning;
+static volatile int pollingQuit;
+
+static void polling(void* x) {
+  pollingRunning = 1;
+
+  while (!pollingQuit) {
+    am_poll();
+    chpl_task_yield();
+  }
+
+  pollingRunning = 0;
+}
+
+static void start_polling(void) {
+  if (chpl_numNodes == 1) return;
+
+  pollingRunning = 0;
+  pollingQuit = 0;
+
+  if (chpl_task_createCommTask(polling, NULL, -1)) {
+    chpl_internal_error("unable to start polling task for shm");
+  }
+
+  while (!pollingRunning) {
+    sched_yield();
+  }
+}
+
+static void stop_polling(chpl_bool wait) {
+  if (chpl_numNodes == 1) return;
+
+  pollingQuit = 1;
+
+  if (wait) {
+    while (pollingRunning) {
+      sched_yield();
+    }
+  }
+}
+
+
+////////////////////////////////////////
+//
+// Setup
+//
+
+static size_t align_up(size_t x, size_t a) {
+  return (x + a - 1) / a * a;
+}
+
+static
+int shm_create_fd(size_t size) {
+  int fd = -1;
+
+#if defined(__linux__) && defined(SYS_memfd_create)
+  fd = (int) syscall(SYS_memfd_create, "chpl-comm-shm", 0);
+  if (fd >= 0 && ftruncate(fd, (off_t) size) != 0) {
+    close(fd);
+    fd = -1;
+  }
+#endif
+
+  return fd;
+}
+
+static
+size_t shm_default_heap_size(void) {
+  ssize_t size = chpl_comm_getenvMaxHeapSize();
+
+  //
+  // Don't use more than 85% of the total memory for heaps.  The heaps
+  // are only reserved here; pages are faulted in as they are used.
+  //
+  size_t max_heap_per_locale = (size_t) (0.85 * chpl_sys_physicalMemoryBytes()
+                                         / chpl_numNodes);
+  if (size <= 0 || (size_t) size > max_heap_per_locale) {
+    size = max_heap_per_locale;
+  }
+
+  return (size_t) size;
+}
+
+static
+void shm_create_region(void) {
+  size_t page_size = chpl_getSysPageSize();
+  size_t nrings = (size_t) chpl_numNodes * chpl_numNodes * AM_NUM_CLASSES;
+  size_t ctrl_size, globals_off, rings_off, heaps_off;
+  int fd;
+
+  ctrl_size = align_up(sizeof(shm_ctrl_t), 64);
+  globals_off = ctrl_size;
+  rings_off = align_up(globals_off + chpl_numGlobalsOnHeap * sizeof(wide_ptr_t),
+                       page_size);
+  heaps_off = align_up(rings_off + nrings * sizeof(am_ring_t), page_size);
+
+  shm_heap_size = align_up(shm_default_heap_size(), page_size);
+  shm_size = heaps_off + chpl_numNodes * shm_heap_size;
+
+  //
+  // Prefer a memfd, which is visible in /proc for debugging; a shared
+  // anonymous mapping works just as well across fork() otherwise.
+  //
+  fd = shm_create_fd(shm_size);
+  if (fd >= 0) {
+    shm_base = mmap(NULL, shm_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_NORESERVE, fd, 0);
+    close(fd);
+  } else {
+    shm_base = mmap(NULL, shm_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  }
+  if (shm_base == MAP_FAILED) {
+    chpl_error("comm shm: cannot create shared memory region", 0, 0);
+  }
+
+  shm_ctrl = (shm_ctrl_t*) shm_base;
+  shm_globals = (wide_ptr_t*) ((char*) shm_base + globals_off);
+  shm_rings = (am_ring_t*) ((char*) shm_base + rings_off);
+  shm_heaps = (char*) shm_base + heaps_off;
+
+  memset(shm_ctrl, 0, sizeof(*shm_ctrl));
+  for (size_t i = 0; i < nrings; i++) {
+    ring_init(&shm_rings[i]);
+  }
+}
+
+//
+// Wait for the locale processes.  If one exits before the others have
+// all agreed to exit (say, by calling exit() or halting), the program
+// is over: stop the rest and report that locale's status.
+//
+static
+int shm_monitor(pid_t* pids) {
+  int remaining = chpl_numNodes;
+  int exit_status = 0;
+  chpl_bool failed = false;
+
+  while (remaining > 0) {
+    int wstatus;
+    int status;
+    int i;
+    pid_t pid = waitpid(-1, &wstatus, 0);
+
+    if (pid < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    for (i = 0; i < chpl_numNodes && pids[i] != pid; i++) ;
+    if (i == chpl_numNodes)
+      continue;
+    pids[i] = 0;
+    remaining--;
+
+    if (WIFEXITED(wstatus))
+      status = WEXITSTATUS(wstatus);
+    else
+      status = 128 + WTERMSIG(wstatus);
+
+    if (failed)
+      continue;
+
+    if (status != 0 || !__atomic_load_n(&shm_ctrl->exit_all, __ATOMIC_ACQUIRE)) {
+      failed = true;
+      exit_status = status;
+      for (int j = 0; j < chpl_numNodes; j++) {
+        if (pids[j] != 0)
+          kill(pids[j], SIGKILL);
+      }
+    } else if (i == 0) {
+      exit_status = status;
+    }
+  }
+
+  return exit_status;
+}
+
+//
+// Fork the locale processes.  Returns in each of them; the original
+// process waits for them and exits.
+//
+static
+void shm_spawn_locales(void) {
+  pid_t* pids = sys_calloc(chpl_numNodes, sizeof(pid_t));
+#ifdef __linux__
+  pid_t monitor = getpid();
+#endif
+
+  fflush(stdout);
+  fflush(stderr);
+
+  for (c_nodeid_t i = 0; i < chpl_numNodes; i++) {
+    pid_t pid = fork();
+
+    if (pid < 0) {
+      for (c_nodeid_t j = 0; j < i; j++)
+        kill(pids[j], SIGKILL);
+      chpl_error("comm shm: cannot fork locale process", 0, 0);
+    }
+
+    if (pid == 0) {
+#ifdef __linux__
+      // Don't outlive the monitor.
+      prctl(PR_SET_PDEATHSIG, SIGKILL);
+      if (getppid() != monitor)
+        _exit(1);
+#endif
+      chpl_nodeID = i;
+      sys_free(pids);
+      return;
+    }
+
+    pids[i] = pid;
+  }
+
+  exit(shm_monitor(pids));
+}
+
+
+////////////////////////////////////////
+//
+// Interface: initialization and shutdown
+//
+
+chpl_comm_nb_handle_t chpl_comm_put_nb(void *addr, c_nodeid_t node, void* raddr,
+                                       size_t size, int32_t commID,
+                                       int ln, int32_t fn)
+{
+  chpl_comm_put(addr, node, raddr, size, commID, ln, fn);
+  return NULL;
+}
+
+chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node, void* raddr,
+                                       size_t size, int32_t commID,
+                                       int ln, int32_t fn)
+{
+  chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
+  return NULL;
+}
+
+int chpl_comm_test_nb_complete(chpl_comm_nb_handle_t h)
+{
+  return ((void*) h) == NULL;
+}
+
+void chpl_comm_wait_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles)
+{
+  size_t i;
+  for( i = 0; i < nhandles; i++ ) {
+    assert(h[i] == NULL);
+  }
+}
+
+int chpl_comm_try_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles)
+{
+  size_t i;
+  for( i = 0; i < nhandles; i++ ) {
+    assert(h[i] == NULL);
+  }
+  return 0;
+}
+
+int chpl_comm_addr_gettable(c_nodeid_t node, void* start, size_t len)
+{
+  return in_shared_region(start, len);
+}
+
+int32_t chpl_comm_getMaxThreads(void) {
+  return 0;
+}
+
+void chpl_comm_init(int *argc_p, char ***argv_p) {
+  int64_t numLocales = chpl_env_rt_get_int("COMM_SHM_NUM_LOCALES", 1);
+
+  if (numLocales < 1 || numLocales > INT32_MAX) {
+    chpl_error("CHPL_RT_COMM_SHM_NUM_LOCALES must be a positive number", 0, 0);
+  }
+
+  chpl_numNodes = (int32_t) numLocales;
+  chpl_nodeID = 0;
+
+  if (chpl_numNodes > 1) {
+    shm_create_region();
+    shm_spawn_locales();
+  }
+
+  // All of the locales share this node.
+  chpl_set_num_locales_on_node(chpl_numNodes);
+  chpl_set_local_rank(chpl_nodeID);
+}
+
+void chpl_comm_pre_mem_init(void) {
+  if (chpl_numNodes == 1) return;
+
+  poll_locks = sys_malloc(chpl_numNodes * AM_NUM_CLASSES * sizeof(*poll_locks));
+  for (int i = 0; i < chpl_numNodes * AM_NUM_CLASSES; i++) {
+    atomic_init_spinlock_t(&poll_locks[i]);
+  }
+}
+
+void chpl_comm_post_mem_init(void) {
+  chpl_comm_init_prv_bcast_tab();
+}
+
+//
+// No support for gdb for now
+//
+int chpl_comm_run_in_gdb(int argc, char* argv[], int gdbArgnum, int* status) {
+  return 0;
+}
+
+//
+// No support for lldb for now
+//
+int chpl_comm_run_in_lldb(int argc, char* argv[], int lldbArgnum, int* status) {
+  return 0;
+}
+
+void chpl_comm_post_task_init(void) {
+  shm_overcommitted = (chpl_numNodes > chpl_sys_getNumCPUsLogical(true));
+  start_polling();
+}
+
+void chpl_comm_rollcall(void) {
+  // Initialize diags
+  chpl_comm_diags_init();
+
+  chpl_msg(2, "executing locale %d of %d on node '%s'\n", chpl_nodeID,
+           chpl_numNodes, chpl_nodeName());
+}
+
+void chpl_comm_impl_regMemHeapInfo(void** start_p, size_t* size_p) {
+  if (shm_heaps == NULL) {
+    *start_p = NULL;
+    *size_p  = 0;
+  } else {
+    *start_p = shm_heaps + (size_t) chpl_nodeID * shm_heap_size;
+    *size_p  = shm_heap_size;
+  }
+}
+
+wide_ptr_t* chpl_comm_broadcast_global_vars_helper(void) {
+  //
+  // Gather the global variables' wide pointers on node 0 into the
+  // table in the shared region.  Everyone already knows where it is,
+  // and reading it is a memcpy.
+  //
+  if (chpl_nodeID == 0) {
+    for (int i = 0; i < chpl_numGlobalsOnHeap; i++) {
+      shm_globals[i] = *chpl_globals_registry[i];
+    }
+    chpl_comm_barrier("fill node 0 globals buf");
+    return NULL; // so common code won't try to free it!
+  } else {
+    chpl_comm_barrier("fill node 0 globals buf");
+    return shm_globals;
+  }
+}
+
+void chpl_comm_broadcast_private(int id, size_t size) {
+  size_t maxsize = AM_MAX_MEDIUM - sizeof(priv_bcast_t);
+  int numOffsets = (size + maxsize - 1) / maxsize;
+  done_t* done;
+  c_nodeid_t node;
+
+  if (chpl_numNodes == 1 || size == 0) return;
+
+  done = (done_t*) chpl_mem_allocManyZero(chpl_numNodes, sizeof(*done),
+                                          CHPL_RT_MD_COMM_FRK_DONE_FLAG,
+                                          0, 0);
+  for (node = 0; node < chpl_numNodes; node++) {
+    if (node != chpl_nodeID)
+      init_done_obj(&done[node], numOffsets);
+  }
+
+  for (size_t offset = 0; offset < size; offset += maxsize) {
+    size_t thissize = size - offset;
+    priv_bcast_t pb;
+
+    if (thissize > maxsize)
+      thissize = maxsize;
+    pb.id = id;
+    pb.offset = (int) offset;
+    pb.size = (int) thissize;
+    for (node = 0; node < chpl_numNodes; node++) {
+      if (node != chpl_nodeID) {
+        pb.ack = &done[node];
+        am_send(node, PRIV_BCAST, &pb, sizeof(pb),
+                (char*) chpl_rt_priv_bcast_tab[id] + offset, thissize);
+      }
+    }
+  }
+
+  // wait for the handlers to complete
+  for (node = 0; node < chpl_numNodes; node++) {
+    if (node != chpl_nodeID)
+      wait_done_obj(&done[node], false);
+  }
+  chpl_mem_free(done, 0, 0);
+}
+
+void chpl_comm_impl_barrier(const char *msg) {
+  uint32_t gen;
+
+  if (chpl_numNodes == 1) return;
+
+  //
+  // A sense-reversing barrier in the shared control block.  The last
+  // locale to arrive starts the next generation.  As required (see
+  // chpl-comm.h), we yield while waiting, and we keep handling active
+  // messages so that locales still working toward the barrier can
+  // make progress.
+  //
+  gen = __atomic_load_n(&shm_ctrl->bar_gen, __ATOMIC_ACQUIRE);
+  if (__atomic_add_fetch(&shm_ctrl->bar_count, 1, __ATOMIC_ACQ_REL)
+      == (uint32_t) chpl_numNodes) {
+    __atomic_store_n(&shm_ctrl->bar_count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&shm_ctrl->bar_gen, gen + 1, __ATOMIC_RELEASE);
+  } else {
+    while (__atomic_load_n(&shm_ctrl->bar_gen, __ATOMIC_ACQUIRE) == gen) {
+      am_poll();
+      chpl_task_yield();
+    }
+  }
+}
+
+void chpl_comm_pre_task_exit(int all) {
+  if (all) {
+    if (chpl_numNodes > 1) {
+      if (chpl_nodeID == 0) {
+        for (int node = 1; node < chpl_numNodes; node++) {
+          am_send(node, SHUTDOWN, NULL, 0, NULL, 0);
+        }
+      } else {
+        chpl_wait_for_shutdown();
+      }
+    }
+
+    chpl_comm_barrier("stop polling");
+
+    //
+    // Tell the polling task to stop, then wait for it to do so.
+    //
+    stop_polling(/*wait*/ true);
+  }
+}
+
+void chpl_comm_exit(int all, int status) {
+  stop_polling(/*wait*/ false);
+
+  if (all && chpl_numNodes > 1) {
+    // chpl_comm_barrier needs the tasking layer (for cache fence) and since
+    // it's shutdown already just directly call the barrier impl.
+    chpl_comm_impl_barrier("exit_comm_shm");
+
+    // Tell the monitor that this is a normal, collective exit.
+    __atomic_store_n(&shm_ctrl->exit_all, 1, __ATOMIC_RELEASE);
+  }
+}
+
+
+////////////////////////////////////////
+//
+// Interface: RMA
+//
+
+void  chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
+                    size_t size, int32_t commID, int ln, int32_t fn) {
+  if (chpl_nodeID == node) {
+    memmove(raddr, addr, size);
+    return;
+  }
+
+  // Communications callback support
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put)) {
+    chpl_comm_cb_info_t cb_data =
+      {chpl_comm_cb_event_kind_put, chpl_nodeID, node,
+       .iu.comm={addr, raddr, size, commID, ln, fn}};
+    chpl_comm_do_callbacks (&cb_data);
+  }
+
+  chpl_comm_diags_verbose_rdma("put", node, size, ln, fn, commID);
+  chpl_comm_diags_incr(put);
+
+  if (in_shared_region(raddr, size)) {
+    memmove(raddr, addr, size);
+  } else {
+    //
+    // The remote address is private to the remote process.  Send the
+    // data in active messages and have the target copy it into place.
+    //
+    size_t max_chunk = AM_MAX_MEDIUM - sizeof(xfer_info_t);
+
+    for (size_t start = 0; start < size; start += max_chunk) {
+      size_t this_size = size - start;
+      xfer_info_t x;
+      done_t done;
+
+      if (this_size > max_chunk)
+        this_size = max_chunk;
+
+      init_done_obj(&done, 1);
+      x.ack = &done;
+      x.tgt = (char*) raddr + start;
+      x.src = NULL;
+      x.size = this_size;
+      am_send(node, DO_COPY_PAYLOAD, &x, sizeof(x),
+              (char*) addr + start, this_size);
+      wait_done_obj(&done, false);
+    }
+  }
+}
+
+void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
+                    size_t size, int32_t commID, int ln, int32_t fn) {
+  if (chpl_nodeID == node) {
+    memmove(addr, raddr, size);
+    return;
+  }
+
+  // Communications callback support
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get)) {
+    chpl_comm_cb_info_t cb_data =
+      {chpl_comm_cb_event_kind_get, chpl_nodeID, node,
+       .iu.comm={addr, raddr, size, commID, ln, fn}};
+    chpl_comm_do_callbacks (&cb_data);
+  }
+
+  chpl_comm_diags_verbose_rdma("get", node, size, ln, fn, commID);
+  chpl_comm_diags_incr(get);
+
+  if (in_shared_region(raddr, size)) {
+    memmove(addr, raddr, size);
+  } else {
+    //
+    // The remote address is private to the remote process.  Ask the
+    // target to send the data back to us in active messages.  These
+    // are independent, so have them all in flight at once.
+    //
+    size_t max_chunk = AM_MAX_MEDIUM - sizeof(xfer_info_t);
+    size_t nchunks = (size + max_chunk - 1) / max_chunk;
+    done_t done;
+
+    init_done_obj(&done, nchunks);
+    for (size_t start = 0; start < size; start += max_chunk) {
+      size_t this_size = size - start;
+      xfer_info_t x;
+
+      if (this_size > max_chunk)
+        this_size = max_chunk;
+
+      x.ack = &done;
+      x.tgt = (char*) addr + start;
+      x.src = (char*) raddr + start;
+      x.size = this_size;
+      am_send(node, DO_REPLY_PUT, &x, sizeof(x), NULL, 0);
+    }
+    if (nchunks > 0)
+      wait_done_obj(&done, false);
+  }
+}
+
+void  chpl_comm_put_strd(void* dstaddr_arg, size_t* dststrides, c_nodeid_t dstnode,
+                         void* srcaddr_arg, size_t* srcstrides, size_t* count,
+                         int32_t stridelevels, size_t elemSize, int32_t commID,
+                         int ln, int32_t fn)
+{
+  put_strd_common(dstaddr_arg, dststrides, dstnode,
+                  srcaddr_arg, srcstrides,
+                  count, stridelevels, elemSize,
+                  1, NULL, // "nb" xfers block, so no need for yield
+                  commID, ln, fn);
+}
+
+void  chpl_comm_get_strd(void* dstaddr_arg, size_t* dststrides, c_nodeid_t srcnode,
+                         void* srcaddr_arg, size_t* srcstrides, size_t* count,
+                         int32_t stridelevels, size_t elemSize, int32_t commID,
+                         int ln, int32_t fn)
+{
+  get_strd_common(dstaddr_arg, dststrides, srcnode,
+                  srcaddr_arg, srcstrides,
+                  count, stridelevels, elemSize,
+                  1, NULL, // "nb" xfers block, so no need for yield
+                  commID, ln, fn);
+}
+
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn)
+{
+  // No native strided transfers, so do the whole thing now.
+  chpl_comm_put_strd(dstaddr, dststrides, dstnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn)
+{
+  chpl_comm_get_strd(dstaddr, dststrides, srcnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
+void chpl_comm_put_indexed(c_nodeid_t dstnode,
+                           size_t dstcount, void* const dstlist[],
+                           size_t dstlen,
+                           size_t srccount, void* const srclist[],
+                           size_t srclen,
+                           int32_t commID, int ln, int32_t fn)
+{
+  put_indexed_common(dstnode, dstcount, dstlist, dstlen,
+                     srccount, srclist, srclen,
+                     1, NULL, // "nb" xfers block, so no need for yield
+                     commID, ln, fn);
+}
+
+void chpl_comm_get_indexed(size_t dstcount, void* const dstlist[],
+                           size_t dstlen,
+                           c_nodeid_t srcnode,
+                           size_t srccount, void* const srclist[],
+                           size_t srclen,
+                           int32_t commID, int ln, int32_t fn)
+{
+  get_indexed_common(dstcount, dstlist, dstlen, srcnode,
+                     srccount, srclist, srclen,
+                     1, NULL, // "nb" xfers block, so no need for yield
+                     commID, ln, fn);
+}
+
+chpl_comm_nb_handle_t chpl_comm_put_indexed_nb(c_nodeid_t dstnode,
+                                               size_t dstcount,
+                                               void* const dstlist[],
+                                               size_t dstlen,
+                                               size_t srccount,
+                                               void* const srclist[],
+                                               size_t srclen,
+                                               int32_t commID,
+                                               int ln, int32_t fn)
+{
+  chpl_comm_put_indexed(dstnode, dstcount, dstlist, dstlen,
+                        srccount, srclist, srclen, commID, ln, fn);
+  return NULL;
+}
+
+chpl_comm_nb_handle_t chpl_comm_get_indexed_nb(size_t dstcount,
+                                               void* const dstlist[],
+                                               size_t dstlen,
+                                               c_nodeid_t srcnode,
+                                               size_t srccount,
+                                               void* const srclist[],
+                                               size_t srclen,
+                                               int32_t commID,
+                                               int ln, int32_t fn)
+{
+  chpl_comm_get_indexed(dstcount, dstlist, dstlen, srcnode,
+                        srccount, srclist, srclen, commID, ln, fn);
+  return NULL;
+}
+
+void chpl_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
+                                c_nodeid_t srcnode, void* srcaddr,
+                                size_t size, int32_t commID,
+                                int ln, int32_t fn)
+{
+  assert(dstaddr != NULL);
+  assert(srcaddr != NULL);
+
+  if (size == 0)
+    return;
+
+  if (dstnode == chpl_nodeID && srcnode == chpl_nodeID) {
+    memmove(dstaddr, srcaddr, size);
+  } else if (dstnode == chpl_nodeID) {
+    chpl_comm_get(dstaddr, srcnode, srcaddr, size, commID, ln, fn);
+  } else if (srcnode == chpl_nodeID) {
+    chpl_comm_put(srcaddr, dstnode, dstaddr, size, commID, ln, fn);
+  } else if (in_shared_region(dstaddr, size)
+             && in_shared_region(srcaddr, size)) {
+    memmove(dstaddr, srcaddr, size);
+  } else {
+    void* tmp = chpl_mem_alloc(size, CHPL_RT_MD_COMM_XMIT_RCV_BUF, ln, fn);
+    chpl_comm_get(tmp, srcnode, srcaddr, size, commID, ln, fn);
+    chpl_comm_put(tmp, dstnode, dstaddr, size, commID, ln, fn);
+    chpl_mem_free(tmp, ln, fn);
+  }
+}
+
+void chpl_comm_get_unordered(void* addr, c_nodeid_t node, void* raddr,
+                             size_t size, int32_t commID, int ln, int32_t fn)
+{
+  chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
+}
+
+void chpl_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
+                             size_t size, int32_t commID, int ln, int32_t fn)
+{
+  chpl_comm_put(addr, node, raddr, size, commID, ln, fn);
+}
+
+void chpl_comm_getput_unordered_task_fence(void) { }
+
+
+////////////////////////////////////////
+//
+// Interface: remote execution
+//
+
+static inline
+void  execute_on_common(c_nodeid_t node, c_sublocid_t subloc,
+                        chpl_fn_int_t fid,
+                        chpl_comm_on_bundle_t *arg, size_t arg_size,
+                        chpl_bool fast, chpl_bool blocking) {
+  done_t done;
+  size_t payload_size = arg_size - sizeof(chpl_comm_on_bundle_t);
+  int large = (sizeof(small_fork_hdr_t) + payload_size > AM_MAX_MEDIUM);
+  small_fork_hdr_t hdr = { .caller = chpl_nodeID,
+                           .subloc = subloc,
+                           .ack = blocking ? &done : NULL,
+                           .infoChapel = *chpl_task_getInfoChapel(),
+                           .fid = fid,
+                           .payload_size = large ? 0 : payload_size };
+
+  if (blocking)
+    init_done_obj(&done, 1);
+
+  // Don't consider it fast if it's large, because the
+  // handler has to GET the bundle.
+  fast = fast && !large;
+
+  arg->kind = CHPL_ARG_BUNDLE_KIND_COMM;
+
+  if (!large) {
+    // Send the header and the payload; the target rebuilds the bundle.
+    am_send(node, fast ? FORK_FAST : (blocking ? FORK : FORK_NB),
+            &hdr, sizeof(hdr), arg + 1, payload_size);
+  } else {
+    // Send a pointer to the bundle so the target can GET it.
+    large_fork_t f;
+
+    if (blocking) {
+      f.arg = arg;
+    } else {
+      // The caller may reuse arg as soon as we return, so the target
+      // gets a copy, which it will tell us to free.
+      f.arg = chpl_mem_allocMany(1, arg_size,
+                                 CHPL_RT_MD_COMM_FRK_SND_ARG, 0, 0);
+      chpl_memcpy(f.arg, arg, arg_size);
+    }
+    f.hdr = hdr;
+    f.arg_size = arg_size;
+
+    am_send(node, blocking ? FORK_LARGE : FORK_NB_LARGE,
+            &f, sizeof(f), NULL, 0);
+  }
+
+  if (blocking)
+    wait_done_obj(&done, !fast);
+}
+
+void  chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
+                           chpl_fn_int_t fid,
+                           chpl_comm_on_bundle_t *arg, size_t arg_size,
+                           int ln, int32_t fn) {
+  if (chpl_nodeID == node) {
+    assert(0);
+    chpl_ftable_call(fid, arg);
+  } else {
+    // Communications callback support
+    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_executeOn, chpl_nodeID, node,
+         .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+    }
+
+    chpl_comm_diags_verbose_executeOn("", node, ln, fn);
+    chpl_comm_diags_incr(execute_on);
+
+    execute_on_common(node, subloc, fid, arg, arg_size,
+                      /*fast*/ false, /*blocking*/ true);
+  }
+}
+
+void  chpl_comm_execute_on_nb(c_nodeid_t node, c_sublocid_t subloc,
+                              chpl_fn_int_t fid,
+                              chpl_comm_on_bundle_t *arg, size_t arg_size,
+                              int ln, int32_t fn) {
+  if (chpl_nodeID == node) {
+    assert(0); // locale model code should prevent this...
+  } else {
+    // Communications callback support
+    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_nb)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_executeOn_nb, chpl_nodeID, node,
+         .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+    }
+
+    chpl_comm_diags_verbose_executeOn("non-blocking", node, ln, fn);
+    chpl_comm_diags_incr(execute_on_nb);
+
+    execute_on_common(node, subloc, fid, arg, arg_size,
+                      /*fast*/ false, /*blocking*/ false);
+  }
+}
+
+void  chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
+                                chpl_fn_int_t fid,
+                                chpl_comm_on_bundle_t *arg, size_t arg_size,
+                                int ln, int32_t fn) {
+  if (chpl_nodeID == node) {
+    assert(0);
+    chpl_ftable_call(fid, arg);
+  } else {
+    // Communications callback support
+    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_fast)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_executeOn_fast, chpl_nodeID, node,
+         .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+    }
+
+    chpl_comm_diags_verbose_executeOn("fast", node, ln, fn);
+    chpl_comm_diags_incr(execute_on_fast);
+
+    execute_on_common(node, subloc, fid, arg, arg_size,
+                      /*fast*/ true, /*blocking*/ true);
+  }
+}
+
+
+////////////////////////////////////////
+//
+// Interface: network atomics
+//
+
+//
+// Do an AMO on the given locale.  Objects in the shared region are
+// operated on directly with CPU atomics; anything else is done by the
+// target in response to an active message.
+//
+static
+chpl_bool32 amo_common(c_nodeid_t node, void* object,
+                       amo_op_t op, amo_type_t type,
+                       const void* opnd1, const void* opnd2, void* result) {
+  size_t size = amo_type_size(type);
+  amo_val_t v1, v2;
+  amo_result_t res;
+
+  memset(&v1, 0, sizeof(v1));
+  memset(&v2, 0, sizeof(v2));
+  memset(&res, 0, sizeof(res));
+  if (opnd1 != NULL)
+    memcpy(&v1, opnd1, size);
+  if (opnd2 != NULL)
+    memcpy(&v2, opnd2, size);
+
+  if (node == chpl_nodeID || in_shared_region(object, size)) {
+    res.ok = do_amo(op, type, object, &v1, &v2, &res.old);
+  } else {
+    amo_req_t req = { .result = &res, .object = object,
+                      .op = op, .type = type,
+                      .opnd1 = v1, .opnd2 = v2 };
+    done_t done;
+
+    init_done_obj(&done, 1);
+    req.ack = &done;
+    am_send(node, DO_AMO, &req, sizeof(req), NULL, 0);
+    wait_done_obj(&done, false);
+  }
+
+  if (result != NULL)
+    memcpy(result, &res.old, size);
+
+  return res.ok;
+}
+
+#define DEFN_CHPL_COMM_ATOMIC_WRITE(fnType)                             \
+  void chpl_comm_atomic_write_##fnType                                  \
+         (void* desired, c_nodeid_t node, void* object,                 \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo write", node, ln, fn);             \
+    chpl_comm_diags_incr(amo);                                          \
+    (void) amo_common(node, object, amo_write, amo_##fnType,            \
+                      desired, NULL, NULL);                             \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_READ(fnType)                              \
+  void chpl_comm_atomic_read_##fnType                                   \
+         (void* result, c_nodeid_t node, void* object,                  \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo read", node, ln, fn);              \
+    chpl_comm_diags_incr(amo);                                          \
+    (void) amo_common(node, object, amo_read, amo_##fnType,             \
+                      NULL, NULL, result);                              \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_XCHG(fnType)                              \
+  void chpl_comm_atomic_xchg_##fnType                                   \
+         (void* desired, c_nodeid_t node, void* object, void* result,   \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo xchg", node, ln, fn);              \
+    chpl_comm_diags_incr(amo);                                          \
+    (void) amo_common(node, object, amo_xchg, amo_##fnType,             \
+                      desired, NULL, result);                           \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_CMPXCHG(fnType)                           \
+  void chpl_comm_atomic_cmpxchg_##fnType                                \
+         (void* expected, void* desired, c_nodeid_t node, void* object, \
+          chpl_bool32* result, memory_order succ, memory_order fail,    \
+          int ln, int32_t fn) {                                         \
+    amo_val_t old;                                                      \
+    chpl_comm_diags_verbose_amo("amo cmpxchg", node, ln, fn);           \
+    chpl_comm_diags_incr(amo);                                          \
+    *result = amo_common(node, object, amo_cmpxchg, amo_##fnType,       \
+                         expected, desired, &old);                      \
+    if (!*result)                                                       \
+      memcpy(expected, &old, amo_type_size(amo_##fnType));              \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_BINARY(op, fnType)                        \
+  void chpl_comm_atomic_##op##_##fnType                                 \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo " #op, node, ln, fn);              \
+    chpl_comm_diags_incr(amo);                                          \
+    (void) amo_common(node, object, amo_##op, amo_##fnType,             \
+                      operand, NULL, NULL);                             \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_##op##_unordered_##fnType                       \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          int ln, int32_t fn) {                                         \
+    chpl_comm_diags_verbose_amo("amo unord_" #op, node, ln, fn);        \
+    chpl_comm_diags_incr(amo);                                          \
+    (void) amo_common(node, object, amo_##op, amo_##fnType,             \
+                      operand, NULL, NULL);                             \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_fetch_##op##_##fnType                           \
+         (void* operand, c_nodeid_t node, void* object, void* result,   \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo fetch_" #op, node, ln, fn);        \
+    chpl_comm_diags_incr(amo);                                          \
+    (void) amo_common(node, object, amo_##op, amo_##fnType,             \
+                      operand, NULL, result);                           \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_ALL_TYPES(DEFN)                           \
+  DEFN(int32)                                                           \
+  DEFN(int64)                                                           \
+  DEFN(uint32)                                                          \
+  DEFN(uint64)                                                          \
+  DEFN(real32)                                                          \
+  DEFN(real64)
+
+DEFN_CHPL_COMM_ATOMIC_ALL_TYPES(DEFN_CHPL_COMM_ATOMIC_WRITE)
+DEFN_CHPL_COMM_ATOMIC_ALL_TYPES(DEFN_CHPL_COMM_ATOMIC_READ)
+DEFN_CHPL_COMM_ATOMIC_ALL_TYPES(DEFN_CHPL_COMM_ATOMIC_XCHG)
+DEFN_CHPL_COMM_ATOMIC_ALL_TYPES(DEFN_CHPL_COMM_ATOMIC_CMPXCHG)
+
+DEFN_CHPL_COMM_ATOMIC_BINARY(and, int32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(and, int64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(and, uint32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(and, uint64)
+
+DEFN_CHPL_COMM_ATOMIC_BINARY(or, int32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(or, int64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(or, uint32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(or, uint64)
+
+DEFN_CHPL_COMM_ATOMIC_BINARY(xor, int32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(xor, int64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(xor, uint32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(xor, uint64)
+
+DEFN_CHPL_COMM_ATOMIC_BINARY(add, int32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(add, int64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(add, uint32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(add, uint64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(add, real32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(add, real64)
+
+DEFN_CHPL_COMM_ATOMIC_BINARY(sub, int32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(sub, int64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(sub, uint32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(sub, uint64)
+DEFN_CHPL_COMM_ATOMIC_BINARY(sub, real32)
+DEFN_CHPL_COMM_ATOMIC_BINARY(sub, real64)
+
+#undef DEFN_CHPL_COMM_ATOMIC_WRITE
+#undef DEFN_CHPL_COMM_ATOMIC_READ
+#undef DEFN_CHPL_COMM_ATOMIC_XCHG
+#undef DEFN_CHPL_COMM_ATOMIC_CMPXCHG
+#undef DEFN_CHPL_COMM_ATOMIC_BINARY
+#undef DEFN_CHPL_COMM_ATOMIC_ALL_TYPES
+
+void chpl_comm_atomic_unordered_task_fence(void) { }
@@ -92,6 +92,8 @@ static void _qio_buffered_advance_cached_leave_bits(qio_channel_t* ch);
 // when rounding up to 4k pages.
 ssize_t qio_too_small_for_default_mmap = 16*1024;
 ssize_t qio_mmap_chunk_iobufs = 128; // mmap 128 iobufs at a time (8M)
+// sequential mmap readers double their chunk size up to this (128M)
+ssize_t qio_mmap_max_chunk_iobufs = 2048;
 
 // Future - possibly set this based on ulimit?
 ssize_t qio_initial_mmap_max = 8*1024*1024;
@@ -104,6 +106,14 @@ ssize_t qio_write_unbuffered_threshold = 32*1024;
 // can avoid buffering by calling pread/fread/read directly
 ssize_t qio_read_unbuffered_threshold = 32*1024;
 
+// Buffered channels using pread/pwrite grow their read-ahead and
+// write-behind windows while they are used sequentially, doubling up to
+// this many iobufs. The window is held in memory by each channel, so with
+// the default 64K iobufs this caps the extra memory at 512K per reading
+// or writing channel. 0 disables.
+ssize_t qio_readahead_max_iobufs = 8;
+ssize_t qio_writebehind_max_iobufs = 8;
+
 #ifdef _chplrt_H_
 qioerr qio_lock(qio_lock_t* x) {
   // recursive mutex based on glibc pthreads implementation
@@ -231,7 +241,8 @@ error:
   return err;
 }
 
-qioerr qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read)
+static
+qioerr _qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read, int use_uring)
 {
   ssize_t nread = 0;
   int64_t num_bytes = qbuffer_iter_num_bytes(start, end);
@@ -257,7 +268,9 @@ qioerr qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffe
   if( err ) goto error;
 
   // read into our buffer.
-  if (file->fd != -1)
+  if (file->fd != -1 && use_uring)
+    err = qio_int_to_err(sys_uring_preadv(file->fd, iov, iovcnt, seek_to_offset, &nread));
+  else if (file->fd != -1)
     err = qio_int_to_err(sys_preadv(file->fd, iov, iovcnt, seek_to_offset, &nread));
   else
     QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid file descriptor");
@@ -272,6 +285,16 @@ error:
 
 }
 
+qioerr qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read)
+{
+  return _qio_preadv(file, buf, start, end, seek_to_offset, num_read, 0);
+}
+
+qioerr qio_uring_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read)
+{
+  return _qio_preadv(file, buf, start, end, seek_to_offset, num_read, 1);
+}
+
 qioerr qio_freadv(FILE* fp, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, ssize_t* num_read)
 {
   int64_t total_read = 0;
@@ -369,7 +392,8 @@ error:
 
 
 
-qioerr qio_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written)
+static
+qioerr _qio_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written, int use_uring)
 {
   ssize_t nwritten = 0;
   int64_t num_bytes = qbuffer_iter_num_bytes(start, end);
@@ -395,7 +419,9 @@ qioerr qio_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuff
   if( err ) goto error;
 
   // write from our buffer
-  if (file->fd != -1)
+  if (file->fd != -1 && use_uring)
+    err = qio_int_to_err(sys_uring_pwritev(file->fd, iov, iovcnt, seek_to_offset, &nwritten));
+  else if (file->fd != -1)
     err = qio_int_to_err(sys_pwritev(file->fd, iov, iovcnt, seek_to_offset, &nwritten));
   else
     QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid file descriptor");
@@ -410,6 +436,16 @@ error:
   return err;
 }
 
+qioerr qio_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written)
+{
+  return _qio_pwritev(file, buf, start, end, seek_to_offset, num_written, 0);
+}
+
+qioerr qio_uring_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written)
+{
+  return _qio_pwritev(file, buf, start, end, seek_to_offset, num_written, 1);
+}
+
 qioerr qio_recv(fd_t sockfd, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int flags,
               sys_sockaddr_t* src_addr_out, /* can be NULL */
               void* ancillary_out, socklen_t* ancillary_len_inout, /* can be NULL */
@@ -655,9 +691,26 @@ qioerr qio_madvise_for_hints(void* data, int64_t len, qio_hint_t hints)
   if( advice == 0 ) err = 0; // do nothing.
   else err = qio_int_to_err(sys_posix_madvise(data, len, advice));
 
+#ifdef MADV_HUGEPAGE
+  // Huge pages are only a performance hint, and the kernel refuses them
+  // for many file systems, so ignore any error here.
+  if( hints & QIO_HINT_HUGEPAGE ) {
+    sys_madvise(data, len, MADV_HUGEPAGE);
+  }
+#endif
+
   return err;
 }
 
+static
+int qio_mmap_populate_flag(qio_hint_t hints)
+{
+#ifdef MAP_POPULATE
+  if( hints & QIO_HINT_POPULATE ) return MAP_POPULATE;
+#endif
+  return 0;
+}
+
 static
 qioerr qio_mmap_initial(qio_file_t* file)
 {
@@ -680,13 +733,7 @@ qioerr qio_mmap_initial(qio_file_t* file)
   if( do_mmap_initial ) {
     void* data;
     int prot = PROT_READ;
-    int populate = 0;
-
-#ifdef MAP_POPULATE
-    if( file->hints & QIO_HINT_CACHED ) {
-      populate = MAP_POPULATE;
-    }
-#endif
+    int populate = qio_mmap_populate_flag(file->hints);
 
     if( file->fdflags & QIO_FDFLAG_WRITEABLE ) prot |= PROT_WRITE;
 
@@ -1565,6 +1612,15 @@ qioerr _qio_channel_init_file(qio_channel_t* ch, qio_file_t* file, qio_hint_t hi
   } else {
     ch->bufIoMax = 64 * 1024; // use a reasonable default
   }
+
+  ch->readahead = 0;
+  ch->readahead_end = ch->av_end;
+  ch->writebehind = 0;
+  ch->mmap_chunk = 0;
+  ch->mmap_count = 0;
+  ch->mmap_bytes = 0;
+  ch->mmap_minflt_base = 0;
+  ch->mmap_majflt_base = 0;
   //_qio_buffered_setup_cached(ch);
 
   return 0;
@@ -2116,7 +2172,7 @@ qioerr _buffered_get_mmap(qio_channel_t* ch, int64_t amt_in, int writing)
 {
   qbuffer_iter_t start;
   qioerr err;
-  size_t mmap_chunk = qio_mmap_chunk_iobufs * qbytes_iobuf_size;
+  int64_t mmap_chunk;
   struct stat stats;
   int prot;
   void* data;
@@ -2136,6 +2192,14 @@ qioerr _buffered_get_mmap(qio_channel_t* ch, int64_t amt_in, int writing)
     QIO_RETURN_CONSTANT_ERROR(EINVAL, "internal error");
   }
 
+  // Sequential readers map larger chunks as they go (see the end of
+  // this function), so that a long scan makes fewer mmap calls and
+  // the kernel sees larger regions to read ahead and back with huge
+  // pages. Writers keep the fixed size since each mapping extends
+  // the file.
+  mmap_chunk = qio_mmap_chunk_iobufs * qbytes_iobuf_size;
+  if( !writing && ch->mmap_chunk > mmap_chunk ) mmap_chunk = ch->mmap_chunk;
+
   // round start down to page size.
   pagesize = sys_page_size();
 
@@ -2205,7 +2269,9 @@ qioerr _buffered_get_mmap(qio_channel_t* ch, int64_t amt_in, int writing)
   // If we're not going to get all the requested data, return EEOF.
   if( len < amt ) eof = 1;
 
-  if( len > 0 ) {
+  // At EOF, len only covers the part of the last page we already have;
+  // don't map it again.
+  if( len > skip ) {
     // OK, now mmap
     prot = PROT_READ;
     if( ch->flags & QIO_FDFLAG_WRITEABLE ) prot |= PROT_WRITE;
@@ -2213,9 +2279,29 @@ qioerr _buffered_get_mmap(qio_channel_t* ch, int64_t amt_in, int writing)
     // This check is (only) important for 32-bit systems.
     if( len > SSIZE_MAX ) QIO_RETURN_CONSTANT_ERROR(EOVERFLOW, "overflow in mmap");
 
-    err = qio_int_to_err(sys_mmap(NULL, len, prot, MAP_SHARED, ch->file->fd, map_start, &data));
+    if( ch->mmap_count == 0 ) {
+      sys_page_faults(&ch->mmap_minflt_base, &ch->mmap_majflt_base);
+    }
+
+    err = qio_int_to_err(sys_mmap(NULL, len, prot,
+                                  MAP_SHARED|qio_mmap_populate_flag(ch->hints),
+                                  ch->file->fd, map_start, &data));
     if( err ) return err;
 
+    err = qio_madvise_for_hints(data, len, ch->hints);
+    if( err ) {
+      sys_munmap(data, len);
+      return err;
+    }
+
+    ch->mmap_count++;
+    ch->mmap_bytes += len;
+
+    if( !writing && !(ch->hints & QIO_HINT_RANDOM) ) {
+      int64_t max_chunk = qio_mmap_max_chunk_iobufs * qbytes_iobuf_size;
+      if( 2 * mmap_chunk <= max_chunk ) ch->mmap_chunk = 2 * mmap_chunk;
+    }
+
     err = qbytes_create_generic(&bytes, data, len, qbytes_free_munmap);
     if( err ) {
       sys_munmap(data, len);
@@ -2235,15 +2321,58 @@ qioerr _buffered_get_mmap(qio_channel_t* ch, int64_t amt_in, int writing)
   else return 0;
 }
 
+// Can this channel use adaptive read-ahead and write-behind?
+// Only for seekable pread/pwrite files: reading ahead on a pipe or
+// terminal could block waiting for input nobody asked for, and O_DIRECT
+// requires the caller to control the I/O sizes.
+static
+int _qio_channel_adaptive_ok(qio_channel_t* ch)
+{
+  qio_method_t method = (qio_method_t) (ch->hints & QIO_METHODMASK);
+
+  return (method == QIO_METHOD_PREADPWRITE || method == QIO_METHOD_URING) &&
+         ch->chan_info == NULL &&
+         !(ch->hints & QIO_HINT_DIRECT) &&
+         !(ch->hints & QIO_HINT_RANDOM);
+}
+
+// Grow or reset the read-ahead window before a read.
+// A reader that asks for more data at the point where the last read
+// ended is reading sequentially, so its window doubles; any seek
+// (which moves av_end) resets it.
+static
+int64_t _qio_channel_next_readahead(qio_channel_t* ch)
+{
+  int64_t max_window = qio_readahead_max_iobufs * qbytes_iobuf_size;
+
+  if( !_qio_channel_adaptive_ok(ch) || max_window <= 0 ) return 0;
+
+  if( ch->hints & QIO_HINT_SEQUENTIAL ) {
+    ch->readahead = max_window;
+  } else if( ch->av_end != ch->readahead_end ) {
+    ch->readahead = 0;
+  } else if( ch->readahead == 0 ) {
+    ch->readahead = qbytes_iobuf_size;
+  } else if( ch->readahead < max_window ) {
+    ch->readahead *= 2;
+    if( ch->readahead > max_window ) ch->readahead = max_window;
+  }
+
+  return ch->readahead;
+}
+
 // Runs read or pread, whichever is appropriate,
-// to read into the buffer.
+// to read into the buffer at least 'amt' bytes, and up to 'ahead' more.
+// Errors (including EOF) past the first 'amt' bytes are ignored;
+// they will be reported if the data is actually required.
 static
-qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
+qioerr _buffered_read_atleast_ahead(qio_channel_t* ch, int64_t amt, int64_t ahead)
 {
   qbuffer_iter_t read_start;
   qbuffer_iter_t read_end;
   ssize_t num_read;
   int64_t left = amt;
+  int64_t got = 0;
   int64_t max_amt;
   int return_eof = 0;
   qioerr err;
@@ -2268,13 +2397,16 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
     return chpl_qio_read_atleast(ch->chan_info, amt);
   }
 
+  if( ahead > max_amt - amt ) ahead = max_amt - amt;
+  if( ahead < 0 ) ahead = 0;
+
   //printf("Allocating bufferspace %lli\n", (long long int) amt);
-  err = _buffered_allocate_bufferspace(ch, amt, max_amt);
+  err = _buffered_allocate_bufferspace(ch, amt + ahead, max_amt);
   if( err ) return err;
 
   read_start = _av_end_iter(ch);
 
-  left = amt;
+  left = amt + ahead;
   while(left > 0) {
     read_end = read_start;
     qbuffer_iter_advance(&ch->buf, &read_end, left);
@@ -2291,6 +2423,9 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
       case QIO_METHOD_PREADPWRITE:
         err = qio_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
         break;
+      case QIO_METHOD_URING:
+        err = qio_uring_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
+        break;
       case QIO_METHOD_FREADFWRITE:
         err = qio_freadv(ch->file->fp, &ch->buf, read_start, read_end, &num_read);
         break;
@@ -2303,15 +2438,23 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
     }
 
     left -= num_read;
+    got += num_read;
     qbuffer_iter_advance(&ch->buf, &read_start, num_read);
 
     // Ignore interrupted system call, just keep reading.
     if( err && qio_err_to_int(err) == EINTR ) err = 0;
 
+    // Ignore problems reading ahead once we have what was required.
+    if( err && got >= amt ) {
+      err = 0;
+      break;
+    }
+
     if( err ) break;
   }
 
   ch->av_end = read_start.offset;
+  ch->readahead_end = ch->av_end;
 
   if( err ) return err;
 
@@ -2688,6 +2831,28 @@ qioerr _qio_buffered_behind(qio_channel_t* ch, int flushall)
     goto done;
   }
 
+  // Collect finished iobufs until the write-behind window is full, so
+  // that a sequential writer makes fewer, larger writes. The window
+  // doubles after each write, up to qio_writebehind_max_iobufs.
+  if( !flushall && _qio_channel_adaptive_ok(ch) &&
+      (ch->flags & QIO_FDFLAG_WRITEABLE) ) {
+    int64_t max_window = qio_writebehind_max_iobufs * qbytes_iobuf_size;
+
+    if( nbytes < ch->writebehind ) {
+      err = 0;
+      goto done;
+    }
+
+    if( ch->hints & QIO_HINT_SEQUENTIAL ) {
+      ch->writebehind = max_window;
+    } else if( ch->writebehind == 0 ) {
+      ch->writebehind = qbytes_iobuf_size;
+    } else if( ch->writebehind < max_window ) {
+      ch->writebehind *= 2;
+      if( ch->writebehind > max_window ) ch->writebehind = max_window;
+    }
+  }
+
   //fprintf(stderr, "starting write\n");
   //debug_print_qbuffer(&ch->buf);
 
@@ -2711,6 +2876,9 @@ qioerr _qio_buffered_behind(qio_channel_t* ch, int flushall)
         case QIO_METHOD_PREADPWRITE:
           err = qio_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
           break;
+        case QIO_METHOD_URING:
+          err = qio_uring_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
+          break;
         case QIO_METHOD_FREADFWRITE:
           err = qio_fwritev(ch->file->fp, &ch->buf, write_start, write_end, &num_written);
           break;
@@ -2790,7 +2958,8 @@ qioerr _qio_channel_require_unlocked(qio_channel_t* ch, int64_t amt, int writing
   } else {
     if( ch->flags & QIO_FDFLAG_READABLE ) {
       // we're reading the data. So read some data!
-      err = _buffered_read_atleast(ch, n_needed);
+      err = _buffered_read_atleast_ahead(ch, n_needed,
+                                         _qio_channel_next_readahead(ch));
     } else {
       // Just writing. Add some space to the end of the channel.
       err = _buffered_makespace_atleast(ch, n_needed);
@@ -2869,6 +3038,10 @@ qioerr _qio_buffered_read(qio_channel_t* ch, void* ptr, ssize_t len, ssize_t* am
           err = qio_int_to_err(sys_pread(ch->file->fd, ptr, remaining,
                                _right_mark_start(ch), &num_read));
           break;
+        case QIO_METHOD_URING:
+          err = qio_int_to_err(sys_uring_pread(ch->file->fd, ptr, remaining,
+                               _right_mark_start(ch), &num_read));
+          break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
             num_read_u = fread(ptr, 1, remaining, ch->file->fp);
@@ -3020,6 +3193,9 @@ qioerr _qio_buffered_write(qio_channel_t* ch, const void* ptr, ssize_t len, ssiz
         case QIO_METHOD_PREADPWRITE:
           err = qio_int_to_err(sys_pwrite(ch->file->fd, ptr, remaining, _right_mark_start(ch), &num_written));
           break;
+        case QIO_METHOD_URING:
+          err = qio_int_to_err(sys_uring_pwrite(ch->file->fd, ptr, remaining, _right_mark_start(ch), &num_written));
+          break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
             num_written_u = fwrite(ptr, 1, remaining, ch->file->fp);
@@ -3144,6 +3320,9 @@ qioerr _qio_unbuffered_write(qio_channel_t* ch, const void* ptr, ssize_t len_in,
         case QIO_METHOD_PREADPWRITE:
           err = qio_int_to_err(sys_pwrite(ch->file->fd, ptr, len, _right_mark_start(ch), &num_written));
           break;
+        case QIO_METHOD_URING:
+          err = qio_int_to_err(sys_uring_pwrite(ch->file->fd, ptr, len, _right_mark_start(ch), &num_written));
+          break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
             num_written_u = fwrite(ptr, 1, len, ch->file->fp);
@@ -3220,7 +3399,8 @@ qioerr _qio_unbuffered_read(qio_channel_t* ch, void* ptr, ssize_t len_in, ssize_
   len = len_in;
 
   if( ch->file->mmap &&
-      (method == QIO_METHOD_PREADPWRITE || method == QIO_METHOD_MMAP) &&
+      (method == QIO_METHOD_PREADPWRITE || method == QIO_METHOD_URING ||
+       method == QIO_METHOD_MMAP) &&
       _right_mark_start(ch) + len <= ch->file->mmap->len) {
     // As long as we're using an I/O method that seeks on every read,
     // copy the data out of the mmap.
@@ -3238,6 +3418,9 @@ qioerr _qio_unbuffered_read(qio_channel_t* ch, void* ptr, ssize_t len_in, ssize_
         case QIO_METHOD_PREADPWRITE:
           err = qio_int_to_err(sys_pread(ch->file->fd, ptr, len, _right_mark_start(ch), &num_read));
           break;
+        case QIO_METHOD_URING:
+          err = qio_int_to_err(sys_uring_pread(ch->file->fd, ptr, len, _right_mark_start(ch), &num_read));
+          break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
             num_read_u = fread(ptr, 1, len, ch->file->fp);
@@ -3444,6 +3627,40 @@ qioerr qio_channel_end_offset(const int threadsafe, qio_channel_t* ch, int64_t*
   return 0;
 }
 
+qioerr qio_channel_mmap_stats(const int threadsafe, qio_channel_t* ch,
+                              int64_t* nmaps_out, int64_t* bytes_out,
+                              int64_t* minflt_out, int64_t* majflt_out)
+{
+  qioerr err;
+  int64_t minflt = 0;
+  int64_t majflt = 0;
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  *nmaps_out = ch->mmap_count;
+  *bytes_out = ch->mmap_bytes;
+  *minflt_out = 0;
+  *majflt_out = 0;
+
+  err = 0;
+  if( ch->mmap_count > 0 ) {
+    err = qio_int_to_err(sys_page_faults(&minflt, &majflt));
+    if( !err ) {
+      *minflt_out = minflt - ch->mmap_minflt_base;
+      *majflt_out = majflt - ch->mmap_majflt_base;
+    }
+  }
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  return err;
+}
+
 static
 qioerr _qio_channel_put_bytes_unlocked(qio_channel_t* ch, qbytes_t* bytes, int64_t skip_bytes, int64_t len_bytes)
 {
@@ -24,6 +24,7 @@
 #endif
 
 #include "qio_formatted.h"
+#include "qio_scan.h"
 
 #include <limits.h>
 #include <ctype.h>
@@ -149,6 +150,13 @@ qioerr _peek_until_byte(qio_channel_t* restrict ch, uint8_t term_byte, int64_t*
   if( err ) return err;
 
   while( 1 ) {
+    // Search what is already buffered before reading byte-by-byte.
+    if( qio_space_in_ptr_diff(1, ch->cached_end, ch->cached_cur) ) {
+      ch->cached_cur = (void*) qio_scan_find_byte(ch->cached_cur,
+                                                  ch->cached_end,
+                                                  term_byte);
+    }
+
     err = qio_channel_read_uint8(false, ch, &byte);
     if( err ) break;
     if( byte == term_byte ) break;
@@ -344,6 +352,45 @@ qioerr _append_char(char* restrict * restrict buf, size_t* restrict buf_len, siz
   return 0;
 }
 
+// always appends room for a NULL byte at the end.
+static
+qioerr _append_bytes(char* restrict * restrict buf, size_t* restrict buf_len, size_t* restrict buf_max, const void* bytes, size_t nbytes)
+{
+  char* buf_in = *buf;
+  size_t len_in = *buf_len;
+  size_t max_in = *buf_max;
+  char* newbuf;
+  size_t newsz;
+  size_t need;
+
+  need = len_in + nbytes + 1;
+  if( need < len_in || need > (SSIZE_MAX-1) ) {
+    // Too big.
+    QIO_RETURN_CONSTANT_ERROR(EOVERFLOW, "");
+  }
+  // First, make sure that there is room.
+  if( need >= max_in ) {
+    // Reallocate buffer.
+    newsz = 2 * max_in;
+    if( newsz < 16  ) newsz = 16;
+    if( newsz < need  ) newsz = need;
+    newbuf = qio_realloc(buf_in, newsz);
+    if( ! newbuf ) return QIO_ENOMEM;
+    buf_in = newbuf;
+    max_in = newsz;
+  }
+
+  // Now store them in the buffer.
+  qio_memcpy(&buf_in[len_in], bytes, nbytes);
+  len_in += nbytes;
+
+  *buf = buf_in;
+  *buf_len = len_in;
+  *buf_max = max_in;
+
+  return 0;
+}
+
 // string binary style:
 // QIO_BINARY_STRING_STYLE_LEN1B_DATA -1 -- 1 byte of length before
 // QIO_BINARY_STRING_STYLE_LEN2B_DATA -2 -- 2 bytes of length before
@@ -611,6 +658,36 @@ qioerr qio_channel_scan_string(const int threadsafe, qio_channel_t* restrict ch,
       // limit # bytes
       qio_channel_offset_unlocked(ch) - mark_offset < maxlen_bytes;
       nread++ ) {
+    // Copy a run of plain ASCII characters straight out of the buffer.
+    // Backslashes, the terminator, whitespace (for FORMAT_WORD) and
+    // multibyte characters are all handled one at a time below.
+    if( nread > 0 &&
+        qio_space_in_ptr_diff(1, ch->cached_end, ch->cached_cur) ) {
+      const uint8_t* start = (const uint8_t*) ch->cached_cur;
+      const uint8_t* stop;
+      ssize_t run;
+      ssize_t room_bytes = maxlen_bytes -
+                           (qio_channel_offset_unlocked(ch) - mark_offset);
+
+      stop = qio_scan_find_special(start, ch->cached_end,
+                                   handle_back ? '\\' : 0x80,
+                                   (!stop_space && 0 <= term_chr &&
+                                    term_chr < 0x80) ? term_chr : 0x80,
+                                   stop_space);
+      run = stop - start;
+      if( run > maxlen_chars - nread ) run = maxlen_chars - nread;
+      if( run > room_bytes ) run = room_bytes;
+
+      if( run > 0 ) {
+        err = _append_bytes(&ret, &ret_len, &ret_max, start, run);
+        if( err ) break;
+        ch->cached_cur = qio_ptr_add(ch->cached_cur, run);
+        // the loop increment counts one more, and rechecks the limits
+        nread += run - 1;
+        continue;
+      }
+    }
+
     err = qio_channel_read_char(false, ch, &chr);
     if( err ) break;
 
@@ -2151,6 +2228,27 @@ static inline bool is_json_whitespace(int32_t c)
            c == '\f' || c == '\n' || c == '\r' || c == '\t' );
 }
 
+// Skip the common JSON whitespace bytes already in the channel's buffer.
+// Anything else (including the rarer \b and \f) is left for the
+// byte-at-a-time loops below.
+static inline void _skip_cached_json_whitespace(qio_channel_t* restrict ch)
+{
+  if( qio_space_in_ptr_diff(1, ch->cached_end, ch->cached_cur) ) {
+    ch->cached_cur = (void*) qio_scan_skip_bytes4(ch->cached_cur,
+                                                  ch->cached_end,
+                                                  ' ', '\n', '\r', '\t');
+  }
+}
+
+// Skip the digits already in the channel's buffer.
+static inline void _skip_cached_digits(qio_channel_t* restrict ch)
+{
+  if( qio_space_in_ptr_diff(1, ch->cached_end, ch->cached_cur) ) {
+    ch->cached_cur = (void*) qio_scan_skip_digits(ch->cached_cur,
+                                                  ch->cached_end);
+  }
+}
+
 // Read and skip an arbitrary JSON object, assuming the leading '{'
 // has already been read. Returns 0 on success or a negative error code.
 int32_t qio_skip_json_object_unlocked(qio_channel_t* restrict ch)
@@ -2165,6 +2263,7 @@ int32_t qio_skip_json_object_unlocked(qio_channel_t* restrict ch)
     // Read whitespace followed by , or '}'
     if( c == 0 || is_json_whitespace(c) ) {
       while( true ) {
+        _skip_cached_json_whitespace(ch);
         c = qio_channel_read_byte(false, ch);
         if( c < 0 ) return c;
         if( is_json_whitespace(c) ) {
@@ -2200,6 +2299,7 @@ int32_t qio_skip_json_array_unlocked(qio_channel_t* restrict ch)
     // Read a whitespace followed by , or ']'
     if( c == 0 || is_json_whitespace(c) ) {
       while( true ) {
+        _skip_cached_json_whitespace(ch);
         c = qio_channel_read_byte(false, ch);
         if( c < 0 ) return c;
         if( is_json_whitespace(c) ) {
@@ -2231,6 +2331,7 @@ int32_t qio_skip_json_value_unlocked(qio_channel_t* restrict ch)
 
   // Read whitespace and then a value.
   while( true ) {
+    _skip_cached_json_whitespace(ch);
     c = qio_channel_read_byte(false, ch);
     if( c < 0 ) return c;
     if( is_json_whitespace(c) ) {
@@ -2246,6 +2347,7 @@ int32_t qio_skip_json_value_unlocked(qio_channel_t* restrict ch)
   } else if( c == '-' || ('0' <= c && c <= '9') ) {
     // read digits before .
     while( true ) {
+      _skip_cached_digits(ch);
       c = qio_channel_read_byte(false, ch);
       if( c < 0 ) return c;
       if( '0' <= c && c <= '9' ) {
@@ -2260,6 +2362,7 @@ int32_t qio_skip_json_value_unlocked(qio_channel_t* restrict ch)
     if( c == '.' ) {
       // read some more digits after .
       while( true ) {
+        _skip_cached_digits(ch);
         c = qio_channel_read_byte(false, ch);
         if( c < 0 ) return c;
         if( '0' <= c && c <= '9' ) {
@@ -2282,6 +2385,7 @@ int32_t qio_skip_json_value_unlocked(qio_channel_t* restrict ch)
       }
       // read some more digits
       while( true ) {
+        _skip_cached_digits(ch);
         c = qio_channel_read_byte(false, ch);
         if( c < 0 ) return c;
         if( '0' <= c && c <= '9' ) {
@@ -2353,6 +2457,13 @@ int32_t qio_skip_json_string_unlocked(qio_channel_t* restrict ch)
   int32_t c;
 
   while( true ) {
+    // Skip ahead to the next quote or backslash in the buffer.
+    if( qio_space_in_ptr_diff(1, ch->cached_end, ch->cached_cur) ) {
+      ch->cached_cur = (void*) qio_scan_find_special(ch->cached_cur,
+                                                     ch->cached_end,
+                                                     '\"', '\\', 0);
+    }
+
     c = qio_channel_read_byte(false, ch);
     if( c < 0 ) return c;
 
@@ -2382,6 +2493,7 @@ int32_t qio_skip_json_field_unlocked(qio_channel_t* restrict ch)
 
   // Read a whitespace followed by " or '}'
   while( true ) {
+    _skip_cached_json_whitespace(ch);
     c = qio_channel_read_byte(false, ch);
     if( c < 0 ) return c;
     if( is_json_whitespace(c) ) {
@@ -2404,6 +2516,7 @@ int32_t qio_skip_json_field_unlocked(qio_channel_t* restrict ch)
 
   // Read a whitespace followed by :
   while( true ) {
+    _skip_cached_json_whitespace(ch);
     c = qio_channel_read_byte(false, ch);
     if( c < 0 ) return c;
     if( is_json_whitespace(c) ) {
@@ -2423,6 +2536,145 @@ int32_t qio_skip_json_field_unlocked(qio_channel_t* restrict ch)
   return c;
 }
 
+// Find the first record start at or after 'nominal' within [start, end).
+static
+qioerr _qio_file_next_record_start(qio_file_t* f, int64_t start, int64_t end,
+                                   int64_t nominal,
+                                   const char* delim, ssize_t delim_len,
+                                   int64_t* pos_out)
+{
+  qio_channel_t* ch = NULL;
+  int64_t search_start;
+  int64_t pos = end;
+  char* got = NULL;
+  char got_onstack[MAX_ON_STACK];
+  qioerr err;
+
+  if( nominal <= start ) {
+    *pos_out = start;
+    return 0;
+  }
+  if( nominal >= end ) {
+    *pos_out = end;
+    return 0;
+  }
+
+  // A delimiter ending exactly at 'nominal' starts a record there.
+  search_start = nominal - delim_len;
+  if( search_start < start ) search_start = start;
+
+  MAYBE_STACK_ALLOC(char, delim_len, got, got_onstack);
+  if( ! got ) return QIO_ENOMEM;
+
+  // The probe usually reads only a few bytes past 'nominal', so ask for
+  // random access: no read-ahead window and no growing mmap chunks.
+  err = qio_channel_create(&ch, f, QIO_HINT_RANDOM, 1, 0,
+                           search_start, end, NULL, 0);
+  if( err ) goto error;
+
+  while( 1 ) {
+    int64_t offset;
+
+    // Find the next byte that could begin the delimiter.
+    err = qio_channel_advance_past_byte(false, ch, (uint8_t) delim[0], 1);
+    if( err ) break;
+
+    if( delim_len > 1 ) {
+      // Check the rest of it, backing up if it doesn't match.
+      err = qio_channel_mark(false, ch);
+      if( err ) break;
+      err = qio_channel_read_amt(false, ch, got, delim_len - 1);
+      if( err == 0 && 0 == memcmp(got, delim + 1, delim_len - 1) ) {
+        qio_channel_commit_unlocked(ch);
+      } else {
+        qio_channel_revert_unlocked(ch);
+        if( err && qio_err_to_int(err) != EEOF ) break;
+        err = 0;
+        continue;
+      }
+    }
+
+    offset = qio_channel_offset_unlocked(ch);
+    if( offset >= nominal ) {
+      pos = offset;
+      break;
+    }
+  }
+
+  // No delimiter before the end means no record starts before it.
+  if( qio_err_to_int(err) == EEOF || qio_err_to_int(err) == ESHORT ) err = 0;
+
+error:
+  if( ch ) qio_channel_release(ch);
+  MAYBE_STACK_FREE(got, got_onstack);
+
+  if( ! err ) *pos_out = pos;
+  return err;
+}
+
+qioerr qio_file_record_chunk(qio_file_t* f, int64_t start, int64_t end,
+                             int64_t nchunks, int64_t chunk,
+                             const char* delim, ssize_t delim_len,
+                             int64_t* chunk_start_out, int64_t* chunk_end_out)
+{
+  int64_t len;
+  int64_t chunk_start;
+  int64_t chunk_end;
+  qioerr err;
+
+  if( nchunks < 1 || chunk < 0 || chunk >= nchunks ||
+      delim == NULL || delim_len < 1 || start < 0 || end < start ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid record chunk arguments");
+  }
+
+  if( end == INT64_MAX ) {
+    err = qio_file_length(f, &end);
+    if( err ) return err;
+    if( end < start ) end = start;
+  }
+
+  len = end - start;
+
+  // chunk * len can overflow for very large files and chunk counts
+  err = _qio_file_next_record_start(f, start, end,
+                  start + (int64_t) (((double) len * chunk) / nchunks),
+                  delim, delim_len, &chunk_start);
+  if( err ) return err;
+
+  if( chunk == nchunks - 1 ) {
+    chunk_end = end;
+  } else {
+    err = _qio_file_next_record_start(f, start, end,
+                    start + (int64_t) (((double) len * (chunk+1)) / nchunks),
+                    delim, delim_len, &chunk_end);
+    if( err ) return err;
+  }
+
+  if( chunk_end < chunk_start ) chunk_end = chunk_start;
+
+  *chunk_start_out = chunk_start;
+  *chunk_end_out = chunk_end;
+  return 0;
+}
+
+qioerr qio_channel_create_record_chunk(qio_channel_t** ch_out, qio_file_t* f,
+                                       qio_hint_t hints,
+                                       int64_t start, int64_t end,
+                                       int64_t nchunks, int64_t chunk,
+                                       const char* delim, ssize_t delim_len,
+                                       qio_style_t* style)
+{
+  int64_t chunk_start, chunk_end;
+  qioerr err;
+
+  err = qio_file_record_chunk(f, start, end, nchunks, chunk,
+                              delim, delim_len, &chunk_start, &chunk_end);
+  if( err ) return err;
+
+  return qio_channel_create(ch_out, f, hints, 1, 0,
+                            chunk_start, chunk_end, style, 0);
+}
+
 qioerr qio_channel_skip_json_field(const int threadsafe, qio_channel_t* ch)
 {
   qioerr err;
@@ -2722,6 +2974,102 @@ error:
 }
 
 
+// Convert the 8 ASCII digits at p, most significant first, using
+// a few multiplies on a 64-bit word instead of 8 multiply-adds.
+static inline
+uint32_t _parse_8_digits(const uint8_t* p)
+{
+  uint64_t v;
+  qio_memcpy(&v, p, 8);
+  v = le64toh(v);
+  v = ((v & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+  v = ((v & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+  return (uint32_t) (((v & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32);
+}
+
+// Convert ndigits (at most 19, so the result can't overflow)
+// ASCII decimal digits.
+static inline
+uint64_t _parse_digits(const uint8_t* p, ssize_t ndigits)
+{
+  uint64_t v = 0;
+  for( ; ndigits >= 8; ndigits -= 8, p += 8 ) {
+    v = v * 100000000 + _parse_8_digits(p);
+  }
+  for( ; ndigits > 0; ndigits--, p++ ) {
+    v = v * 10 + (*p - '0');
+  }
+  return v;
+}
+
+// Can the fast paths below read numbers in this state?
+// They only handle plain decimal numbers with the default
+// sign, radix point, and exponent characters.
+static inline
+int _fast_decimal_ok(const number_reading_state_t* restrict st)
+{
+  return (st->base == 0 || st->base == 10) &&
+         st->positive_char == '+' &&
+         st->negative_char == '-' &&
+         ! st->allow_i_after &&
+         ( ! st->allow_point || st->point_char == '.' ) &&
+         ( ! st->allow_real || st->exponent_char == 'e' );
+}
+
+// Skip whitespace and an optional sign at the start of a number
+// in the channel's buffer. Returns a pointer to the first
+// character after them.
+static inline
+const uint8_t* _fast_decimal_start(qio_channel_t* restrict ch,
+                                   const number_reading_state_t* restrict st,
+                                   int* restrict sign)
+{
+  const uint8_t* p = (const uint8_t*) ch->cached_cur;
+  const uint8_t* end = (const uint8_t*) ch->cached_end;
+
+  p = qio_scan_skip_bytes4(p, end, ' ', '\n', '\t', '\r');
+  *sign = 1;
+  if( p < end && *p == '+' ) {
+    p++;
+  } else if( p < end && *p == '-' && st->allow_neg_sign ) {
+    *sign = -1;
+    p++;
+  }
+  return p;
+}
+
+// Try to read a decimal integer directly from the channel's buffer.
+// Returns 1 and advances the channel if it did; returns 0 without
+// changing anything when _peek_number_unlocked needs to handle it
+// (a number that might continue past the buffer, a possible 0x/0b/0o
+// prefix, more than 19 digits, a fraction, or anything unusual).
+static
+int _scan_int_fast(qio_channel_t* restrict ch,
+                   const number_reading_state_t* restrict st,
+                   unsigned long long int* restrict num,
+                   int* restrict sign)
+{
+  const uint8_t* end = (const uint8_t*) ch->cached_end;
+  const uint8_t* digits;
+  const uint8_t* p;
+
+  if( ! qio_space_in_ptr_diff(1, ch->cached_end, ch->cached_cur) ) return 0;
+  if( ! _fast_decimal_ok(st) || st->allow_point ) return 0;
+
+  digits = _fast_decimal_start(ch, st, sign);
+  p = qio_scan_skip_digits(digits, end);
+
+  if( p == digits || p == end || p - digits > 19 || *p >= 0x80 ) return 0;
+  if( st->allow_base && p - digits == 1 && *digits == '0' ) {
+    int c = tolower(*p);
+    if( c == 'x' || c == 'o' || c == 'b' ) return 0;
+  }
+
+  *num = _parse_digits(digits, p - digits);
+  ch->cached_cur = (void*) p;
+  return 1;
+}
+
 qioerr qio_channel_scan_int(const int threadsafe, qio_channel_t* restrict ch, void* restrict out, size_t len, int issigned)
 {
   unsigned long long int num = 0;
@@ -2760,6 +3108,12 @@ qioerr qio_channel_scan_int(const int threadsafe, qio_channel_t* restrict ch, vo
   st.positive_char = tolower(style->positive_char);
   st.negative_char = tolower(style->negative_char);
 
+  if( _scan_int_fast(ch, &st, &num, &sign) ) {
+    if( ! issigned ) sign = 1;
+    err = 0;
+    goto error;
+  }
+
   err = _peek_number_unlocked(ch, &st, &amount);
   if( qio_err_to_int(err) == EEOF && st.end > 0 ) err = 0; // we tolerate EOF if there's data.
   if( err ) goto error;
@@ -2877,6 +3231,94 @@ error:
   return err;
 }
 
+// Powers of ten that are exactly representable as doubles.
+static const double _exact_pow10[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Try to read a decimal floating point number directly from the
+// channel's buffer. This handles numbers whose significand fits in
+// 53 bits and whose decimal exponent is within +/-22, where a single
+// multiply or divide of exact values is correctly rounded
+// (Clinger's fast path), so the result matches strtod exactly.
+// Returns 0 without changing anything for everything else
+// (including inf and nan), which goes through strtod.
+static
+int _scan_float_fast(qio_channel_t* restrict ch,
+                     const number_reading_state_t* restrict st,
+                     double* restrict num)
+{
+#if FLT_EVAL_METHOD == 0
+  const uint8_t* end = (const uint8_t*) ch->cached_end;
+  const uint8_t* int_digits;
+  const uint8_t* frac_digits = NULL;
+  const uint8_t* p;
+  ssize_t n_int, n_frac = 0;
+  int sign;
+  int exp_sign = 1;
+  int exp = 0;
+  uint64_t mant;
+  double ret;
+
+  if( ! qio_space_in_ptr_diff(1, ch->cached_end, ch->cached_cur) ) return 0;
+  if( ! _fast_decimal_ok(st) ) return 0;
+
+  int_digits = _fast_decimal_start(ch, st, &sign);
+  p = qio_scan_skip_digits(int_digits, end);
+  n_int = p - int_digits;
+
+  if( p < end && *p == '.' ) {
+    frac_digits = p + 1;
+    p = qio_scan_skip_digits(frac_digits, end);
+    n_frac = p - frac_digits;
+  }
+
+  if( n_int + n_frac == 0 || n_int + n_frac > 19 ) return 0;
+
+  if( p < end && (*p == 'e' || *p == 'E') ) {
+    const uint8_t* exp_digits;
+    p++;
+    if( p < end && (*p == '+' || *p == '-') ) {
+      if( *p == '-' ) exp_sign = -1;
+      p++;
+    }
+    exp_digits = p;
+    p = qio_scan_skip_digits(exp_digits, end);
+    if( p == exp_digits || p - exp_digits > 3 ) return 0;
+    exp = (int) _parse_digits(exp_digits, p - exp_digits);
+  }
+
+  // _peek_number_unlocked would keep going after an exponent if there
+  // is a '.' next, for example; leave those cases to it.
+  if( p == end || *p >= 0x80 || *p == '.' || *p == 'e' || *p == 'E' )
+    return 0;
+  if( st->allow_base && n_int == 1 && *int_digits == '0' && p == int_digits + 1 ) {
+    int c = tolower(*p);
+    if( c == 'x' || c == 'o' || c == 'b' ) return 0;
+  }
+
+  mant = _parse_digits(int_digits, n_int);
+  if( n_frac > 0 ) {
+    mant = mant * (uint64_t) _exact_pow10[n_frac] +
+           _parse_digits(frac_digits, n_frac);
+  }
+  exp = exp_sign * exp - (int) n_frac;
+
+  if( mant > (1ULL << DBL_MANT_DIG) || exp < -22 || exp > 22 ) return 0;
+
+  ret = (double) mant;
+  if( exp < 0 ) ret /= _exact_pow10[-exp];
+  else ret *= _exact_pow10[exp];
+
+  *num = sign < 0 ? -ret : ret;
+  ch->cached_cur = (void*) p;
+  return 1;
+#else
+  return 0;
+#endif
+}
+
 static
 qioerr qio_channel_scan_float_or_imag(const int threadsafe, qio_channel_t* restrict ch, void* restrict out, size_t len, bool imag)
 {
@@ -2922,6 +3364,11 @@ qioerr qio_channel_scan_float_or_imag(const int threadsafe, qio_channel_t* restr
   st.allow_i_after = needs_i;
   st.i_char = style->i_char;
 
+  if( _scan_float_fast(ch, &st, &num) ) {
+    err = 0;
+    goto error;
+  }
+
   err = _peek_number_unlocked(ch, &st, &amount);
   if( qio_err_to_int(err) == EEOF && st.end > 0 ) err = 0; // we tolerate EOF if there's data.
   if( err ) goto error;
@@ -3088,6 +3535,42 @@ static inline int _ltoa_convert(char *tmp, int tmplen, uint64_t num, int base, i
   return at;
 }
 
+static const char _dec_digit_pairs[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+// _ltoa_convert for base 10, producing two digits per division.
+// tmp must have room for 21 bytes.
+static inline int _ltoa_convert_dec(char *tmp, int tmplen, uint64_t num)
+{
+  int at = tmplen - 1;
+  int pair;
+
+  tmp[at] = '\0';
+  while( num >= 100 ) {
+    pair = 2 * (num % 100);
+    num /= 100;
+    tmp[--at] = _dec_digit_pairs[pair + 1];
+    tmp[--at] = _dec_digit_pairs[pair];
+  }
+  if( num >= 10 ) {
+    pair = 2 * num;
+    tmp[--at] = _dec_digit_pairs[pair + 1];
+    tmp[--at] = _dec_digit_pairs[pair];
+  } else {
+    tmp[--at] = '0' + num;
+  }
+  return at;
+}
+
 // dst must have room (at most 65 bytes for binary + '\0')
 // Returns the number of characters written (not including '\0')
 // or >= size if there wasn't room in the buffer (returns amt needed)
@@ -3113,7 +3596,7 @@ int _ltoa(char* restrict dst, size_t size, uint64_t num, int isnegative,
   else if( base == 8 )
     tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 8, 0);
   else if( base == 10 )
-    tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 10, 0);
+    tmp_skip = _ltoa_convert_dec(tmp, sizeof(tmp), num);
   else if( base == 16 )
     tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 16, style->uppercase);
   else
@@ -3313,7 +3796,18 @@ int _ftoa_core(char* buf, size_t buf_sz, double num,
     // We'll add 0x later if we want it.
     if( !isnan(num) && !isinf(num) ) *skip = 2;
   } else if( realfmt == 0 ) {
-    if( precision < 0 ) {
+    if( precision < 0 && num >= 0.0 && num < 100000.0 &&
+        num == (double) (int32_t) num ) {
+      // %g prints these small whole numbers as plain integers.
+      char tmp[24];
+      int at = _ltoa_convert_dec(tmp, sizeof(tmp), (uint64_t) num);
+      got = sizeof(tmp) - 1 - at;
+      if( buf_sz > 0 ) {
+        size_t n = ((size_t) got < buf_sz) ? (size_t) got : buf_sz - 1;
+        qio_memcpy(buf, tmp + at, n);
+        buf[n] = '\0';
+      }
+    } else if( precision < 0 ) {
       if( uppercase ) {
         // This if is necessary because if the number has
         // 6 digits in the integer part, %g will not print
@@ -4046,6 +4540,20 @@ qioerr qio_channel_skip_past_newline(const int threadsafe, qio_channel_t* restri
   }
 
   while( 1 ) {
+    // Skip buffered ASCII bytes that can't end the loop. Anything else,
+    // including multibyte characters, goes through qio_channel_read_char.
+    if( qio_space_in_ptr_diff(1, ch->cached_end, ch->cached_cur) ) {
+      if( skipOnlyWs ) {
+        ch->cached_cur = (void*) qio_scan_skip_bytes4(ch->cached_cur,
+                                                      ch->cached_end,
+                                                      ' ', '\t', '\r', '\v');
+      } else {
+        ch->cached_cur = (void*) qio_scan_find_special(ch->cached_cur,
+                                                       ch->cached_end,
+                                                       '\n', 0x80, 0);
+      }
+    }
+
     lastpos = qio_channel_offset_unlocked(ch);
     err = qio_channel_read_char(threadsafe, ch, &c);
     if( err  || c == '\n' ) break;
@@ -35,6 +35,7 @@
 #include <sys/stat.h>
 #include <sys/socket.h>
 #include <sys/mman.h>
+#include <sys/resource.h>
 #include <sys/uio.h> // maybe need this for preadv/pwritev
 #include <netdb.h>
 #include <fcntl.h>
@@ -100,6 +101,8 @@
 // Should be available in sys_xsi_strerror_r.c
 extern int sys_xsi_strerror_r(int errnum, char* buf, size_t buflen);
 
+extern void chpl_task_yield(void);
+
 void sys_init_sys_sockaddr_t(sys_sockaddr_t* addr)
 {
   memset(addr, 0, sizeof(sys_sockaddr_t));
@@ -379,6 +382,42 @@ qio_err_t sys_posix_madvise(void* addr, size_t len, int advice)
   return err_out;
 }
 
+qio_err_t sys_madvise(void* addr, size_t len, int advice)
+{
+  int got;
+  qio_err_t err_out;
+
+#ifdef MADV_NORMAL
+  got = madvise(addr, len, advice);
+  if( got != 0 ) err_out = errno;
+  else err_out = 0;
+#else
+  err_out = ENOSYS;
+#endif
+
+  return err_out;
+}
+
+qio_err_t sys_page_faults(int64_t* minor_out, int64_t* major_out)
+{
+  struct rusage usage;
+  int got;
+  qio_err_t err_out;
+
+  got = getrusage(RUSAGE_SELF, &usage);
+  if( got != 0 ) {
+    err_out = errno;
+    *minor_out = 0;
+    *major_out = 0;
+  } else {
+    err_out = 0;
+    *minor_out = usage.ru_minflt;
+    *major_out = usage.ru_majflt;
+  }
+
+  return err_out;
+}
+
 
 
 // Some systems use "No error" and some use "Success"
@@ -1281,6 +1320,467 @@ qio_err_t sys_pwritev(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_t
 
 #endif
 
+/* io_uring support.
+ *
+ * Requests are submitted to one of a small pool of rings shared by all
+ * threads.  Each ring has two spinlocks, neither held across a yield:
+ * one for adding to the submission queue, and one for consuming the
+ * completion queue.  A task waiting for its request checks a flag in
+ * its request.  Only one waiter at a time reaps a ring, and it hands
+ * out every available completion, so completions are batched across
+ * tasks rather than each waiter polling the ring for its own.  Other
+ * waiters just yield.  A waiter whose request is still not done after
+ * SYS_URING_SPINS yields blocks in io_uring_enter until a completion
+ * arrives, instead of spinning.  A task that migrates to another
+ * thread while waiting can still reap from the ring it submitted to.
+ *
+ * We talk to the kernel directly rather than through liburing to avoid
+ * a new runtime dependency.  If the kernel headers are missing, or
+ * io_uring_setup fails at run time (old kernel, seccomp), the sys_uring_*
+ * calls fall back to the synchronous preadv/pwritev versions.
+ */
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define SYS_HAS_URING 1
+#endif
+#endif
+
+#ifdef CHPL_RT_UNIT_TEST
+int sys_uring_test_reject_submit = 0;
+#endif
+
+#ifdef SYS_HAS_URING
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sched.h>
+
+// Unit tests link without the tasking layer, so yield the thread instead.
+static void sys_task_yield(void) {
+#ifdef CHPL_RT_UNIT_TEST
+  sched_yield();
+#else
+  chpl_task_yield();
+#endif
+}
+
+#define SYS_URING_NRINGS 8
+#define SYS_URING_ENTRIES 64
+#define SYS_URING_SPINS 16
+
+typedef struct sys_uring_s {
+  char sq_lock; // held while adding to the submission queue
+  char cq_lock; // held by the one task reaping the completion queue
+  int fd;
+  unsigned inflight; // submitted and not yet reaped; updated atomically
+
+  unsigned* sq_head;
+  unsigned* sq_tail;
+  unsigned* sq_mask;
+  unsigned* sq_array;
+  unsigned sq_entries;
+  struct io_uring_sqe* sqes;
+
+  unsigned* cq_head;
+  unsigned* cq_tail;
+  unsigned* cq_mask;
+  unsigned cq_entries;
+  struct io_uring_cqe* cqes;
+
+  // the mappings, for teardown
+  void* sq_map;
+  size_t sq_map_sz;
+  void* cq_map;
+  size_t cq_map_sz;
+  void* sqes_map;
+  size_t sqes_map_sz;
+} sys_uring_t;
+
+typedef struct sys_uring_req_s {
+  int done;
+  int res;
+} sys_uring_req_t;
+
+// 0: not yet initialized, 1: initializing, 2: ready, 3: unavailable
+static int sys_uring_state = 0;
+static int sys_uring_next_slot = 0;
+static __thread int sys_uring_slot = -1;
+static sys_uring_t sys_urings[SYS_URING_NRINGS];
+
+static void sys_uring_lock(char* lock) {
+  while( __atomic_test_and_set(lock, __ATOMIC_ACQUIRE) ) {
+    // spin; the lock is only held for a few loads and stores
+  }
+}
+
+static void sys_uring_unlock(char* lock) {
+  __atomic_clear(lock, __ATOMIC_RELEASE);
+}
+
+// Unmap and close whatever part of a ring has been set up.
+static void sys_uring_teardown_one(sys_uring_t* r) {
+  if( r->sqes_map ) munmap(r->sqes_map, r->sqes_map_sz);
+  if( r->cq_map && r->cq_map != r->sq_map ) munmap(r->cq_map, r->cq_map_sz);
+  if( r->sq_map ) munmap(r->sq_map, r->sq_map_sz);
+  if( r->fd >= 0 ) close(r->fd);
+
+  memset(r, 0, sizeof(*r));
+  r->fd = -1;
+}
+
+static int sys_uring_setup_one(sys_uring_t* r) {
+  struct io_uring_params p;
+  size_t sq_sz, cq_sz;
+  void* sq_ptr;
+  void* cq_ptr;
+  void* sqes;
+  int fd;
+
+  memset(&p, 0, sizeof(p));
+  memset(r, 0, sizeof(*r));
+  r->fd = -1;
+
+  fd = (int) syscall(__NR_io_uring_setup, SYS_URING_ENTRIES, &p);
+  if( fd < 0 ) return errno;
+  r->fd = fd;
+
+  sq_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  cq_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if( p.features & IORING_FEAT_SINGLE_MMAP ) {
+    if( cq_sz > sq_sz ) sq_sz = cq_sz;
+    cq_sz = sq_sz;
+  }
+
+  sq_ptr = mmap(NULL, sq_sz, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                fd, IORING_OFF_SQ_RING);
+  if( sq_ptr == MAP_FAILED ) goto error;
+  r->sq_map = sq_ptr;
+  r->sq_map_sz = sq_sz;
+
+  if( p.features & IORING_FEAT_SINGLE_MMAP ) {
+    cq_ptr = sq_ptr;
+  } else {
+    cq_ptr = mmap(NULL, cq_sz, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                  fd, IORING_OFF_CQ_RING);
+    if( cq_ptr == MAP_FAILED ) goto error;
+  }
+  r->cq_map = cq_ptr;
+  r->cq_map_sz = cq_sz;
+
+  sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+              PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+              fd, IORING_OFF_SQES);
+  if( sqes == MAP_FAILED ) goto error;
+  r->sqes_map = sqes;
+  r->sqes_map_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+
+  r->sq_head = (unsigned*) ((char*) sq_ptr + p.sq_off.head);
+  r->sq_tail = (unsigned*) ((char*) sq_ptr + p.sq_off.tail);
+  r->sq_mask = (unsigned*) ((char*) sq_ptr + p.sq_off.ring_mask);
+  r->sq_array = (unsigned*) ((char*) sq_ptr + p.sq_off.array);
+  r->sq_entries = p.sq_entries;
+  r->sqes = (struct io_uring_sqe*) sqes;
+  r->cq_head = (unsigned*) ((char*) cq_ptr + p.cq_off.head);
+  r->cq_tail = (unsigned*) ((char*) cq_ptr + p.cq_off.tail);
+  r->cq_mask = (unsigned*) ((char*) cq_ptr + p.cq_off.ring_mask);
+  r->cq_entries = p.cq_entries;
+  r->cqes = (struct io_uring_cqe*) ((char*) cq_ptr + p.cq_off.cqes);
+
+  return 0;
+
+error:
+  sys_uring_teardown_one(r);
+  return ENOSYS;
+}
+
+int sys_uring_available(void)
+{
+  int state = __atomic_load_n(&sys_uring_state, __ATOMIC_ACQUIRE);
+  int expected = 0;
+
+  if( state == 2 ) return 1;
+  if( state == 3 ) return 0;
+
+  if( __atomic_compare_exchange_n(&sys_uring_state, &expected, 1, 0,
+                                  __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ) {
+    int i;
+    int ok = 1;
+    for( i = 0; i < SYS_URING_NRINGS && ok; i++ ) {
+      if( sys_uring_setup_one(&sys_urings[i]) != 0 ) ok = 0;
+    }
+    if( ! ok ) {
+      // Release the rings that were set up before the failure; the
+      // process falls back to synchronous I/O.
+      for( i = 0; i < SYS_URING_NRINGS; i++ )
+        sys_uring_teardown_one(&sys_urings[i]);
+    }
+    __atomic_store_n(&sys_uring_state, ok ? 2 : 3, __ATOMIC_RELEASE);
+    return ok;
+  }
+
+  // Someone else is setting up the rings
+  while( (state = __atomic_load_n(&sys_uring_state, __ATOMIC_ACQUIRE)) == 1 )
+    sys_task_yield();
+
+  return state == 2;
+}
+
+static sys_uring_t* sys_uring_for_thread(void) {
+  if( sys_uring_slot < 0 ) {
+    sys_uring_slot = __atomic_fetch_add(&sys_uring_next_slot, 1,
+                                        __ATOMIC_RELAXED) % SYS_URING_NRINGS;
+  }
+  return &sys_urings[sys_uring_slot];
+}
+
+static int sys_uring_cq_empty(sys_uring_t* r) {
+  return __atomic_load_n(r->cq_head, __ATOMIC_RELAXED) ==
+         __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+}
+
+// Move all finished requests from the completion queue to their
+// waiters.  If another task is already reaping the ring, return right
+// away: it will hand out our completion too.  If 'wait_for' is given,
+// has not completed, and there is nothing to reap, wait in the kernel for
+// a completion.  Completions are only handed out with cq_lock held, so
+// checking wait_for under it can't miss one.
+static void sys_uring_reap(sys_uring_t* r, sys_uring_req_t* wait_for) {
+  unsigned head;
+  unsigned tail;
+  unsigned n;
+
+  if( wait_for == NULL && sys_uring_cq_empty(r) ) return;
+  if( __atomic_test_and_set(&r->cq_lock, __ATOMIC_ACQUIRE) ) return;
+
+  if( wait_for && ! __atomic_load_n(&wait_for->done, __ATOMIC_ACQUIRE) &&
+      sys_uring_cq_empty(r) ) {
+    STARTING_SLOW_SYSCALL;
+    // Errors (EINTR) just return to the caller, which checks again.
+    syscall(__NR_io_uring_enter, r->fd, 0, 1, IORING_ENTER_GETEVENTS,
+            NULL, 0);
+    DONE_SLOW_SYSCALL;
+  }
+
+  head = *r->cq_head;
+  tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+
+  for( n = 0; head != tail; n++, head++ ) {
+    struct io_uring_cqe* cqe = &r->cqes[head & *r->cq_mask];
+    sys_uring_req_t* req = (sys_uring_req_t*) (uintptr_t) cqe->user_data;
+
+    req->res = cqe->res;
+    __atomic_store_n(&req->done, 1, __ATOMIC_RELEASE);
+  }
+
+  __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+  __atomic_fetch_sub(&r->inflight, n, __ATOMIC_RELEASE);
+
+  sys_uring_unlock(&r->cq_lock);
+}
+
+// Synchronous version of one sys_uring_rw request, used when the kernel
+// does not accept the submission.
+static qio_err_t sys_uring_rw_sync(int op, fd_t fd, const struct iovec* iov,
+                                   int iovcnt, off_t offset, ssize_t* res_out)
+{
+  ssize_t got;
+
+  STARTING_SLOW_SYSCALL;
+
+  do {
+    // Some systems preadv doesn't take a const struct iovec*, hence the cast
+    if( op == IORING_OP_READV )
+      got = preadv(fd, (struct iovec*) iov, iovcnt, offset);
+    else
+      got = pwritev(fd, (struct iovec*) iov, iovcnt, offset);
+  } while( got == -1 && errno == EINTR );
+
+  DONE_SLOW_SYSCALL;
+
+  if( got == -1 ) {
+    *res_out = 0;
+    return errno;
+  }
+
+  *res_out = got;
+  return 0;
+}
+
+// Submit one vectored read or write and yield until it completes.
+// Returns 0 or an errno value; *res_out is the byte count.
+static qio_err_t sys_uring_rw(int op, fd_t fd, const struct iovec* iov,
+                              int iovcnt, off_t offset, ssize_t* res_out)
+{
+  sys_uring_t* r = sys_uring_for_thread();
+  sys_uring_req_t req;
+  struct io_uring_sqe* sqe;
+  unsigned tail;
+  unsigned inflight;
+  int spins;
+  int got;
+
+  req.done = 0;
+  req.res = 0;
+
+  // Wait for room on the ring.  Limiting the requests in flight to the
+  // queue sizes keeps the completion queue from overflowing.
+  while( 1 ) {
+    sys_uring_lock(&r->sq_lock);
+    inflight = __atomic_load_n(&r->inflight, __ATOMIC_ACQUIRE);
+    if( inflight < r->sq_entries && inflight < r->cq_entries ) break;
+    sys_uring_unlock(&r->sq_lock);
+    sys_uring_reap(r, NULL);
+    sys_task_yield();
+  }
+
+  tail = *r->sq_tail;
+  sqe = &r->sqes[tail & *r->sq_mask];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = op;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t) (uintptr_t) iov;
+  sqe->len = iovcnt;
+  sqe->off = offset;
+  sqe->user_data = (uint64_t) (uintptr_t) &req;
+  r->sq_array[tail & *r->sq_mask] = tail & *r->sq_mask;
+  __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+  // Count the request before the kernel can complete it, so a reaper
+  // never sees more completions than requests in flight.
+  __atomic_fetch_add(&r->inflight, 1, __ATOMIC_RELEASE);
+
+#ifdef CHPL_RT_UNIT_TEST
+  if( sys_uring_test_reject_submit ) got = 0;
+  else
+#endif
+  got = (int) syscall(__NR_io_uring_enter, r->fd, 1, 0, 0, NULL, 0);
+  if( got != 1 ) {
+    // The kernel did not take the request (an error such as EAGAIN or
+    // EBUSY, or nothing consumed).  Withdraw it and do the I/O directly
+    // rather than waiting for a completion that will never come.
+    __atomic_store_n(r->sq_tail, tail, __ATOMIC_RELEASE);
+    __atomic_fetch_sub(&r->inflight, 1, __ATOMIC_RELEASE);
+    sys_uring_unlock(&r->sq_lock);
+    return sys_uring_rw_sync(op, fd, iov, iovcnt, offset, res_out);
+  }
+
+  sys_uring_unlock(&r->sq_lock);
+
+  // Yield to other tasks until our request is done.
+  for( spins = 0; ! __atomic_load_n(&req.done, __ATOMIC_ACQUIRE); spins++ ) {
+    sys_uring_reap(r, spins >= SYS_URING_SPINS ? &req : NULL);
+    if( ! __atomic_load_n(&req.done, __ATOMIC_ACQUIRE) ) sys_task_yield();
+  }
+
+  if( req.res < 0 ) {
+    *res_out = 0;
+    return -req.res;
+  }
+
+  *res_out = req.res;
+  return 0;
+}
+
+qio_err_t sys_uring_preadv(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_read_out)
+{
+  ssize_t got;
+  ssize_t got_total;
+  qio_err_t err_out;
+  int i;
+  int niovs = IOV_MAX;
+
+  if( ! sys_uring_available() )
+    return sys_preadv(fd, iov, iovcnt, seek_to_offset, num_read_out);
+
+  err_out = 0;
+  got_total = 0;
+  for( i = 0; i < iovcnt; i += niovs ) {
+    niovs = iovcnt - i;
+    if( niovs > IOV_MAX ) niovs = IOV_MAX;
+
+    err_out = sys_uring_rw(IORING_OP_READV, fd, &iov[i], niovs,
+                           seek_to_offset + got_total, &got);
+    if( err_out ) break;
+    got_total += got;
+    if( got != sys_iov_total_bytes(&iov[i], niovs) ) {
+      break;
+    }
+  }
+
+  if( err_out == 0 && got_total == 0 && sys_iov_total_bytes(iov, iovcnt) != 0 ) err_out = EEOF;
+
+  *num_read_out = got_total;
+
+  return err_out;
+}
+
+qio_err_t sys_uring_pwritev(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_written_out)
+{
+  ssize_t got;
+  ssize_t got_total;
+  qio_err_t err_out;
+  int i;
+  int niovs = IOV_MAX;
+
+  if( ! sys_uring_available() )
+    return sys_pwritev(fd, iov, iovcnt, seek_to_offset, num_written_out);
+
+  err_out = 0;
+  got_total = 0;
+  for( i = 0; i < iovcnt; i += niovs ) {
+    niovs = iovcnt - i;
+    if( niovs > IOV_MAX ) niovs = IOV_MAX;
+
+    err_out = sys_uring_rw(IORING_OP_WRITEV, fd, &iov[i], niovs,
+                           seek_to_offset + got_total, &got);
+    if( err_out ) break;
+    got_total += got;
+    if( got != sys_iov_total_bytes(&iov[i], niovs) ) {
+      break;
+    }
+  }
+
+  *num_written_out = got_total;
+
+  return err_out;
+}
+
+#else
+
+int sys_uring_available(void)
+{
+  return 0;
+}
+
+qio_err_t sys_uring_preadv(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_read_out)
+{
+  return sys_preadv(fd, iov, iovcnt, seek_to_offset, num_read_out);
+}
+
+qio_err_t sys_uring_pwritev(fd_t fd, const struct iovec* iov, int iovcnt, off_t seek_to_offset, ssize_t* num_written_out)
+{
+  return sys_pwritev(fd, iov, iovcnt, seek_to_offset, num_written_out);
+}
+
+#endif
+
+qio_err_t sys_uring_pread(fd_t fd, void* buf, size_t count, off_t offset, ssize_t* num_read_out)
+{
+  struct iovec iov;
+  iov.iov_base = buf;
+  iov.iov_len = count;
+  return sys_uring_preadv(fd, &iov, 1, offset, num_read_out);
+}
+
+qio_err_t sys_uring_pwrite(fd_t fd, const void* buf, size_t count, off_t offset, ssize_t* num_written_out)
+{
+  struct iovec iov;
+  iov.iov_base = (void*) buf;
+  iov.iov_len = count;
+  return sys_uring_pwritev(fd, &iov, 1, offset, num_written_out);
+}
+
 qio_err_t sys_fsync(fd_t fd)
 {
   int got;
@@ -1852,8 +2352,6 @@ qio_err_t sys_socketpair(int domain, int type, int protocol, fd_t* sockfd_out_a,
   return err_out;
 }
 
-extern void chpl_task_yield(void);
-
 qio_err_t sys_select(int nfds, fd_set* readfds, fd_set* writefds, fd_set* exceptfds, struct timeval* timeout, int* nset) {
   int got_nset;
   qio_err_t err_out = 0;
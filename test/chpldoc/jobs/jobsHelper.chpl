@@ -0,0 +1,4 @@
+// A second input file, so that --jobs 2 documents in parallel.
+module jobsHelper {
+  proc hi() { }
+}
@@ -0,0 +1,8 @@
+// With --jobs, a file that only draws a warning must still be documented,
+// and the output must match what the serial mode produces.
+
+proc hello() { }
+
+module Sub {
+  proc goodbye() { }
+}
@@ -0,0 +1,24 @@
+// Check that --opt-remarks writes valid JSON Lines sorted by location, and
+// that chplremarks.py can show them next to the source.  The .prediff
+// validates the file and renders the inlining remarks for 'compute'.
+
+record R {
+  var x: int;
+}
+
+proc small(r: R) {
+  return r.x;
+}
+
+proc fact(n: int): int {
+  if n <= 1 then return 1;
+  return n * fact(n-1);
+}
+
+proc compute(r: R): int {
+  const a = small(r);
+  const b = fact(3);
+  return a + b;
+}
+
+writeln(compute(new R(4)));
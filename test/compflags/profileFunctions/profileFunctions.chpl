@@ -0,0 +1,9 @@
+// Compiled with --profile-functions; the .prediff checks the trace
+// and the shape of the summary the compiler prints.
+
+proc twice(x) {
+  return x + x;
+}
+
+writeln(twice(21));
+writeln(twice("ab"));
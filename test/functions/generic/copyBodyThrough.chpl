@@ -0,0 +1,56 @@
+// Methods on a generic record are instantiated for the receiver first and
+// then for their other generic formals, so the body of each final
+// instantiation is copied straight from the generic function, past the
+// intermediate partial instantiation.  Exercise copied bodies that define
+// the return symbol, return 'this', and define 'this' itself (the tuple
+// construction), and make sure the intermediates can still be finalized
+// on their own.
+
+record R {
+  type t;
+  var v: t;
+
+  // the return symbol is defined in the body
+  proc scaled(k) {
+    var ret: t = v * k: t;
+    return ret;
+  }
+
+  // returns a copy of 'this'
+  proc plus(x) {
+    var copy = this;
+    copy.v += x: t;
+    return copy;
+  }
+
+  // the tuple construction defines its own 'this'
+  proc pair(x) {
+    return (v, x);
+  }
+
+  // generic in two steps past the receiver
+  proc mix(x, y: ?u) {
+    var r: u = (v + x: t): u + y;
+    return r;
+  }
+
+  // varargs are expanded on the intermediate, so it is copied normally
+  proc sum(xs...) {
+    var s = v;
+    for param i in 0..<xs.size do s += xs(i): t;
+    return s;
+  }
+}
+
+// a generic method reached only through another instantiation
+proc R.twice(x) do return plus(x).plus(x);
+
+var ri = new R(int, 3);
+var rr = new R(real, 1.5);
+
+writeln(ri.scaled(2), " ", ri.scaled(2.0), " ", rr.scaled(2));
+writeln(ri.plus(1), " ", rr.plus(1), " ", rr.plus(0.25));
+writeln(ri.pair("a"), " ", rr.pair(2), " ", ri.pair(ri));
+writeln(ri.mix(1, 2.5), " ", ri.mix(1.0, 2), " ", rr.mix(1, 2));
+writeln(ri.sum(1, 2), " ", rr.sum(1, 2.5, 3));
+writeln(ri.twice(1), " ", rr.twice(0.5));
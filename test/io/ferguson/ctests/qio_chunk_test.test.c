@@ -0,0 +1,212 @@
+#include "qio_formatted.h"
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+
+int verbose = 0;
+
+// Write 'nrecords' records of varying length, each ending in 'delim'.
+// Returns the file length.
+int64_t write_records(qio_file_t* f, int64_t nrecords, const char* delim)
+{
+  qio_channel_t* writing;
+  int64_t offset;
+  int64_t i;
+  int j;
+  qioerr err;
+
+  err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+
+  for( i = 0; i < nrecords; i++ ) {
+    // every so often, a record longer than a whole chunk
+    int len = (i % 97 == 0) ? 5000 : (int) (i % 31);
+    for( j = 0; j < len; j++ ) {
+      err = qio_channel_write_byte(false, writing, 'a' + (i + j) % 26);
+      assert(!err);
+    }
+    err = qio_channel_write_amt(false, writing, delim, strlen(delim));
+    assert(!err);
+  }
+
+  err = qio_channel_offset(true, writing, &offset);
+  assert(!err);
+  qio_channel_release(writing);
+
+  return offset;
+}
+
+// Count the records in a chunk by counting delimiters.
+int64_t count_records(qio_channel_t* ch, const char* delim)
+{
+  int64_t count = 0;
+  ssize_t delim_len = strlen(delim);
+  qioerr err;
+
+  while( 1 ) {
+    err = qio_channel_advance_past_byte(true, ch, delim[0], 1);
+    if( err ) break;
+    if( delim_len > 1 ) {
+      char got[8];
+      qio_channel_mark(true, ch);
+      err = qio_channel_read_amt(true, ch, got, delim_len - 1);
+      if( !err && 0 == memcmp(got, delim + 1, delim_len - 1) ) {
+        qio_channel_commit(true, ch);
+      } else {
+        qio_channel_revert(true, ch);
+        continue;
+      }
+    }
+    count++;
+  }
+
+  return count;
+}
+
+void check_chunks(int64_t nrecords, const char* delim, int64_t nchunks)
+{
+  qio_file_t* f;
+  qio_channel_t* reading;
+  int64_t len;
+  int64_t total = 0;
+  int64_t prev_end = 0;
+  int64_t i;
+  ssize_t delim_len = strlen(delim);
+  char before[8];
+  qioerr err;
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+
+  len = write_records(f, nrecords, delim);
+
+  for( i = 0; i < nchunks; i++ ) {
+    int64_t start, end;
+
+    err = qio_file_record_chunk(f, 0, INT64_MAX, nchunks, i,
+                                delim, delim_len, &start, &end);
+    assert(!err);
+
+    // no gaps or overlap
+    assert(start == prev_end);
+    assert(start <= end);
+    prev_end = end;
+
+    // chunks start at a record
+    if( start > 0 && start < len ) {
+      err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0,
+                               start - delim_len, start, NULL, 0);
+      assert(!err);
+      err = qio_channel_read_amt(true, reading, before, delim_len);
+      assert(!err);
+      assert(0 == memcmp(before, delim, delim_len));
+      qio_channel_release(reading);
+    }
+
+    err = qio_channel_create_record_chunk(&reading, f, QIO_CH_BUFFERED,
+                                          0, INT64_MAX, nchunks, i,
+                                          delim, delim_len, NULL);
+    assert(!err);
+    total += count_records(reading, delim);
+    qio_channel_release(reading);
+  }
+
+  assert(prev_end == len);
+  assert(total == nrecords);
+
+  qio_file_release(f);
+}
+
+typedef struct {
+  qio_file_t* f;
+  int64_t nchunks;
+  int64_t chunk;
+  int64_t count;
+} chunk_task_t;
+
+void* count_chunk(void* arg)
+{
+  chunk_task_t* task = (chunk_task_t*) arg;
+  qio_channel_t* reading;
+  qioerr err;
+
+  err = qio_channel_create_record_chunk(&reading, task->f, QIO_CH_BUFFERED,
+                                        0, INT64_MAX, task->nchunks,
+                                        task->chunk, "\n", 1, NULL);
+  assert(!err);
+  task->count = count_records(reading, "\n");
+  qio_channel_release(reading);
+  return NULL;
+}
+
+// Read one file with 1, 2, 4, ... threads, each reading its own chunk.
+void check_parallel(int64_t nrecords, int max_threads)
+{
+  qio_file_t* f;
+  chunk_task_t tasks[64];
+  pthread_t threads[64];
+  int nthreads;
+  int i;
+  qioerr err;
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+
+  write_records(f, nrecords, "\n");
+
+  for( nthreads = 1; nthreads <= max_threads; nthreads *= 2 ) {
+    struct timespec t0, t1;
+    int64_t total = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for( i = 0; i < nthreads; i++ ) {
+      tasks[i].f = f;
+      tasks[i].nchunks = nthreads;
+      tasks[i].chunk = i;
+      tasks[i].count = 0;
+      pthread_create(&threads[i], NULL, count_chunk, &tasks[i]);
+    }
+    for( i = 0; i < nthreads; i++ ) {
+      pthread_join(threads[i], NULL);
+      total += tasks[i].count;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    assert(total == nrecords);
+
+    if( verbose ) {
+      printf("%i threads: %f s\n", nthreads,
+             (t1.tv_sec - t0.tv_sec) + 1e-9 * (t1.tv_nsec - t0.tv_nsec));
+    }
+  }
+
+  qio_file_release(f);
+}
+
+int main(int argc, char** argv)
+{
+  int64_t nchunks[] = {1, 2, 3, 7, 64, 1000, 0};
+  int max_threads = 8;
+  int64_t nrecords = 10000;
+  int i;
+
+  // Run as a scaling benchmark with: qio_chunk_test <records> <max threads>
+  if( argc > 2 ) {
+    verbose = 1;
+    nrecords = atoll(argv[1]);
+    max_threads = atoi(argv[2]);
+    if( max_threads > 64 ) max_threads = 64;
+  }
+
+  for( i = 0; nchunks[i] != 0; i++ ) {
+    check_chunks(1000, "\n", nchunks[i]);
+    check_chunks(1000, "|#", nchunks[i]);
+    check_chunks(1000, "\r\n", nchunks[i]);
+  }
+
+  check_parallel(nrecords, max_threads);
+
+  printf("qio_chunk_test PASS\n");
+
+  return 0;
+}
@@ -1492,6 +1492,168 @@ void test_quoted_string_maxlength(void)
   if( verbose ) printf("PASS: quoted max length\n");
 }
 
+void test_scanning(void)
+{
+  // The long runs here exercise the vectorized scanners, and the small
+  // qbytes_iobuf_size values used by main() make them cross buffers.
+  const char* text =
+    "   \t  a_long_word_with_more_than_thirty_two_characters_in_it next\n"
+    "ignored text on the rest of this line, which is quite long too\n"
+    "{ \"key with a \\\"quote\\\" in it\" :   "
+    "[ 123456789012345678901234567890.5e+10 ,    \"v\" , true ] ,"
+    " \"k2\" : null } , 7\n"
+    "\"a chpl string with \\t an escape and more than 32 bytes\" rest\n"
+    "terminated by a semicolon, with many bytes before it;after\n";
+  const char* expect_chpl = "a chpl string with \t an escape and more than 32 bytes";
+  qio_style_t style = qio_style_default();
+  qio_channel_t *reading;
+  qio_channel_t *writing;
+  qio_file_t *f = NULL;
+  const char* got = NULL;
+  int64_t got_len = 0;
+  int32_t c;
+  qioerr err;
+
+  if( verbose ) printf("Testing scanning\n");
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+
+  err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_write_amt(true, writing, text, strlen(text));
+  assert(!err);
+  qio_channel_release(writing);
+
+  style.string_format = QIO_STRING_FORMAT_WORD;
+  err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, &style, 0);
+  assert(!err);
+
+  err = qio_channel_scan_string(true, reading, &got, &got_len, -1);
+  assert(!err);
+  assert(0 == strcmp(got, "a_long_word_with_more_than_thirty_two_characters_in_it"));
+  qio_free((void*) got);
+
+  err = qio_channel_scan_string(true, reading, &got, &got_len, -1);
+  assert(!err);
+  assert(0 == strcmp(got, "next"));
+  qio_free((void*) got);
+
+  // only the newline is left on the first line
+  err = qio_channel_skip_past_newline(true, reading, 1);
+  assert(!err);
+
+  // skipOnlyWs should stop at the first word
+  err = qio_channel_skip_past_newline(true, reading, 1);
+  assert(qio_err_to_int(err) == EFORMAT);
+  c = qio_channel_read_byte(true, reading);
+  assert(c == 'i');
+
+  err = qio_channel_skip_past_newline(true, reading, 0);
+  assert(!err);
+
+  // skip the JSON object, then the , 7 after it
+  c = qio_skip_json_value_unlocked(reading);
+  assert(c == 0);
+  c = qio_skip_json_value_unlocked(reading);
+  assert(c == ',');
+  c = qio_skip_json_value_unlocked(reading);
+  assert(c == '\n');
+
+  style.string_format = QIO_STRING_FORMAT_CHPL;
+  qio_channel_set_style(reading, &style);
+  err = qio_channel_scan_string(true, reading, &got, &got_len, -1);
+  assert(!err);
+  assert(got_len == strlen(expect_chpl));
+  assert(0 == strcmp(got, expect_chpl));
+  qio_free((void*) got);
+
+  // a long string read with a byte limit stops at the limit
+  err = qio_channel_skip_past_newline(true, reading, 0);
+  assert(!err);
+  err = qio_channel_mark(true, reading);
+  assert(!err);
+  style.string_format = QIO_STRING_FORMAT_TOEND;
+  style.string_end = ';';
+  qio_channel_set_style(reading, &style);
+  err = qio_channel_scan_string(true, reading, &got, &got_len, 10);
+  assert(!err);
+  assert(0 == strcmp(got, "terminated"));
+  qio_free((void*) got);
+  qio_channel_revert(true, reading);
+
+  // and otherwise includes the terminator for FORMAT_TOEND
+  err = qio_channel_scan_string(true, reading, &got, &got_len, -1);
+  assert(!err);
+  assert(0 == strcmp(got, "terminated by a semicolon, with many bytes before it;"));
+  qio_free((void*) got);
+
+  qio_channel_release(reading);
+  qio_file_release(f);
+
+  if( verbose ) printf("PASS: scanning\n");
+}
+
+void test_scan_decimal(void)
+{
+  // Plain decimal numbers are read straight from the buffer;
+  // anything else should still go through the general path.
+  const char* text = "  -1234567890123456789 0x1f 007 12.5\n"
+                     "3.25e2 -0.1 1e23 123456789012345678901 0x1p4 inf\n";
+  qio_channel_t *reading;
+  qio_channel_t *writing;
+  qio_file_t *f = NULL;
+  int64_t i64;
+  double d;
+  int32_t c;
+  qioerr err;
+
+  if( verbose ) printf("Testing decimal scanning\n");
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+
+  err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_write_amt(true, writing, text, strlen(text));
+  assert(!err);
+  qio_channel_release(writing);
+
+  err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+
+  err = qio_channel_scan_int(true, reading, &i64, 8, 1);
+  assert(!err && i64 == -1234567890123456789LL);
+  err = qio_channel_scan_int(true, reading, &i64, 8, 1);
+  assert(!err && i64 == 0x1f);
+  err = qio_channel_scan_int(true, reading, &i64, 8, 1);
+  assert(!err && i64 == 7);
+  err = qio_channel_scan_int(true, reading, &i64, 8, 1);
+  assert(!err && i64 == 12);
+  c = qio_channel_read_byte(true, reading);
+  assert(c == '.');
+  err = qio_channel_scan_int(true, reading, &i64, 8, 1);
+  assert(!err && i64 == 5);
+
+  err = qio_channel_scan_float(true, reading, &d, 8);
+  assert(!err && d == 325.0);
+  err = qio_channel_scan_float(true, reading, &d, 8);
+  assert(!err && d == -0.1);
+  err = qio_channel_scan_float(true, reading, &d, 8);
+  assert(!err && d == 1e23);
+  err = qio_channel_scan_float(true, reading, &d, 8);
+  assert(!err && d == 123456789012345678901.0);
+  err = qio_channel_scan_float(true, reading, &d, 8);
+  assert(!err && d == 16.0);
+  err = qio_channel_scan_float(true, reading, &d, 8);
+  assert(!err && isinf(d));
+
+  qio_channel_release(reading);
+  qio_file_release(f);
+
+  if( verbose ) printf("PASS: decimal scanning\n");
+}
+
 int main(int argc, char** argv)
 {
   int sizes[] = {qbytes_iobuf_size, 64, 1, 2, 0};
@@ -1531,6 +1693,10 @@ int main(int argc, char** argv)
     test_scanmatch();
 
     test_quoted_string_maxlength();
+
+    test_scanning();
+
+    test_scan_decimal();
   }
 
   printf("qio_formatted_test PASS\n");
@@ -0,0 +1,177 @@
+#include "qio.h"
+#include <assert.h>
+#include <stdio.h>
+
+// Checks that a sequential QIO_METHOD_MMAP reader maps larger chunks as
+// it goes, that QIO_HINT_RANDOM keeps the chunk size fixed, and that
+// qio_channel_mmap_stats counts the mappings.  The chunk sizes are made
+// small so that a small file spans several chunks.  The fault counts from
+// qio_channel_mmap_stats are process-level deltas (they include faults
+// from anything else the process does), so they are only checked to be
+// non-negative.
+
+#define CHUNK (64*1024)
+#define MAX_CHUNK (8*CHUNK)
+
+// 64K, 128K, 256K, and then 512K chunks, with a partial chunk at the end.
+#define FILE_LEN (CHUNK + 2*CHUNK + 4*CHUNK + 3*MAX_CHUNK + 1000)
+
+unsigned char data_at(int64_t offset)
+{
+  return offset + (offset >> 2) + 'a' + (offset % 7);
+}
+
+qio_file_t* write_file(void)
+{
+  qio_file_t* f;
+  qio_channel_t* writing;
+  int64_t i;
+  qioerr err;
+
+  // The file is empty when it is opened, so it has no initial mapping
+  // and all the reader's mappings are made on demand.
+  err = qio_file_open_tmp(&f, QIO_METHOD_MMAP, NULL);
+  assert(!err);
+
+  err = qio_channel_create(&writing, f, QIO_CH_BUFFERED|QIO_METHOD_PREADPWRITE,
+                           0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  for( i = 0; i < FILE_LEN; i++ ) {
+    err = qio_channel_write_byte(false, writing, data_at(i));
+    assert(!err);
+  }
+  qio_channel_release(writing);
+
+  return f;
+}
+
+// Read the whole file in small pieces. chunks[i] is set to the
+// length of the i'th mapping, and the number of mappings is returned.
+int64_t read_file(qio_file_t* f, qio_hint_t hints, int64_t* chunks,
+                  int64_t max_chunks, int64_t* bytes_out)
+{
+  qio_channel_t* reading;
+  unsigned char buf[4096];
+  int64_t offset = 0;
+  int64_t nmaps = 0;
+  int64_t bytes = 0;
+  int64_t prev_bytes = 0;
+  int64_t minflt, majflt;
+  ssize_t amt;
+  ssize_t k;
+  qioerr err;
+
+  err = qio_channel_create(&reading, f, QIO_CH_BUFFERED|QIO_METHOD_MMAP|hints,
+                           1, 0, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+
+  err = qio_channel_mmap_stats(true, reading, &nmaps, &bytes,
+                               &minflt, &majflt);
+  assert(!err);
+  assert(nmaps == 0);
+  assert(bytes == 0);
+
+  while( offset < FILE_LEN ) {
+    amt = sizeof(buf);
+    if( amt > FILE_LEN - offset ) amt = FILE_LEN - offset;
+    err = qio_channel_read_amt(true, reading, buf, amt);
+    assert(!err);
+    for( k = 0; k < amt; k++ ) assert(buf[k] == data_at(offset + k));
+    offset += amt;
+
+    err = qio_channel_mmap_stats(true, reading, &nmaps, &bytes,
+                                 &minflt, &majflt);
+    assert(!err);
+    assert(minflt >= 0);
+    assert(majflt >= 0);
+    if( bytes != prev_bytes ) {
+      assert(nmaps <= max_chunks);
+      chunks[nmaps-1] = bytes - prev_bytes;
+      prev_bytes = bytes;
+    }
+  }
+
+  // Reading at EOF does not map anything more.
+  err = qio_channel_read_amt(true, reading, buf, 1);
+  assert(qio_err_to_int(err) == EEOF);
+  err = qio_channel_mmap_stats(true, reading, &nmaps, &bytes,
+                               &minflt, &majflt);
+  assert(!err);
+  assert(bytes == prev_bytes);
+
+  qio_channel_release(reading);
+
+  *bytes_out = bytes;
+  return nmaps;
+}
+
+void check_sequential(qio_file_t* f)
+{
+  int64_t expect[] = {CHUNK, 2*CHUNK, 4*CHUNK,
+                      MAX_CHUNK, MAX_CHUNK, MAX_CHUNK, 1000};
+  int64_t chunks[64];
+  int64_t nmaps;
+  int64_t bytes;
+  int64_t i;
+
+  nmaps = read_file(f, 0, chunks, 64, &bytes);
+
+  assert(nmaps == sizeof(expect)/sizeof(expect[0]));
+  for( i = 0; i < nmaps; i++ ) assert(chunks[i] == expect[i]);
+  assert(bytes == FILE_LEN);
+}
+
+void check_random(qio_file_t* f)
+{
+  int64_t chunks[64];
+  int64_t nmaps;
+  int64_t bytes;
+  int64_t i;
+
+  nmaps = read_file(f, QIO_HINT_RANDOM, chunks, 64, &bytes);
+
+  assert(nmaps == (FILE_LEN + CHUNK - 1) / CHUNK);
+  for( i = 0; i < nmaps - 1; i++ ) assert(chunks[i] == CHUNK);
+  assert(chunks[nmaps-1] == FILE_LEN % CHUNK);
+  assert(bytes == FILE_LEN);
+}
+
+// The populate and huge page hints don't change what is mapped, and a
+// file system that can't provide huge pages doesn't cause an error.
+void check_hints(qio_file_t* f)
+{
+  qio_hint_t hints[] = {QIO_HINT_POPULATE, QIO_HINT_HUGEPAGE,
+                        QIO_HINT_POPULATE|QIO_HINT_HUGEPAGE,
+                        QIO_HINT_CACHED};
+  int64_t chunks[64];
+  int64_t nmaps;
+  int64_t bytes;
+  size_t i;
+
+  for( i = 0; i < sizeof(hints)/sizeof(hints[0]); i++ ) {
+    nmaps = read_file(f, hints[i], chunks, 64, &bytes);
+    assert(nmaps == 7);
+    assert(bytes == FILE_LEN);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  qio_file_t* f;
+
+  qio_mmap_chunk_iobufs = CHUNK / qbytes_iobuf_size;
+  qio_mmap_max_chunk_iobufs = MAX_CHUNK / qbytes_iobuf_size;
+  assert(qio_mmap_chunk_iobufs * qbytes_iobuf_size == CHUNK);
+
+  f = write_file();
+
+  check_sequential(f);
+  check_random(f);
+  check_hints(f);
+
+  qio_file_release(f);
+
+  printf("qio_mmap_test PASS\n");
+
+  return 0;
+}
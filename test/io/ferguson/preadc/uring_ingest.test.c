@@ -0,0 +1,142 @@
+#include "sys_basic.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "sys.h"
+
+// Measures parallel ingest of one file: several threads each read their
+// own part of it in 1 MiB requests, once with sys_pread and once with
+// sys_uring_pread.  The rates are printed for the performance keys and
+// filtered out by the .prediff.
+//
+// The file is usually in the page cache after it is written, so this
+// measures the per-request overhead more than the device.  Run with
+// "<MiB> cold" to evict the file from the page cache (with
+// POSIX_FADV_DONTNEED) before each measurement, so that the reads go to
+// the device.
+
+#define REQUEST_SIZE (1024*1024)
+
+static int fd;
+static int64_t file_size;
+static int use_uring;
+static int cold;
+
+typedef struct {
+  int64_t start;
+  int64_t end;
+  uint64_t sum;
+} part_t;
+
+static void* read_part(void* arg)
+{
+  part_t* part = (part_t*) arg;
+  unsigned char* buf = malloc(REQUEST_SIZE);
+  int64_t offset;
+  ssize_t got;
+  ssize_t i;
+  qio_err_t err;
+
+  assert(buf);
+
+  for( offset = part->start; offset < part->end; offset += got ) {
+    ssize_t len = part->end - offset;
+    if( len > REQUEST_SIZE ) len = REQUEST_SIZE;
+    if( use_uring ) err = sys_uring_pread(fd, buf, len, offset, &got);
+    else err = sys_pread(fd, buf, len, offset, &got);
+    assert(!err);
+    assert(got > 0);
+    for( i = 0; i < got; i++ ) part->sum += buf[i];
+  }
+
+  free(buf);
+  return NULL;
+}
+
+static uint64_t ingest(int nthreads, double* seconds)
+{
+  pthread_t threads[64];
+  part_t parts[64];
+  struct timespec t0, t1;
+  uint64_t sum = 0;
+  int i;
+
+  if( cold ) {
+    assert(fsync(fd) == 0);
+    assert(posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for( i = 0; i < nthreads; i++ ) {
+    parts[i].start = file_size * i / nthreads;
+    parts[i].end = file_size * (i + 1) / nthreads;
+    parts[i].sum = 0;
+    pthread_create(&threads[i], NULL, read_part, &parts[i]);
+  }
+  for( i = 0; i < nthreads; i++ ) {
+    pthread_join(threads[i], NULL);
+    sum += parts[i].sum;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+
+  *seconds = (t1.tv_sec - t0.tv_sec) + 1e-9 * (t1.tv_nsec - t0.tv_nsec);
+  return sum;
+}
+
+int main(int argc, char** argv) {
+  int nthreads[] = {1, 4, 16};
+  int mib = 64;
+  unsigned char* buf;
+  uint64_t expect = 0;
+  int64_t offset;
+  ssize_t got;
+  qio_err_t err;
+  int i, j;
+
+  if( argc > 1 ) mib = atoi(argv[1]);
+  if( argc > 2 ) cold = (strcmp(argv[2], "cold") == 0);
+  file_size = (int64_t) mib * 1024 * 1024;
+
+  fd = open("tmp.data", O_RDWR | O_CREAT | O_TRUNC, S_IRWXU);
+  assert(fd>=0);
+
+  buf = malloc(REQUEST_SIZE);
+  assert(buf);
+  for( offset = 0; offset < file_size; offset += REQUEST_SIZE ) {
+    for( i = 0; i < REQUEST_SIZE; i++ ) {
+      buf[i] = (unsigned char) ((offset + i) * 7 >> 3);
+      expect += buf[i];
+    }
+    err = sys_pwrite(fd, buf, REQUEST_SIZE, offset, &got);
+    assert(!err);
+    assert(got == REQUEST_SIZE);
+  }
+  free(buf);
+
+  for( i = 0; i < (int) (sizeof(nthreads)/sizeof(int)); i++ ) {
+    for( j = 0; j < 2; j++ ) {
+      double seconds;
+      use_uring = j;
+      assert(ingest(nthreads[i], &seconds) == expect);
+      printf("%s, %d threads: %.1f MiB/s\n", use_uring ? "uring" : "pread",
+             nthreads[i], mib / seconds);
+    }
+  }
+
+  close(fd);
+  unlink("tmp.data");
+
+  printf("OK\n");
+
+  return 0;
+}
@@ -0,0 +1,150 @@
+#include "sys_basic.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <assert.h>
+
+#include "sys.h"
+#include "qio_error.h"
+
+// Checks the sys_uring_* calls.  They behave the same whether io_uring
+// is available or they fall back to preadv/pwritev, so the output does
+// not depend on the kernel.
+
+#define DATALEN 100000
+
+static char data[DATALEN];
+
+static void check_data(const char* buf, off_t offset, ssize_t len)
+{
+  assert(0 == memcmp(buf, data + offset, len));
+}
+
+// Write the file in two pieces, through pwrite and pwritev.
+static void write_file(int fd)
+{
+  struct iovec vec[3];
+  ssize_t got;
+  qio_err_t err;
+
+  err = sys_uring_pwrite(fd, data, 1000, 0, &got);
+  assert(!err);
+  assert(got == 1000);
+
+  vec[0].iov_base = data + 1000;
+  vec[0].iov_len = 1;
+  vec[1].iov_base = data + 1001;
+  vec[1].iov_len = 4095;
+  vec[2].iov_base = data + 5096;
+  vec[2].iov_len = DATALEN - 5096;
+  err = sys_uring_pwritev(fd, vec, 3, 1000, &got);
+  assert(!err);
+  assert(got == DATALEN - 1000);
+}
+
+static void check_reads(int fd)
+{
+  char* buf;
+  size_t buflen = 2 * DATALEN;
+  struct iovec vec[3];
+  ssize_t got;
+  qio_err_t err;
+
+  buf = malloc(buflen);
+  assert(buf);
+
+  // a full read
+  memset(buf, 0, buflen);
+  err = sys_uring_pread(fd, buf, DATALEN, 0, &got);
+  assert(!err);
+  assert(got == DATALEN);
+  check_data(buf, 0, DATALEN);
+
+  // a short read: only part of the request is before EOF
+  memset(buf, 0, buflen);
+  err = sys_uring_pread(fd, buf, 1000, DATALEN - 10, &got);
+  assert(!err);
+  assert(got == 10);
+  check_data(buf, DATALEN - 10, 10);
+
+  // a short vectored read ending in the second iovec,
+  // with the third iovec past EOF
+  memset(buf, 0, buflen);
+  vec[0].iov_base = buf;
+  vec[0].iov_len = 50;
+  vec[1].iov_base = buf + 50;
+  vec[1].iov_len = 100;
+  vec[2].iov_base = buf + 150;
+  vec[2].iov_len = 100;
+  err = sys_uring_preadv(fd, vec, 3, DATALEN - 70, &got);
+  assert(!err);
+  assert(got == 70);
+  check_data(buf, DATALEN - 70, 70);
+  assert(buf[70] == 0);
+
+  // reading at EOF
+  err = sys_uring_pread(fd, buf, 100, DATALEN, &got);
+  assert(err == EEOF);
+  assert(got == 0);
+
+  // reading past EOF
+  err = sys_uring_pread(fd, buf, 100, DATALEN + 4096, &got);
+  assert(err == EEOF);
+  assert(got == 0);
+
+  // an empty read is not EOF
+  err = sys_uring_pread(fd, buf, 0, DATALEN, &got);
+  assert(!err);
+  assert(got == 0);
+
+  // a bad file descriptor reports the error
+  err = sys_uring_pread(-1, buf, 100, 0, &got);
+  assert(err == EBADF);
+  assert(got == 0);
+
+  free(buf);
+}
+
+int main() {
+  int fd;
+  int i;
+  ssize_t got;
+  qio_err_t err;
+  char buf[100];
+
+  for( i = 0; i < DATALEN; i++ ) data[i] = 'a' + (i * 7) % 26;
+
+  fd = open("tmp.data", O_RDWR | O_CREAT | O_TRUNC, S_IRWXU);
+  assert(fd>=0);
+
+  write_file(fd);
+  check_reads(fd);
+
+  // When the kernel takes no submissions, the requests are done
+  // synchronously and give the same results.
+  sys_uring_test_reject_submit = 1;
+  err = ftruncate(fd, 0);
+  assert(!err);
+  write_file(fd);
+  check_reads(fd);
+  sys_uring_test_reject_submit = 0;
+
+  // The withdrawn submissions did not upset the ring.
+  err = sys_uring_pread(fd, buf, sizeof(buf), 500, &got);
+  assert(!err);
+  assert(got == sizeof(buf));
+  check_data(buf, 500, sizeof(buf));
+
+  close(fd);
+  unlink("tmp.data");
+
+  printf("OK\n");
+
+  return 0;
+}
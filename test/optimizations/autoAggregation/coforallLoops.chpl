@@ -0,0 +1,26 @@
+// Scatters and gathers at the end of for loops within coforall tasks are
+// reported, but not aggregated: the iterations of a for loop are ordered.
+config const n = 100;
+
+const D = {0..#n};
+var A: [D] int;
+var B: [D] int;
+const idx = [i in D] (i * 7) % n;
+
+coforall tid in 0..#2 {
+  for i in tid*n/2..#n/2 do
+    A[idx[i]] = i;
+}
+
+coforall tid in 0..#2 {
+  for i in tid*n/2..#n/2 do
+    B[i] = A[idx[i]];
+}
+
+coforall tid in 0..#2 {
+  for i in tid*n/2..#n/2 do
+    A[idx[i]] += 1;
+}
+
+writeln("sum = ", + reduce A);
+writeln("sum = ", + reduce B);
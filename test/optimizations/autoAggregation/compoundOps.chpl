@@ -0,0 +1,17 @@
+// Compound assignments at the end of a forall body are reported as not
+// aggregated: the aggregators only support copies.
+config const n = 100;
+
+const D = {0..#n};
+var A: [D] int;
+var B: [D] int;
+const idx = [i in D] (i * 7) % n;
+
+forall i in D do
+  A[idx[i]] += i;
+
+forall i in D do
+  B[idx[i]] *= 2;
+
+writeln("sum = ", + reduce A);
+writeln("sum = ", + reduce B);
@@ -0,0 +1,18 @@
+// Reducing potentially remote reads at the end of a forall body is reported,
+// but not aggregated: the reduction accumulates in a reduce-op object.
+config const n = 100;
+
+const D = {0..#n};
+var A: [D] int = D;
+const idx = [i in D] (i * 7) % n;
+
+var sum = 0;
+forall i in D with (+ reduce sum) do
+  sum += A[idx[i]];
+
+var mx = min(int);
+forall i in D with (max reduce mx) do
+  mx reduce= A[idx[i]];
+
+writeln("sum = ", sum);
+writeln("max = ", mx);
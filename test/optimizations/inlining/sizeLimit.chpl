@@ -0,0 +1,49 @@
+// Check which functions --inline-size-limit inlines.  The .prediff keeps
+// only the --report-inlining lines about the functions below, without
+// their sizes.
+
+record R {
+  var x: int;
+}
+
+// small, with a single call site
+proc small(r: R) {
+  return r.x;
+}
+
+// small, but recursive
+proc fact(n: int): int {
+  if n <= 1 then return 1;
+  return n * fact(n-1);
+}
+
+// small, but exported
+export proc exported(x: int): int {
+  return x + 1;
+}
+
+// larger than the limit, with two call sites
+proc big(x: int): int {
+  var a = x * 3;
+  var b = a + x / 2;
+  var c = b - a % 7;
+  var d = c * c + b;
+  var e = d / 5 + a;
+  return a + b + c + d + e;
+}
+
+// contains a loop, with two call sites
+proc loopy(n: int): int {
+  var s = 0;
+  for i in 1..n do s += i;
+  return s;
+}
+
+proc main() {
+  const r = new R(5);
+  writeln(small(r));
+  writeln(fact(5));
+  writeln(exported(1));
+  writeln(big(1), " ", big(2));
+  writeln(loopy(3), " ", loopy(4));
+}
@@ -0,0 +1,42 @@
+// Check the loops reported by --report-non-inlined-iterators, with the
+// reason each iterator was not inlined, and that raising
+// --inline-iterators-cost-limit inlines an iterator over the yield limit.
+
+iter three() {
+  yield 1;
+  yield 2;
+  yield 3;
+}
+
+iter many() {
+  yield 1;  yield 2;  yield 3;  yield 4;
+  yield 5;  yield 6;  yield 7;  yield 8;
+  yield 9;  yield 10; yield 11; yield 12;
+}
+
+class Parent {
+  iter items() { yield 1; }
+}
+
+class Child : Parent {
+  override iter items() { yield 2; }
+}
+
+proc main() {
+  var sum = 0;
+
+  for i in three() do
+    sum += i;
+
+  for (a, b) in zip(three(), three()) do
+    sum += a * b;
+
+  for i in many() do
+    sum += i;
+
+  var p: owned Parent = new owned Child();
+  for i in p.items() do
+    sum += i;
+
+  writeln("sum = ", sum);
+}
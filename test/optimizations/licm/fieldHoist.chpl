@@ -0,0 +1,59 @@
+// Check that loop invariant code motion hoists a read of a remote field
+// out of a loop containing an on statement that doesn't write the field,
+// and that it leaves the read alone when the on statement does write it.
+
+use CommDiagnostics;
+
+config param expectHoist = true;
+config const n = 100;
+
+class C {
+  var limit: int;
+  var scale: int;
+}
+
+proc getsOnHere() {
+  const d = getCommDiagnostics()[here.id];
+  return d.get + d.get_nb;
+}
+
+proc main() {
+  const c = new unmanaged C(3, 2);
+
+  on Locales[1] {
+    var sum = 0;
+    var last = 0;
+
+    // the on statement only reads 'c'
+    resetCommDiagnostics();
+    startCommDiagnostics();
+    for i in 1..n {
+      sum += c.limit;
+      on Locales[0] do last = c.scale;
+    }
+    stopCommDiagnostics();
+    const readGets = getsOnHere();
+
+    writeln("sum = ", sum, ", last = ", last);
+    if expectHoist then
+      writeln("hoisted read uses fewer gets: ", readGets < n);
+    else
+      writeln("unhoisted read uses a get per iteration: ", readGets >= n);
+
+    // the on statement writes the field that is read
+    sum = 0;
+    resetCommDiagnostics();
+    startCommDiagnostics();
+    for i in 1..n {
+      sum += c.limit;
+      on Locales[0] do c.limit += 1;
+    }
+    stopCommDiagnostics();
+    const writtenGets = getsOnHere();
+
+    writeln("sum = ", sum, ", limit = ", c.limit);
+    writeln("written field is read every iteration: ", writtenGets >= n);
+  }
+
+  delete c;
+}
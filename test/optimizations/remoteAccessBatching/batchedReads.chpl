@@ -0,0 +1,54 @@
+// Check that --remote-access-batching turns several reads of fields of a
+// remote record into a single get, and that reads separated by a statement
+// that may write memory are left alone.
+
+use CommDiagnostics;
+
+config param expectBatching = true;
+
+record R {
+  var a, b, c, d: int;
+}
+
+var r = new R(1, 2, 3, 4);
+
+proc getsOnHere() {
+  const d = getCommDiagnostics()[here.id];
+  return d.get + d.get_nb;
+}
+
+on Locales[1] {
+  ref rr = r;
+  var sum = 0;
+  var counter: atomic int;
+
+  // straight-line reads of the same record: one bulk get when batching
+  resetCommDiagnostics();
+  startCommDiagnostics();
+  const a1 = rr.a, b1 = rr.b, c1 = rr.c, d1 = rr.d;
+  stopCommDiagnostics();
+  const batchedGets = getsOnHere();
+  sum += a1 + b1 + c1 + d1;
+
+  // the same reads, separated by atomic operations: never batched
+  resetCommDiagnostics();
+  startCommDiagnostics();
+  const a2 = rr.a;
+  counter.add(1);
+  const b2 = rr.b;
+  counter.add(1);
+  const c2 = rr.c;
+  counter.add(1);
+  const d2 = rr.d;
+  stopCommDiagnostics();
+  const separateGets = getsOnHere();
+  sum += a2 + b2 + c2 + d2;
+
+  writeln("sum = ", sum);
+  writeln("separate reads use one get each: ", separateGets == 4);
+
+  if expectBatching then
+    writeln("batched reads use fewer gets: ", batchedGets < separateGets);
+  else
+    writeln("unbatched reads use one get each: ", batchedGets == separateGets);
+}
@@ -0,0 +1,50 @@
+// Check that --remote-access-batching turns writes of every field of a
+// remote record into a single put, and that writing only some of the
+// fields is left alone.
+
+use CommDiagnostics;
+
+config param expectBatching = true;
+
+record R {
+  var a, b, c, d: int;
+}
+
+var r = new R(1, 2, 3, 4);
+
+proc putsOnHere() {
+  const d = getCommDiagnostics()[here.id];
+  return d.put + d.put_nb;
+}
+
+on Locales[1] {
+  ref rr = r;
+  const x = here.id;
+
+  // straight-line writes of every field: one bulk put when batching
+  resetCommDiagnostics();
+  startCommDiagnostics();
+  rr.a = x + 10;
+  rr.b = x + 20;
+  rr.c = x + 30;
+  rr.d = x + 40;
+  stopCommDiagnostics();
+  const batchedPuts = putsOnHere();
+
+  // writes of some of the fields: never batched
+  resetCommDiagnostics();
+  startCommDiagnostics();
+  rr.a += 100;
+  rr.c += 100;
+  stopCommDiagnostics();
+  const partialPuts = putsOnHere();
+
+  writeln("partial writes use one put each: ", partialPuts == 2);
+
+  if expectBatching then
+    writeln("batched writes use one put: ", batchedPuts == 1);
+  else
+    writeln("unbatched writes use one put each: ", batchedPuts == 4);
+}
+
+writeln(r);
@@ -0,0 +1,48 @@
+// Check the --report-remote-access-batching output for a batched read
+// group and a batched write group, and that reads of two small fields of
+// a large record are not turned into a get of the whole record.
+
+use CommDiagnostics;
+
+record R {
+  var a, b, c, d: int;
+}
+
+record Big {
+  var a: int;
+  var t: 64*int;
+  var b: int;
+}
+
+var r = new R(1, 2, 3, 4);
+var big: Big;
+big.a = 1;
+big.b = 2;
+
+proc getsOnHere() {
+  const d = getCommDiagnostics()[here.id];
+  return d.get + d.get_nb;
+}
+
+on Locales[1] {
+  ref rr = r;
+  ref bb = big;
+  const x = here.id;
+
+  const a1 = rr.a, b1 = rr.b, c1 = rr.c, d1 = rr.d;
+  writeln("sum = ", a1 + b1 + c1 + d1);
+
+  rr.a = x + 10;
+  rr.b = x + 20;
+  rr.c = x + 30;
+  rr.d = x + 40;
+
+  resetCommDiagnostics();
+  startCommDiagnostics();
+  const a2 = bb.a, b2 = bb.b;
+  stopCommDiagnostics();
+  writeln("big record fields: ", a2 + b2);
+  writeln("big record reads use one get each: ", getsOnHere() == 2);
+}
+
+writeln(r);
@@ -0,0 +1,74 @@
+// Check which class instances --stack-allocation moves to the stack.  Each
+// case uses its own class so that the report lines can be told apart.
+// The size limit lets _new be inlined into the functions below, which is
+// what exposes their allocations.
+
+use CTypes;
+
+class NoEscape       { var x: int; }
+class Escapes        { var x: int; }
+class FieldNotStored { var x: int; }
+class FieldStored    { var x: int; }
+class PassedToFn     { var x: int; }
+
+var saved: unmanaged Escapes?;
+var savedPtr: c_ptr(int);
+
+// the reference does not outlive the call
+proc bump(ref x: int) {
+  x += 1;
+}
+
+// the reference is kept after the call
+proc keep(ref x: int) {
+  savedPtr = c_ptrTo(x);
+}
+
+// reads a field of the instance, without keeping it
+proc read(c: unmanaged PassedToFn): int {
+  return c.x;
+}
+
+proc noEscape(): int {
+  var c = new unmanaged NoEscape(1);
+  c.x += 1;
+  const r = c.x;
+  delete c;
+  return r;
+}
+
+proc escapes(): int {
+  var c = new unmanaged Escapes(2);
+  saved = c;
+  return c.x;
+}
+
+proc fieldNotStored(): int {
+  var c = new unmanaged FieldNotStored(3);
+  bump(c.x);
+  const r = c.x;
+  delete c;
+  return r;
+}
+
+proc fieldStored(): int {
+  var c = new unmanaged FieldStored(4);
+  keep(c.x);
+  const r = c.x;
+  delete c;
+  return r;
+}
+
+proc passedToFn(): int {
+  var c = new unmanaged PassedToFn(5);
+  const r = read(c);
+  delete c;
+  return r;
+}
+
+writeln(noEscape());
+writeln(escapes());
+writeln(fieldNotStored());
+writeln(fieldStored());
+writeln(passedToFn());
+delete saved;
@@ -0,0 +1,24 @@
+// Check that --stack-allocation leaves instances larger than
+// --stack-allocation-limit on the heap, even when they do not escape.
+
+class Small { var x: int; }
+class Large { var x: int; var t: 64*int; }
+
+proc small(): int {
+  var c = new unmanaged Small(1);
+  c.x += 1;
+  const r = c.x;
+  delete c;
+  return r;
+}
+
+proc large(): int {
+  var c = new unmanaged Large(1);
+  c.t[0] = c.x + 1;
+  const r = c.t[0];
+  delete c;
+  return r;
+}
+
+writeln(small());
+writeln(large());
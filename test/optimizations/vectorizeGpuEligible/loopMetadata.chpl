@@ -0,0 +1,23 @@
+// Check that --vectorize-gpu-eligible-loops requests vectorization of a
+// GPU-eligible loop through llvm.loop.vectorize.enable metadata, and does
+// not request it for a loop whose iterations are ordered.
+
+config const n = 16;
+
+proc scaleInto(ref A: [] real, const ref B: [] real, x: real) {
+  foreach i in 0..<n do
+    A[i] = x * B[i];
+}
+
+proc prefixSum(ref A: [] real) {
+  for i in 1..<n do
+    A[i] += A[i-1];
+}
+
+var A, B: [0..<n] real;
+B = 1.0;
+
+scaleInto(A, B, 2.0);
+prefixSum(A);
+
+writeln("result ", A[n-1]);
@@ -0,0 +1,34 @@
+// Measures the rate of atomic operations on a remote object.  With
+// network atomics these go straight to the network; without them each
+// one is an active message to the object's locale.
+
+use Time;
+
+config const numOps = 10000;
+config const printTiming = false;
+
+var x: atomic int;
+
+proc report(name: string, ref t: stopwatch, n: int) {
+  if printTiming then
+    writeln(name, " ops/sec: ", n / t.elapsed());
+}
+
+on Locales[numLocales-1] {
+  var t: stopwatch;
+
+  // one task, each op waits for its result
+  t.start();
+  for 1..numOps do x.fetchAdd(1);
+  t.stop();
+  report("serial fetchAdd", t, numOps);
+
+  // many tasks, non-fetching, which may use the unordered variants
+  t.clear();
+  t.start();
+  forall 1..numOps do x.add(1);
+  t.stop();
+  report("parallel add", t, numOps);
+}
+
+writeln("x = ", x.read(), ", expected ", 2 * numOps);
@@ -0,0 +1,94 @@
+// Compares the runtime collectives' barriers with the comm layer's own
+// barrier, times a small allreduce, and checks that the other runtime
+// collectives get the right answers.  The runtime collectives must be
+// called from exactly one task per locale, which the coforall+on gives us.
+
+use Time, CTypes;
+
+config const numTrials = 1000;
+config const printTiming = false;
+
+extern proc chpl_comm_barrier(msg: c_ptrConst(c_char));
+extern proc chpl_comm_coll_barrier_dissemination();
+extern proc chpl_comm_coll_barrier_tree();
+extern proc chpl_comm_coll_broadcast(root: int(32), buf: c_ptr(void),
+                                     size: c_size_t);
+extern proc chpl_comm_coll_allreduce(sendbuf: c_ptrConst(void),
+                                     recvbuf: c_ptr(void), count: c_size_t,
+                                     ctype: c_int, op: c_int);
+extern proc chpl_comm_coll_allgather(sendbuf: c_ptrConst(void),
+                                     recvbuf: c_ptr(void), size: c_size_t);
+
+extern const CHPL_COMM_COLL_INT64: c_int;
+extern const CHPL_COMM_COLL_SUM: c_int;
+
+enum barrierKind { commLayer, dissemination, tree };
+
+proc timeBarrier(param kind: barrierKind) {
+  var t: stopwatch;
+  t.start();
+  coforall loc in Locales do on loc {
+    for 1..numTrials {
+      select kind {
+        when barrierKind.commLayer do chpl_comm_barrier("perf".c_str());
+        when barrierKind.dissemination do chpl_comm_coll_barrier_dissemination();
+        when barrierKind.tree do chpl_comm_coll_barrier_tree();
+      }
+    }
+  }
+  t.stop();
+  if printTiming then
+    writeln(kind, " barrier usec: ", t.elapsed() * 1e6 / numTrials);
+}
+
+// The first collective call sets the collectives up; keep that out of
+// the timings.
+coforall loc in Locales do on loc do chpl_comm_coll_barrier_tree();
+
+timeBarrier(barrierKind.commLayer);
+timeBarrier(barrierKind.dissemination);
+timeBarrier(barrierKind.tree);
+
+proc timeAllreduce() {
+  var t: stopwatch;
+  t.start();
+  coforall loc in Locales do on loc {
+    var s = here.id, r: int;
+    for 1..numTrials do
+      chpl_comm_coll_allreduce(c_ptrToConst(s), c_ptrTo(r), 1,
+                               CHPL_COMM_COLL_INT64, CHPL_COMM_COLL_SUM);
+  }
+  t.stop();
+  if printTiming then
+    writeln("allreduce usec: ", t.elapsed() * 1e6 / numTrials);
+}
+
+timeAllreduce();
+
+var ok: [LocaleSpace] bool;
+coforall loc in Locales do on loc {
+  const me = here.id;
+  var good = true;
+
+  var b: int = if me == numLocales-1 then 42 else 0;
+  chpl_comm_coll_broadcast((numLocales-1): int(32), c_ptrTo(b), c_sizeof(int));
+  good &&= b == 42;
+
+  var s = me + 1, r: int;
+  chpl_comm_coll_allreduce(c_ptrToConst(s), c_ptrTo(r), 1,
+                           CHPL_COMM_COLL_INT64, CHPL_COMM_COLL_SUM);
+  good &&= r == numLocales * (numLocales + 1) / 2;
+
+  // big enough to use reduce and broadcast rather than recursive doubling
+  var sa: [0..<1024] int = me + 1, ra: [0..<1024] int;
+  chpl_comm_coll_allreduce(c_ptrToConst(sa), c_ptrTo(ra), 1024,
+                           CHPL_COMM_COLL_INT64, CHPL_COMM_COLL_SUM);
+  good &&= && reduce (ra == numLocales * (numLocales + 1) / 2);
+
+  var all: [0..<numLocales] int;
+  chpl_comm_coll_allgather(c_ptrToConst(s), c_ptrTo(all), c_sizeof(int));
+  for i in 0..<numLocales do good &&= all[i] == i + 1;
+
+  ok[me] = good;
+}
+writeln(if && reduce ok then "collectives ok" else "collectives FAILED");
@@ -0,0 +1,156 @@
+// Issue the runtime's non-blocking strided and indexed transfers directly
+// and complete them through chpl_comm_test_nb_complete(),
+// chpl_comm_try_nb_some() and chpl_comm_wait_nb_some().  The transfers
+// run from the last locale against memory on locale 0, so with more than
+// one locale they are remote.
+
+use CTypes;
+
+extern proc chpl_comm_get_strd_nb(dstaddr: c_ptr(void),
+                                  dststrides: c_ptr(c_size_t),
+                                  srcnode: int(32), srcaddr: c_ptr(void),
+                                  srcstrides: c_ptr(c_size_t),
+                                  count: c_ptr(c_size_t),
+                                  stridelevels: int(32), elemSize: c_size_t,
+                                  commID: int(32), ln: c_int,
+                                  fn: int(32)): c_ptr(void);
+extern proc chpl_comm_put_strd_nb(dstaddr: c_ptr(void),
+                                  dststrides: c_ptr(c_size_t),
+                                  dstnode: int(32), srcaddr: c_ptr(void),
+                                  srcstrides: c_ptr(c_size_t),
+                                  count: c_ptr(c_size_t),
+                                  stridelevels: int(32), elemSize: c_size_t,
+                                  commID: int(32), ln: c_int,
+                                  fn: int(32)): c_ptr(void);
+extern proc chpl_comm_get_indexed_nb(dstcount: c_size_t,
+                                     dstlist: c_ptr(c_ptr(void)),
+                                     dstlen: c_size_t, srcnode: int(32),
+                                     srccount: c_size_t,
+                                     srclist: c_ptr(c_ptr(void)),
+                                     srclen: c_size_t, commID: int(32),
+                                     ln: c_int, fn: int(32)): c_ptr(void);
+extern proc chpl_comm_put_indexed_nb(dstnode: int(32), dstcount: c_size_t,
+                                     dstlist: c_ptr(c_ptr(void)),
+                                     dstlen: c_size_t, srccount: c_size_t,
+                                     srclist: c_ptr(c_ptr(void)),
+                                     srclen: c_size_t, commID: int(32),
+                                     ln: c_int, fn: int(32)): c_ptr(void);
+extern proc chpl_comm_test_nb_complete(h: c_ptr(void)): c_int;
+extern proc chpl_comm_try_nb_some(h: c_ptr(c_ptr(void)),
+                                  nhandles: c_size_t): c_int;
+extern proc chpl_comm_wait_nb_some(h: c_ptr(c_ptr(void)),
+                                   nhandles: c_size_t);
+
+config const useTry = true;
+
+const sz = c_sizeof(int);
+
+// Wait for all of the handles.  A handle reported complete must not be
+// tested again, so clear it.
+proc complete(ref hs: c_array(c_ptr(void), 2)) {
+  while true {
+    var pending = 0;
+    for i in 0..<2 {
+      if hs[i] != nil {
+        if chpl_comm_test_nb_complete(hs[i]) != 0 then
+          hs[i] = nil;
+        else
+          pending += 1;
+      }
+    }
+    if pending == 0 then break;
+    if useTry && chpl_comm_try_nb_some(c_ptrTo(hs[0]), 2) != 0 then continue;
+    chpl_comm_wait_nb_some(c_ptrTo(hs[0]), 2);
+  }
+}
+
+// 8x8 source matrix, plus destinations for the puts, all on locale 0
+var A: [0..<64] int = 0..<64;
+var P: [0..<64] int;
+var Q: [0..<16] int;
+
+const aAddr = c_ptrTo(A[0]);
+const pAddr = c_ptrTo(P[0]);
+const qAddr = c_ptrTo(Q[0]);
+
+on Locales[numLocales-1] {
+  const node0 = 0: int(32);
+
+  //
+  // Strided: the first 4 columns of the even rows of A, as a 4x4 block.
+  //
+  var B: [0..<16] int;
+  var hs: c_array(c_ptr(void), 2);
+  {
+    var count: c_array(c_size_t, 2);
+    var aStr: c_array(c_size_t, 1);
+    var bStr: c_array(c_size_t, 1);
+    count[0] = 4; count[1] = 4;
+    aStr[0] = 16; bStr[0] = 4;
+
+    hs[0] = chpl_comm_get_strd_nb(c_ptrTo(B[0]), c_ptrTo(bStr[0]), node0,
+                                  aAddr: c_ptr(void), c_ptrTo(aStr[0]),
+                                  c_ptrTo(count[0]), 1, sz, 0, 0, 0);
+    hs[1] = nil;
+    // The stride and count arrays may be reused once the call returns.
+    count[0] = 0; count[1] = 0; aStr[0] = 0; bStr[0] = 0;
+    complete(hs);
+  }
+  var ok = true;
+  for r in 0..<4 do for c in 0..<4 do
+    if B[r*4 + c] != (2*r)*8 + c then ok = false;
+  writeln("strided get: ", ok);
+
+  // ... and back into the odd rows of P.
+  {
+    var count: c_array(c_size_t, 2);
+    var pStr: c_array(c_size_t, 1);
+    var bStr: c_array(c_size_t, 1);
+    count[0] = 4; count[1] = 4;
+    pStr[0] = 16; bStr[0] = 4;
+
+    hs[0] = chpl_comm_put_strd_nb((pAddr + 8): c_ptr(void),
+                                  c_ptrTo(pStr[0]), node0,
+                                  c_ptrTo(B[0]), c_ptrTo(bStr[0]),
+                                  c_ptrTo(count[0]), 1, sz, 0, 0, 0);
+    hs[1] = nil;
+    complete(hs);
+  }
+
+  //
+  // Indexed: gather four 2-int pieces of A into two 4-int pieces of G,
+  // and scatter one 16-int piece into sixteen 1-int pieces of Q, with
+  // both transfers in flight at once.
+  //
+  var G: [0..<8] int;
+  var S: [0..<16] int = 100..#16;
+  {
+    var aList: c_array(c_ptr(void), 4);
+    var gList: c_array(c_ptr(void), 2);
+    for i in 0..<4 do aList[i] = (aAddr + i*10): c_ptr(void);
+    for i in 0..<2 do gList[i] = c_ptrTo(G[i*4]): c_ptr(void);
+
+    var qList: c_array(c_ptr(void), 16);
+    var sList: c_array(c_ptr(void), 1);
+    for i in 0..<16 do qList[i] = (qAddr + (15-i)): c_ptr(void);
+    sList[0] = c_ptrTo(S[0]): c_ptr(void);
+
+    hs[0] = chpl_comm_get_indexed_nb(2, c_ptrTo(gList[0]), 4*sz, node0,
+                                     4, c_ptrTo(aList[0]), 2*sz, 0, 0, 0);
+    hs[1] = chpl_comm_put_indexed_nb(node0, 16, c_ptrTo(qList[0]), sz,
+                                     1, c_ptrTo(sList[0]), 16*sz, 0, 0, 0);
+    // The address lists may be reused once the calls return.
+    for i in 0..<4 do aList[i] = nil;
+    for i in 0..<16 do qList[i] = nil;
+    complete(hs);
+  }
+  writeln("indexed get: ", G);
+}
+
+var ok = true;
+for r in 0..<8 do for c in 0..<8 {
+  const expect = if r % 2 == 1 && c < 4 then (r-1)*8 + c else 0;
+  if P[r*8 + c] != expect then ok = false;
+}
+writeln("strided put: ", ok);
+writeln("indexed put: ", Q);
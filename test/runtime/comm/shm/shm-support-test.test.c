@@ -0,0 +1,238 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+
+#include "comm-shm-support.c"
+
+//
+// Active message rings
+//
+
+static am_ring_t ring;
+
+static void push_one(uint16_t handler, uint64_t val) {
+  assert( ring_try_push(&ring, handler, &val, sizeof(val), NULL, 0) );
+}
+
+static uint64_t pop_one(uint16_t expect_handler) {
+  am_msg_t msg;
+  uint64_t val;
+  assert( ring_try_pop(&ring, &msg) );
+  assert( msg.handler == expect_handler );
+  assert( msg.size == sizeof(val) );
+  memcpy(&val, msg.data, sizeof(val));
+  return val;
+}
+
+static void test_ring_basic(void) {
+  am_msg_t msg;
+
+  ring_init(&ring);
+  assert( !ring_try_pop(&ring, &msg) );
+
+  for (uint64_t i = 0; i < 10; i++) {
+    push_one(1, i);
+  }
+  for (uint64_t i = 0; i < 10; i++) {
+    assert( pop_one(1) == i );
+  }
+  assert( !ring_try_pop(&ring, &msg) );
+
+  // Header and payload are concatenated in the slot.
+  {
+    const char hdr[] = "hdr:";
+    const char data[] = "payload";
+    assert( ring_try_push(&ring, 7, hdr, 4, data, sizeof(data)) );
+    assert( ring_try_pop(&ring, &msg) );
+    assert( msg.handler == 7 );
+    assert( msg.size == 4 + sizeof(data) );
+    assert( memcmp(msg.data, "hdr:payload", msg.size) == 0 );
+  }
+
+  // A maximum-size message fits.
+  {
+    unsigned char big[AM_MAX_MEDIUM];
+    for (size_t i = 0; i < sizeof(big); i++) {
+      big[i] = (unsigned char) i;
+    }
+    assert( ring_try_push(&ring, 2, big, 16, big + 16, sizeof(big) - 16) );
+    assert( ring_try_pop(&ring, &msg) );
+    assert( msg.size == AM_MAX_MEDIUM );
+    assert( memcmp(msg.data, big, sizeof(big)) == 0 );
+  }
+
+  printf("ring basic OK\n");
+}
+
+static void test_ring_full_and_wrap(void) {
+  am_msg_t msg;
+
+  ring_init(&ring);
+
+  // Fill it, check it refuses more, then drain it.  Do this a few times
+  // so head and tail wrap around the slot array.
+  for (int round = 0; round < 3; round++) {
+    for (uint64_t i = 0; i < AM_RING_SLOTS; i++) {
+      push_one(3, round * AM_RING_SLOTS + i);
+    }
+    {
+      uint64_t val = 0;
+      assert( !ring_try_push(&ring, 3, &val, sizeof(val), NULL, 0) );
+    }
+    for (uint64_t i = 0; i < AM_RING_SLOTS; i++) {
+      assert( pop_one(3) == round * AM_RING_SLOTS + i );
+    }
+    assert( !ring_try_pop(&ring, &msg) );
+  }
+
+  // Interleaved pushes and pops with a partly full ring.
+  for (uint64_t i = 0; i < 5 * AM_RING_SLOTS; i++) {
+    push_one(4, i);
+    push_one(4, i);
+    assert( pop_one(4) == i );
+    assert( pop_one(4) == i );
+  }
+  assert( !ring_try_pop(&ring, &msg) );
+
+  printf("ring full/wrap OK\n");
+}
+
+#define NUM_PRODUCERS 4
+#define MSGS_PER_PRODUCER 100000
+
+static void* producer(void* arg) {
+  uint64_t id = (uint64_t) (uintptr_t) arg;
+  for (uint64_t i = 0; i < MSGS_PER_PRODUCER; i++) {
+    uint64_t val = (id << 32) | i;
+    while (!ring_try_push(&ring, (uint16_t) id, &val, sizeof(val), NULL, 0))
+      ;
+  }
+  return NULL;
+}
+
+static void test_ring_mpsc(void) {
+  pthread_t threads[NUM_PRODUCERS];
+  uint64_t next[NUM_PRODUCERS] = { 0 };
+  uint64_t received = 0;
+
+  ring_init(&ring);
+  for (uint64_t p = 0; p < NUM_PRODUCERS; p++) {
+    assert( pthread_create(&threads[p], NULL, producer,
+                           (void*) (uintptr_t) p) == 0 );
+  }
+
+  // Every message arrives exactly once, and each producer's messages
+  // arrive in the order it sent them.
+  while (received < NUM_PRODUCERS * MSGS_PER_PRODUCER) {
+    am_msg_t msg;
+    uint64_t val, id;
+    if (!ring_try_pop(&ring, &msg)) {
+      continue;
+    }
+    memcpy(&val, msg.data, sizeof(val));
+    id = val >> 32;
+    assert( id == msg.handler && id < NUM_PRODUCERS );
+    assert( (val & 0xffffffff) == next[id] );
+    next[id]++;
+    received++;
+  }
+
+  for (int p = 0; p < NUM_PRODUCERS; p++) {
+    assert( pthread_join(threads[p], NULL) == 0 );
+  }
+  printf("ring multi-producer OK\n");
+}
+
+//
+// AMOs
+//
+
+#define test_amo_int(field, T)                                          \
+  {                                                                     \
+    T obj = 0x12;                                                       \
+    amo_val_t o1, o2, old;                                              \
+    o1.field = 0x30;                                                    \
+    do_amo(amo_write, amo_##field, &obj, &o1, NULL, &old);              \
+    assert( obj == 0x30 );                                              \
+    do_amo(amo_read, amo_##field, &obj, NULL, NULL, &old);              \
+    assert( old.field == 0x30 );                                        \
+    o1.field = 0x12;                                                    \
+    do_amo(amo_xchg, amo_##field, &obj, &o1, NULL, &old);               \
+    assert( old.field == 0x30 && obj == 0x12 );                         \
+    o1.field = 0x99; o2.field = 0x55;                                   \
+    assert( !do_amo(amo_cmpxchg, amo_##field, &obj, &o1, &o2, &old) );  \
+    assert( old.field == 0x12 && obj == 0x12 );                         \
+    o1.field = 0x12;                                                    \
+    assert( do_amo(amo_cmpxchg, amo_##field, &obj, &o1, &o2, &old) );   \
+    assert( old.field == 0x12 && obj == 0x55 );                         \
+    obj = 0x12; o1.field = 0x10;                                        \
+    do_amo(amo_and, amo_##field, &obj, &o1, NULL, &old);                \
+    assert( old.field == 0x12 && obj == 0x10 );                         \
+    obj = 0x12; o1.field = 0x11;                                        \
+    do_amo(amo_or, amo_##field, &obj, &o1, NULL, &old);                 \
+    assert( old.field == 0x12 && obj == 0x13 );                         \
+    obj = 0x12; o1.field = 0x10;                                        \
+    do_amo(amo_xor, amo_##field, &obj, &o1, NULL, &old);                \
+    assert( old.field == 0x12 && obj == 0x02 );                         \
+    obj = 10; o1.field = 2;                                             \
+    do_amo(amo_add, amo_##field, &obj, &o1, NULL, &old);                \
+    assert( old.field == 10 && obj == 12 );                             \
+    do_amo(amo_sub, amo_##field, &obj, &o1, NULL, &old);                \
+    assert( old.field == 12 && obj == 10 );                             \
+    assert( amo_type_size(amo_##field) == sizeof(T) );                  \
+  }
+
+#define test_amo_real(field, T)                                         \
+  {                                                                     \
+    T obj = 1.5;                                                        \
+    amo_val_t o1, o2, old;                                              \
+    o1.field = 2.25;                                                    \
+    do_amo(amo_write, amo_##field, &obj, &o1, NULL, &old);              \
+    assert( obj == 2.25 );                                              \
+    do_amo(amo_read, amo_##field, &obj, NULL, NULL, &old);              \
+    assert( old.field == 2.25 );                                        \
+    o1.field = -1.0;                                                    \
+    do_amo(amo_xchg, amo_##field, &obj, &o1, NULL, &old);               \
+    assert( old.field == 2.25 && obj == -1.0 );                         \
+    o1.field = 3.0; o2.field = 4.0;                                     \
+    assert( !do_amo(amo_cmpxchg, amo_##field, &obj, &o1, &o2, &old) );  \
+    assert( old.field == -1.0 && obj == -1.0 );                         \
+    o1.field = -1.0;                                                    \
+    assert( do_amo(amo_cmpxchg, amo_##field, &obj, &o1, &o2, &old) );   \
+    assert( old.field == -1.0 && obj == 4.0 );                          \
+    o1.field = 0.5;                                                     \
+    do_amo(amo_add, amo_##field, &obj, &o1, NULL, &old);                \
+    assert( old.field == 4.0 && obj == 4.5 );                           \
+    do_amo(amo_sub, amo_##field, &obj, &o1, NULL, &old);                \
+    assert( old.field == 4.5 && obj == 4.0 );                           \
+    assert( amo_type_size(amo_##field) == sizeof(T) );                  \
+  }
+
+static void test_amos(void) {
+  test_amo_int(int32, int32_t);
+  test_amo_int(int64, int64_t);
+  test_amo_int(uint32, uint32_t);
+  test_amo_int(uint64, uint64_t);
+  test_amo_real(real32, _real32);
+  test_amo_real(real64, _real64);
+
+  // Wide values survive the round trip.
+  {
+    int64_t obj = 0;
+    amo_val_t o1, old;
+    o1.int64 = INT64_MIN;
+    do_amo(amo_add, amo_int64, &obj, &o1, NULL, &old);
+    assert( obj == INT64_MIN );
+  }
+
+  printf("AMOs OK\n");
+}
+
+int main(int argc, char** argv)
+{
+  test_ring_basic();
+  test_ring_full_and_wrap();
+  test_ring_mpsc();
+  test_amos();
+  return 0;
+}
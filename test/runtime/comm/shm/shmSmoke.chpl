@@ -0,0 +1,107 @@
+// Exercise the basic operations of the shm comm layer: on statements
+// (blocking, non-blocking, and nested back to the origin), puts and gets
+// both smaller and larger than an active message slot, strided
+// transfers, and atomics on remote memory.
+
+use BlockDist;
+
+config const n = 100000;
+
+proc check(cond: bool, what: string) {
+  if !cond then writeln("FAILED: ", what);
+}
+
+// on statements
+{
+  var ids: [0..#numLocales] int;
+  coforall loc in Locales do on loc {
+    var back = -1;
+    on Locales[0] do back = here.id;
+    ids[loc.id] = here.id + back;
+  }
+  check(&& reduce [i in 0..#numLocales] ids[i] == i, "blocking on");
+
+  var count: atomic int;
+  sync {
+    for loc in Locales do begin on loc do count.add(1);
+  }
+  check(count.read() == numLocales, "begin on");
+  writeln("on statements OK");
+}
+
+// puts and gets
+{
+  var small: int;
+  var big: [1..n] int;
+  on Locales[numLocales-1] {
+    // remote PUTs from the far locale
+    small = 42;
+    big = [i in 1..n] i * 2;
+  }
+  check(small == 42, "small put");
+  check(&& reduce [i in 1..n] big[i] == i * 2, "large put");
+
+  on Locales[numLocales-1] {
+    // remote GETs from the far locale
+    check(small == 42, "small get");
+    var sum = 0;
+    for x in big do sum += x;
+    check(sum == n * (n + 1), "large get");
+    var copy: [1..n] int = big;
+    check(&& reduce [i in 1..n] copy[i] == i * 2, "bulk get");
+  }
+  writeln("put/get OK");
+}
+
+// strided transfers
+{
+  var A: [1..8, 1..8] real;
+  on Locales[numLocales-1] {
+    var B: [1..8, 1..8] real = [(i, j) in {1..8, 1..8}] i * 10 + j;
+    A[1..8 by 2, 2..7] = B[2..8 by 2, 1..6];
+  }
+  var ok = true;
+  for (i, j) in {1..8, 1..8} {
+    const expect = if i % 2 == 1 && j >= 2 && j <= 7
+                   then (i + 1) * 10 + (j - 1) else 0;
+    if A[i, j] != expect then ok = false;
+  }
+  check(ok, "strided put");
+  writeln("strided OK");
+}
+
+// atomics on remote memory
+{
+  var ai: atomic int;
+  var au: atomic uint(32);
+  var ar: atomic real;
+  coforall loc in Locales do on loc {
+    for 1..1000 {
+      ai.add(1);
+      au.fetchOr(1:uint(32) << (here.id % 32));
+      ar.add(0.5);
+    }
+    ai.sub(1);
+  }
+  check(ai.read() == numLocales * 999, "atomic int add/sub");
+  check(au.read() == ((1:uint(32) << min(numLocales, 32)) - 1), "atomic or");
+  check(ar.read() == numLocales * 500.0, "atomic real add");
+
+  on Locales[numLocales-1] {
+    var expected = numLocales * 999;
+    check(ai.compareExchange(expected, -1), "cmpxchg success");
+    check(!ai.compareExchange(expected, 7), "cmpxchg failure");
+    check(ai.exchange(5) == -1, "xchg");
+  }
+  check(ai.read() == 5, "final value");
+  writeln("atomics OK");
+}
+
+// a distributed array touches every locale from every locale
+{
+  const D = blockDist.createDomain({1..n});
+  var X: [D] int;
+  forall i in D do X[i] = i;
+  check(+ reduce X == n * (n + 1) / 2, "block reduce");
+  writeln("distributed OK");
+}
@@ -0,0 +1,489 @@
+/*
+ * Copyright 2021-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ast-matcher.h"
+#include "chpl/uast/all-uast.h"
+#include "chpl/parsing/parsing-queries.h"
+
+#include <unordered_map>
+
+using namespace chpl;
+using namespace uast;
+
+PyTypeObject PatternType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+};
+
+void setupPatternType() {
+  PatternType.tp_name = "Pattern";
+  PatternType.tp_basicsize = sizeof(PatternObject);
+  PatternType.tp_itemsize = 0;
+  PatternType.tp_dealloc = (destructor) PatternObject_dealloc;
+  PatternType.tp_flags = Py_TPFLAGS_DEFAULT;
+  PatternType.tp_doc = PyDoc_STR("A compiled structural pattern over Chapel AST nodes");
+  PatternType.tp_init = (initproc) PatternObject_init;
+  PatternType.tp_new = PyType_GenericNew;
+}
+
+using TagRange = std::pair<AstTag, AstTag>;
+
+/* Map user-facing class names (including abstract ones like Loop or
+   NamedDecl) to the range of tags they cover. */
+static const std::unordered_map<std::string, TagRange>& tagRangesByName() {
+  static const auto ranges = []() {
+    std::unordered_map<std::string, TagRange> m;
+    m["AstNode"] = TagRange(AstTag(0), asttags::NUM_AST_TAGS);
+#define AST_NODE(NAME) m[#NAME] = TagRange(asttags::NAME, asttags::NAME);
+#define AST_LEAF(NAME) m[#NAME] = TagRange(asttags::NAME, asttags::NAME);
+#define AST_BEGIN_SUBCLASSES(NAME) m[#NAME].first = asttags::START_##NAME;
+#define AST_END_SUBCLASSES(NAME) m[#NAME].second = asttags::END_##NAME;
+#include "chpl/uast/uast-classes-list.h"
+#undef AST_NODE
+#undef AST_LEAF
+#undef AST_BEGIN_SUBCLASSES
+#undef AST_END_SUBCLASSES
+    return m;
+  }();
+  return ranges;
+}
+
+bool AstPattern::matchesTag(AstTag tag) const {
+  if (kinds.empty()) return true;
+  for (auto& range : kinds) {
+    if (range.first <= tag && tag <= range.second) return true;
+  }
+  return false;
+}
+
+static bool nodeName(const AstNode* node, UniqueString& out) {
+  if (auto decl = node->toNamedDecl()) {
+    out = decl->name();
+  } else if (auto ident = node->toIdentifier()) {
+    out = ident->name();
+  } else if (auto dot = node->toDot()) {
+    out = dot->field();
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static bool matchAttributes(const AstPattern& pattern, const AstNode* node) {
+  bool needsGroup = !pattern.attributes.empty() || !pattern.pragmas.empty() ||
+                    pattern.deprecated == 1 || pattern.unstable == 1;
+  auto attrs = node->attributeGroup();
+  if (!attrs) return !needsGroup;
+
+  if (pattern.deprecated != -1 &&
+      attrs->isDeprecated() != (pattern.deprecated == 1)) return false;
+  if (pattern.unstable != -1 &&
+      attrs->isUnstable() != (pattern.unstable == 1)) return false;
+
+  for (auto tag : pattern.pragmas) {
+    if (!attrs->hasPragma(tag)) return false;
+  }
+  for (auto& name : pattern.attributes) {
+    bool found = false;
+    for (auto child : attrs->children()) {
+      if (auto attr = child->toAttribute()) {
+        if (attr->name() == name) {
+          found = true;
+          break;
+        }
+      }
+    }
+    if (!found) return false;
+  }
+  return true;
+}
+
+bool matchAstPattern(Context* context,
+                     const AstPattern& pattern,
+                     const AstNode* node,
+                     AstPatternCaptures& captures) {
+  if (!pattern.matchesTag(node->tag())) return false;
+
+  if (!pattern.names.empty()) {
+    UniqueString name;
+    if (!nodeName(node, name)) return false;
+    bool found = false;
+    for (auto& candidate : pattern.names) {
+      if (name == candidate) {
+        found = true;
+        break;
+      }
+    }
+    if (!found) return false;
+  }
+
+  if (!matchAttributes(pattern, node)) return false;
+
+  if (node->numChildren() < (int) pattern.children.size()) return false;
+
+  // Sub-patterns may capture before a later one fails; roll those back.
+  size_t mark = captures.size();
+  for (size_t i = 0; i < pattern.children.size(); i++) {
+    auto& childPattern = pattern.children[i];
+    if (childPattern &&
+        !matchAstPattern(context, *childPattern, node->child(i), captures)) {
+      captures.resize(mark);
+      return false;
+    }
+  }
+
+  if (pattern.parent) {
+    auto parent = parsing::parentAst(context, node);
+    if (!parent ||
+        !matchAstPattern(context, *pattern.parent, parent, captures)) {
+      captures.resize(mark);
+      return false;
+    }
+  }
+
+  if (!pattern.capture.empty()) {
+    captures.emplace_back(pattern.capture.c_str(), node);
+  }
+  return true;
+}
+
+/* Read a str, or a list / tuple of strs, into 'out'. Sets a Python
+   error and returns false if 'obj' is anything else. */
+static bool stringsFromPython(PyObject* obj, const char* key,
+                              std::vector<std::string>& out) {
+  if (PyUnicode_Check(obj)) {
+    const char* str = PyUnicode_AsUTF8(obj);
+    if (!str) return false;
+    out.push_back(str);
+    return true;
+  }
+  if (PyList_Check(obj) || PyTuple_Check(obj)) {
+    Py_ssize_t size = PySequence_Size(obj);
+    for (Py_ssize_t i = 0; i < size; i++) {
+      PyObject* item = PySequence_Fast_GET_ITEM(obj, i);
+      if (!PyUnicode_Check(item)) {
+        PyErr_Format(PyExc_TypeError,
+                     "pattern key '%s' expects a str or a list of str", key);
+        return false;
+      }
+      const char* str = PyUnicode_AsUTF8(item);
+      if (!str) return false;
+      out.push_back(str);
+    }
+    return true;
+  }
+  PyErr_Format(PyExc_TypeError,
+               "pattern key '%s' expects a str or a list of str", key);
+  return false;
+}
+
+static bool addKinds(AstPattern& pattern, PyObject* obj) {
+  std::vector<std::string> names;
+  if (!stringsFromPython(obj, "kind", names)) return false;
+  auto& ranges = tagRangesByName();
+  for (auto& name : names) {
+    auto it = ranges.find(name);
+    if (it == ranges.end()) {
+      PyErr_Format(PyExc_ValueError, "unknown AST node kind '%s'",
+                   name.c_str());
+      return false;
+    }
+    pattern.kinds.push_back(it->second);
+  }
+  return true;
+}
+
+static std::shared_ptr<const AstPattern> compilePattern(PyObject* spec);
+
+static std::shared_ptr<const AstPattern>
+compilePatternFromDict(PyObject* spec) {
+  auto pattern = std::make_shared<AstPattern>();
+  PyObject* key;
+  PyObject* value;
+  Py_ssize_t pos = 0;
+
+  while (PyDict_Next(spec, &pos, &key, &value)) {
+    if (!PyUnicode_Check(key)) {
+      PyErr_SetString(PyExc_TypeError, "pattern keys must be str");
+      return nullptr;
+    }
+    const char* k = PyUnicode_AsUTF8(key);
+    if (!k) return nullptr;
+
+    std::string keyStr = k;
+    if (keyStr == "kind") {
+      if (!addKinds(*pattern, value)) return nullptr;
+    } else if (keyStr == "name") {
+      if (!stringsFromPython(value, k, pattern->names)) return nullptr;
+    } else if (keyStr == "attribute") {
+      if (!stringsFromPython(value, k, pattern->attributes)) return nullptr;
+    } else if (keyStr == "pragma") {
+      std::vector<std::string> names;
+      if (!stringsFromPython(value, k, names)) return nullptr;
+      for (auto& name : names) {
+        auto tag = pragmaNameToTag(name.c_str());
+        if (tag == PRAGMA_UNKNOWN) {
+          PyErr_Format(PyExc_ValueError, "unknown pragma '%s'", name.c_str());
+          return nullptr;
+        }
+        pattern->pragmas.push_back(tag);
+      }
+    } else if (keyStr == "deprecated" || keyStr == "unstable") {
+      int truth = PyObject_IsTrue(value);
+      if (truth < 0) return nullptr;
+      (keyStr == "deprecated" ? pattern->deprecated : pattern->unstable) = truth;
+    } else if (keyStr == "children") {
+      if (!PyList_Check(value) && !PyTuple_Check(value)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "pattern key 'children' expects a list");
+        return nullptr;
+      }
+      Py_ssize_t size = PySequence_Size(value);
+      for (Py_ssize_t i = 0; i < size; i++) {
+        PyObject* item = PySequence_Fast_GET_ITEM(value, i);
+        if (item == Py_None) {
+          pattern->children.push_back(nullptr);
+        } else if (auto child = compilePattern(item)) {
+          pattern->children.push_back(std::move(child));
+        } else {
+          return nullptr;
+        }
+      }
+    } else if (keyStr == "parent") {
+      pattern->parent = compilePattern(value);
+      if (!pattern->parent) return nullptr;
+    } else if (keyStr == "capture") {
+      if (!PyUnicode_Check(value)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "pattern key 'capture' expects a str");
+        return nullptr;
+      }
+      const char* capture = PyUnicode_AsUTF8(value);
+      if (!capture) return nullptr;
+      pattern->capture = capture;
+    } else {
+      PyErr_Format(PyExc_ValueError, "unknown pattern key '%s'", k);
+      return nullptr;
+    }
+  }
+
+  return pattern;
+}
+
+/* Compile a Python pattern description. Returns nullptr with a Python
+   error set if the description is malformed. */
+static std::shared_ptr<const AstPattern> compilePattern(PyObject* spec) {
+  if (PyObject_TypeCheck(spec, &PatternType)) {
+    return ((PatternObject*) spec)->pattern;
+  }
+  if (PyUnicode_Check(spec)) {
+    auto pattern = std::make_shared<AstPattern>();
+    if (!addKinds(*pattern, spec)) return nullptr;
+    return pattern;
+  }
+  if (PyDict_Check(spec)) {
+    return compilePatternFromDict(spec);
+  }
+  PyErr_SetString(PyExc_TypeError,
+                  "a pattern must be a Pattern, a node kind, or a dict");
+  return nullptr;
+}
+
+/*
+  A Pattern is built from one of:
+
+    * the name of an AST node class, e.g. "Function" or "Loop" (abstract
+      classes match any of their subclasses; "AstNode" matches anything);
+    * a dict with any of the keys
+        "kind"       - a class name or list of them (any may match),
+        "name"       - a name or list of them the node must have (any may
+                       match); applies to NamedDecl, Identifier, and Dot,
+        "attribute"  - attribute name(s) the node must all have,
+        "pragma"     - pragma name(s) the node must all have,
+        "deprecated" / "unstable" - required truth of those flags,
+        "children"   - a list of patterns (or None) matched against the
+                       node's first children, in order,
+        "parent"     - a pattern the node's parent must match,
+        "capture"    - a name under which to report the matched node;
+    * another Pattern.
+ */
+int PatternObject_init(PatternObject* self, PyObject* args, PyObject* kwargs) {
+  PyObject* spec;
+  if (!PyArg_ParseTuple(args, "O", &spec)) return -1;
+
+  new (&self->pattern) std::shared_ptr<const AstPattern>();
+  self->pattern = compilePattern(spec);
+  return self->pattern ? 0 : -1;
+}
+
+void PatternObject_dealloc(PatternObject* self) {
+  using PatternPtr = std::shared_ptr<const AstPattern>;
+  self->pattern.~PatternPtr();
+  Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+/* Compile the patterns argument of find_matches. It is either a single
+   pattern or a list / tuple of patterns (for example, one per lint rule);
+   'single' records which so that results can be shaped to match. */
+static bool compilePatternArg(PyObject* arg,
+                              std::vector<std::shared_ptr<const AstPattern>>& out,
+                              bool& single) {
+  single = !PyList_Check(arg) && !PyTuple_Check(arg);
+  if (single) {
+    auto pattern = compilePattern(arg);
+    if (!pattern) return false;
+    out.push_back(std::move(pattern));
+    return true;
+  }
+
+  Py_ssize_t size = PySequence_Size(arg);
+  for (Py_ssize_t i = 0; i < size; i++) {
+    auto pattern = compilePattern(PySequence_Fast_GET_ITEM(arg, i));
+    if (!pattern) return false;
+    out.push_back(std::move(pattern));
+  }
+  return true;
+}
+
+static PyObject* wrapCaptures(ContextObject* contextObject,
+                              const AstPatternCaptures& captures) {
+  PyObject* dict = PyDict_New();
+  if (!dict) return nullptr;
+  for (auto& capture : captures) {
+    PyObject* node = wrapAstNode(contextObject, capture.second);
+    if (!node || PyDict_SetItemString(dict, capture.first, node) < 0) {
+      Py_XDECREF(node);
+      Py_DECREF(dict);
+      return nullptr;
+    }
+    Py_DECREF(node);
+  }
+  return dict;
+}
+
+/* Walk the trees rooted at 'roots' in pre-order (source order), trying
+   each pattern whose kind admits the node's tag. For a single pattern the
+   result is a list of (node, captures); otherwise it is a list of
+   (pattern index, node, captures). Returns nullptr, with the Python
+   error set, if building the results fails. */
+static PyObject* findMatches(ContextObject* contextObject,
+                             const std::vector<const AstNode*>& roots,
+                             const std::vector<std::shared_ptr<const AstPattern>>& patterns,
+                             bool single) {
+  auto context = &contextObject->context;
+
+  // Decide once, rather than at every node, which patterns could apply
+  // to each tag.
+  std::vector<int> candidates[asttags::NUM_AST_TAGS];
+  for (int tag = 0; tag < asttags::NUM_AST_TAGS; tag++) {
+    for (size_t i = 0; i < patterns.size(); i++) {
+      if (patterns[i]->matchesTag(AstTag(tag))) candidates[tag].push_back(i);
+    }
+  }
+
+  PyObject* results = PyList_New(0);
+  if (!results) return nullptr;
+  AstPatternCaptures captures;
+  std::vector<const AstNode*> stack(roots.rbegin(), roots.rend());
+
+  while (!stack.empty()) {
+    const AstNode* node = stack.back();
+    stack.pop_back();
+
+    for (int i : candidates[node->tag()]) {
+      captures.clear();
+      if (!matchAstPattern(context, *patterns[i], node, captures)) continue;
+
+      PyObject* wrapped = wrapAstNode(contextObject, node);
+      PyObject* wrappedCaptures =
+        wrapped ? wrapCaptures(contextObject, captures) : nullptr;
+      if (!wrappedCaptures) {
+        Py_XDECREF(wrapped);
+        Py_DECREF(results);
+        return nullptr;
+      }
+
+      // "N" hands our references to the tuple, or releases them on failure.
+      PyObject* match;
+      if (single) {
+        match = Py_BuildValue("(NN)", wrapped, wrappedCaptures);
+      } else {
+        match = Py_BuildValue("(iNN)", i, wrapped, wrappedCaptures);
+      }
+      if (!match || PyList_Append(results, match) < 0) {
+        Py_XDECREF(match);
+        Py_DECREF(results);
+        return nullptr;
+      }
+      Py_DECREF(match);
+    }
+
+    for (int i = node->numChildren() - 1; i >= 0; i--) {
+      stack.push_back(node->child(i));
+    }
+  }
+
+  return results;
+}
+
+PyObject* AstNodeObject_match(AstNodeObject* self, PyObject* args) {
+  PyObject* spec;
+  if (!PyArg_ParseTuple(args, "O", &spec)) return nullptr;
+  auto pattern = compilePattern(spec);
+  if (!pattern) return nullptr;
+
+  auto contextObject = (ContextObject*) self->contextObject;
+  AstPatternCaptures captures;
+  if (!matchAstPattern(&contextObject->context, *pattern, self->astNode,
+                       captures)) {
+    Py_RETURN_NONE;
+  }
+  return wrapCaptures(contextObject, captures);
+}
+
+PyObject* AstNodeObject_find_matches(AstNodeObject* self, PyObject* args) {
+  PyObject* arg;
+  if (!PyArg_ParseTuple(args, "O", &arg)) return nullptr;
+  std::vector<std::shared_ptr<const AstPattern>> patterns;
+  bool single;
+  if (!compilePatternArg(arg, patterns, single)) return nullptr;
+
+  return findMatches((ContextObject*) self->contextObject,
+                     { self->astNode }, patterns, single);
+}
+
+PyObject* ContextObject_find_matches(ContextObject* self, PyObject* args) {
+  auto context = &self->context;
+  const char* fileName;
+  PyObject* arg;
+  if (!PyArg_ParseTuple(args, "sO", &fileName, &arg)) return nullptr;
+  std::vector<std::shared_ptr<const AstPattern>> patterns;
+  bool single;
+  if (!compilePatternArg(arg, patterns, single)) return nullptr;
+
+  auto fileNameUS = UniqueString::get(context, fileName);
+  auto parentPathUS = UniqueString();
+  auto& builderResult = parsing::parseFileToBuilderResultAndCheck(context, fileNameUS, parentPathUS);
+
+  std::vector<const AstNode*> roots;
+  for (int i = 0; i < builderResult.numTopLevelExpressions(); i++) {
+    roots.push_back(builderResult.topLevelExpression(i));
+  }
+  return findMatches(self, roots, patterns, single);
+}
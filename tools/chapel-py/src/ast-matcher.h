@@ -0,0 +1,87 @@
+/*
+ * Copyright 2021-2023 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CHAPEL_PY_AST_MATCHER_H
+#define CHAPEL_PY_AST_MATCHER_H
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+#include "chpl/framework/Context.h"
+#include "chpl/uast/AstNode.h"
+#include "chpl/uast/Pragma.h"
+#include "core-types.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* A structural pattern over uAST nodes, compiled once from its Python
+   description (see PatternObject_init for the accepted forms) so that
+   whole subtrees can be searched without calling back into Python for
+   every node. */
+struct AstPattern {
+  // Inclusive tag ranges; a node matches if its tag is in any of them.
+  // Empty means any kind of node.
+  std::vector<std::pair<chpl::uast::AstTag, chpl::uast::AstTag>> kinds;
+  // The node's name (NamedDecl, Identifier, or Dot field) must be one of
+  // these. Empty means any name, including none.
+  std::vector<std::string> names;
+  // The node's attribute group must contain all of these.
+  std::vector<std::string> attributes;
+  std::vector<chpl::uast::PragmaTag> pragmas;
+  // -1 means "don't care", otherwise the required value.
+  int deprecated = -1;
+  int unstable = -1;
+  // Patterns for the first children.size() children; nullptr matches any.
+  std::vector<std::shared_ptr<const AstPattern>> children;
+  std::shared_ptr<const AstPattern> parent;
+  // If non-empty, a matching node is reported under this name.
+  std::string capture;
+
+  bool matchesTag(chpl::uast::AstTag tag) const;
+};
+
+using AstPatternCaptures =
+  std::vector<std::pair<const char*, const chpl::uast::AstNode*>>;
+
+/* Returns true if 'node' matches 'pattern', appending any captured nodes
+   to 'captures'. On failure, 'captures' is left as it was. */
+bool matchAstPattern(chpl::Context* context,
+                     const AstPattern& pattern,
+                     const chpl::uast::AstNode* node,
+                     AstPatternCaptures& captures);
+
+typedef struct {
+  PyObject_HEAD
+  std::shared_ptr<const AstPattern> pattern;
+} PatternObject;
+extern PyTypeObject PatternType;
+
+void setupPatternType();
+
+int PatternObject_init(PatternObject* self, PyObject* args, PyObject* kwargs);
+void PatternObject_dealloc(PatternObject* self);
+
+PyObject* AstNodeObject_match(AstNodeObject* self, PyObject* args);
+PyObject* AstNodeObject_find_matches(AstNodeObject* self, PyObject* args);
+PyObject* ContextObject_find_matches(ContextObject* self, PyObject* args);
+
+#endif // CHAPEL_PY_AST_MATCHER_H
@@ -24,6 +24,7 @@
 #include "iterator-support.h"
 #include "error-tracker.h"
 #include "core-types.h"
+#include "ast-matcher.h"
 #include <utility>
 
 static PyMethodDef ChapelMethods[] = {
@@ -51,6 +52,7 @@ PyMODINIT_FUNC PyInit_core() {
   setupAstCallIterType();
   setupAstNodeType();
   setupPerNodeTypes();
+  setupPatternType();
 
   if (PyType_Ready(&ContextType) < 0) return nullptr;
   if (PyType_Ready(&ErrorType) < 0) return nullptr;
@@ -59,6 +61,7 @@ PyMODINIT_FUNC PyInit_core() {
   if (PyType_Ready(&AstIterType) < 0) return nullptr;
   if (PyType_Ready(&AstCallIterType) < 0) return nullptr;
   if (PyType_Ready(&AstNodeType) < 0) return nullptr;
+  if (PyType_Ready(&PatternType) < 0) return nullptr;
 #define READY_TYPE(NAME) if (PyType_Ready(&NAME##Type) < 0) return nullptr;
 #define AST_NODE(NAME) READY_TYPE(NAME)
 #define AST_LEAF(NAME) READY_TYPE(NAME)
@@ -84,6 +87,7 @@ PyMODINIT_FUNC PyInit_core() {
 #undef AST_BEGIN_SUBCLASSES
 #undef AST_END_SUBCLASSES
   ADD_TYPE(AstNode);
+  ADD_TYPE(Pattern);
   if (PyModule_AddObject(chapelModule, "Context", (PyObject *) &ContextType) < 0) {
     Py_DECREF(&ContextType);
     Py_DECREF(chapelModule);
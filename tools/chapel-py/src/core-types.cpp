@@ -22,6 +22,7 @@
 #include "chpl/parsing/parsing-queries.h"
 #include "python-types.h"
 #include "error-tracker.h"
+#include "ast-matcher.h"
 
 using namespace chpl;
 using namespace uast;
@@ -30,8 +31,11 @@ static PyMethodDef ContextObject_methods[] = {
   { "parse", (PyCFunction) ContextObject_parse, METH_VARARGS, "Parse a top-level AST node from the given file" },
   { "is_bundled_path", (PyCFunction) ContextObject_is_bundled_path, METH_VARARGS, "Check if the given file path is within the bundled (built-in) Chapel files" },
   { "advance_to_next_revision", (PyCFunction) ContextObject_advance_to_next_revision, METH_VARARGS, "Advance the context to the next revision" },
+  { "set_query_memory_budget", (PyCFunction) ContextObject_set_query_memory_budget, METH_VARARGS, "Set how much memory (in bytes) of saved query results collect_garbage keeps; 0 keeps only the results used in the current revision" },
+  { "collect_garbage", (PyCFunction) ContextObject_collect_garbage, METH_NOARGS, "Free saved query results not used in the current revision, beyond the query memory budget. AST nodes from freed results, such as files not parsed again in this revision, become invalid and must not be used afterwards" },
   { "_get_pyi_file", (PyCFunction) ContextObject_get_pyi_file, METH_NOARGS, "Generate a stub file for the Chapel AST nodes" },
   { "track_errors", (PyCFunction) ContextObject_track_errors, METH_NOARGS, "Return a context manager that tracks errors emitted by this Context" },
+  { "find_matches", (PyCFunction) ContextObject_find_matches, METH_VARARGS, "Parse the given file and return the nodes in it that match the given Pattern or list of Patterns" },
   {NULL, NULL, 0, NULL}  /* Sentinel */
 };
 
@@ -118,6 +122,24 @@ PyObject* ContextObject_advance_to_next_revision(ContextObject *self, PyObject*
   Py_RETURN_NONE;
 }
 
+PyObject* ContextObject_set_query_memory_budget(ContextObject *self, PyObject* args) {
+  unsigned long long bytes;
+  if (!PyArg_ParseTuple(args, "K", &bytes)) {
+    PyErr_BadArgument();
+    return nullptr;
+  }
+
+  self->context.setQueryMemoryBudget((size_t) bytes);
+
+  Py_RETURN_NONE;
+}
+
+PyObject* ContextObject_collect_garbage(ContextObject *self, PyObject* Py_UNUSED(args)) {
+  self->context.collectGarbage();
+
+  Py_RETURN_NONE;
+}
+
 template <typename Tuple, size_t ... Indices>
 static void printTypedPythonFunctionArgs(std::ostringstream& ss, std::index_sequence<Indices...>) {
   // std::index_sequence is an empty object that only serves to contain a list
@@ -256,9 +278,11 @@ PyObject* LocationObject_path(LocationObject *self, PyObject* Py_UNUSED(args)) {
 
 static PyMethodDef AstNodeObject_methods[] = {
   {"dump", (PyCFunction) AstNodeObject_dump, METH_NOARGS, "Dump the internal representation of the given AST node"},
+  {"find_matches", (PyCFunction) AstNodeObject_find_matches, METH_VARARGS, "Return the nodes in this subtree that match the given Pattern or list of Patterns"},
   {"tag", (PyCFunction) AstNodeObject_tag, METH_NOARGS, "Get a string representation of the AST node's type"},
   {"attribute_group", (PyCFunction) AstNodeObject_attribute_group, METH_NOARGS, "Get the attribute group, if any, associated with this node"},
   {"location", (PyCFunction) AstNodeObject_location, METH_NOARGS, "Get the location of this AST node in its file"},
+  {"match", (PyCFunction) AstNodeObject_match, METH_VARARGS, "Match this AST node against a Pattern, returning its captures or None"},
   {"parent", (PyCFunction) AstNodeObject_parent, METH_NOARGS, "Get the parent node of this AST node"},
   {"pragmas", (PyCFunction) AstNodeObject_pragmas, METH_NOARGS, "Get the pragmas of this AST node"},
   {"unique_id", (PyCFunction) AstNodeObject_unique_id, METH_NOARGS, "Get a unique identifer for this AST node"},
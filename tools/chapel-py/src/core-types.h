@@ -41,6 +41,8 @@ void ContextObject_dealloc(ContextObject* self);
 PyObject* ContextObject_parse(ContextObject *self, PyObject* args);
 PyObject* ContextObject_is_bundled_path(ContextObject *self, PyObject* args);
 PyObject* ContextObject_advance_to_next_revision(ContextObject *self, PyObject* args);
+PyObject* ContextObject_set_query_memory_budget(ContextObject *self, PyObject* args);
+PyObject* ContextObject_collect_garbage(ContextObject *self, PyObject* args);
 PyObject* ContextObject_get_pyi_file(ContextObject *self, PyObject* args);
 PyObject* ContextObject_track_errors(ContextObject *self, PyObject* args);
 
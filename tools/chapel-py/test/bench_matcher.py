@@ -0,0 +1,90 @@
+#
+# Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+# Other additional copyright holders may be indicated within.
+#
+# The entirety of this work is licensed under the Apache License,
+# Version 2.0 (the "License"); you may not use this file except
+# in compliance with the License.
+#
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""
+Compares finding calls through a named function with a Python walk over
+the AST against doing the same with find_matches.
+
+Run with the chapel-py venv active:
+
+    python3 $CHPL_HOME/tools/chapel-py/test/bench_matcher.py [file.chpl ...]
+
+With no arguments it reads $CHPL_HOME/modules/standard/List.chpl. Each
+file is parsed once up front, so only the searches are timed.
+"""
+
+import os
+import sys
+import time
+
+from chapel.core import Context
+
+PATTERN = {"kind": "FnCall", "children": [{"kind": "Identifier"}]}
+REPEAT = 10
+
+
+def python_walk(node, out):
+    if node.tag() == "FnCall":
+        for child in node:
+            if child.tag() == "Identifier":
+                out.append(node)
+            break
+    for child in node:
+        python_walk(child, out)
+    return out
+
+
+def find_matches(node, out):
+    out.extend(n for (n, _) in node.find_matches(PATTERN))
+    return out
+
+
+def best_of(search, mods):
+    best = None
+    for _ in range(REPEAT):
+        start = time.perf_counter()
+        found = []
+        for mod in mods:
+            search(mod, found)
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return (best, found)
+
+
+def main(paths):
+    if not paths:
+        paths = [os.path.join(os.environ["CHPL_HOME"],
+                              "modules", "standard", "List.chpl")]
+    ctx = Context()
+    mods = [mod for path in paths for mod in ctx.parse(path)]
+
+    (walk_time, walk_found) = best_of(python_walk, mods)
+    (match_time, match_found) = best_of(find_matches, mods)
+
+    assert ([n.unique_id() for n in walk_found] ==
+            [n.unique_id() for n in match_found])
+
+    print("matches:      %d" % len(match_found))
+    print("python walk:  %.2f ms" % (walk_time * 1000))
+    print("find_matches: %.2f ms" % (match_time * 1000))
+    print("ratio:        %.1fx" % (walk_time / match_time))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
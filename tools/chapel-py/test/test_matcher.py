@@ -0,0 +1,173 @@
+#
+# Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+# Other additional copyright holders may be indicated within.
+#
+# The entirety of this work is licensed under the Apache License,
+# Version 2.0 (the "License"); you may not use this file except
+# in compliance with the License.
+#
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""
+Tests for the structural pattern matcher (chapel.core.Pattern,
+AstNode.match and the find_matches methods).
+
+Run with the chapel-py venv active:
+
+    python3 -m unittest discover -s $CHPL_HOME/tools/chapel-py/test
+"""
+
+import os
+import tempfile
+import unittest
+
+from chapel.core import Context, Pattern
+
+SOURCE = """
+module M {
+  proc foo(x: int) { return x + 1; }
+
+  @deprecated("use foo")
+  proc bar() { }
+
+  pragma "inline"
+  proc baz() { var y = foo(1); }
+
+  record R {
+    proc method() { foo(2); }
+  }
+}
+"""
+
+
+class MatcherTest(unittest.TestCase):
+    def setUp(self):
+        fd, self.path = tempfile.mkstemp(suffix=".chpl")
+        with os.fdopen(fd, "w") as f:
+            f.write(SOURCE)
+        self.ctx = Context()
+        (self.mod,) = self.ctx.parse(self.path)
+
+    def tearDown(self):
+        os.remove(self.path)
+
+    def names(self, matches):
+        return [node.name() for (node, _) in matches]
+
+    def test_kind(self):
+        matches = self.mod.find_matches(Pattern("Function"))
+        self.assertEqual(self.names(matches), ["foo", "bar", "baz", "method"])
+        for (_, captures) in matches:
+            self.assertEqual(captures, {})
+
+    def test_abstract_kind(self):
+        matches = self.mod.find_matches({"kind": "AggregateDecl"})
+        self.assertEqual(self.names(matches), ["R"])
+
+    def test_name(self):
+        pattern = {"kind": "Function", "name": ["baz", "bar"]}
+        self.assertEqual(self.names(self.mod.find_matches(pattern)),
+                         ["bar", "baz"])
+
+    def test_deprecated_and_pragma(self):
+        deprecated = {"kind": "Function", "deprecated": True}
+        self.assertEqual(self.names(self.mod.find_matches(deprecated)),
+                         ["bar"])
+        inline = {"kind": "Function", "pragma": "inline"}
+        self.assertEqual(self.names(self.mod.find_matches(inline)), ["baz"])
+
+    def test_parent(self):
+        pattern = {"kind": "Function", "parent": "Record"}
+        self.assertEqual(self.names(self.mod.find_matches(pattern)),
+                         ["method"])
+
+    def test_children_and_captures(self):
+        pattern = Pattern({
+            "kind": "FnCall",
+            "capture": "call",
+            "children": [{"kind": "Identifier", "name": "foo",
+                          "capture": "callee"}],
+        })
+        matches = self.mod.find_matches(pattern)
+        self.assertEqual(len(matches), 2)
+        for (node, captures) in matches:
+            self.assertEqual(sorted(captures.keys()), ["call", "callee"])
+            self.assertEqual(captures["callee"].name(), "foo")
+            self.assertEqual(captures["call"].unique_id(), node.unique_id())
+
+        # a None child matches anything
+        wildcard = {"kind": "FnCall", "children": [None]}
+        self.assertEqual(len(self.mod.find_matches(wildcard)), 2)
+
+    def test_match(self):
+        (foo, _) = self.mod.find_matches({"kind": "Function",
+                                          "name": "foo"})[0]
+        self.assertEqual(foo.match({"kind": "Function", "capture": "f"})
+                         .keys(), {"f"})
+        self.assertIsNone(foo.match("Record"))
+        self.assertIsNone(foo.match({"kind": "Function", "name": "bar"}))
+
+    def test_multiple_patterns(self):
+        patterns = [{"kind": "Function", "name": "baz"}, "Record"]
+        matches = self.mod.find_matches(patterns)
+        self.assertEqual([(i, node.name()) for (i, node, _) in matches],
+                         [(0, "baz"), (1, "R")])
+
+    def test_context_find_matches(self):
+        matches = self.ctx.find_matches(self.path, "Record")
+        self.assertEqual(self.names(matches), ["R"])
+
+    def test_bad_patterns(self):
+        with self.assertRaises(ValueError):
+            Pattern("NotANodeKind")
+        with self.assertRaises(ValueError):
+            Pattern({"bogus": 1})
+        with self.assertRaises(ValueError):
+            Pattern({"pragma": "not a pragma"})
+        with self.assertRaises(TypeError):
+            Pattern({"name": 3})
+        with self.assertRaises(TypeError):
+            Pattern({"name": ["foo", 3]})
+        with self.assertRaises(TypeError):
+            Pattern({"capture": 3})
+        with self.assertRaises(TypeError):
+            Pattern({1: "Function"})
+        with self.assertRaises(TypeError):
+            Pattern(42)
+
+    def test_unencodable_strings(self):
+        # Lone surrogates can't be converted to UTF-8; the conversion
+        # error should be reported rather than crashing.
+        bad = "\udc80"
+        with self.assertRaises(UnicodeEncodeError):
+            Pattern(bad)
+        with self.assertRaises(UnicodeEncodeError):
+            Pattern({"name": bad})
+        with self.assertRaises(UnicodeEncodeError):
+            Pattern({"name": ["foo", bad]})
+        with self.assertRaises(UnicodeEncodeError):
+            Pattern({"capture": bad})
+        with self.assertRaises(UnicodeEncodeError):
+            Pattern({bad: "Function"})
+
+    def test_bad_arguments(self):
+        # errors from argument parsing come through unchanged
+        with self.assertRaisesRegex(TypeError, "argument"):
+            self.mod.match()
+        with self.assertRaisesRegex(TypeError, "argument"):
+            self.mod.find_matches("Function", "Record")
+        with self.assertRaisesRegex(TypeError, "str"):
+            self.ctx.find_matches(3, "Function")
+
+
+if __name__ == "__main__":
+    unittest.main()
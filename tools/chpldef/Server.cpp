@@ -82,6 +82,9 @@ Server::Server(Server::Configuration config)
   errorHandler_ = handler.get();
   chapel_.installErrorHandler(std::move(handler));
 
+  // Bound the memory of saved query results kept by collectGarbage.
+  chapel_.setQueryMemoryBudget(config_.queryMemoryBudgetMiB * 1024 * 1024);
+
   // Open the server log.
   Logger logger;
   if (!config_.logFile.empty()) {
@@ -58,6 +58,7 @@ public:
     Logger::Level logLevel = Logger::OFF;
     std::string chplHome;
     int garbageCollectionFrequency = DEFAULT_GC_FREQUENCY;
+    size_t queryMemoryBudgetMiB = 0;
     bool warnUnstable = false;
     bool enableStandardLibrary = false;
     bool compilerDebugTrace = false;
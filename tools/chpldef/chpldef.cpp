@@ -42,6 +42,7 @@ static Server::Configuration prepareServerConfig(int argc, char** argv) {
   ret.logFile = cmd::logFile;
   ret.logLevel = cmd::logLevel;
   ret.garbageCollectionFrequency = cmd::garbageCollectionFrequency;
+  ret.queryMemoryBudgetMiB = cmd::queryMemoryBudget;
   ret.warnUnstable = cmd::warnUnstable;
   ret.enableStandardLibrary = cmd::enableStandardLibrary;
   ret.compilerDebugTrace = cmd::compilerDebugTrace;
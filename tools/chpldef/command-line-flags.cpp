@@ -49,6 +49,14 @@ Flag<int> garbageCollectionFrequency("gc-frequency",
   llvm::cl::desc("Set the garbage collection frequency"),
   llvm::cl::value_desc("An integer specifying a revision interval"));
 
+Flag<unsigned> queryMemoryBudget("query-memory-budget",
+  llvm::cl::init(0),
+  llvm::cl::desc("Set how much memory of saved query results garbage "
+                 "collection keeps; ASTs from collected results are freed, "
+                 "so handles to them become invalid"),
+  llvm::cl::value_desc("An integer number of MiB, or 0 to keep only "
+                       "the current revision"));
+
 Flag<bool> enableStandardLibrary("enable-std",
   llvm::cl::init(false),
   llvm::cl::desc("Set to enable use of the standard library"));
@@ -60,7 +68,7 @@ Flag<bool> compilerDebugTrace("debug-trace",
 namespace {
 static std::set<const llvm::cl::Option*> flagAddresses = {
   &logFile, &logLevel, &chplHome, &warnUnstable, &garbageCollectionFrequency,
-  &enableStandardLibrary,
+  &queryMemoryBudget, &enableStandardLibrary,
   &compilerDebugTrace
 };
 
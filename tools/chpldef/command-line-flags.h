@@ -54,6 +54,9 @@ extern Flag<bool> warnUnstable;
 /** The GC frequency. Defaults to a server-decided value. */
 extern Flag<int> garbageCollectionFrequency;
 
+/** Memory budget for query results kept by GC in MiB. Defaults to 0. */
+extern Flag<unsigned> queryMemoryBudget;
+
 /** If the standard library should be enabled. Defaults to 'false'. */
 extern Flag<bool> enableStandardLibrary;
 
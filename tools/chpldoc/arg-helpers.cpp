@@ -28,7 +28,7 @@
 #include <cstdlib>
 #include <inttypes.h>
 
-extern chpl::Context* gContext;
+extern thread_local chpl::Context* gContext;
 
 bool developer = false;
 
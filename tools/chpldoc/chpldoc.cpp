@@ -19,6 +19,7 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstring>
 #include <ios>
@@ -28,6 +29,8 @@
 #include <regex>
 #include <unordered_map>
 #include <queue>
+#include <sstream>
+#include <thread>
 
 #include "arg.h"
 #include "arg-helpers.h"
@@ -74,12 +77,14 @@ bool fPrintSettingsHelp = false;
 bool fPrintChplHome = false;
 bool fPrintVersion = false;
 bool fWarnUnknownAttributeToolname = true;
+int fDocsJobs = 1;
 std::string CHPL_THIRD_PARTY;
 
-std::vector<UniqueString> usingAttributeToolNames;
 std::vector<std::string> usingAttributeToolNamesStr;
 
-Context* gContext;
+// The Context in use by the current thread. With --jobs, each worker
+// thread documents its share of the files with its own Context.
+thread_local Context* gContext;
 
 
 static const int indentPerDepth = 3;
@@ -119,14 +124,15 @@ void setHome(const ArgumentDescription* desc, const char* arg) {
   Because the context is not setup during argument processing, it will not work
   to use UniqueString::get() to get the UniqueString for the toolnames. So we
   temporarily store the names as strings during arg processing and then promote
-  them to unique strings here.
+  them to unique strings for each Context here.
 */
-static void promoteAttributeToolNameStrToUniqueString() {
+static std::vector<UniqueString>
+promoteAttributeToolNameStrToUniqueString(Context* context) {
+  std::vector<UniqueString> ret;
   for (auto toolName : usingAttributeToolNamesStr) {
-    UniqueString name = UniqueString::get(gContext, toolName);
-    usingAttributeToolNames.push_back(name);
+    ret.push_back(UniqueString::get(context, toolName));
   }
-  usingAttributeToolNamesStr.clear();
+  return ret;
 }
 
 /*
@@ -189,6 +195,7 @@ ArgumentDescription docs_arg_desc[] = {
  {"print-commands", ' ', NULL, "[Don't] print system commands", "N", &printSystemCommands, "CHPL_PRINT_COMMANDS", NULL},
  {"warn-unknown-attribute-toolname", ' ', NULL, "Enable warnings when an unknown tool name is found in an attribute", "N", &fWarnUnknownAttributeToolname, "CHPL_WARN_UNKNOWN_ATTRIBUTE_TOOLNAME", NULL},
  {"using-attribute-toolname", ' ', "<toolname>", "Specify additional tool names for attributes that are expected in the source", "S", NULL, "CHPL_ATTRIBUTE_TOOLNAMES", addUsingAttributeToolNameStr},
+ {"jobs", 'j', "<n>", "Process input files using <n> threads (0 means one per core)", "I", &fDocsJobs, "CHPLDOC_JOBS", NULL},
  {"", ' ', NULL, "Information Options", NULL, NULL, NULL, NULL},
 
  DRIVER_ARG_HELP,
@@ -1302,6 +1309,29 @@ struct RstSignatureVisitor {
   void exit(const AstNode* a) {}
 };
 
+/*
+  Create 'outDir' if needed and open the .rst (or .txt) file for module 'name'
+  in it. Returns false, after printing why, if that failed.
+*/
+static bool openModuleOutputFile(const std::string& outDir,
+                                 const std::string& name,
+                                 std::ofstream& ofs) {
+  std::string ext = textOnly_ ? ".txt" : ".rst";
+  auto outpath = outDir + "/" + name + ext;
+
+  std::error_code err = makeDir(outDir, true);
+
+  if (err != std::error_code()) {
+    if (err) {
+      std::cerr << "Could not create " << outDir << " because "
+                << err.message() << "\n";
+      return false;
+    }
+  }
+  ofs.open(outpath, std::ios::out);
+  return true;
+}
+
 /**
  Stores the rst docs result of an AstNode and its children.
  `doc` looks like: (using Python's triple quote syntax)
@@ -1349,20 +1379,10 @@ struct RstResult {
   void mark(const Context *c) const {}
 
   void outputModule(std::string outDir, std::string name, int indentPerDepth) {
-    std::string ext = textOnly_ ? ".txt" : ".rst";
-    auto outpath = outDir + "/" + name + ext;
-
-    std::error_code err = makeDir(outDir, true);
-
-    if (err != std::error_code()) {
-      if (err) {
-        std::cerr << "Could not create " << outDir << " because "
-                  << err.message() << "\n";
-        return;
-      }
+    std::ofstream ofs;
+    if (openModuleOutputFile(outDir, name, ofs)) {
+      output(ofs, indentPerDepth);
     }
-    std::ofstream ofs = std::ofstream(outpath, std::ios::out);
-    output(ofs, indentPerDepth);
   }
 
   void output(std::ostream& os, int indentPerDepth) {
@@ -2247,19 +2267,43 @@ class ChpldocErrorHandler : public Context::ErrorHandler {
     return reportedErrors.size();
   }
 
-  void printAndExitIfError(Context* context) {
-    // TODO: handle errors better, don't rely on parse query to emit them
-    // per @mppf: if dyno-chpldoc wants to quit on an error, it should
-    // configure Context::reportError to have a custom function that does so.
-    bool fatal = false;
+  static bool isFatal(const ErrorBase* error) {
+    return error->kind() == ErrorBase::Kind::ERROR ||
+           error->kind() == ErrorBase::Kind::SYNTAX;
+  }
+
+  // Warnings and notes don't count, as they don't stop chpldoc.
+  bool hasFatalErrors() const {
     for (auto& e : reportedErrors) {
+      if (isFatal(e.get())) return true;
+    }
+    return false;
+  }
+
+  std::vector<owned<ErrorBase>> takeErrors() {
+    return std::move(reportedErrors);
+  }
+
+  /* Print 'errors', which were reported by 'context'. Returns true if
+     any of them should stop chpldoc. */
+  static bool printErrors(Context* context,
+                          const std::vector<owned<ErrorBase>>& errors) {
+    bool fatal = false;
+    for (auto& e : errors) {
     // just display the error messages right now, see TODO above
-      if (e->kind() == ErrorBase::Kind::ERROR ||
-          e->kind() == ErrorBase::Kind::SYNTAX) {
+      if (isFatal(e.get())) {
             fatal = true;
       }
       Context::defaultReportError(context, e.get());
     }
+    return fatal;
+  }
+
+  void printAndExitIfError(Context* context) {
+    // TODO: handle errors better, don't rely on parse query to emit them
+    // per @mppf: if dyno-chpldoc wants to quit on an error, it should
+    // configure Context::reportError to have a custom function that does so.
+    bool fatal = printErrors(context, reportedErrors);
     if (fatal) {
       clean_exit(1);
     }
@@ -2267,6 +2311,208 @@ class ChpldocErrorHandler : public Context::ErrorHandler {
   }
 };
 
+/*
+  Configure a freshly created Context for documenting 'files'. The main
+  Context and each --jobs worker's Context are set up the same way.
+*/
+static void setupDocsContext(Context* context, const ChplEnvMap& chplEnv,
+                             const std::vector<std::string>& files) {
+  context->setDetailedErrorOutput(false);
+  chpl::parsing::setAttributeToolNames(context,
+      promoteAttributeToolNameStrToUniqueString(context));
+  chpl::CompilerFlags flags;
+  flags.set(chpl::CompilerFlags::WARN_UNKNOWN_TOOL_SPACED_ATTRS,
+            fWarnUnknownAttributeToolname);
+  // Set the compilation flags all at once using a query.
+  chpl::setCompilerFlags(context, flags);
+
+  // CHPL_MODULE_PATH isn't always in the output; check if it's there.
+  auto it = chplEnv.find("CHPL_MODULE_PATH");
+  auto chplModulePath = (it != chplEnv.end()) ? it->second : "";
+  setupModuleSearchPaths(context,
+                         CHPL_HOME,
+                         false, //minimal modules
+                         chplEnv.at("CHPL_LOCALE_MODEL"),
+                         false, //task tracking
+                         chplEnv.at("CHPL_TASKS"),
+                         chplEnv.at("CHPL_COMM"),
+                         chplEnv.at("CHPL_SYS_MODULES_SUBDIR"),
+                         chplModulePath,
+                         {}, //prependInternalModulePaths,
+                         {}, //prependStandardModulePaths,
+                         {}, //cmdLinePaths
+                         files);
+}
+
+// Parse the file at 'cpath' and gather the modules it documents.
+static void gatherModulesInFile(Context* context, const std::string& cpath,
+                                GatherModulesVisitor& gather) {
+  UniqueString path = UniqueString::get(context, cpath);
+  UniqueString emptyParent;
+
+  std::vector<UniqueString> paths;
+  size_t location = cpath.rfind("/");
+  paths.push_back(UniqueString::get(context,"./"));
+  if (location != std::string::npos) {
+    paths.push_back(UniqueString::get(context, cpath.substr(0, location + 1)));
+  }
+  setModuleSearchPath(context, paths);
+
+  // TODO: Change which query we use to parse files as suggested by @mppf
+  // parseFileContainingIdToBuilderResult(Context* context, ID id);
+  // and then work with the module ID to find the preceding comment.
+  const BuilderResult& builderResult =
+    parseFileToBuilderResultAndCheck(context, path, emptyParent);
+
+  // gather all the top level and used/imported/included module IDs
+  for (const chpl::uast::AstNode* ast : builderResult.topLevelExpressions()) {
+    /* note the use of the above pattern rather than `const auto& ast:`
+        was motivated by a compiler error from chapelmac during smoketests
+        that complained about the pattern and suggested this replacement,
+        which it seems satisfied with.
+    */
+    ast->traverse(gather);
+  }
+}
+
+// Compute the directory and file name (sans extension) for a module's docs.
+static void moduleOutputLocation(Context* context, ID id,
+                                 std::string& outdir,
+                                 std::string& moduleName) {
+  // given a module ID we can get the path to the file that we parsed
+  UniqueString filePath;
+  UniqueString parentSymbol;
+  context->filePathForId(id, filePath, parentSymbol);
+  moduleName = id.symbolName(context).str();
+  std::string parentPath;
+  auto pathVec = id.expandSymbolPath(context, id.symbolPath());
+  // remove last entry
+  pathVec.pop_back();
+  for (auto path : pathVec) {
+    for (int i = 0; i <= path.second; i++) {
+      if (path.first != id.symbolName(context)) {
+        parentPath += unescapeStringId(path.first.str()) + "/";
+      }
+    }
+  }
+  std::string docsWorkingDir_ = filenameFromModuleName(filePath.c_str(), outputDir_);
+  outdir = docsWorkingDir_;
+  // TODO: This is an ugly hack to handle included module paths
+  if (parentSymbol.isEmpty()) {
+    outdir += "/" + parentPath;
+  }
+}
+
+// The docs a --jobs worker produced for one input file.
+struct FileDocs {
+  // Index of the worker (and so the Context) that reported the errors.
+  size_t worker = 0;
+  // Errors from parsing the file, and from rendering its docs.
+  std::vector<owned<ErrorBase>> parseErrors;
+  std::vector<owned<ErrorBase>> docErrors;
+  // (output directory, module name, rendered docs) for each module.
+  std::vector<std::tuple<std::string, std::string, std::string>> modules;
+};
+
+/*
+  Document 'files' using 'numJobs' threads. Each thread has its own Context
+  (the frontend's Context is not thread-safe) and repeatedly takes the next
+  unprocessed file. Workers only render into memory; afterwards, errors are
+  printed and module files written in input file order, so the output does
+  not depend on how the files were scheduled. A module reached from several
+  files (e.g. with --process-used-modules) is written once, as it would be
+  when documenting serially.
+*/
+static void documentFilesInParallel(const std::vector<std::string>& files,
+                                    size_t numJobs,
+                                    const ChplEnvMap& chplEnv) {
+  std::vector<FileDocs> results(files.size());
+  std::vector<owned<Context>> contexts;
+  std::vector<ChpldocErrorHandler*> handlers;
+  for (size_t w = 0; w < numJobs; w++) {
+    Context::Configuration config;
+    config.chplHome = CHPL_HOME;
+    config.toolName = "chpldoc";
+    contexts.push_back(toOwned(new Context(config)));
+    auto handler = new ChpldocErrorHandler(); // wrapped in owned on next line
+    contexts.back()->installErrorHandler(owned<Context::ErrorHandler>(handler));
+    handlers.push_back(handler);
+    setupDocsContext(contexts.back().get(), chplEnv, files);
+  }
+
+  std::atomic<size_t> nextFile(0);
+  auto worker = [&](size_t w) {
+    gContext = contexts[w].get();
+    for (size_t i = nextFile++; i < files.size(); i = nextFile++) {
+      FileDocs& docs = results[i];
+      docs.worker = w;
+
+      GatherModulesVisitor gather(gContext);
+      gatherModulesInFile(gContext, files[i], gather);
+
+      // As in the serial case, don't document a file that failed to parse.
+      // Warnings don't count.
+      bool parsedOk = !handlers[w]->hasFatalErrors();
+      docs.parseErrors = handlers[w]->takeErrors();
+      if (parsedOk) {
+        for (auto id : gather.modules) {
+          if (auto& r = rstDoc(gContext, id)) {
+            std::string outdir;
+            std::string moduleName;
+            moduleOutputLocation(gContext, id, outdir, moduleName);
+            std::ostringstream os;
+            r->output(os, indentPerDepth);
+            docs.modules.emplace_back(outdir, moduleName, os.str());
+          }
+        }
+      }
+      docs.docErrors = handlers[w]->takeErrors();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t w = 1; w < numJobs; w++) {
+    threads.emplace_back(worker, w);
+  }
+  worker(0);
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // The serial case reports every file's parse errors as it goes and
+  // stops at the first file with a fatal one, then reports the errors
+  // from rendering the docs at the end. Match that order.
+  for (auto& docs : results) {
+    if (ChpldocErrorHandler::printErrors(contexts[docs.worker].get(),
+                                         docs.parseErrors)) {
+      clean_exit(1);
+    }
+  }
+
+  std::set<std::string> written;
+  for (auto& docs : results) {
+    for (auto& mod : docs.modules) {
+      auto& outdir = std::get<0>(mod);
+      auto& moduleName = std::get<1>(mod);
+      if (!written.insert(outdir + "/" + moduleName).second) continue;
+
+      std::ofstream ofs;
+      if (openModuleOutputFile(outdir, moduleName, ofs)) {
+        ofs << std::get<2>(mod);
+      }
+    }
+  }
+
+  bool fatal = false;
+  for (auto& docs : results) {
+    fatal |= ChpldocErrorHandler::printErrors(contexts[docs.worker].get(),
+                                              docs.docErrors);
+  }
+  if (fatal) {
+    clean_exit(1);
+  }
+}
+
 int main(int argc, char** argv) {
   Args args = parseArgs(argc, argv, (void*)main);
   std::string warningMsg;
@@ -2316,18 +2562,8 @@ int main(int argc, char** argv) {
   gContext = &context;
   auto erroHandler = new ChpldocErrorHandler(); // wraped in owned on next line
   gContext->installErrorHandler(owned<Context::ErrorHandler>(erroHandler));
-  gContext->setDetailedErrorOutput(false);
   auto chplEnv = gContext->getChplEnv();
   assert(!chplEnv.getError() && "not handling chplenv errors yet");
-  // set any attribute toolnames we processed earlier and clear the local list.
-  promoteAttributeToolNameStrToUniqueString();
-  chpl::parsing::setAttributeToolNames(gContext, usingAttributeToolNames);
-  usingAttributeToolNames.clear();
-  chpl::CompilerFlags flags;
-  flags.set(chpl::CompilerFlags::WARN_UNKNOWN_TOOL_SPACED_ATTRS,
-            fWarnUnknownAttributeToolname);
-  // Set the compilation flags all at once using a query.
-  chpl::setCompilerFlags(gContext, flags);
   // This is the final location for the output format (e.g. the html files.).
   std::string docsOutputDir;
   if (args.outputDir.length() > 0) {
@@ -2371,90 +2607,36 @@ int main(int argc, char** argv) {
 
   outputDir_ = docsRstDir;
 
-  std::string modRoot = CHPL_HOME + "/modules";
-  std::string internal = modRoot + "/internal";
-  std::string bundled = modRoot + "/";
-
-  // CHPL_MODULE_PATH isn't always in the output; check if it's there.
-  auto it = chplEnv->find("CHPL_MODULE_PATH");
-  auto chplModulePath = (it != chplEnv->end()) ? it->second : "";
-  setupModuleSearchPaths(gContext,
-                         CHPL_HOME,
-                         false, //minimal modules
-                         chplEnv->at("CHPL_LOCALE_MODEL"),
-                         false, //task tracking
-                         chplEnv->at("CHPL_TASKS"),
-                         chplEnv->at("CHPL_COMM"),
-                         chplEnv->at("CHPL_SYS_MODULES_SUBDIR"),
-                         chplModulePath,
-                         {}, //prependInternalModulePaths,
-                         {}, //prependStandardModulePaths,
-                         {}, //cmdLinePaths
-                         args.files);
-  GatherModulesVisitor gather(gContext);
+  setupDocsContext(gContext, *chplEnv, args.files);
   printStuff(argv[0], (void*)main);
-  // evaluate all the files and gather the modules
-  for (auto cpath : args.files) {
-    UniqueString path = UniqueString::get(gContext, cpath);
-    UniqueString emptyParent;
-
-    std::vector<UniqueString> paths;
-    size_t location = cpath.rfind("/");
-    paths.push_back(UniqueString::get(gContext,"./"));
-    if (location != std::string::npos) {
-      paths.push_back(UniqueString::get(gContext, cpath.substr(0, location + 1)));
-    }
-    setModuleSearchPath(gContext, paths);
-
-    // TODO: Change which query we use to parse files as suggested by @mppf
-    // parseFileContainingIdToBuilderResult(Context* context, ID id);
-    // and then work with the module ID to find the preceding comment.
-    const BuilderResult& builderResult =
-      parseFileToBuilderResultAndCheck(gContext, path, emptyParent);
-
-    if (erroHandler->numErrors() > 0) {
-      erroHandler->printAndExitIfError(gContext);
-    }
-    // gather all the top level and used/imported/included module IDs
-    for (const chpl::uast::AstNode* ast : builderResult.topLevelExpressions()) {
-      /* note the use of the above pattern rather than `const auto& ast:`
-          was motivated by a compiler error from chapelmac during smoketests
-          that complained about the pattern and suggested this replacement,
-          which it seems satisfied with.
-      */
-      ast->traverse(gather);
-    }
-  }
-
-  for (auto id : gather.modules) {
-    if (auto& r = rstDoc(gContext, id)) {
-        // given a module ID we can get the path to the file that we parsed
-        UniqueString filePath;
-        UniqueString parentSymbol;
-        gContext->filePathForId(id, filePath, parentSymbol);
-        std::string moduleName = id.symbolName(gContext).str();
-        std::string parentPath;
-        auto pathVec = id.expandSymbolPath(gContext, id.symbolPath());
-        // remove last entry
-        pathVec.pop_back();
-        for (auto path : pathVec) {
-          for (int i = 0; i <= path.second; i++) {
-            if (path.first != id.symbolName(gContext)) {
-              parentPath += unescapeStringId(path.first.str()) + "/";
-            }
-          }
-        }
-        std::string docsWorkingDir_ = filenameFromModuleName(filePath.c_str(), outputDir_);
-        std::string outdir = docsWorkingDir_;
-        // TODO: This is an ugly hack to handle included module paths
-        if (parentSymbol.isEmpty()) {
-          outdir += "/" + parentPath;
-        }
 
+  size_t numJobs = fDocsJobs > 0 ? fDocsJobs
+                                 : std::max(1u, std::thread::hardware_concurrency());
+  numJobs = std::min(numJobs, args.files.size());
+  if (numJobs > 1) {
+    documentFilesInParallel(args.files, numJobs, *chplEnv);
+    gContext = &context;
+  } else {
+    GatherModulesVisitor gather(gContext);
+    // evaluate all the files and gather the modules
+    for (auto cpath : args.files) {
+      gatherModulesInFile(gContext, cpath, gather);
+
+      if (erroHandler->numErrors() > 0) {
+        erroHandler->printAndExitIfError(gContext);
+      }
+    }
+
+    for (auto id : gather.modules) {
+      if (auto& r = rstDoc(gContext, id)) {
+        std::string outdir;
+        std::string moduleName;
+        moduleOutputLocation(gContext, id, outdir, moduleName);
         // need to check for a parent module in the path and add it to the directory structure if it exists
         r->outputModule(outdir, moduleName, indentPerDepth);
-     }
-   }
+      }
+    }
+  }
 
   // chpldoc-specific warnings could've been issued, make sure they're printed.
   erroHandler->printAndExitIfError(gContext);
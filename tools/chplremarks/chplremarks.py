@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+
+#
+# Copyright 2020-2023 Hewlett Packard Enterprise Development LP
+# Other additional copyright holders may be indicated within.
+#
+# The entirety of this work is licensed under the Apache License,
+# Version 2.0 (the "License"); you may not use this file except
+# in compliance with the License.
+#
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""
+Show the optimization remarks written by `chpl --opt-remarks=<file>` next to
+the source lines they refer to.
+
+    chpl --fast --opt-remarks=remarks.jsonl foo.chpl
+    chplremarks.py remarks.jsonl
+
+Each remark is printed under its source line, prefixed by '+' for an applied
+optimization, '-' for a missed one and '*' for other analysis information.
+Missed remarks also show the reason the optimization was not applied, when
+the compiler gave one.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+from collections import defaultdict
+
+KIND_MARKERS = {"passed": "+", "missed": "-", "analysis": "*"}
+
+
+def read_remarks(paths):
+    remarks = []
+    for path in paths:
+        with open(path, encoding="utf-8") as f:
+            for lineno, line in enumerate(f, 1):
+                line = line.strip()
+                if not line:
+                    continue
+                try:
+                    remarks.append(json.loads(line))
+                except json.JSONDecodeError as e:
+                    print("{}:{}: ignoring malformed remark: {}"
+                          .format(path, lineno, e), file=sys.stderr)
+    return remarks
+
+
+def keep_remark(remark, args):
+    kind = remark.get("kind", "analysis")
+    if args.missed_only and kind != "missed":
+        return False
+    if args.kind and kind not in args.kind:
+        return False
+    if args.passes and not args.passes.search(remark.get("pass", "")):
+        return False
+    if args.function and remark.get("function") != args.function:
+        return False
+    return True
+
+
+def find_source(filename, search_path):
+    if os.path.isabs(filename):
+        return filename if os.path.exists(filename) else None
+    for directory in search_path:
+        candidate = os.path.join(directory, filename)
+        if os.path.exists(candidate):
+            return candidate
+    return None
+
+
+def read_source(filename, search_path, cache):
+    if filename not in cache:
+        path = find_source(filename, search_path)
+        lines = None
+        if path is not None:
+            with open(path, encoding="utf-8", errors="replace") as f:
+                lines = f.read().splitlines()
+        cache[filename] = lines
+    return cache[filename]
+
+
+def format_remark(remark):
+    marker = KIND_MARKERS.get(remark.get("kind"), "?")
+    text = "{} [{}] {}".format(marker, remark.get("pass", "?"),
+                               remark.get("message", ""))
+    if remark.get("reason"):
+        text += ": " + remark["reason"]
+    return text
+
+
+def render(remarks, args, out):
+    by_file = defaultdict(lambda: defaultdict(list))
+    for remark in remarks:
+        by_file[remark.get("file", "")][remark.get("line", 0)].append(remark)
+
+    search_path = args.source_dir or ["."]
+    source_cache = {}
+
+    for filename in sorted(by_file):
+        lines = read_source(filename, search_path, source_cache)
+        print("=== {} ===".format(filename or "<unknown file>"), file=out)
+
+        by_line = by_file[filename]
+        for lineno in sorted(by_line):
+            if lines is not None and 0 < lineno <= len(lines):
+                source = lines[lineno - 1]
+            else:
+                source = ""
+            print("{:6d} | {}".format(lineno, source), file=out)
+
+            indent = len(source) - len(source.lstrip())
+            for remark in by_line[lineno]:
+                print("       | {}{}".format(" " * indent,
+                                           format_remark(remark)), file=out)
+        print(file=out)
+
+
+def summarize(remarks, out):
+    counts = defaultdict(lambda: defaultdict(int))
+    for remark in remarks:
+        counts[remark.get("pass", "?")][remark.get("kind", "analysis")] += 1
+
+    print("{:32s} {:>8s} {:>8s} {:>8s}".format("pass", "passed", "missed",
+                                               "analysis"), file=out)
+    for name in sorted(counts):
+        c = counts[name]
+        print("{:32s} {:8d} {:8d} {:8d}".format(name, c["passed"],
+                                                c["missed"], c["analysis"]),
+              file=out)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Show chpl optimization remarks next to the source.")
+    parser.add_argument("remarks", nargs="+",
+                        help="remarks file(s) written by --opt-remarks")
+    parser.add_argument("--pass", dest="passes", metavar="REGEX",
+                        help="only show remarks from passes matching REGEX")
+    parser.add_argument("--kind", action="append",
+                        choices=sorted(KIND_MARKERS),
+                        help="only show remarks of this kind (repeatable)")
+    parser.add_argument("--missed-only", action="store_true",
+                        help="only show missed optimizations")
+    parser.add_argument("--function",
+                        help="only show remarks in this function")
+    parser.add_argument("--source-dir", action="append", metavar="DIR",
+                        help="directory to search for source files "
+                             "(repeatable, default: .)")
+    parser.add_argument("--summary", action="store_true",
+                        help="print remark counts per pass instead of source")
+    args = parser.parse_args()
+
+    if args.passes:
+        args.passes = re.compile(args.passes)
+
+    remarks = [r for r in read_remarks(args.remarks) if keep_remark(r, args)]
+
+    if args.summary:
+        summarize(remarks, sys.stdout)
+    else:
+        render(remarks, args, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()